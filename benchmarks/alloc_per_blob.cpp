@@ -0,0 +1,152 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reports the number of heap allocations made per DataBlob delivered through
+// the API when polling with GetNextBlob(), when draining with GetPendingBlobs()
+// and when using a stream callback.  The count covers the whole process: the producer inside the
+// implementation as well as the client-side wrappers.
+//
+// Allocations are counted by replacing the global operator new.  On platforms
+// where a shared library binds to the executable's operator new (Linux/ELF),
+// this includes allocations made inside the hrgls library; elsewhere only the
+// client side is counted.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <hrgls_api.hpp>
+
+static std::atomic<size_t> g_allocations(0);
+
+void *operator new(std::size_t size)
+{
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (size == 0) { size = 1; }
+  void *ret = std::malloc(size);
+  if (!ret) { throw std::bad_alloc(); }
+  return ret;
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+static std::atomic<size_t> g_callbackBlobs(0);
+
+static void CountBlobCallback(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  if (blob.Size() > 0) {
+    g_callbackBlobs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+static void Report(const char *name, size_t blobs, size_t allocations, double seconds)
+{
+  std::cout << name << ": " << blobs << " blobs, "
+    << static_cast<double>(allocations) / blobs << " allocations/blob, "
+    << blobs / seconds << " blobs/second" << std::endl;
+}
+
+int main(int argc, const char *argv[])
+{
+  size_t count = 2000;
+  if (argc > 1) {
+    count = static_cast<size_t>(std::atol(argv[1]));
+    if (count == 0) {
+      std::cerr << "Usage: " << argv[0] << " [BLOB_COUNT]" << std::endl;
+      return -1;
+    }
+  }
+
+  hrgls::API api;
+  if (api.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not open API" << std::endl;
+    return 1;
+  }
+  hrgls::StreamProperties sp;
+  sp.Rate(5000);
+  hrgls::datablob::DataBlobSource stream(api, sp);
+  if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not open DataBlobSource" << std::endl;
+    return 2;
+  }
+
+  //------------------------------------------------------
+  // Polling with GetNextBlob().
+  if (stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not start streaming" << std::endl;
+    return 3;
+  }
+  struct timeval timeout = { 1, 0 };
+  for (size_t i = 0; i < 50; i++) {
+    stream.GetNextBlob(timeout);
+  }
+  size_t start = g_allocations.load();
+  auto startTime = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; i++) {
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not get blob " << i << std::endl;
+      return 4;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  Report("GetNextBlob", count, g_allocations.load() - start, elapsed.count());
+
+  //------------------------------------------------------
+  // Draining with GetPendingBlobs().
+  stream.GetPendingBlobs();
+  start = g_allocations.load();
+  startTime = std::chrono::steady_clock::now();
+  size_t drained = 0;
+  while (drained < count) {
+    drained += stream.GetPendingBlobs(count - drained, timeout).size();
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not get pending blobs" << std::endl;
+      return 6;
+    }
+  }
+  elapsed = std::chrono::steady_clock::now() - startTime;
+  Report("GetPendingBlobs", drained, g_allocations.load() - start, elapsed.count());
+
+  //------------------------------------------------------
+  // Stream callback.
+  if (stream.SetStreamCallback(CountBlobCallback) != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not set stream callback" << std::endl;
+    return 5;
+  }
+  while (g_callbackBlobs.load() < 50) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  size_t startBlobs = g_callbackBlobs.load();
+  start = g_allocations.load();
+  startTime = std::chrono::steady_clock::now();
+  while (g_callbackBlobs.load() - startBlobs < count) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  size_t blobs = g_callbackBlobs.load() - startBlobs;
+  size_t allocations = g_allocations.load() - start;
+  elapsed = std::chrono::steady_clock::now() - startTime;
+  Report("StreamCallback", blobs, allocations, elapsed.count());
+
+  stream.SetStreamingState(false);
+  stream.SetStreamCallback(nullptr);
+  return 0;
+}
@@ -0,0 +1,61 @@
+# Copyright 2020 ReliaSolve, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compares the results of two runs of hourglass_paths (or hourglass_paths.py) and
+# lists every result that got worse by more than the tolerance.  Results that are in
+# only one of the runs are listed but do not count as regressions.  Run as:
+#   python compare_results.py [--tolerance FRACTION] BASELINE.json CURRENT.json
+# Exits with 1 if anything regressed, so that it can be used in a script.
+
+import json
+import sys
+
+def Load(fileName):
+    with open(fileName) as f:
+        return dict((r['name'], r) for r in json.load(f)['results'])
+
+tolerance = 0.25
+args = sys.argv[1:]
+if len(args) >= 2 and args[0] == '--tolerance':
+    tolerance = float(args[1])
+    args = args[2:]
+if len(args) != 2:
+    sys.stderr.write('Usage: {} [--tolerance FRACTION] BASELINE.json CURRENT.json\n'.format(sys.argv[0]))
+    sys.exit(-1)
+
+baseline = Load(args[0])
+current = Load(args[1])
+
+regressions = 0
+for name in sorted(set(baseline) | set(current)):
+    if name not in current:
+        print('missing    {}'.format(name))
+        continue
+    if name not in baseline:
+        print('new        {}: {} {}'.format(name, current[name]['value'], current[name]['unit']))
+        continue
+    was = baseline[name]['value']
+    now = current[name]['value']
+    if current[name]['better'] == 'higher':
+        worse = now < was * (1 - tolerance)
+    else:
+        # Values near zero, such as a dropped fraction of 0, are only worse if they
+        # are worse by more than the tolerance in absolute terms as well.
+        worse = now > was * (1 + tolerance) and now - was > tolerance
+    if worse:
+        regressions += 1
+        print('REGRESSION {}: {} -> {} {}'.format(name, was, now, current[name]['unit']))
+
+print('{} regression(s) beyond {:.0f}%'.format(regressions, 100 * tolerance))
+sys.exit(1 if regressions > 0 else 0)
@@ -0,0 +1,473 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the paths that every call from the C++ interface takes through the C
+// interface to the implementation and back:
+//  - The time per call for calls that do almost nothing, so that the cost of the
+//    round trip dominates.
+//  - The rate at which blobs are delivered, and the latency from when each was
+//    produced to when the client had it, both through a stream callback and through
+//    GetNextBlob(), for several numbers of sources streaming at once.  The rate is
+//    measured with the sources producing as fast as they can and the latency with
+//    them producing at a steady DELIVERY_RATE, so that it is not just the time spent
+//    waiting in a full queue.
+//  - The rate at which log messages are delivered through GetPendingLogMessages() and
+//    the time spent in it per message, and the rate at which they are delivered to a
+//    callback handler that is given a copy of each and to one that borrows them.
+//
+// Progress is printed to standard error and the results are written as JSON to the
+// file named on the command line, or to standard output.  hourglass_paths.py writes
+// the same results for the Python interface and compare_results.py compares two sets
+// of results to find regressions.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <hrgls_api.hpp>
+
+typedef std::chrono::steady_clock Clock;
+
+/// Rate at which each source produces blobs while latency is being measured.
+static const double DELIVERY_RATE = 1000;
+
+/// Keeps the compiler from discarding the results of the calls being timed.
+static volatile long long g_sink;
+
+struct Result {
+  std::string name;
+  double value;
+  std::string unit;
+  bool higherIsBetter;
+};
+static std::vector<Result> g_results;
+
+static void Report(const std::string &name, double value, const std::string &unit,
+  bool higherIsBetter)
+{
+  Result r = { name, value, unit, higherIsBetter };
+  g_results.push_back(r);
+  std::cerr << name << ": " << value << " " << unit << std::endl;
+}
+
+static double Seconds(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Reads the same clock that the NULL implementation stamps its blobs with.
+static long long NowMicroseconds()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static long long Microseconds(const struct timeval &t)
+{
+  return static_cast<long long>(t.tv_sec) * 1000000 + t.tv_usec;
+}
+
+/// One source being streamed from, along with what arrived from it.
+struct Source {
+  std::unique_ptr<hrgls::datablob::DataBlobSource> stream;
+  std::vector<long long> latencies;   ///< Microseconds from production to delivery
+  size_t blobs = 0;
+  uint32_t payload = 0;
+};
+
+static void RecordBlob(Source &source, hrgls::datablob::DataBlob &blob)
+{
+  source.latencies.push_back(NowMicroseconds() - Microseconds(blob.Time()));
+  source.payload = blob.Size();
+  source.blobs++;
+}
+
+static void RecordBlobCallback(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  RecordBlob(*static_cast<Source *>(userData), blob);
+}
+
+static void CountMessageCallback(hrgls::Message &message, void *userData)
+{
+  (*static_cast<std::atomic<size_t> *>(userData))++;
+}
+
+static void CountMessageViewCallback(const hrgls::MessageView &message, void *userData)
+{
+  (*static_cast<std::atomic<size_t> *>(userData))++;
+}
+
+/// Pulls blobs from one source until the deadline passes.
+static void PollSource(Source *source, Clock::time_point deadline)
+{
+  struct timeval timeout = { 0, 100000 };
+  while (Clock::now() < deadline) {
+    hrgls::datablob::DataBlob blob = source->stream->GetNextBlob(timeout);
+    if (source->stream->GetStatus() == hrgls_STATUS_OKAY) {
+      RecordBlob(*source, blob);
+    }
+  }
+}
+
+static double Percentile(const std::vector<long long> &sorted, double fraction)
+{
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t i = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return static_cast<double>(sorted[i]);
+}
+
+/// @brief Streams from a number of sources at once for a time.
+/// @param [in] rate Rate for each source; the latencies are only reported when
+///             paced is true, and the delivery rate only when it is not.
+/// @param [in] payloadSize Size of the blobs that each source sends.
+/// @return 0 on success, nonzero on failure.
+static int Stream(hrgls::API &api, bool callback, size_t sourceCount, double rate,
+  uint32_t payloadSize, bool paced, double seconds)
+{
+  hrgls::StreamProperties sp;
+  sp.Rate(rate);
+  sp.QueueCapacity(4096);
+  sp.PayloadSize(payloadSize);
+  std::vector<Source> sources(sourceCount);
+  for (Source &s : sources) {
+    s.stream.reset(new hrgls::datablob::DataBlobSource(api, sp));
+    if (s.stream->GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not open DataBlobSource" << std::endl;
+      return 1;
+    }
+    s.latencies.reserve(static_cast<size_t>(paced ? 2 * rate * seconds : 1 << 20));
+    if (callback && s.stream->SetStreamCallback(RecordBlobCallback, &s) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set stream callback" << std::endl;
+      return 2;
+    }
+  }
+
+  Clock::time_point start = Clock::now();
+  Clock::time_point deadline = start +
+    std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+  for (Source &s : sources) {
+    if (s.stream->SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start streaming" << std::endl;
+      return 3;
+    }
+  }
+  if (callback) {
+    std::this_thread::sleep_until(deadline);
+  } else {
+    std::vector<std::thread> pollers;
+    for (Source &s : sources) {
+      pollers.push_back(std::thread(PollSource, &s, deadline));
+    }
+    for (std::thread &t : pollers) {
+      t.join();
+    }
+  }
+  double elapsed = Seconds(start);
+
+  // A callback may still be running after streaming is stopped, but not once the
+  // source has been destroyed.
+  size_t blobs = 0;
+  uint64_t dropped = 0;
+  uint32_t payload = 0;
+  std::vector<long long> latencies;
+  for (Source &s : sources) {
+    s.stream->SetStreamingState(false);
+    dropped += s.stream->GetDroppedBlobCount();
+    s.stream.reset();
+    blobs += s.blobs;
+    payload = std::max(payload, s.payload);
+    latencies.insert(latencies.end(), s.latencies.begin(), s.latencies.end());
+  }
+  if (blobs == 0) {
+    std::cerr << "No blobs were delivered" << std::endl;
+    return 4;
+  }
+
+  std::string name = std::string("stream/") + (callback ? "callback" : "GetNextBlob") +
+    "/sources=" + std::to_string(sourceCount) + "/payload=" + std::to_string(payload) + "/";
+  if (!paced) {
+    Report(name + "blobs_per_second", blobs / elapsed, "blobs/s", true);
+    Report(name + "dropped_fraction", static_cast<double>(dropped) / (blobs + dropped),
+      "fraction", false);
+  } else {
+    std::sort(latencies.begin(), latencies.end());
+    Report(name + "latency_p50", Percentile(latencies, 0.50), "us", false);
+    Report(name + "latency_p90", Percentile(latencies, 0.90), "us", false);
+    Report(name + "latency_p99", Percentile(latencies, 0.99), "us", false);
+    Report(name + "latency_max", static_cast<double>(latencies.back()), "us", false);
+  }
+  return 0;
+}
+
+static void WriteResults(std::ostream &out)
+{
+  out << "{\n  \"benchmark\": \"hourglass_paths\",\n  \"language\": \"C++\",\n"
+    << "  \"results\": [\n";
+  out.precision(6);
+  for (size_t i = 0; i < g_results.size(); i++) {
+    const Result &r = g_results[i];
+    out << "    { \"name\": \"" << r.name << "\", \"value\": " << r.value
+      << ", \"unit\": \"" << r.unit << "\", \"better\": \""
+      << (r.higherIsBetter ? "higher" : "lower") << "\" }"
+      << (i + 1 < g_results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+int main(int argc, const char *argv[])
+{
+  double seconds = 0.5;
+  const char *outName = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = std::atof(argv[++i]);
+    } else if (argv[i][0] != '-' && !outName) {
+      outName = argv[i];
+    } else {
+      seconds = 0;
+    }
+    if (seconds <= 0) {
+      std::cerr << "Usage: " << argv[0] << " [--seconds SECONDS_PER_CASE] [RESULTS.json]"
+        << std::endl;
+      return -1;
+    }
+  }
+
+  hrgls::API api;
+  if (api.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not open API" << std::endl;
+    return 1;
+  }
+
+  //------------------------------------------------------
+  // Round trips for calls that do almost nothing.
+  const size_t calls = 1000000;
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < calls; i++) {
+    g_sink = g_sink + api.GetVerbosity();
+  }
+  Report("call/API::GetVerbosity", 1e9 * Seconds(start) / calls, "ns/call", false);
+
+  // Recording a trace event, with tracing off and on.
+  start = Clock::now();
+  for (size_t i = 0; i < calls; i++) {
+    hrgls_TraceRecord(hrgls_TRACE_USER, 1, i);
+  }
+  Report("trace/record_off", 1e9 * Seconds(start) / calls, "ns/call", false);
+  hrgls_TraceStart(0);
+  start = Clock::now();
+  for (size_t i = 0; i < calls; i++) {
+    hrgls_TraceRecord(hrgls_TRACE_USER, 1, i);
+  }
+  Report("trace/record_on", 1e9 * Seconds(start) / calls, "ns/call", false);
+  hrgls_TraceStop();
+
+  {
+    hrgls::StreamProperties sp;
+    sp.Rate(1000);
+    hrgls::datablob::DataBlobSource stream(api, sp);
+    stream.SetStreamingState(true);
+    struct timeval timeout = { 1, 0 };
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not get blob" << std::endl;
+      return 2;
+    }
+    stream.SetStreamingState(false);
+
+    start = Clock::now();
+    for (size_t i = 0; i < calls; i++) {
+      g_sink = g_sink + blob.Size();
+    }
+    Report("call/DataBlob::Size", 1e9 * Seconds(start) / calls, "ns/call", false);
+
+    start = Clock::now();
+    for (size_t i = 0; i < calls; i++) {
+      g_sink = g_sink + blob.Time().tv_usec;
+    }
+    Report("call/DataBlob::Time", 1e9 * Seconds(start) / calls, "ns/call", false);
+
+    start = Clock::now();
+    for (size_t i = 0; i < calls; i++) {
+      hrgls::datablob::DataBlob copy(blob);
+      g_sink = g_sink + copy.Size();
+    }
+    Report("call/DataBlob::copy_and_destroy", 1e9 * Seconds(start) / calls, "ns/call", false);
+  }
+
+  //------------------------------------------------------
+  // Discovering and opening sources when there are many of them.
+  {
+    const uint32_t manySources = 5000;
+    hrgls::API many(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", manySources);
+    std::string lastName = "/hrgls/null/DataBlobSource/" + std::to_string(manySources);
+    const size_t lists = 100;
+    start = Clock::now();
+    for (size_t i = 0; i < lists; i++) {
+      g_sink = g_sink + many.GetAvailableDataBlobSources().size();
+    }
+    Report("discovery/list/sources=5000", 1e6 * Seconds(start) / lists, "us/call", false);
+    start = Clock::now();
+    for (size_t i = 0; i < lists; i++) {
+      g_sink = g_sink + many.DataBlobSourcesChangedSince(many.GetDataBlobSourceGeneration());
+    }
+    Report("discovery/changed_since/sources=5000", 1e6 * Seconds(start) / lists, "us/call", false);
+    hrgls::StreamProperties sp;
+    start = Clock::now();
+    for (size_t i = 0; i < lists; i++) {
+      hrgls::datablob::DataBlobSource s(many, sp, lastName);
+      g_sink = g_sink + s.GetStatus();
+    }
+    Report("discovery/open_by_name/sources=5000", 1e6 * Seconds(start) / lists, "us/call", false);
+
+    // Bringing all of them up and down one at a time and as a group; the time is per source.
+    start = Clock::now();
+    {
+      std::vector<hrgls::datablob::DataBlobSource *> each;
+      for (uint32_t i = 1; i <= manySources; i++) {
+        each.push_back(new hrgls::datablob::DataBlobSource(many, sp,
+          "/hrgls/null/DataBlobSource/" + std::to_string(i)));
+      }
+      for (size_t i = 0; i < each.size(); i++) {
+        each[i]->SetStreamingState(true);
+      }
+      for (size_t i = 0; i < each.size(); i++) {
+        each[i]->SetStreamingState(false);
+        delete each[i];
+      }
+    }
+    Report("bringup/each/sources=5000", 1e6 * Seconds(start) / manySources, "us/source", false);
+    start = Clock::now();
+    {
+      hrgls::datablob::DataBlobSourceGroup group(many, sp);
+      group.SetStreamingState(true);
+      group.SetStreamingState(false);
+      g_sink = g_sink + group.Size();
+    }
+    Report("bringup/group/sources=5000", 1e6 * Seconds(start) / manySources, "us/source", false);
+  }
+
+  //------------------------------------------------------
+  // Streaming blobs.  The number of sources is varied with the default payload size,
+  // and then the payload size is varied with a single source; the size is part of each
+  // result's name.
+  const size_t sourceCounts[] = { 1, 4, 16 };
+  const uint32_t payloadSizes[] = { 64, 4096, 65536 };
+  for (int callback = 0; callback < 2; callback++) {
+    for (size_t sourceCount : sourceCounts) {
+      if (int ret = Stream(api, callback != 0, sourceCount, 1e6, 256, false, seconds)) {
+        return 10 + ret;
+      }
+      if (int ret = Stream(api, callback != 0, sourceCount, DELIVERY_RATE, 256, true, seconds)) {
+        return 20 + ret;
+      }
+    }
+    for (uint32_t payloadSize : payloadSizes) {
+      if (int ret = Stream(api, callback != 0, 1, 1e6, payloadSize, false, seconds)) {
+        return 10 + ret;
+      }
+    }
+  }
+
+  //------------------------------------------------------
+  // Log messages.
+  if (api.SetLogMessageMinimumLevel(hrgls_MESSAGE_MINIMUM_INFO) != hrgls_STATUS_OKAY ||
+      api.SetLogMessageStreamingState(true) != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not start log messages" << std::endl;
+    return 30;
+  }
+  api.GetPendingLogMessages();
+  start = Clock::now();
+  const size_t emptyCalls = 100000;
+  for (size_t i = 0; i < emptyCalls; i++) {
+    g_sink = g_sink + api.GetPendingLogMessages().size();
+  }
+  Report("log/GetPendingLogMessages_call", 1e9 * Seconds(start) / emptyCalls, "ns/call", false);
+
+  api.SetLogMessageStreamingState(false);
+
+  // The messages are drained as they arrive from an API that generates a million a
+  // second; only the calls that returned some count towards the time per message.
+  hrgls::API loud(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1e6);
+  if (loud.GetStatus() != hrgls_STATUS_OKAY ||
+      loud.SetLogMessageMinimumLevel(hrgls_MESSAGE_MINIMUM_INFO) != hrgls_STATUS_OKAY ||
+      loud.SetLogMessageStreamingState(true) != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not start log messages" << std::endl;
+    return 30;
+  }
+  size_t messages = 0;
+  double inCalls = 0;
+  start = Clock::now();
+  double logSeconds = std::max(seconds, 1.0);
+  while (Seconds(start) < logSeconds) {
+    Clock::time_point callStart = Clock::now();
+    std::vector<hrgls::Message> got = loud.GetPendingLogMessages();
+    if (!got.empty()) {
+      inCalls += Seconds(callStart);
+      messages += got.size();
+    }
+    std::this_thread::yield();
+  }
+  double elapsed = Seconds(start);
+  loud.SetLogMessageStreamingState(false);
+  if (messages == 0) {
+    std::cerr << "No log messages were delivered" << std::endl;
+    return 31;
+  }
+  Report("log/messages_per_second", messages / elapsed, "messages/s", true);
+  Report("log/time_per_message", 1e9 * inCalls / messages, "ns/message", false);
+
+  // Messages from an API that generates them as fast as it can, handed to each kind of
+  // callback handler on the thread that generates them.
+  hrgls::API flood(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1e9);
+  for (int view = 0; view < 2; view++) {
+    std::atomic<size_t> count(0);
+    if (view) {
+      flood.SetLogMessageViewCallback(CountMessageViewCallback, &count);
+    } else {
+      flood.SetLogMessageCallback(CountMessageCallback, &count);
+    }
+    start = Clock::now();
+    flood.SetLogMessageStreamingState(true);
+    std::this_thread::sleep_for(std::chrono::duration<double>(logSeconds));
+    flood.SetLogMessageStreamingState(false);
+    elapsed = Seconds(start);
+    flood.SetLogMessageCallback(nullptr, nullptr);
+    Report(view ? "log/view_callback/messages_per_second" : "log/callback/messages_per_second",
+      count.load() / elapsed, "messages/s", true);
+  }
+
+  if (outName) {
+    std::ofstream out(outName);
+    WriteResults(out);
+    if (!out) {
+      std::cerr << "Could not write " << outName << std::endl;
+      return 40;
+    }
+  } else {
+    WriteResults(std::cout);
+  }
+  return 0;
+}
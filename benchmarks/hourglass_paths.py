@@ -0,0 +1,247 @@
+# Copyright 2020 ReliaSolve, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Measures the same paths as hourglass_paths.cpp, but from Python through the
+# hrglspy wrapper, and writes its results in the same form so that compare_results.py
+# can check them.  Run as:
+#   python hourglass_paths.py [--seconds SECONDS_PER_CASE] [RESULTS.json]
+
+# Import the hrgls library
+import hrglspy as hrgls
+import json
+import sys
+import threading
+import time
+
+# Rate at which each source produces blobs while latency is being measured.
+DELIVERY_RATE = 1000
+
+results = []
+
+def Report(name, value, unit, higherIsBetter):
+    results.append({'name': name, 'value': value, 'unit': unit,
+        'better': 'higher' if higherIsBetter else 'lower'})
+    sys.stderr.write('{}: {} {}\n'.format(name, value, unit))
+
+def Microseconds(t):
+    return t.tv_sec * 1000000 + t.tv_usec
+
+# One source being streamed from, along with what arrived from it.
+class Source:
+    def __init__(self, api, sp):
+        self.stream = hrgls.DataBlobSource(api, sp)
+        self.latencies = []
+        self.payload = 0
+
+    def Record(self, blob):
+        now = int(time.time() * 1000000)
+        self.latencies.append(now - Microseconds(blob.Time()))
+        self.payload = blob.Size()
+
+def RecordBlobCallback(blob, source):
+    source.Record(blob)
+
+def PollSource(source, deadline):
+    timeout = hrgls.timeval()
+    timeout.tv_sec = 0
+    timeout.tv_usec = 100000
+    while time.monotonic() < deadline:
+        blob = source.stream.GetNextBlob(timeout)
+        if source.stream.GetStatus() == hrgls.hrgls_STATUS_OKAY:
+            source.Record(blob)
+
+def Percentile(ordered, fraction):
+    if len(ordered) == 0:
+        return 0
+    return float(ordered[int(fraction * (len(ordered) - 1) + 0.5)])
+
+def Stream(api, callback, sourceCount, rate, payloadSize, paced, seconds):
+    sp = hrgls.StreamProperties()
+    sp.Rate(rate)
+    sp.QueueCapacity(4096)
+    sp.PayloadSize(payloadSize)
+    sources = []
+    for i in range(sourceCount):
+        s = Source(api, sp)
+        if s.stream.GetStatus() != hrgls.hrgls_STATUS_OKAY:
+            sys.stderr.write('Could not open DataBlobSource\n')
+            sys.exit(11)
+        if callback and s.stream.SetStreamCallback(RecordBlobCallback, s) != hrgls.hrgls_STATUS_OKAY:
+            sys.stderr.write('Could not set stream callback\n')
+            sys.exit(12)
+        sources.append(s)
+
+    start = time.monotonic()
+    deadline = start + seconds
+    for s in sources:
+        if s.stream.SetStreamingState(True) != hrgls.hrgls_STATUS_OKAY:
+            sys.stderr.write('Could not start streaming\n')
+            sys.exit(13)
+    if callback:
+        time.sleep(seconds)
+    else:
+        pollers = [threading.Thread(target=PollSource, args=(s, deadline)) for s in sources]
+        for t in pollers:
+            t.start()
+        for t in pollers:
+            t.join()
+    elapsed = time.monotonic() - start
+
+    blobs = 0
+    dropped = 0
+    payload = 0
+    latencies = []
+    for s in sources:
+        s.stream.SetStreamingState(False)
+        if callback:
+            s.stream.SetStreamCallback(None, None)
+        dropped += s.stream.GetDroppedBlobCount()
+        blobs += len(s.latencies)
+        payload = max(payload, s.payload)
+        latencies.extend(s.latencies)
+    if blobs == 0:
+        sys.stderr.write('No blobs were delivered\n')
+        sys.exit(14)
+
+    name = 'stream/{}/sources={}/payload={}/'.format(
+        'callback' if callback else 'GetNextBlob', sourceCount, payload)
+    if not paced:
+        Report(name + 'blobs_per_second', blobs / elapsed, 'blobs/s', True)
+        Report(name + 'dropped_fraction', dropped / float(blobs + dropped), 'fraction', False)
+    else:
+        latencies.sort()
+        Report(name + 'latency_p50', Percentile(latencies, 0.50), 'us', False)
+        Report(name + 'latency_p90', Percentile(latencies, 0.90), 'us', False)
+        Report(name + 'latency_p99', Percentile(latencies, 0.99), 'us', False)
+        Report(name + 'latency_max', float(latencies[-1]), 'us', False)
+
+seconds = 0.5
+outName = None
+args = sys.argv[1:]
+while len(args) > 0:
+    arg = args.pop(0)
+    if arg == '--seconds' and len(args) > 0:
+        seconds = float(args.pop(0))
+    elif not arg.startswith('-') and outName is None:
+        outName = arg
+    else:
+        seconds = 0
+    if seconds <= 0:
+        sys.stderr.write('Usage: {} [--seconds SECONDS_PER_CASE] [RESULTS.json]\n'.format(sys.argv[0]))
+        sys.exit(-1)
+
+api = hrgls.API()
+if api.GetStatus() != hrgls.hrgls_STATUS_OKAY:
+    sys.stderr.write('Could not open API\n')
+    sys.exit(1)
+
+#------------------------------------------------------
+# Round trips for calls that do almost nothing.
+calls = 200000
+start = time.perf_counter()
+for i in range(calls):
+    api.GetVerbosity()
+Report('call/API::GetVerbosity', 1e9 * (time.perf_counter() - start) / calls, 'ns/call', False)
+
+sp = hrgls.StreamProperties()
+sp.Rate(1000)
+stream = hrgls.DataBlobSource(api, sp)
+stream.SetStreamingState(True)
+timeout = hrgls.timeval()
+timeout.tv_sec = 1
+timeout.tv_usec = 0
+blob = stream.GetNextBlob(timeout)
+if stream.GetStatus() != hrgls.hrgls_STATUS_OKAY:
+    sys.stderr.write('Could not get blob\n')
+    sys.exit(2)
+stream.SetStreamingState(False)
+
+start = time.perf_counter()
+for i in range(calls):
+    blob.Size()
+Report('call/DataBlob::Size', 1e9 * (time.perf_counter() - start) / calls, 'ns/call', False)
+
+start = time.perf_counter()
+for i in range(calls):
+    blob.Time()
+Report('call/DataBlob::Time', 1e9 * (time.perf_counter() - start) / calls, 'ns/call', False)
+
+start = time.perf_counter()
+for i in range(calls):
+    hrgls.DataBlob(blob)
+Report('call/DataBlob::copy_and_destroy', 1e9 * (time.perf_counter() - start) / calls,
+    'ns/call', False)
+blob = None
+stream = None
+
+#------------------------------------------------------
+# Streaming blobs.  The number of sources is varied with the default payload size,
+# and then the payload size is varied with a single source; the size is part of each
+# result's name.
+for callback in (False, True):
+    for sourceCount in (1, 4, 16):
+        Stream(api, callback, sourceCount, 1e6, 256, False, seconds)
+        Stream(api, callback, sourceCount, DELIVERY_RATE, 256, True, seconds)
+    for payloadSize in (64, 4096, 65536):
+        Stream(api, callback, 1, 1e6, payloadSize, False, seconds)
+
+#------------------------------------------------------
+# Log messages.
+if (api.SetLogMessageMinimumLevel(hrgls.hrgls_MESSAGE_MINIMUM_INFO) != hrgls.hrgls_STATUS_OKAY or
+        api.SetLogMessageStreamingState(True) != hrgls.hrgls_STATUS_OKAY):
+    sys.stderr.write('Could not start log messages\n')
+    sys.exit(30)
+api.GetPendingLogMessages()
+emptyCalls = 100000
+start = time.perf_counter()
+for i in range(emptyCalls):
+    api.GetPendingLogMessages()
+Report('log/GetPendingLogMessages_call', 1e9 * (time.perf_counter() - start) / emptyCalls,
+    'ns/call', False)
+
+api.SetLogMessageStreamingState(False)
+
+# The messages are drained as they arrive from an API that generates a million a
+# second; only the calls that returned some count towards the time per message.
+loud = hrgls.API(hrgls.cvar.ANONYMOUS_USER, hrgls.cvar.NO_CREDENTIALS, 0, '', '', 2, 1e6)
+if (loud.GetStatus() != hrgls.hrgls_STATUS_OKAY or
+        loud.SetLogMessageMinimumLevel(hrgls.hrgls_MESSAGE_MINIMUM_INFO) != hrgls.hrgls_STATUS_OKAY or
+        loud.SetLogMessageStreamingState(True) != hrgls.hrgls_STATUS_OKAY):
+    sys.stderr.write('Could not start log messages\n')
+    sys.exit(30)
+messages = 0
+inCalls = 0.0
+start = time.perf_counter()
+while time.perf_counter() - start < max(seconds, 1.0):
+    callStart = time.perf_counter()
+    got = loud.GetPendingLogMessages()
+    if len(got) > 0:
+        inCalls += time.perf_counter() - callStart
+        messages += len(got)
+elapsed = time.perf_counter() - start
+loud.SetLogMessageStreamingState(False)
+if messages == 0:
+    sys.stderr.write('No log messages were delivered\n')
+    sys.exit(31)
+Report('log/messages_per_second', messages / elapsed, 'messages/s', True)
+Report('log/time_per_message', 1e9 * inCalls / messages, 'ns/message', False)
+
+report = {'benchmark': 'hourglass_paths', 'language': 'Python', 'results': results}
+if outName is not None:
+    with open(outName, 'w') as f:
+        json.dump(report, f, indent=2)
+        f.write('\n')
+else:
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write('\n')
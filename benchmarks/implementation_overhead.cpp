@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares an API implemented by the library the program is linked against with
+// one implemented by the loadable NULL implementation, which is called through its
+// function table.  Reports the time to create and destroy an API (including loading
+// the library the first time it is named), the time per call for cheap calls on a
+// blob, where the extra indirection matters most, and the rate at which blobs can be
+// drained from a source.  The build tells it where the loadable NULL implementation
+// is in HRGLS_NULL_IMPLEMENTATION.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <hrgls_api.hpp>
+
+typedef std::chrono::steady_clock Clock;
+
+/// Keeps the compiler from discarding the results of the calls being timed.
+static volatile long long g_sink;
+
+static double Seconds(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// @brief Times the calls on one implementation; an empty name is the linked one.
+/// @return 0 on success, nonzero on failure.
+static int Measure(const char *label, const std::string &implementation, size_t count)
+{
+  // The first API from a library pays to load it.
+  Clock::time_point start = Clock::now();
+  {
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", implementation);
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << label << ": could not open API" << std::endl;
+      return 1;
+    }
+  }
+  double first = Seconds(start);
+  const size_t apis = 100;
+  start = Clock::now();
+  for (size_t i = 0; i < apis; i++) {
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", implementation);
+  }
+  double later = Seconds(start) / apis;
+
+  hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", implementation);
+  hrgls::StreamProperties sp;
+  sp.Rate(1e6);
+  sp.QueueCapacity(4096);
+  hrgls::datablob::DataBlobSource stream(api, sp);
+  if (stream.GetStatus() != hrgls_STATUS_OKAY ||
+      stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+    std::cerr << label << ": could not start DataBlobSource" << std::endl;
+    return 2;
+  }
+  struct timeval timeout = { 1, 0 };
+  hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+  if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << label << ": could not get blob" << std::endl;
+    return 3;
+  }
+  hrgls_DataBlob raw = blob.RawDataBlob();
+
+  // A call that does almost nothing, so the cost of reaching it dominates.
+  struct timeval t;
+  long long sum = 0;
+  start = Clock::now();
+  for (size_t i = 0; i < count; i++) {
+    hrgls_DataBlobGetTime(raw, &t);
+    sum += t.tv_usec;
+  }
+  double getTime = Seconds(start) / count;
+  g_sink = sum;
+
+  // Copying and destroying a handle, as is done whenever a blob is passed around.
+  start = Clock::now();
+  for (size_t i = 0; i < count; i++) {
+    hrgls_DataBlob copy;
+    hrgls_DataBlobCopy(&copy, raw);
+    hrgls_DataBlobDestroy(copy);
+  }
+  double copy = Seconds(start) / count;
+
+  // Draining blobs, which makes several calls per blob.
+  size_t drained = 0;
+  start = Clock::now();
+  while (drained < count / 100) {
+    drained += stream.GetPendingBlobs(64, timeout).size();
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << label << ": could not get pending blobs" << std::endl;
+      return 4;
+    }
+  }
+  double rate = drained / Seconds(start);
+  stream.SetStreamingState(false);
+
+  std::cout << label << ": first API " << first * 1e3 << " ms, later APIs "
+    << later * 1e3 << " ms, DataBlobGetTime " << getTime * 1e9 << " ns, DataBlobCopy+Destroy "
+    << copy * 1e9 << " ns, GetPendingBlobs " << rate << " blobs/second" << std::endl;
+  return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+  size_t count = 10000000;
+  if (argc > 1) {
+    count = static_cast<size_t>(std::atol(argv[1]));
+    if (count < 100) {
+      std::cerr << "Usage: " << argv[0] << " [CALL_COUNT >= 100]" << std::endl;
+      return -1;
+    }
+  }
+#ifdef HRGLS_NULL_IMPLEMENTATION
+  int ret = Measure("Linked", "", count);
+  if (ret == 0) {
+    ret = Measure("Loaded", HRGLS_NULL_IMPLEMENTATION, count);
+  }
+  return ret;
+#else
+  std::cerr << "Built without the loadable NULL implementation" << std::endl;
+  return 1;
+#endif
+}
@@ -172,8 +172,8 @@ int main(int argc, const char *argv[])
 
     size_t count = 0;
     do {
-      // Return immediately if we don't get a blob.
-      struct timeval timeout = { 0,0 };
+      // Wait up to 100 milliseconds for a blob; the thread sleeps while it waits.
+      struct timeval timeout = { 0, 100000 };
       hrgls_DataBlob blob;
       status = hrgls_DataBlobSourceGetNextBlob(stream, &blob, timeout);
       if (hrgls_STATUS_OKAY == status) {
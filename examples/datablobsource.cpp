@@ -109,9 +109,11 @@ int main(int argc, const char *argv[])
       return 15;
     }
 
+    // Wait up to 100 milliseconds for each blob; the thread sleeps while it waits.
+    struct timeval timeout = { 0, 100000 };
     size_t count = 0;
     do {
-      hrgls::datablob::DataBlob blob = stream->GetNextBlob();
+      hrgls::datablob::DataBlob blob = stream->GetNextBlob(timeout);
       status = stream->GetStatus();
       if (hrgls_STATUS_OKAY == status) {
 
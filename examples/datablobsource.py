@@ -1,7 +1,6 @@
 # Import the hrgls library
 import hrglspy as hrgls
 import sys
-import ctypes
 import time
 
 # Handler for callback-based reading of DataBlob
@@ -78,17 +77,22 @@ print('Get-based blob reading')
 if (stream.SetStreamingState(True) != hrgls.hrgls_STATUS_OKAY):
     print('Could not set streaming state on: ', hrgls.hrgls_ErrorMessage(status))
     sys.exit(15)
+# Wait up to 100 milliseconds for each blob; the thread sleeps (and releases
+# the Python global interpreter lock) while it waits.
+timeout = hrgls.timeval()
+timeout.tv_sec = 0
+timeout.tv_usec = 100000
 count = 0
 while (count <= 10):
-    blob = stream.GetNextBlob()
+    blob = stream.GetNextBlob(timeout)
     status = stream.GetStatus()
     if (status == hrgls.hrgls_STATUS_OKAY):
         count = count + 1
 
-        # Convert the data we received into a bytearray so that
-        # we can deal with it in a manner useful to Python
-        myCArray = ctypes.cast(int(blob.Data()), ctypes.POINTER(ctypes.c_char * blob.Size()))[0]
-        myArray  = bytearray(myCArray)
+        # View the data we received as a read-only NumPy array of bytes.
+        # This does not copy the data, and the array keeps it valid for as
+        # long as the array exists, even after the blob's data is released.
+        myArray = blob.AsArray()
         if (len(myArray) >= 2):
             print(' first char = ',myArray[0])
             print(' second char = ',myArray[1])
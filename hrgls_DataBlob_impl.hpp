@@ -12,8 +12,8 @@
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
  * See the License for the specific language governing permissions and
  * limitations under the License.
- */
-
+ */
+
 #pragma once
 
 /**
@@ -28,6 +28,16 @@
 
 #include <string.h>
 
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+// A client built directly against the implementation (see hrgls_api.hpp) sees these
+// definitions as well as the library does, so they are inline, and blobs that this
+// library made are read straight from their handles rather than through the C layer.
+#include "hrgls_Handle_impl.hpp"
+#define hrgls_DATABLOB_METHOD inline
+#else
+#define hrgls_DATABLOB_METHOD
+#endif
+
 namespace hrgls {
 
   namespace datablob {
@@ -36,15 +46,39 @@ namespace hrgls {
     public:
       hrgls_DataBlob blob = nullptr;
       hrgls_Status status = hrgls_STATUS_OKAY;
+
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+      /// @brief True if our handle was made by this library, so it can be read directly.
+      bool IsLocal() const
+      {
+        return hrgls_ImplementationOf(blob) == &hrgls_ThisImplementation;
+      }
+
+      /// @brief Read the data of a local handle as hrgls_DataBlobGetData() does.
+      hrgls_Status GetData(const uint8_t *&data, uint32_t &size) const
+      {
+        const hrgls_DataBlobPayload_ *payload = blob->payload;
+        data = nullptr;
+        size = 0;
+        if (payload) {
+          if (!payload->InOnePiece()) {
+            return hrgls_STATUS_SEGMENTED_DATA;
+          }
+          data = payload->first.data;
+          size = static_cast<uint32_t>(payload->totalSize);
+        }
+        return hrgls_STATUS_OKAY;
+      }
+#endif
     };
 
-    DataBlob::DataBlob()
+    hrgls_DATABLOB_METHOD DataBlob::DataBlob()
     {
       m_private = new DataBlob_private;
       m_private->status = hrgls_DataBlobCreate(&m_private->blob);
     }
 
-    DataBlob::DataBlob(hrgls_DataBlob blob)
+    hrgls_DATABLOB_METHOD DataBlob::DataBlob(hrgls_DataBlob blob)
     {
       m_private = new DataBlob_private;
       if (!blob) {
@@ -54,7 +88,7 @@ namespace hrgls {
       m_private->status = hrgls_DataBlobCopy(&m_private->blob, blob);
     }
 
-    DataBlob::~DataBlob()
+    hrgls_DATABLOB_METHOD DataBlob::~DataBlob()
     {
       if (m_private) {
         if (m_private->blob) {
@@ -64,13 +98,13 @@ namespace hrgls {
       }
     }
 
-    DataBlob::DataBlob(const DataBlob&copy)
+    hrgls_DATABLOB_METHOD DataBlob::DataBlob(const DataBlob&copy)
     {
       m_private = new DataBlob_private();
       m_private->status = hrgls_DataBlobCopy(&m_private->blob, copy.RawDataBlob());
     }
 
-    DataBlob& DataBlob::operator = (const DataBlob&copy)
+    hrgls_DATABLOB_METHOD DataBlob& DataBlob::operator = (const DataBlob&copy)
     {
       // Get rid of any pre-existing data that we have.
       if (m_private) {
@@ -85,7 +119,50 @@ namespace hrgls {
       return *this;
     }
 
-    hrgls_Status DataBlob::GetStatus()
+    hrgls_DATABLOB_METHOD DataBlob::DataBlob(DataBlob&& other) noexcept
+    {
+      m_private = other.m_private;
+      other.m_private = nullptr;
+    }
+
+    hrgls_DATABLOB_METHOD DataBlob& DataBlob::operator = (DataBlob&& other) noexcept
+    {
+      if (this != &other) {
+        if (m_private) {
+          if (m_private->blob) {
+            hrgls_DataBlobDestroy(m_private->blob);
+          }
+          delete m_private;
+        }
+        m_private = other.m_private;
+        other.m_private = nullptr;
+      }
+      return *this;
+    }
+
+    hrgls_DATABLOB_METHOD DataBlob DataBlob::Adopt(hrgls_DataBlob blob)
+    {
+      // Constructing from a null handle allocates only our private data, which
+      // we then point at the blob we were handed.
+      DataBlob ret(static_cast<hrgls_DataBlob>(nullptr));
+      if (blob) {
+        ret.m_private->blob = blob;
+        ret.m_private->status = hrgls_STATUS_OKAY;
+      }
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD hrgls_DataBlob DataBlob::Detach()
+    {
+      hrgls_DataBlob ret = nullptr;
+      if (m_private) {
+        ret = m_private->blob;
+        m_private->blob = nullptr;
+      }
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD hrgls_Status DataBlob::GetStatus()
     {
       if (!m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
@@ -93,13 +170,22 @@ namespace hrgls {
       return m_private->status;
     }
 
-    struct timeval DataBlob::Time() const
+    hrgls_DATABLOB_METHOD struct timeval DataBlob::Time() const
     {
       struct timeval ret = {};
+      if (!m_private) {
+        return ret;
+      }
       if (!m_private->blob) {
         m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
         return ret;
       }
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+      if (m_private->IsLocal()) {
+        m_private->status = hrgls_STATUS_OKAY;
+        return m_private->blob->time;
+      }
+#endif
       if (hrgls_STATUS_OKAY !=
         (m_private->status = hrgls_DataBlobGetTime(m_private->blob, &ret))) {
         return ret;
@@ -107,32 +193,111 @@ namespace hrgls {
       return ret;
     }
 
-    const uint8_t * DataBlob::Data() const
+    hrgls_DATABLOB_METHOD const uint8_t * DataBlob::Data() const
     {
       const uint8_t *ret = nullptr;
+      if (!m_private) {
+        return ret;
+      }
       if (!m_private->blob) {
         m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
         return ret;
       }
       uint32_t size;
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+      if (m_private->IsLocal()) {
+        m_private->status = m_private->GetData(ret, size);
+        return ret;
+      }
+#endif
       m_private->status = hrgls_DataBlobGetData(m_private->blob, &ret, &size);
       return ret;
     }
 
-    uint32_t DataBlob::Size() const
+    hrgls_DATABLOB_METHOD uint32_t DataBlob::Size() const
     {
       uint32_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
       if (!m_private->blob) {
         m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
         return ret;
       }
       const uint8_t *data;
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+      if (m_private->IsLocal()) {
+        m_private->status = m_private->GetData(data, ret);
+        return ret;
+      }
+#endif
       m_private->status = hrgls_DataBlobGetData(m_private->blob, &data, &ret);
       return ret;
     }
 
-    void DataBlob::ReleaseData()
+    hrgls_DATABLOB_METHOD uint32_t DataBlob::SegmentCount() const
+    {
+      uint32_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->blob) {
+        m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->status = hrgls_DataBlobGetSegmentCount(m_private->blob, &ret);
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD const uint8_t * DataBlob::SegmentData(uint32_t which) const
+    {
+      const uint8_t *ret = nullptr;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->blob) {
+        m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      uint64_t size;
+      m_private->status = hrgls_DataBlobGetSegment(m_private->blob, which, &ret, &size);
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD uint64_t DataBlob::SegmentSize(uint32_t which) const
+    {
+      uint64_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->blob) {
+        m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      const uint8_t *data;
+      m_private->status = hrgls_DataBlobGetSegment(m_private->blob, which, &data, &ret);
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD uint64_t DataBlob::TotalSize() const
     {
+      uint64_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->blob) {
+        m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->status = hrgls_DataBlobGetTotalSize(m_private->blob, &ret);
+      return ret;
+    }
+
+    hrgls_DATABLOB_METHOD void DataBlob::ReleaseData()
+    {
+      if (!m_private) {
+        return;
+      }
       if (!m_private->blob) {
         m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
         return;
@@ -141,7 +306,7 @@ namespace hrgls {
       return;
     }
 
-    hrgls_DataBlob const DataBlob::RawDataBlob() const
+    hrgls_DATABLOB_METHOD hrgls_DataBlob const DataBlob::RawDataBlob() const
     {
       hrgls_DataBlob ret = nullptr;
       if (!m_private) {
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_Handle_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal wrapper file that should not be directly included
+* by application code or by code that implements the API.  It describes the
+* C handles that the library makes, for hrgls_internal_wrap.cpp and, in a build
+* with HRGLS_DIRECT_IMPLEMENTATION defined, for the DataBlob methods that read
+* them without calling through the C layer.
+*/
+
+#include "hrgls_implementation.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/// @brief The function table for this library's implementation.
+///
+/// Its address is what handles made here point to; the function pointers are filled
+/// in when hrgls_GetImplementation() is first called.
+extern hrgls_Implementation hrgls_ThisImplementation;
+
+/// @brief Start of every C handle structure, as required by hrgls_implementation.h.
+struct hrgls_Handle_ {
+  /// Implementation that made the handle, and that all calls on it go to.
+  const hrgls_Implementation *implementation = &hrgls_ThisImplementation;
+};
+
+static inline const hrgls_Implementation *hrgls_ImplementationOf(const hrgls_Handle_ *handle)
+{
+  return handle->implementation;
+}
+
+/// Reference-counted ownership of the data that is shared by all of the copies
+/// of a DataBlob.  The deletion functions are called when the last reference is
+/// released.  Because each deletion function was provided by whoever allocated
+/// its segment, memory is still freed on the same side of the interface that
+/// allocated it no matter which copy happens to release it last.
+struct hrgls_DataBlobPayload_ {
+  std::atomic<uint32_t> refCount;
+  /// The first segment is kept here so that data in one piece, which nearly all
+  /// is, needs no more memory than the payload itself.
+  hrgls_DataBlobSegment first = {};
+  /// The segments after the first, segmentCount - 1 of them.
+  std::unique_ptr<hrgls_DataBlobSegment[]> rest;
+  uint32_t segmentCount = 1;
+  uint64_t totalSize = 0;
+
+  hrgls_DataBlobPayload_() : refCount(1) {}
+
+  const hrgls_DataBlobSegment &Segment(uint32_t which) const
+  {
+    return which == 0 ? first : rest[which - 1];
+  }
+
+  /// True if the data can be described by one pointer and a 32-bit size.
+  bool InOnePiece() const
+  {
+    return segmentCount <= 1 && totalSize <= 0xffffffffu;
+  }
+};
+
+struct hrgls_DataBlob_ : hrgls_Handle_ {
+  /// Shared data, or nullptr if this handle does not refer to any.
+  hrgls_DataBlobPayload_ *payload = nullptr;
+  /// Number of references on payload that are held by this handle.  Each handle
+  /// holds one when it is given data or copied; hrgls_DataBlobRetainData() adds
+  /// more and hrgls_DataBlobReleaseData() removes them.
+  uint32_t heldReferences = 0;
+  struct timeval time = { 0, 0 };
+};
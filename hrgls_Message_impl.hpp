@@ -12,8 +12,8 @@
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
  * See the License for the specific language governing permissions and
  * limitations under the License.
- */
-
+ */
+
 #pragma once
 
 /**
@@ -103,6 +103,49 @@ namespace hrgls {
     return *this;
   }
 
+  Message::Message(Message &&other) noexcept
+  {
+    m_private = other.m_private;
+    other.m_private = nullptr;
+  }
+
+  Message &Message::operator = (Message &&other) noexcept
+  {
+    if (this != &other) {
+      if (m_private) {
+        if (m_private->Message) {
+          hrgls_MessageDestroy(m_private->Message);
+        }
+        delete m_private;
+      }
+      m_private = other.m_private;
+      other.m_private = nullptr;
+    }
+    return *this;
+  }
+
+  Message Message::Adopt(hrgls_Message message)
+  {
+    // Constructing from a null handle allocates only our private data, which
+    // we then point at the message we were handed.
+    Message ret(static_cast<hrgls_Message>(nullptr));
+    if (message) {
+      ret.m_private->Message = message;
+      ret.m_private->status = hrgls_STATUS_OKAY;
+    }
+    return ret;
+  }
+
+  hrgls_Message Message::Detach()
+  {
+    hrgls_Message ret = nullptr;
+    if (m_private) {
+      ret = m_private->Message;
+      m_private->Message = nullptr;
+    }
+    return ret;
+  }
+
   hrgls_Status Message::GetStatus()
   {
     if (!m_private) {
@@ -114,6 +157,9 @@ namespace hrgls {
   ::std::string Message::Value() const
   {
     ::std::string ret;
+    if (!m_private) {
+      return ret;
+    }
     if (!m_private->Message) {
       m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
       return ret;
@@ -132,9 +178,20 @@ namespace hrgls {
     return hrgls_MessageSetValue(m_private->Message, val.c_str());
   }
 
+  hrgls_Status Message::StaticValue(const char *val)
+  {
+    if (!m_private || !m_private->Message) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_MessageSetStaticValue(m_private->Message, val);
+  }
+
   struct timeval Message::TimeStamp() const
   {
 	  struct timeval ret = {};
+	  if (!m_private) {
+		  return ret;
+	  }
 	  if (!m_private->Message) {
 		  m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
 		  return ret;
@@ -154,6 +211,9 @@ namespace hrgls {
   hrgls_MessageLevel Message::Level() const
   {
 	  hrgls_MessageLevel ret = {};
+	  if (!m_private) {
+		  return ret;
+	  }
 	  if (!m_private->Message) {
 		  m_private->status = hrgls_STATUS_NULL_OBJECT_POINTER;
 		  return ret;
@@ -0,0 +1,647 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_Network_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal file that should not be directly included by application
+* code.  It holds the TCP transport: the frame format, the client-side helpers and
+* the NetworkServer that serves an API's DataBlobSources to remote clients.  It only
+* uses the public classes declared in hrgls_api_defs.hpp.  Linux only.
+*/
+
+#include "hrgls_api_defs.hpp"
+#include "hrgls_Recording_impl.hpp"
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace hrgls {
+
+  //------------------------------------------------------------------------------
+  // Network transport.  Each frame on a connection starts with two 32-bit words,
+  // the frame type and the length in bytes of the payload that follows.  All values
+  // are little-endian.  A client asks for the list of sources, or opens one stream
+  // per connection and then reads batches of blobs from it, turning streaming on and
+  // off with frames of its own without waiting for replies.
+
+  /// Client asks for the names of the server's sources.  Empty.
+  static const uint32_t NetFrameList = 1;
+  /// Reply to NetFrameList: count, then that many strings.
+  static const uint32_t NetFrameSources = 2;
+  /// Client opens a stream: name, rate (64-bit double), queue capacity, overflow policy,
+  /// payload size, payload distribution, burst length.
+  static const uint32_t NetFrameOpen = 3;
+  /// Reply to NetFrameOpen: status, then the name of the stream that was opened.
+  static const uint32_t NetFrameOpened = 4;
+  /// Client turns streaming on (1) or off (0).
+  static const uint32_t NetFrameStreaming = 5;
+  /// Server sends blobs: count, then for each: seconds (64 bits), microseconds, size, data.
+  static const uint32_t NetFrameBlobs = 6;
+  /// Client changes the properties of its stream, carried as they are in NetFrameOpen.
+  static const uint32_t NetFrameProperties = 7;
+
+  /// @brief Size of the frame header and of the header ahead of each blob's data.
+  static const size_t NetFrameHeaderSize = 8;
+  static const size_t NetBlobHeaderSize = 16;
+
+  /// @brief Largest frame other than NetFrameBlobs that we accept.
+  static const uint32_t NetMaxControlFrame = 1 << 16;
+
+  /// @brief Most blobs that the server sends in one frame.
+  static const size_t NetMaxBlobsPerFrame = 64;
+
+  /// @brief How long a client waits for the server to answer a request.
+  static const int NetRequestTimeoutSeconds = 5;
+
+  static void NetPutString(std::vector<uint8_t> &buf, const std::string &s)
+  {
+    PutLittle32(buf, static_cast<uint32_t>(s.size()));
+    buf.insert(buf.end(), s.begin(), s.end());
+  }
+
+  /// @brief Reads values in order from a received payload, noting if it runs short.
+  class NetParser {
+  public:
+    NetParser(const std::vector<uint8_t> &buf) : m_buf(buf) {}
+    bool Ok() const { return m_ok; }
+    uint32_t Get32()
+    {
+      if (!Have(4)) { return 0; }
+      m_pos += 4;
+      return GetLittle32(m_buf.data() + m_pos - 4);
+    }
+    uint64_t Get64()
+    {
+      if (!Have(8)) { return 0; }
+      m_pos += 8;
+      return GetLittle64(m_buf.data() + m_pos - 8);
+    }
+    std::string GetString()
+    {
+      uint32_t size = Get32();
+      if (!Have(size)) { return std::string(); }
+      m_pos += size;
+      return std::string(reinterpret_cast<const char*>(m_buf.data()) + m_pos - size, size);
+    }
+  private:
+    bool Have(size_t n)
+    {
+      if (m_buf.size() - m_pos < n) {
+        m_ok = false;
+      }
+      return m_ok;
+    }
+    const std::vector<uint8_t> &m_buf;
+    size_t m_pos = 0;
+    bool m_ok = true;
+  };
+
+  /// @brief Append stream properties as NetFrameOpen and NetFrameProperties carry them.
+  static void NetPutProperties(std::vector<uint8_t> &buf, StreamProperties &props)
+  {
+    double rate = props.Rate();
+    uint64_t rateBits;
+    memcpy(&rateBits, &rate, sizeof(rateBits));
+    PutLittle64(buf, rateBits);
+    PutLittle32(buf, props.QueueCapacity());
+    PutLittle32(buf, static_cast<uint32_t>(props.OverflowPolicy()));
+    PutLittle32(buf, props.PayloadSize());
+    PutLittle32(buf, static_cast<uint32_t>(props.PayloadDistribution()));
+    PutLittle32(buf, props.BurstLength());
+  }
+
+  /// @brief Read stream properties written by NetPutProperties().
+  /// @return False if they are missing or not valid.
+  static bool NetGetProperties(NetParser &parser, StreamProperties &props)
+  {
+    uint64_t rateBits = parser.Get64();
+    uint32_t capacity = parser.Get32();
+    uint32_t policy = parser.Get32();
+    uint32_t payloadSize = parser.Get32();
+    uint32_t distribution = parser.Get32();
+    uint32_t burstLength = parser.Get32();
+    double rate;
+    memcpy(&rate, &rateBits, sizeof(rate));
+    return parser.Ok() && props.Rate(rate) == hrgls_STATUS_OKAY &&
+      props.QueueCapacity(capacity) == hrgls_STATUS_OKAY &&
+      props.OverflowPolicy(static_cast<hrgls_OverflowPolicy>(policy)) == hrgls_STATUS_OKAY &&
+      props.PayloadSize(payloadSize) == hrgls_STATUS_OKAY &&
+      props.PayloadDistribution(static_cast<hrgls_PayloadDistribution>(distribution)) ==
+        hrgls_STATUS_OKAY &&
+      props.BurstLength(burstLength) == hrgls_STATUS_OKAY;
+  }
+
+  /// @brief Send all of the pieces of a message, retrying after partial writes.
+  /// @return False if the connection has failed or been shut down.
+  static bool NetSendAll(int fd, struct iovec *iov, size_t count)
+  {
+    while (count > 0) {
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = iov;
+      msg.msg_iovlen = std::min(count, static_cast<size_t>(IOV_MAX));
+      ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      size_t left = static_cast<size_t>(sent);
+      while (count > 0 && left >= iov->iov_len) {
+        left -= iov->iov_len;
+        iov++;
+        count--;
+      }
+      if (count > 0) {
+        iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + left;
+        iov->iov_len -= left;
+      }
+    }
+    return true;
+  }
+
+  /// @brief Send a frame whose payload is in a single buffer.
+  static bool NetSendFrame(int fd, uint32_t type, const std::vector<uint8_t> &payload)
+  {
+    std::vector<uint8_t> header;
+    PutLittle32(header, type);
+    PutLittle32(header, static_cast<uint32_t>(payload.size()));
+    struct iovec iov[2];
+    iov[0].iov_base = header.data();
+    iov[0].iov_len = header.size();
+    iov[1].iov_base = const_cast<uint8_t*>(payload.data());
+    iov[1].iov_len = payload.size();
+    return NetSendAll(fd, iov, payload.empty() ? 1 : 2);
+  }
+
+  /// @brief Buffered reader for a connection, so that the small headers in a frame do
+  /// not each cost a system call.  Large reads go straight to their destination.
+  class NetReader {
+  public:
+    NetReader(int fd) : m_fd(fd), m_buf(1 << 16) {}
+
+    /// @return Number of bytes that have been received but not yet read.
+    size_t Buffered() const { return m_end - m_start; }
+
+    /// @brief Read exactly size bytes, or skip them if dest is null.
+    /// @return False if the connection has failed, closed, or timed out first.
+    bool Read(void *dest, size_t size)
+    {
+      uint8_t *out = static_cast<uint8_t*>(dest);
+      while (size > 0) {
+        if (m_start == m_end) {
+          if (out && size >= m_buf.size()) {
+            ssize_t got = Receive(out, size);
+            if (got <= 0) {
+              return false;
+            }
+            out += got;
+            size -= got;
+            continue;
+          }
+          ssize_t got = Receive(m_buf.data(), m_buf.size());
+          if (got <= 0) {
+            return false;
+          }
+          m_start = 0;
+          m_end = static_cast<size_t>(got);
+        }
+        size_t n = std::min(size, m_end - m_start);
+        if (out) {
+          memcpy(out, m_buf.data() + m_start, n);
+          out += n;
+        }
+        m_start += n;
+        size -= n;
+      }
+      return true;
+    }
+
+    /// @brief Read the header of the next frame.
+    bool ReadHeader(uint32_t &type, uint32_t &length)
+    {
+      uint8_t header[NetFrameHeaderSize];
+      if (!Read(header, sizeof(header))) {
+        return false;
+      }
+      type = GetLittle32(header);
+      length = GetLittle32(header + 4);
+      return true;
+    }
+
+    /// @brief Read the payload of a frame other than NetFrameBlobs.
+    bool ReadPayload(uint32_t length, std::vector<uint8_t> &payload)
+    {
+      if (length > NetMaxControlFrame) {
+        return false;
+      }
+      payload.resize(length);
+      return Read(payload.data(), length);
+    }
+
+  private:
+    ssize_t Receive(void *dest, size_t size)
+    {
+      ssize_t got;
+      do {
+        got = recv(m_fd, dest, size, 0);
+      } while (got < 0 && errno == EINTR);
+      return got;
+    }
+
+    int m_fd;
+    std::vector<uint8_t> m_buf;
+    size_t m_start = 0;
+    size_t m_end = 0;
+  };
+
+  /// @brief Split "host:port" into its parts.  The host may be empty or a bracketed IPv6
+  /// address; the port must be a number.
+  static bool NetParseEndpoint(const std::string &endpoint, std::string &host, std::string &port)
+  {
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos) {
+      return false;
+    }
+    host = endpoint.substr(0, colon);
+    port = endpoint.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+      host = host.substr(1, host.size() - 2);
+    }
+    if (port.empty() || port.size() > 5 ||
+        port.find_first_not_of("0123456789") != std::string::npos ||
+        std::stoul(port) > 65535) {
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Connect to a server, with a timeout on receiving so that a server that does
+  /// not answer a request does not hang us.  Call NetClearTimeout() before streaming.
+  /// @return The socket, or -1 on failure.
+  static int NetConnect(const std::string &endpoint)
+  {
+    std::string host, port;
+    if (!NetParseEndpoint(endpoint, host, port)) {
+      return -1;
+    }
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *addrs = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addrs) != 0) {
+      return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *a = addrs; a && fd < 0; a = a->ai_next) {
+      fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+      if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    freeaddrinfo(addrs);
+    if (fd >= 0) {
+      // We do our own batching, so send each frame as soon as it is written.
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      struct timeval timeout = { NetRequestTimeoutSeconds, 0 };
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    return fd;
+  }
+
+  static void NetClearTimeout(int fd)
+  {
+    struct timeval none = { 0, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &none, sizeof(none));
+  }
+
+  /// @brief Send a batch of blobs in one frame.  The blob data is sent from where it
+  /// is rather than being copied into the frame, a segment at a time for blobs whose
+  /// data is in pieces.
+  static bool NetSendBlobs(int fd, const std::vector<datablob::DataBlob> &blobs)
+  {
+    std::vector<uint8_t> headers;
+    headers.reserve(NetFrameHeaderSize + 4 + NetBlobHeaderSize * blobs.size());
+    std::vector<uint64_t> sizes(blobs.size());
+    uint64_t length = 4;
+    for (size_t i = 0; i < blobs.size(); i++) {
+      sizes[i] = blobs[i].TotalSize();
+      length += NetBlobHeaderSize + sizes[i];
+    }
+    if (length > 0xffffffffu) {
+      return false;
+    }
+    PutLittle32(headers, NetFrameBlobs);
+    PutLittle32(headers, static_cast<uint32_t>(length));
+    PutLittle32(headers, static_cast<uint32_t>(blobs.size()));
+    for (size_t i = 0; i < blobs.size(); i++) {
+      struct timeval t = blobs[i].Time();
+      PutLittle64(headers, static_cast<uint64_t>(t.tv_sec));
+      PutLittle32(headers, static_cast<uint32_t>(t.tv_usec));
+      PutLittle32(headers, static_cast<uint32_t>(sizes[i]));
+    }
+    std::vector<struct iovec> iov;
+    iov.reserve(1 + 2 * blobs.size());
+    struct iovec v;
+    v.iov_base = headers.data();
+    v.iov_len = NetFrameHeaderSize + 4;
+    iov.push_back(v);
+    for (size_t i = 0; i < blobs.size(); i++) {
+      v.iov_base = headers.data() + NetFrameHeaderSize + 4 + NetBlobHeaderSize * i;
+      v.iov_len = NetBlobHeaderSize;
+      iov.push_back(v);
+      uint32_t segments = sizes[i] > 0 ? blobs[i].SegmentCount() : 0;
+      for (uint32_t j = 0; j < segments; j++) {
+        v.iov_len = static_cast<size_t>(blobs[i].SegmentSize(j));
+        if (v.iov_len > 0) {
+          v.iov_base = const_cast<uint8_t*>(blobs[i].SegmentData(j));
+          iov.push_back(v);
+        }
+      }
+    }
+    return NetSendAll(fd, iov.data(), iov.size());
+  }
+
+  /// @brief Serves an API's DataBlobSources to remote APIs.
+  ///
+  /// A thread accepts connections, each of which gets a thread of its own.  That thread
+  /// answers requests for the source list, or opens a local DataBlobSource with the
+  /// client's StreamProperties and sends its blobs whenever its notification descriptor
+  /// says that some are queued, all that are queued (up to NetMaxBlobsPerFrame) at a time.
+  /// Sending blocks when the client falls behind, so that blobs queue up locally under the
+  /// client's overflow policy.  Destroying the server shuts down every socket, which
+  /// wakes each thread, and joins them.
+  class NetworkServer {
+  public:
+    /// @brief Listen on the endpoint.
+    /// @return The server, or nullptr with status set on failure.
+    static NetworkServer *Start(API &api, const std::string &endpoint, hrgls_Status &status)
+    {
+      std::string host, port;
+      if (!NetParseEndpoint(endpoint, host, port)) {
+        status = hrgls_STATUS_BAD_PARAMETER;
+        return nullptr;
+      }
+      struct addrinfo hints;
+      memset(&hints, 0, sizeof(hints));
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags = AI_PASSIVE;
+      struct addrinfo *addrs = nullptr;
+      if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addrs) != 0) {
+        status = hrgls_STATUS_CONNECTION_FAILED;
+        return nullptr;
+      }
+      int fd = -1;
+      for (struct addrinfo *a = addrs; a && fd < 0; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) {
+          continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, a->ai_addr, a->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0) {
+          close(fd);
+          fd = -1;
+        }
+      }
+      freeaddrinfo(addrs);
+      if (fd < 0) {
+        status = hrgls_STATUS_CONNECTION_FAILED;
+        return nullptr;
+      }
+
+      NetworkServer *ret = new NetworkServer;
+      ret->m_api = &api;
+      ret->m_listenFD = fd;
+      struct sockaddr_storage addr;
+      socklen_t len = sizeof(addr);
+      if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) == 0) {
+        if (addr.ss_family == AF_INET) {
+          ret->m_port = ntohs(reinterpret_cast<struct sockaddr_in*>(&addr)->sin_port);
+        } else if (addr.ss_family == AF_INET6) {
+          ret->m_port = ntohs(reinterpret_cast<struct sockaddr_in6*>(&addr)->sin6_port);
+        }
+      }
+      ret->m_listener = std::thread([ret]() { ret->Listen(); });
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    ~NetworkServer()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+      }
+      shutdown(m_listenFD, SHUT_RDWR);
+      m_listener.join();
+      close(m_listenFD);
+
+      // The listener is gone, so nobody else touches the list now.
+      for (auto &c : m_connections) {
+        shutdown(c->fd, SHUT_RDWR);
+      }
+      for (auto &c : m_connections) {
+        c->thread.join();
+        close(c->fd);
+      }
+    }
+
+    uint16_t Port() const { return m_port; }
+
+  private:
+    NetworkServer() {}
+
+    struct Connection {
+      int fd;
+      std::thread thread;
+      std::atomic<bool> done{ false };
+    };
+
+    void Listen()
+    {
+      while (true) {
+        int fd = accept4(m_listenFD, nullptr, nullptr, SOCK_CLOEXEC);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_quit) {
+          if (fd >= 0) {
+            close(fd);
+          }
+          return;
+        }
+        if (fd < 0) {
+          if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE ||
+              errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+            continue;
+          }
+          return;
+        }
+
+        // Clean up after connections that have finished.
+        for (auto it = m_connections.begin(); it != m_connections.end(); ) {
+          if ((*it)->done.load()) {
+            (*it)->thread.join();
+            close((*it)->fd);
+            it = m_connections.erase(it);
+          } else {
+            ++it;
+          }
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::unique_ptr<Connection> c(new Connection);
+        c->fd = fd;
+        Connection *conn = c.get();
+        c->thread = std::thread([this, conn]() { Serve(conn); conn->done = true; });
+        m_connections.push_back(std::move(c));
+      }
+    }
+
+    /// Answer requests until the client opens a stream or goes away.
+    void Serve(Connection *c)
+    {
+      NetReader reader(c->fd);
+      uint32_t type, length;
+      std::vector<uint8_t> payload;
+      while (reader.ReadHeader(type, length) && reader.ReadPayload(length, payload)) {
+        if (type == NetFrameList) {
+          std::vector<DataBlobSourceDescription> sources = m_api->GetAvailableDataBlobSources();
+          std::vector<uint8_t> reply;
+          PutLittle32(reply, static_cast<uint32_t>(sources.size()));
+          for (size_t i = 0; i < sources.size(); i++) {
+            NetPutString(reply, sources[i].Name());
+          }
+          if (!NetSendFrame(c->fd, NetFrameSources, reply)) {
+            return;
+          }
+        } else if (type == NetFrameOpen) {
+          ServeStream(c, reader, payload);
+          return;
+        }
+      }
+    }
+
+    /// Open the stream the client asked for and send it blobs until it goes away.
+    void ServeStream(Connection *c, NetReader &reader, const std::vector<uint8_t> &request)
+    {
+      NetParser parser(request);
+      std::string name = parser.GetString();
+
+      hrgls_Status status = hrgls_STATUS_OKAY;
+      std::unique_ptr<datablob::DataBlobSource> source;
+      StreamProperties props;
+      if (!NetGetProperties(parser, props)) {
+        status = hrgls_STATUS_BAD_PARAMETER;
+      } else {
+        source.reset(new datablob::DataBlobSource(*m_api, props, name));
+        status = source->GetStatus();
+      }
+      int notify = -1;
+      if (status == hrgls_STATUS_OKAY) {
+        notify = source->GetNotificationFD();
+        status = source->GetStatus();
+      }
+      std::vector<uint8_t> reply;
+      PutLittle32(reply, static_cast<uint32_t>(status));
+      NetPutString(reply, status == hrgls_STATUS_OKAY ? source->GetInfo().Name() : std::string());
+      if (!NetSendFrame(c->fd, NetFrameOpened, reply) || status != hrgls_STATUS_OKAY) {
+        return;
+      }
+
+      struct timeval zero = { 0, 0 };
+      std::vector<uint8_t> payload;
+      while (true) {
+        struct pollfd fds[2];
+        fds[0].fd = c->fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = notify;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if (reader.Buffered() == 0 && poll(fds, 2, -1) < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return;
+        }
+
+        // Requests from the client, or it has gone away.
+        if (reader.Buffered() > 0 || fds[0].revents != 0) {
+          uint32_t type, length;
+          if (!reader.ReadHeader(type, length) || !reader.ReadPayload(length, payload)) {
+            return;
+          }
+          if (type == NetFrameStreaming) {
+            NetParser parser(payload);
+            bool on = parser.Get32() != 0;
+            if (parser.Ok()) {
+              source->SetStreamingState(on);
+            }
+          } else if (type == NetFrameProperties) {
+            NetParser parser(payload);
+            StreamProperties changed;
+            if (NetGetProperties(parser, changed)) {
+              source->SetStreamProperties(changed);
+            }
+          }
+        }
+
+        // Send everything that has queued up since the last time.
+        if (fds[1].revents & POLLIN) {
+          std::vector<datablob::DataBlob> blobs = source->GetPendingBlobs(NetMaxBlobsPerFrame, zero);
+          if (!blobs.empty() && !NetSendBlobs(c->fd, blobs)) {
+            return;
+          }
+        }
+      }
+    }
+
+    API *m_api = nullptr;
+    int m_listenFD = -1;
+    uint16_t m_port = 0;
+    std::thread m_listener;
+
+    /// Protects the connection list and m_quit between the listener and the destructor.
+    std::mutex m_mutex;
+    bool m_quit = false;
+    std::list< std::unique_ptr<Connection> > m_connections;
+  };
+
+} // end namespace hrgls
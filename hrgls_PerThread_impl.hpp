@@ -0,0 +1,140 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_PerThread_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal wrapper file that should not be directly included
+* by application code or by code that implements the API.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hrgls {
+
+  /// @brief Stores a separate value of type T for each thread that uses an object.
+  ///
+  /// Used to keep the status of the last call made by each thread, so that a thread
+  /// only sees results from methods that it called.  Each PerThread object is given
+  /// a small index that is reused once it is destroyed, and each thread keeps its
+  /// values in a thread_local table indexed by it, so Get() does no locking, no
+  /// lookup, and (after a thread's first use of an index) no allocation.  A thread's
+  /// table is freed when the thread exits.  A value left behind by a destroyed
+  /// object is reset the next time its index is used, which is detected by giving
+  /// each object a unique generation number.
+  template <class T>
+  class PerThread {
+  public:
+    PerThread() : m_index(Indices().Acquire()), m_generation(NextGeneration()) {}
+
+    /// Copies are separate objects, with their own values for each thread.
+    PerThread(const PerThread &) : PerThread() {}
+    PerThread &operator=(const PerThread &) { return *this; }
+
+    ~PerThread() { Indices().Release(m_index); }
+
+    /// @brief Value for the calling thread, value-initialized on its first use.
+    ///
+    /// The reference remains valid until the thread exits or this object is destroyed.
+    T &Get()
+    {
+      std::vector<std::unique_ptr<Slot> > &slots = Slots();
+      if (m_index < slots.size()) {
+        Slot *s = slots[m_index].get();
+        if (s && s->generation == m_generation) {
+          return s->value;
+        }
+      }
+      return Claim(slots);
+    }
+
+  private:
+    struct Slot {
+      uint64_t generation = 0;
+      T value{};
+    };
+
+    /// Hands out the smallest indices available so that the tables stay small.
+    class IndexAllocator {
+    public:
+      size_t Acquire()
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) {
+          return m_next++;
+        }
+        size_t ret = m_free.back();
+        m_free.pop_back();
+        return ret;
+      }
+      void Release(size_t index)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(index);
+      }
+    private:
+      std::mutex m_mutex;
+      std::vector<size_t> m_free;
+      size_t m_next = 0;
+    };
+
+    /// Never destroyed, so objects can be destroyed during program exit.
+    static IndexAllocator &Indices()
+    {
+      static IndexAllocator *indices = new IndexAllocator;
+      return *indices;
+    }
+
+    static uint64_t NextGeneration()
+    {
+      static std::atomic<uint64_t> generation(0);
+      return ++generation;
+    }
+
+    /// Slots are allocated separately so that references to their values stay valid
+    /// when the table grows.
+    static std::vector<std::unique_ptr<Slot> > &Slots()
+    {
+      static thread_local std::vector<std::unique_ptr<Slot> > slots;
+      return slots;
+    }
+
+    T &Claim(std::vector<std::unique_ptr<Slot> > &slots)
+    {
+      if (m_index >= slots.size()) {
+        slots.resize(m_index + 1);
+      }
+      if (!slots[m_index]) {
+        slots[m_index].reset(new Slot);
+      } else {
+        slots[m_index]->value = T();
+      }
+      slots[m_index]->generation = m_generation;
+      return slots[m_index]->value;
+    }
+
+    size_t m_index;
+    uint64_t m_generation;
+  };
+
+} // end namespace hrgls
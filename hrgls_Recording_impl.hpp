@@ -0,0 +1,87 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_Recording_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal file that should not be directly included by application
+* code.  It holds the little-endian helpers and the recording file format that the
+* NULL implementation shares between DataBlobRecorder, replay and the network
+* transport, none of which depend on the rest of the implementation.
+*/
+
+#include "hrgls_api.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hrgls {
+
+  /// @brief Helpers to write little-endian values to and read them from a buffer.
+  static void PutLittle32(std::vector<uint8_t> &buf, uint32_t v)
+  {
+    for (int i = 0; i < 4; i++) {
+      buf.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+  }
+  static void PutLittle64(std::vector<uint8_t> &buf, uint64_t v)
+  {
+    PutLittle32(buf, static_cast<uint32_t>(v));
+    PutLittle32(buf, static_cast<uint32_t>(v >> 32));
+  }
+  static uint32_t GetLittle32(const uint8_t *p)
+  {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+      (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+  static uint64_t GetLittle64(const uint8_t *p)
+  {
+    return GetLittle32(p) | (static_cast<uint64_t>(GetLittle32(p + 4)) << 32);
+  }
+
+  //------------------------------------------------------------------------------
+  // Recordings.  A recording starts with a 16-byte header: the magic string
+  // "HRGLSREC", a format version, and a reserved word.  Each record follows as a
+  // 16-byte header (seconds as 64 bits, microseconds, and data size, all little-endian)
+  // and then its data, padded to a multiple of 8 bytes so that every record's data is
+  // aligned.  Alongside it, the file name followed by ".idx" has a header of the same
+  // form ("HRGLSIDX") and then one 16-byte entry per record: its time in microseconds
+  // since the epoch and its offset in the recording.  The index may be missing, or may
+  // only cover the earlier records if the recorder did not finish; replay finds the rest
+  // by reading through the records after the last one that it covers.
+
+  static const char RecordingMagic[] = "HRGLSREC";
+  static const char RecordingIndexMagic[] = "HRGLSIDX";
+  static const uint32_t RecordingVersion = 1;
+  static const size_t RecordingHeaderSize = 16;
+  static const size_t RecordHeaderSize = 16;
+  static const size_t RecordIndexEntrySize = 16;
+  static const size_t RecordAlignment = 8;
+
+  static std::string RecordingIndexName(const std::string &fileName)
+  {
+    return fileName + ".idx";
+  }
+
+  static int64_t MicrosecondsOf(struct timeval t)
+  {
+    return static_cast<int64_t>(t.tv_sec) * 1000000 + t.tv_usec;
+  }
+
+} // end namespace hrgls
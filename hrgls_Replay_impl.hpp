@@ -0,0 +1,243 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_Replay_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal file that should not be directly included by application
+* code.  It holds the mapping of a recording that a DataBlobSource replays.
+* Linux only.
+*/
+
+#include "hrgls_api.h"
+#include "hrgls_Recording_impl.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace hrgls {
+
+  /// @brief Reads a whole file, returning an empty vector if it cannot be opened.
+  static std::vector<char> GetFile(std::string fileName)
+  {
+    std::vector<char> ret;
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (!f) { return ret; }
+
+    // Read the DataBlob into memory after finding its size.
+    fseek(f, 0L, SEEK_END);
+    long data_size = ftell(f);
+    fseek(f, 0L, SEEK_SET);
+    ret.resize(data_size);
+    fread(ret.data(), sizeof(ret.data()[0]), data_size, f);
+    fclose(f);
+    return ret;
+  }
+
+  /// @brief A recording mapped into memory for replay, along with an index of its records.
+  ///
+  /// Blobs made from it point straight into the mapping and each hold a reference to
+  /// it, so that it stays mapped until the last of them is released even if the
+  /// DataBlobSource that replays it has been destroyed.
+  class ReplayFile {
+  public:
+    /// @brief Names of DataBlobSources that replay a file start with this.
+    static const std::string &NamePrefix()
+    {
+      static const std::string prefix("/hrgls/replay/");
+      return prefix;
+    }
+
+    /// @brief Map a recording and read its index.
+    /// @return The file, holding one reference, or nullptr if it is not a recording.
+    static ReplayFile *Open(const std::string &fileName)
+    {
+      int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return nullptr;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(RecordingHeaderSize)) {
+        close(fd);
+        return nullptr;
+      }
+      size_t length = static_cast<size_t>(st.st_size);
+      void *map = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED) {
+        return nullptr;
+      }
+      ReplayFile *ret = new ReplayFile(static_cast<const uint8_t*>(map), length);
+      if (memcmp(map, RecordingMagic, 8) != 0 ||
+          GetLittle32(ret->m_base + 8) != RecordingVersion) {
+        ret->Unref();
+        return nullptr;
+      }
+      madvise(map, length, MADV_SEQUENTIAL);
+      ret->LoadIndex(RecordingIndexName(fileName));
+      return ret;
+    }
+
+    void Ref() { m_refs++; }
+    void Unref()
+    {
+      if (--m_refs == 0) {
+        delete this;
+      }
+    }
+
+    /// @brief Number of records.
+    size_t Count() const { return m_index.size(); }
+
+    /// @brief Time of record i in microseconds since the epoch.
+    int64_t TimeOf(size_t i) const { return m_index[i].time; }
+
+    /// @brief Index of the first record at or after the time, Count() if there is none.
+    size_t Find(int64_t time) const
+    {
+      Entry key = { time, 0 };
+      return std::lower_bound(m_index.begin(), m_index.end(), key,
+        [](const Entry &a, const Entry &b) { return a.time < b.time; }) - m_index.begin();
+    }
+
+    /// @brief Make a blob for record i whose data points into the mapping.
+    /// @return The blob, or nullptr if one could not be created or the record does
+    ///         not fit in the file, which a damaged or stale index can point to.
+    hrgls_DataBlob MakeBlob(size_t i)
+    {
+      if (RecordEnd(m_index[i].offset) == 0) {
+        return nullptr;
+      }
+      const uint8_t *record = m_base + m_index[i].offset;
+      hrgls_DataBlob blob;
+      if (hrgls_DataBlobCreate(&blob) != hrgls_STATUS_OKAY) {
+        return nullptr;
+      }
+      hrgls_DataBlobSetTime(blob, RecordTime(record));
+      Ref();
+      if (hrgls_DataBlobSetData(blob, record + RecordHeaderSize, GetLittle32(record + 12),
+            ReleaseRecord, this) != hrgls_STATUS_OKAY) {
+        Unref();
+        hrgls_DataBlobDestroy(blob);
+        return nullptr;
+      }
+      return blob;
+    }
+
+  private:
+    ReplayFile(const uint8_t *base, size_t length) : m_base(base), m_length(length) {}
+    ~ReplayFile()
+    {
+      munmap(const_cast<uint8_t*>(m_base), m_length);
+    }
+
+    struct Entry {
+      int64_t time;
+      uint64_t offset;
+    };
+
+    /// Deletion function for blob data, which leaves the mapping alone until the last
+    /// blob that points into it is done.
+    static void ReleaseRecord(void *userData, const uint8_t *)
+    {
+      static_cast<ReplayFile*>(userData)->Unref();
+    }
+
+    static struct timeval RecordTime(const uint8_t *record)
+    {
+      struct timeval ret;
+      ret.tv_sec = static_cast<decltype(ret.tv_sec)>(GetLittle64(record));
+      ret.tv_usec = static_cast<decltype(ret.tv_usec)>(GetLittle32(record + 8));
+      return ret;
+    }
+
+    /// @return Offset just past the record at offset, or 0 if it does not fit in the file.
+    uint64_t RecordEnd(uint64_t offset) const
+    {
+      if (offset % RecordAlignment != 0 || offset < RecordingHeaderSize ||
+          m_length - offset < RecordHeaderSize) {
+        return 0;
+      }
+      uint64_t size = GetLittle32(m_base + offset + 12);
+      uint64_t end = offset + RecordHeaderSize + size;
+      if (end > m_length) {
+        return 0;
+      }
+      return (end + RecordAlignment - 1) / RecordAlignment * RecordAlignment;
+    }
+
+    /// Read the index file, keeping the entries that fit this recording, and then read
+    /// through the records after the last one it covers.  Entries are checked for
+    /// aligned, increasing offsets that lie within the file and for times that do not go
+    /// backwards, which Find() depends on, and the last is checked against its record,
+    /// without touching the records in between; MakeBlob() checks each record's size.
+    void LoadIndex(const std::string &indexName)
+    {
+      std::vector<char> file = GetFile(indexName);
+      const uint8_t *p = reinterpret_cast<const uint8_t*>(file.data());
+      if (file.size() >= RecordingHeaderSize && memcmp(p, RecordingIndexMagic, 8) == 0 &&
+          GetLittle32(p + 8) == RecordingVersion) {
+        size_t count = (file.size() - RecordingHeaderSize) / RecordIndexEntrySize;
+        m_index.reserve(count);
+        uint64_t last = 0;
+        for (size_t i = 0; i < count; i++) {
+          const uint8_t *e = p + RecordingHeaderSize + i * RecordIndexEntrySize;
+          Entry entry = { static_cast<int64_t>(GetLittle64(e)), GetLittle64(e + 8) };
+          if (entry.offset <= last || entry.offset > m_length - RecordHeaderSize ||
+              entry.offset % RecordAlignment != 0 ||
+              (!m_index.empty() && entry.time < m_index.back().time)) {
+            break;
+          }
+          last = entry.offset;
+          m_index.push_back(entry);
+        }
+        while (!m_index.empty()) {
+          const Entry &e = m_index.back();
+          if (RecordEnd(e.offset) != 0 && MicrosecondsOf(RecordTime(m_base + e.offset)) == e.time) {
+            break;
+          }
+          m_index.pop_back();
+        }
+      }
+
+      uint64_t offset = m_index.empty() ? RecordingHeaderSize : RecordEnd(m_index.back().offset);
+      while (uint64_t end = RecordEnd(offset)) {
+        Entry entry = { MicrosecondsOf(RecordTime(m_base + offset)), offset };
+        if (!m_index.empty() && entry.time < m_index.back().time) {
+          break;
+        }
+        m_index.push_back(entry);
+        offset = end;
+      }
+    }
+
+    const uint8_t *m_base;
+    size_t m_length;
+    std::vector<Entry> m_index;
+    std::atomic<long> m_refs{ 1 };
+  };
+
+} // end namespace hrgls
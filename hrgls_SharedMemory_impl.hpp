@@ -0,0 +1,366 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+* @file hrgls_SharedMemory_impl.hpp
+* @brief Internal implementation file.
+*
+* This is an internal file that should not be directly included by application
+* code.  It holds the ring in a POSIX shared-memory segment through which a
+* DataBlobSource publishes its blobs to other processes.  Linux only.
+*/
+
+#include "hrgls_api.h"
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace hrgls {
+
+  //------------------------------------------------------------------------------
+  /// @brief Ring of blobs in a POSIX shared-memory segment, for fan-out to other processes.
+  ///
+  /// One process creates the ring and publishes blobs into it; any number of
+  /// processes attach to it and are handed DataBlobs whose data points straight
+  /// into the mapped segment.  Each slot holds one blob and has a state word that
+  /// counts the readers (in any process) that hold its data.  The publisher only
+  /// overwrites a slot that no reader holds; when the next slot is held it skips
+  /// that blob rather than waiting for a slow consumer.  A reader that has fallen
+  /// a full ring behind is moved up to the oldest blob that is still there.
+  /// Readers sleep on a futex in the segment until the next blob is published.
+  /// The mapping is reference counted so that it stays valid until the last blob
+  /// pointing into it is released, even after its DataBlobSource is destroyed.
+  /// A reader process that dies while holding blobs leaves their slots held.
+  class SharedBlobRing {
+  public:
+    /// Prefix of the DataBlobSource names that attach to published rings.
+    static const std::string &NamePrefix()
+    {
+      static const std::string prefix("/hrgls/shm/");
+      return prefix;
+    }
+
+    /// @brief Whether a name can be used for a ring.
+    ///
+    /// The name becomes a file name under /dev/shm, so it must fit in NAME_MAX along
+    /// with the prefix, and it is limited to characters that cannot reach another
+    /// directory or be mistaken for an option.
+    static bool ValidName(const std::string &name)
+    {
+      if (name.empty() || name.size() + strlen(SegmentPrefix()) - 1 > NAME_MAX) {
+        return false;
+      }
+      for (char c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-') {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// @brief Creates and maps a new ring, replacing any stale one of the same name.
+    /// @return The ring, holding one reference, or nullptr on failure.
+    static SharedBlobRing *Create(const std::string &name, uint32_t slotCount, uint32_t slotSize)
+    {
+      if (!ValidName(name)) {
+        return nullptr;
+      }
+      if (slotCount == 0) {
+        slotCount = 1;
+      }
+      std::string shmName = SegmentName(name);
+      int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      if (fd < 0 && errno == EEXIST) {
+        shm_unlink(shmName.c_str());
+        fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+      }
+      if (fd < 0) {
+        return nullptr;
+      }
+      uint64_t stride = RoundUp(SlotHeaderSize() + slotSize);
+      size_t length = static_cast<size_t>(HeaderSize() + stride * slotCount);
+      if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        close(fd);
+        shm_unlink(shmName.c_str());
+        return nullptr;
+      }
+      void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (base == MAP_FAILED) {
+        shm_unlink(shmName.c_str());
+        return nullptr;
+      }
+
+      // Fill in everything else before the magic number, which tells readers that
+      // the segment is ready.
+      Header *header = new (base) Header;
+      header->version = Version;
+      header->slotCount = slotCount;
+      header->slotSize = slotSize;
+      header->slotStride = stride;
+      SharedBlobRing *ret = new SharedBlobRing(base, length, shmName);
+      for (uint32_t i = 0; i < slotCount; i++) {
+        Slot *slot = new (ret->SlotAt(i)) Slot;
+        slot->sequence.store(NoSequence, std::memory_order_relaxed);
+      }
+      ret->m_header->magic.store(Magic, std::memory_order_release);
+      return ret;
+    }
+
+    /// @brief Maps an existing ring that was made by Create().
+    /// @return The ring, holding one reference, or nullptr if there is no such ring.
+    static SharedBlobRing *Attach(const std::string &name)
+    {
+      if (!ValidName(name)) {
+        return nullptr;
+      }
+      std::string shmName = SegmentName(name);
+      int fd = shm_open(shmName.c_str(), O_RDWR, 0);
+      if (fd < 0) {
+        return nullptr;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < HeaderSize()) {
+        close(fd);
+        return nullptr;
+      }
+      size_t length = static_cast<size_t>(st.st_size);
+      void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (base == MAP_FAILED) {
+        return nullptr;
+      }
+      Header *header = static_cast<Header*>(base);
+      if (header->magic.load(std::memory_order_acquire) != Magic || header->version != Version ||
+          header->slotCount == 0 ||
+          HeaderSize() + header->slotStride * header->slotCount > length) {
+        munmap(base, length);
+        return nullptr;
+      }
+      return new SharedBlobRing(base, length, std::string());
+    }
+
+    void Ref() { m_refs++; }
+
+    /// Unmaps and deletes the ring when the last reference is released.
+    void Unref()
+    {
+      if (--m_refs == 0) {
+        munmap(m_base, m_length);
+        delete this;
+      }
+    }
+
+    uint32_t SlotCount() const { return m_header->slotCount; }
+
+    /// @brief Publisher side: copies a blob into the next slot and wakes the readers.
+    /// @return False if the blob was skipped because it was too large or its slot
+    ///         was held by a reader.
+    bool Publish(const uint8_t *data, uint32_t size, struct timeval time)
+    {
+      uint64_t seq = m_header->writeSeq.load(std::memory_order_relaxed);
+      Slot *slot = SlotAt(seq % m_header->slotCount);
+      uint64_t expected = 0;
+      bool ok = (size <= m_header->slotSize) &&
+        slot->state.compare_exchange_strong(expected, Writing, std::memory_order_acquire);
+      if (ok) {
+        memcpy(SlotData(slot), data, size);
+        slot->sec = time.tv_sec;
+        slot->usec = time.tv_usec;
+        slot->size = size;
+        slot->sequence.store(seq, std::memory_order_relaxed);
+        slot->state.store(0, std::memory_order_release);
+      } else {
+        m_header->skipped++;
+      }
+
+      // Skipped blobs still use up a sequence number, so that one held slot cannot
+      // stop the ring; readers see that the slot does not hold it and move on.
+      m_header->writeSeq.store(seq + 1, std::memory_order_release);
+      Wake();
+      return ok;
+    }
+
+    /// @brief Publisher side: tells readers that no more blobs are coming and
+    /// removes the name, so that new readers can no longer attach.
+    void Close()
+    {
+      m_header->closed.store(1);
+      if (!m_shmName.empty()) {
+        shm_unlink(m_shmName.c_str());
+      }
+      Wake();
+    }
+
+    /// @brief Reader side: sequence number of the next blob to be published.
+    uint64_t Head() const { return m_header->writeSeq.load(std::memory_order_acquire); }
+
+    bool Closed() const { return m_header->closed.load() != 0; }
+
+    /// @brief Reader side: takes a reference to the blob with sequence number seq.
+    /// The DataBlob's data points into the segment and it holds a reference to this
+    /// ring and to the slot, both released along with its data.
+    /// @return False if the slot no longer (or never did) hold that blob.
+    bool Claim(uint64_t seq, hrgls_DataBlob *blob)
+    {
+      uint32_t index = static_cast<uint32_t>(seq % m_header->slotCount);
+      Slot *slot = SlotAt(index);
+      uint64_t state = slot->state.load(std::memory_order_relaxed);
+      do {
+        if (state & Writing) {
+          return false;
+        }
+      } while (!slot->state.compare_exchange_weak(state, state + 1, std::memory_order_acquire));
+      if (slot->sequence.load(std::memory_order_relaxed) != seq ||
+          hrgls_DataBlobCreate(blob) != hrgls_STATUS_OKAY) {
+        slot->state.fetch_sub(1, std::memory_order_release);
+        return false;
+      }
+      struct timeval time;
+      time.tv_sec = static_cast<decltype(time.tv_sec)>(slot->sec);
+      time.tv_usec = static_cast<decltype(time.tv_usec)>(slot->usec);
+      hrgls_DataBlobSetTime(*blob, time);
+      Ref();
+      hrgls_DataBlobSetData(*blob, SlotData(slot), slot->size, ReleaseSlot, &m_slotRefs[index]);
+      return true;
+    }
+
+    /// @brief Reader side: sleeps until a blob past head is published, the ring is
+    /// closed, Interrupt() is called, or the timeout expires.
+    void WaitForPublish(uint64_t head, int timeoutMs)
+    {
+      uint32_t word = m_header->wakeWord.load();
+      m_header->sleepers++;
+      if (Head() == head && !Closed()) {
+        struct timespec ts;
+        ts.tv_sec = timeoutMs / 1000;
+        ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->wakeWord), FUTEX_WAIT,
+          word, &ts, nullptr, 0);
+      }
+      m_header->sleepers--;
+    }
+
+    /// @brief Wakes any reader sleeping in WaitForPublish(), so it can check for quitting.
+    void Interrupt()
+    {
+      m_header->wakeWord++;
+      syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->wakeWord), FUTEX_WAKE,
+        INT_MAX, nullptr, nullptr, 0);
+    }
+
+  private:
+    static const uint32_t Magic = 0x68726773;   // "hrgs"
+    static const uint32_t Version = 1;
+    static const uint64_t Writing = 1ULL << 63;
+    static const uint64_t NoSequence = ~0ULL;
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+      "Shared-memory rings need lock-free atomics");
+
+    /// Start of the segment.  Made only of fixed-size fields and lock-free atomics,
+    /// which work across processes.
+    struct Header {
+      std::atomic<uint32_t> magic{ 0 };
+      uint32_t version = 0;
+      uint32_t slotCount = 0;
+      uint32_t slotSize = 0;              ///< Most bytes of data that a slot can hold.
+      uint64_t slotStride = 0;            ///< Bytes from one slot to the next.
+      std::atomic<uint64_t> writeSeq{ 0 };  ///< Sequence number of the next blob.
+      std::atomic<uint64_t> skipped{ 0 };   ///< Blobs that could not be published.
+      std::atomic<uint32_t> wakeWord{ 0 };  ///< Futex, bumped after each publish.
+      std::atomic<uint32_t> sleepers{ 0 };  ///< Readers waiting on wakeWord.
+      std::atomic<uint32_t> closed{ 0 };
+    };
+
+    /// Start of each slot, followed by its data.
+    struct Slot {
+      /// Number of readers holding the data, or Writing while the publisher fills it.
+      std::atomic<uint64_t> state{ 0 };
+      std::atomic<uint64_t> sequence{ 0 };  ///< Sequence number of the blob held.
+      int64_t sec = 0;
+      int64_t usec = 0;
+      uint32_t size = 0;
+    };
+
+    /// Local (not shared) information passed as the deletion user data for a slot.
+    struct SlotRef {
+      SharedBlobRing *ring;
+      uint32_t index;
+    };
+
+    SharedBlobRing(void *base, size_t length, const std::string &shmName)
+      : m_base(base), m_length(length), m_header(static_cast<Header*>(base))
+      , m_shmName(shmName), m_slotRefs(m_header->slotCount)
+    {
+      for (uint32_t i = 0; i < m_header->slotCount; i++) {
+        m_slotRefs[i].ring = this;
+        m_slotRefs[i].index = i;
+      }
+    }
+
+    static uint64_t RoundUp(uint64_t size) { return (size + 63) & ~static_cast<uint64_t>(63); }
+    static uint64_t HeaderSize() { return RoundUp(sizeof(Header)); }
+    static uint64_t SlotHeaderSize() { return RoundUp(sizeof(Slot)); }
+
+    static const char *SegmentPrefix() { return "/hrgls_shm_"; }
+    static std::string SegmentName(const std::string &name) { return SegmentPrefix() + name; }
+
+    Slot *SlotAt(uint32_t index)
+    {
+      return reinterpret_cast<Slot*>(static_cast<char*>(m_base) + HeaderSize() +
+        m_header->slotStride * index);
+    }
+    uint8_t *SlotData(Slot *slot) { return reinterpret_cast<uint8_t*>(slot) + SlotHeaderSize(); }
+
+    void Wake()
+    {
+      m_header->wakeWord++;
+      if (m_header->sleepers.load() > 0) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_header->wakeWord), FUTEX_WAKE,
+          INT_MAX, nullptr, nullptr, 0);
+      }
+    }
+
+    /// Deletion function for the data of claimed blobs.
+    static void ReleaseSlot(void *userData, const uint8_t *)
+    {
+      SlotRef *ref = static_cast<SlotRef*>(userData);
+      ref->ring->SlotAt(ref->index)->state.fetch_sub(1, std::memory_order_release);
+      ref->ring->Unref();
+    }
+
+    void *m_base;
+    size_t m_length;
+    Header *m_header;
+    std::string m_shmName;          ///< Set for the publisher, which unlinks it.
+    std::vector<SlotRef> m_slotRefs;
+    std::atomic<long> m_refs{ 1 };
+  };
+
+} // end namespace hrgls
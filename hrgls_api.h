@@ -77,6 +77,16 @@ typedef int hrgls_Status;
   #define hrgls_STATUS_NULL_OBJECT_POINTER (1006)
   /// @brief Error: Internal failure: Exception inside the hourglass.
   #define hrgls_STATUS_INTERNAL_EXCEPTION (1007)
+  /// @brief Error: Could not connect to, or lost the connection to, a remote endpoint.
+  #define hrgls_STATUS_CONNECTION_FAILED (1008)
+  /// @brief Error: Reading or writing a file failed.
+  #define hrgls_STATUS_FILE_ERROR (1009)
+  /// @brief Error: An implementation library could not be loaded or does not provide
+  /// a compatible function table.
+  #define hrgls_STATUS_IMPLEMENTATION_NOT_FOUND (1010)
+  /// @brief Error: The data of a DataBlob is in more than one segment, or is 4 GiB or more,
+  /// so it must be read with hrgls_DataBlobGetSegment().
+  #define hrgls_STATUS_SEGMENTED_DATA (1011)
 
 /// @brief Helper function to return a descriptive error message based on a status value.
 /// @param [in] status Return value from an hrgls_* C API or C++ API call.
@@ -147,6 +157,28 @@ HRGLS_EXPORT hrgls_Status hrgls_MessageGetValue(hrgls_Message obj,
 HRGLS_EXPORT hrgls_Status hrgls_MessageSetValue(hrgls_Message obj,
 	const char *val);
 
+/// @brief Set the Message value parameter without copying it.
+///
+/// Meant for implementations that log at high rates with a fixed set of texts: the
+/// Message refers to the text, so neither setting it nor copying the Message (as
+/// happens on the way to a callback handler) copies or allocates the string.
+/// @param [in] obj Structure to use.
+/// @param [in] val New value to set.  It must stay valid and unchanged for as long as the
+///        library is loaded, as string literals and the results of hrgls_InternString() do.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_MessageSetStaticValue(hrgls_Message obj,
+	const char *val);
+
+/// @brief Get a copy of a string that lasts as long as the library is loaded.
+///
+/// Each distinct string is copied once into a table, and later calls with the same
+/// text return the same copy, so this is meant for a bounded set of texts (such as
+/// message formats) that are to be passed to hrgls_MessageSetStaticValue().
+/// @param [in] val String to look up.
+/// @param [out] returnInterned Pointer to the location to store the copy.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_InternString(const char *val, const char **returnInterned);
+
 /// @brief Read the Message timestamp parameter in UTC.
 /// @param [in] obj Structure to use.
 /// @param [out] val Pointer to the location to store the result.
@@ -233,6 +265,267 @@ HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetCredentials(
   hrgls_APICreateParams params,
   const uint8_t *credentials, uint32_t size);
 
+/// @brief Get the number of callback threads set by hrgls_APICreateParametersSetCallbackThreads().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnCount Pointer to a location to store the number of threads.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetCallbackThreads(
+  hrgls_APICreateParams params,
+  uint32_t *returnCount);
+
+/// @brief Set the number of threads to call callback handlers from.
+///
+/// When 0 (the default), the log-message and stream callback handlers are called
+/// directly by the threads that produce the messages and blobs, so a slow handler
+/// holds up production.  Otherwise they are called from a pool of this many threads;
+/// calls for the same hrgls_DataBlobSource (and for the log messages) are made one at a
+/// time in order, while those for different sources run in parallel.  Blobs and messages
+/// waiting for a handler are queued as described in hrgls_StreamPropertiesSetQueueCapacity().
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] count Number of threads.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetCallbackThreads(
+  hrgls_APICreateParams params,
+  uint32_t count);
+
+/// @brief Get the endpoint previously set by hrgls_APICreateParametersSetEndpoint().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnEndpoint Pointer to a location to store a pointer to the endpoint.
+///        This pointer will be valid until hrgls_APICreateParametersDestroy() is called
+///        on these params.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetEndpoint(
+  hrgls_APICreateParams params,
+  const char **returnEndpoint);
+
+/// @brief Set the remote endpoint that the API gets its DataBlobSources from.
+///
+/// When empty (the default), the API's DataBlobSources are local.  Otherwise it is
+/// of the form "host:port" and names an API elsewhere (usually on another host) that
+/// has called hrgls_APIStartServer().  hrgls_APIGetAvailableDataBlobSourceCount() then
+/// lists that API's sources, and each hrgls_DataBlobSource created on this API opens a
+/// connection of its own to stream blobs from one of them.
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] endpoint Host and port to connect to, or NULL or empty for none.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetEndpoint(
+  hrgls_APICreateParams params,
+  const char *endpoint);
+
+/// @brief Get the implementation previously set by hrgls_APICreateParametersSetImplementation().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnImplementation Pointer to a location to store a pointer to the
+///        implementation's file name.  This pointer will be valid until
+///        hrgls_APICreateParametersDestroy() is called on these params.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetImplementation(
+  hrgls_APICreateParams params,
+  const char **returnImplementation);
+
+/// @brief Set the shared library that implements the API.
+///
+/// When empty (the default), the API is implemented by the library that the program
+/// is linked against.  Otherwise it names a shared library (a .so, .dylib or .dll file,
+/// with or without a path, as passed to dlopen() or LoadLibrary()) that exports the
+/// function table described in hrgls_implementation.h.  The library is loaded the first
+/// time it is named and stays loaded, and hrgls_APICreate() and every call on the
+/// objects obtained from the API are passed to it through that table, so several
+/// implementations can be used at once in one program.
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] implementation File name of the library, or NULL or empty for none.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetImplementation(
+  hrgls_APICreateParams params,
+  const char *implementation);
+
+/// @brief Get the source count previously set by hrgls_APICreateParametersSetSourceCount().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnCount Pointer to a location to store the number of sources.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetSourceCount(
+  hrgls_APICreateParams params,
+  uint32_t *returnCount);
+
+/// @brief Set the number of DataBlobSources that the API advertises.
+///
+/// Used by implementations that generate their own data for testing, such as the
+/// NULL implementation, which names them "/hrgls/null/DataBlobSource/1" and up.
+/// Implementations that get their data from elsewhere ignore it.
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] count Number of sources.  Its default value is 2.  Must be at least 1.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetSourceCount(
+  hrgls_APICreateParams params,
+  uint32_t count);
+
+/// @brief Get the message rate previously set by hrgls_APICreateParametersSetMessageRate().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnRate Pointer to a location to store the messages/second.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetMessageRate(
+  hrgls_APICreateParams params,
+  double *returnRate);
+
+/// @brief Set the messages/second that the API sends while log messages are streaming.
+///
+/// Used by implementations that generate their own messages for testing, such as the
+/// NULL implementation; others ignore it.  Counts the messages generated, including
+/// those below the level set by hrgls_APISetLogMessageMinimumLevel(), which are not sent.
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] rate Messages/second.  Its default value is 10.  Must not be negative;
+///        0 sends none.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetMessageRate(
+  hrgls_APICreateParams params,
+  double rate);
+
+/// @brief Get the message level previously set by hrgls_APICreateParametersSetMessageLevel().
+/// @param [in] params Object that was created by hrgls_APICreateParametersCreate().
+/// @param [out] returnLevel Pointer to a location to store the level.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersGetMessageLevel(
+  hrgls_APICreateParams params,
+  hrgls_MessageLevel *returnLevel);
+
+/// @brief Set the lowest level of the messages that the API generates.
+///
+/// Used by implementations that generate their own messages for testing, such as the
+/// NULL implementation; others ignore it.  The messages cycle through those of the
+/// hrgls_MESSAGE_MINIMUM_* levels that are at least this one, or all have this level
+/// if none are.
+/// @param [in] params Object that created by hrgls_APICreateParametersCreate().
+/// @param [in] level Its default value is hrgls_MESSAGE_MINIMUM_INFO, which cycles
+///        through all of them.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APICreateParametersSetMessageLevel(
+  hrgls_APICreateParams params,
+  hrgls_MessageLevel level);
+
+//----------------------------------------------------------------------------------------
+/// @brief Opaque pointer to a C structure that stores statistics on a stream.
+///
+/// Filled in by hrgls_DataBlobSourceGetStatistics() with what has passed through a
+/// DataBlobSource, or by hrgls_APIGetLogMessageStatistics() with what has passed through
+/// an API's log-message path, in which case each message counts as a blob.
+/// Use the hrgls_StreamStatisticsGet* functions to read its values.
+///
+/// Times are in nanoseconds.  The latency of a blob is the time from its
+/// hrgls_DataBlobGetTime() (or hrgls_MessageGetTimeStamp()) to when it was handed to the
+/// client, either returned from a call or passed to a callback handler.
+typedef struct hrgls_StreamStatistics_ *hrgls_StreamStatistics;
+
+/// @brief Number of bins in the latency and callback-duration histograms.
+///
+/// Bin 0 counts times of 0.  Each bin i from 1 up to the next-to-last counts times
+/// from 2^(i-1) to 2^i - 1 nanoseconds, so bin 11 holds times from 1024 to 2047 ns
+/// (about 1-2 microseconds).  The last bin counts all times of 2^(i-1) nanoseconds and
+/// more, about 20 hours.
+#define hrgls_STATISTICS_HISTOGRAM_BINS (48)
+
+/// @brief Construct a statistics object with all counts zero.
+///
+/// hrgls_StreamStatisticsDestroy() should be called when the application is finished
+/// with it to avoid leaking resources.
+/// @param [out] returnStats Pointer to location to store the result, not changed on error.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsCreate(hrgls_StreamStatistics *returnStats);
+
+/// @brief Destroy a statistics object.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsDestroy(hrgls_StreamStatistics stats);
+
+/// @brief Read the number of blobs made by the producer, including ones later dropped.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetProduced(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the number of blobs handed to the client.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetDelivered(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the number of blobs dropped because their queue was full.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetDropped(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the number of blobs waiting in the queue when the statistics were read.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetQueueDepth(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the most blobs that have been waiting in the queue at once.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetMaxQueueDepth(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the sum of the latencies of all delivered blobs.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnNanoseconds Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetLatencyTotal(hrgls_StreamStatistics stats,
+  uint64_t *returnNanoseconds);
+
+/// @brief Read the largest latency of a delivered blob.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnNanoseconds Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetLatencyMax(hrgls_StreamStatistics stats,
+  uint64_t *returnNanoseconds);
+
+/// @brief Read the number of delivered blobs in each latency bin.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] counts Array to store the counts in, as described for
+///        hrgls_STATISTICS_HISTOGRAM_BINS.
+/// @param [in] size Number of entries in counts.  If it is less than
+///        hrgls_STATISTICS_HISTOGRAM_BINS, only the first size bins are returned;
+///        entries past the last bin are set to 0.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetLatencyHistogram(hrgls_StreamStatistics stats,
+  uint64_t *counts, uint32_t size);
+
+/// @brief Read the number of calls made to the callback handler.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnCount Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetCallbacks(hrgls_StreamStatistics stats,
+  uint64_t *returnCount);
+
+/// @brief Read the sum of the time spent in the callback handler.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnNanoseconds Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetCallbackDurationTotal(
+  hrgls_StreamStatistics stats, uint64_t *returnNanoseconds);
+
+/// @brief Read how long the longest call to the callback handler took.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] returnNanoseconds Pointer to location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetCallbackDurationMax(
+  hrgls_StreamStatistics stats, uint64_t *returnNanoseconds);
+
+/// @brief Read the number of calls to the callback handler in each duration bin.
+/// @param [in] stats Object returned from hrgls_StreamStatisticsCreate().
+/// @param [out] counts Array to store the counts in, as described for
+///        hrgls_STATISTICS_HISTOGRAM_BINS.
+/// @param [in] size Number of entries in counts, as for
+///        hrgls_StreamStatisticsGetLatencyHistogram().
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamStatisticsGetCallbackDurationHistogram(
+  hrgls_StreamStatistics stats, uint64_t *counts, uint32_t size);
+
 //----------------------------------------------------------------------------------------
 /// @brief Opaque pointer to a C structure that manages an API.
 typedef struct hrgls_API_ *hrgls_API;
@@ -243,7 +536,9 @@ typedef struct hrgls_API_ *hrgls_API;
 /// to avoid leaking resources.
 /// @param [out] returnAPI Pointer to location to store the result, not changed on error.
 /// @param [in] params Parameters to use when constructing the API.
-/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_IMPLEMENTATION_NOT_FOUND if the
+///         implementation named in the parameters could not be loaded, specific error
+///         code on other failures.
 HRGLS_EXPORT hrgls_Status hrgls_APICreate(hrgls_API *returnAPI, hrgls_APICreateParams params);
 
 /// @brief Destroy an API.
@@ -369,13 +664,44 @@ HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageStreamingState(hrgls_API api, bo
 HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageCallback(hrgls_API api,
 	hrgls_LogMessageCallback handler, void *userData);
 
+/// @brief Borrowed view of a log message, handed to a hrgls_LogMessageViewCallback.
+///
+/// The view and the text it points to belong to the library and are only valid until
+/// the callback handler returns, so the handler must copy anything it needs later.
+typedef struct {
+  const char *value;          ///< Text of the message.
+  struct timeval timeStamp;   ///< Time the message was generated, in UTC.
+  hrgls_MessageLevel level;   ///< Level of the message.
+} hrgls_MessageView;
+
+/// @brief Type declaration for a log message callback handler that borrows the message.
+/// @param [in] message View of the message, valid only during the call.
+/// @param [in] userData Pointer that was passed to hrgls_APISetLogMessageViewCallback().
+typedef void(*hrgls_LogMessageViewCallback)(const hrgls_MessageView *message, void *userData);
+
+/// @brief Set a callback function to be called with a borrowed view of each new log message.
+///
+/// This works like hrgls_APISetLogMessageCallback(), except that the handler is lent the
+/// message rather than given a copy to destroy.  When callbacks are made from the thread
+/// that generates the messages, no Message is created for them at all, so this is the
+/// cheapest way to receive messages at high rates.  Only one of the two kinds of handler
+/// is used at a time: setting either one, even to NULL, removes the other.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [in] handler Function to call whenever a new message is received.  Set to
+///        NULL to disable.
+/// @param [in] userData Pointer that is passed into the function whenever it is called.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageViewCallback(hrgls_API api,
+	hrgls_LogMessageViewCallback handler, void *userData);
+
 /// @brief Get the next available log message.
 ///
 /// Either hrgls_APISetLogMessageCallback() or hrgls_APIGetNextLogMessage() should
 /// be used to get log messages, but not both.  If the callback handler
 /// is set, it will be called from a separate thread whenever a new message is available.
 /// If there is no callback handler set, messages will queue up in memory until the program calls
-/// hrgls_APIGetNextLogMessage().
+/// hrgls_APIGetNextLogMessage().  The queue has a fixed size; once it is full the oldest messages
+/// are dropped and counted (see hrgls_APIGetDroppedLogMessageCount()).
 /// @param [in] api hrgls_API created by calling hrgls_APICreate().
 /// @param [in] message A pointer to the message that has been received.  Note: The receiver
 ///        must destroy the message by calling hrgls_MessageDestroy() when it is
@@ -385,6 +711,21 @@ HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageCallback(hrgls_API api,
 ///        not a message available.
 HRGLS_EXPORT hrgls_Status hrgls_APIGetNextLogMessage(hrgls_API api, hrgls_Message *message);
 
+/// @brief Read how many log messages have been dropped because their queue was full.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [out] count Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APIGetDroppedLogMessageCount(hrgls_API api, uint64_t *count);
+
+/// @brief Read statistics on the log messages generated since the API was created.
+///
+/// Each message counts as a blob; see hrgls_StreamStatistics for what is counted.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [in] stats Statistics created by hrgls_StreamStatisticsCreate() to be filled in.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APIGetLogMessageStatistics(hrgls_API api,
+  hrgls_StreamStatistics stats);
+
 /// @brief Sets the range of message levels to be returned.
 ///
 /// This method filters log messages so that only those of sufficient urgency
@@ -394,9 +735,109 @@ HRGLS_EXPORT hrgls_Status hrgls_APIGetNextLogMessage(hrgls_API api, hrgls_Messag
 /// @return hrgls_STATUS_OKAY on success, a specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageMinimumLevel(hrgls_API api, hrgls_MessageLevel level);
 
+/// @brief Serves this API's DataBlobSources to APIs on other hosts.
+///
+/// Listens for connections from APIs created with hrgls_APICreateParametersSetEndpoint().
+/// Each remote hrgls_DataBlobSource is served by a local one that is created with the
+/// remote one's stream properties, so its rate and overflow policy apply at the producer.
+/// Blobs are sent with their original times, as many at a time as have queued up, without
+/// waiting for the consumer to ask for each.  When the consumer or the network falls
+/// behind, the connection stops accepting data and blobs back up into the local source's
+/// queue, where the overflow policy decides what happens to them.  The server is stopped
+/// when the API is destroyed.  Only available on Linux.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [in] endpoint Address and port to listen on, of the form "host:port".  The host
+///        may be empty to listen on all addresses and the port may be 0 to pick a free one.
+/// @param [out] returnPort Pointer to the location to store the port that is being
+///        listened on, may be NULL.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the endpoint is not
+///         valid or the API is already serving, hrgls_STATUS_CONNECTION_FAILED if it could
+///         not listen there, hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not
+///         available, or another specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APIStartServer(hrgls_API api, const char *endpoint,
+  uint16_t *returnPort);
+
+/// @brief Makes a recording available as a DataBlobSource.
+///
+/// The recording, written by an hrgls_DataBlobRecorder, is listed by
+/// hrgls_APIGetAvailableDataBlobSourceCount() under the name "/hrgls/replay/" followed by
+/// the file name.  Creating an hrgls_DataBlobSource with that name replays it, whether or
+/// not it has been added here.  Only available on Linux.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [in] fileName Recording to add.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the file is not a
+///         recording or the API gets its sources from a remote endpoint,
+///         hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not available, specific
+///         error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_APIAddReplayFile(hrgls_API api, const char *fileName);
+
+/// @brief Reads the generation of an API's list of available DataBlobSources.
+///
+/// The generation increases each time the list that hrgls_APIGetAvailableDataBlobSourceCount()
+/// reports changes, so a client that keeps a copy of the list only needs to enumerate it
+/// again when the generation is not the one that it saw when it made its copy.  An API
+/// that gets its sources from a remote endpoint cannot tell when they change and reports
+/// generation 0, meaning that the list must be read again each time it is needed.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [out] returnGeneration Location to store the generation.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APIGetDataBlobSourceGeneration(hrgls_API api,
+  uint64_t *returnGeneration);
+
+/// @brief Callback handler type declaration for changes to the list of DataBlobSources.
+/// @param [in] generation Generation of the list after the change; see
+///        hrgls_APIGetDataBlobSourceGeneration().
+/// @param [in] userData Pointer that was passed to hrgls_APISetDataBlobSourcesChangedCallback().
+typedef void(*hrgls_DataBlobSourcesChangedCallback)(uint64_t generation, void *userData);
+
+/// @brief Sets up a handler to be called each time the list of DataBlobSources changes.
+///
+/// The handler is called from the thread that changed the list, after the change, and
+/// may read the list.  It must not set the handler again.  Once this returns, the
+/// handler that it replaced will not be called.  APIs that get their sources from a
+/// remote endpoint never call it.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [in] handler Function to call, or nullptr to remove the handler.
+/// @param [in] userData Pointer passed to the handler with each call.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APISetDataBlobSourcesChangedCallback(hrgls_API api,
+  hrgls_DataBlobSourcesChangedCallback handler, void *userData);
+
 //---------------------------------------------------------------------------
 // DataBlobSource API class and its parameters and methods.
 
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for what a DataBlobSource does when its queue of blobs
+/// waiting to be retrieved by hrgls_DataBlobSourceGetNextBlob() is full.
+typedef int32_t hrgls_OverflowPolicy;
+/// @brief Discard the oldest queued blob to make room for the new one.
+#define hrgls_OVERFLOW_DROP_OLDEST (0)
+/// @brief Discard the new blob, keeping the ones that are already queued.
+#define hrgls_OVERFLOW_DROP_NEWEST (1)
+/// @brief Hold the new blob in the producer until there is room, producing no more until then.
+#define hrgls_OVERFLOW_BLOCK_PRODUCER (2)
+
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for how the sizes of the blobs from a DataBlobSource that
+/// generates its own data vary around hrgls_StreamPropertiesSetPayloadSize().
+typedef int32_t hrgls_PayloadDistribution;
+/// @brief Every blob is the payload size.
+#define hrgls_PAYLOAD_FIXED (0)
+/// @brief Sizes are spread evenly from 1 byte to one less than twice the payload size.
+#define hrgls_PAYLOAD_UNIFORM (1)
+/// @brief Sizes are exponentially distributed with the payload size as their mean, from
+/// 1 byte to eight times the payload size.
+#define hrgls_PAYLOAD_EXPONENTIAL (2)
+
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for how a DataBlobSource that replays a recording paces its blobs.
+typedef int32_t hrgls_ReplayPacing;
+/// @brief Deliver blobs spaced out as they were when they were recorded.
+#define hrgls_REPLAY_RECORDED_RATE (0)
+/// @brief Deliver blobs as fast as the consumer takes them.  Usually combined with
+/// hrgls_OVERFLOW_BLOCK_PRODUCER so that none are dropped.
+#define hrgls_REPLAY_AS_FAST_AS_POSSIBLE (1)
+
 //----------------------------------------------------------------------------------------
 /// @brief Opaque pointer to a C structure that stores the properties of an hrgls_DataBlobSource.
 ///
@@ -429,8 +870,100 @@ HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetRate(hrgls_StreamProperties p
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetRate(hrgls_StreamProperties prop, double val);
 
+/// @brief Read the number of blobs that can be queued waiting to be retrieved.
+/// @param [in] prop Structure to use.
+/// @param [out] val Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetQueueCapacity(hrgls_StreamProperties prop,
+  uint32_t *val);
+
+/// @brief Set the number of blobs that can be queued waiting to be retrieved.
+///
+/// Once this many blobs are queued, new blobs are handled as described by the
+/// overflow policy.  The queue is allocated when the DataBlobSource is created.
+/// @param [in] prop Structure to use.
+/// @param [in] val Its default value is 256.  Must be at least 1.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetQueueCapacity(hrgls_StreamProperties prop,
+  uint32_t val);
+
+/// @brief Read what the stream does when its queue is full.
+/// @param [in] prop Structure to use.
+/// @param [out] val Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetOverflowPolicy(hrgls_StreamProperties prop,
+  hrgls_OverflowPolicy *val);
+
+/// @brief Set what the stream does when its queue is full.
+/// @param [in] prop Structure to use.
+/// @param [in] val One of the hrgls_OVERFLOW_* values.  Its default value is
+///        hrgls_OVERFLOW_DROP_OLDEST.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetOverflowPolicy(hrgls_StreamProperties prop,
+  hrgls_OverflowPolicy val);
+
+/// @brief Read the typical number of bytes in each blob.
+/// @param [in] prop Structure to use.
+/// @param [out] val Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetPayloadSize(hrgls_StreamProperties prop,
+  uint32_t *val);
+
+/// @brief Set the typical number of bytes in each blob.
+///
+/// Used by DataBlobSources that generate their own data for testing, such as those of
+/// the NULL implementation; others ignore it.  How the sizes vary around this one is
+/// set by hrgls_StreamPropertiesSetPayloadDistribution().
+/// @param [in] prop Structure to use.
+/// @param [in] val Its default value is 256.  Must be from 1 to 268435456 (256 MiB).
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetPayloadSize(hrgls_StreamProperties prop,
+  uint32_t val);
+
+/// @brief Read how the number of bytes in each blob varies.
+/// @param [in] prop Structure to use.
+/// @param [out] val Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetPayloadDistribution(
+  hrgls_StreamProperties prop, hrgls_PayloadDistribution *val);
+
+/// @brief Set how the number of bytes in each blob varies.
+///
+/// Used along with hrgls_StreamPropertiesSetPayloadSize().
+/// @param [in] prop Structure to use.
+/// @param [in] val One of the hrgls_PAYLOAD_* values.  Its default value is
+///        hrgls_PAYLOAD_FIXED.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetPayloadDistribution(
+  hrgls_StreamProperties prop, hrgls_PayloadDistribution val);
+
+/// @brief Read the number of blobs that are sent together.
+/// @param [in] prop Structure to use.
+/// @param [out] val Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesGetBurstLength(hrgls_StreamProperties prop,
+  uint32_t *val);
+
+/// @brief Set the number of blobs that are sent together.
+///
+/// Used by DataBlobSources that generate their own data for testing, such as those of
+/// the NULL implementation; others ignore it.  The blobs are sent in bursts of this
+/// many at once, with the bursts spaced so that the average is still the rate set by
+/// hrgls_StreamPropertiesSetRate().
+/// @param [in] prop Structure to use.
+/// @param [in] val Its default value is 1, which spaces all blobs evenly.  Must be at
+///        least 1.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_StreamPropertiesSetBurstLength(hrgls_StreamProperties prop,
+  uint32_t val);
+
 //----------------------------------------------------------------------------------------
 /// @brief Stores a blob from an hrgls_DataBlobSource.
+///
+/// The data pointed to by a DataBlob is reference counted and shared by all of
+/// its copies, so copying a DataBlob never copies its data.  Each DataBlob holds
+/// a reference that is dropped either by hrgls_DataBlobReleaseData() or when the
+/// DataBlob is destroyed; the data is freed when the last reference is dropped.
 typedef struct hrgls_DataBlob_ *hrgls_DataBlob;
 
 /// @brief Create a DataBlob and initialize with default values.
@@ -443,8 +976,9 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobCreate(hrgls_DataBlob*returnBlob);
 
 /// @brief Create a DataBlob and initialize with values from another DataBlob.
 ///
-/// Call hrgls_DataBlobDestroy() when done with the DataBlob (and after
-/// calling release on its data) to avoid leaking resources.
+/// The new DataBlob shares the data of the original, taking a new reference to it
+/// rather than copying it.  Call hrgls_DataBlobDestroy() when done with the DataBlob
+/// to avoid leaking resources.
 /// @param [out] returnBlob Pointer to the DataBlob to be constructed.
 /// @param [in] blobToCopy The DataBlob to copy information from.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
@@ -456,8 +990,8 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobCopy(hrgls_DataBlob*returnBlob,
 /// Used to destroy a DataBlob obtained from hrgls_DataBlobCreate(),
 /// hrgls_DataBlobCopy(), or hrgls_DataBlobSourceGetNextBlob(), or
 /// in a registered callback handler on a render stream.
-/// Does not free the underlying data -- call hrgls_DataBlobReleaseData()
-/// on it to do that.
+/// Releases any references the DataBlob still holds on its data, which frees
+/// the data if no other copy refers to it.
 /// @param [in] blob DataBlob to be destroyed.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobDestroy(hrgls_DataBlob blob);
@@ -476,9 +1010,14 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobSetTime(hrgls_DataBlob blob, struct time
 
 
 /// @brief Read a pointer to the blob data and size.
+///
+/// Only data that is a single segment of less than 4 GiB can be read this way; for other
+/// data, NULL and 0 are returned along with hrgls_STATUS_SEGMENTED_DATA.
 /// @param [in] blob Structure to use.
 /// @param [out] data Pointer to a pointer to the binary data.
 ///              The data is not copied, only a pointer to the data is stored.
+///              It remains valid as long as this DataBlob holds a reference to it.
+///              NULL is returned if the DataBlob has released all of its references.
 /// @param [out] size Pointer to a location to store the blob size.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobGetData(hrgls_DataBlob blob, const uint8_t** data, uint32_t* size);
@@ -492,20 +1031,267 @@ typedef void(*hrgls_DeletionFunction)(void* userData, const uint8_t* dataToDelet
 ///              The data is not copied, only a pointer to the data is stored.
 /// @param [in] size The blob size.
 /// @param [in] deleteFunction Pointer to a deletion function, or NULL for no deletion.
+///              It is called once, when the last reference to the data is released.
 /// @param [in] userData Passed back to the deleteFunction, may be NULL.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobSetData(hrgls_DataBlob blob, const uint8_t* data, uint32_t size,
   hrgls_DeletionFunction deleteFunction, void* userData);
 
-/// @brief Release the data associated with a DataBlob.
+/// @brief One of the separate buffers that the data of a DataBlob can be made of.
+///
+/// Lets a producer hand over data that is in pieces, such as a header and a body or the
+/// planes of an image, without copying it into one buffer, and describe data of 4 GiB or
+/// more.  Each segment is freed by its own deletion function.
+typedef struct {
+  const uint8_t *data;                    ///< Start of the segment, may be NULL if size is 0.
+  uint64_t size;                          ///< Size of the segment in bytes.
+  hrgls_DeletionFunction deleteFunction;  ///< Called with userData and data when the last
+                                          ///< reference to the blob data is released, or NULL.
+  void *userData;                         ///< Passed back to deleteFunction, may be NULL.
+} hrgls_DataBlobSegment;
+
+/// @brief Set the blob data to a list of segments.  Not normally called by client code.
+///
+/// The segments together make up the data, in order.  The data is not copied, and the
+/// deletion function of each segment is called, in order, when the last reference to
+/// the data is released.  On failure none of them are called.
+/// @param [in] blob Structure to use.
+/// @param [in] segments Array of segments, which is copied.
+/// @param [in] count Number of segments, 0 to leave the blob without data.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSetSegments(hrgls_DataBlob blob,
+  const hrgls_DataBlobSegment *segments, uint32_t count);
+
+/// @brief Read how many segments the blob data is made of.
+/// @param [in] blob Structure to use.
+/// @param [out] count Pointer to the location to store the result: 1 for data set by
+///        hrgls_DataBlobSetData(), 0 if the DataBlob has no data.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobGetSegmentCount(hrgls_DataBlob blob, uint32_t *count);
+
+/// @brief Read a pointer to one segment of the blob data and its size.
+/// @param [in] blob Structure to use.
+/// @param [in] which Index of the segment, less than the count.
+/// @param [out] data Pointer to a pointer to the segment's data, which remains valid as
+///        long as the pointer from hrgls_DataBlobGetData() would.
+/// @param [out] size Pointer to a location to store the segment's size.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobGetSegment(hrgls_DataBlob blob, uint32_t which,
+  const uint8_t **data, uint64_t *size);
+
+/// @brief Read the total size of all of the segments of the blob data.
+/// @param [in] blob Structure to use.
+/// @param [out] size Pointer to a location to store the size, 0 if there is no data.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobGetTotalSize(hrgls_DataBlob blob, uint64_t *size);
+
+/// @brief Take an additional reference on the data associated with a DataBlob.
+///
+/// Each call must be balanced by a call to hrgls_DataBlobReleaseData(), or by
+/// destroying the DataBlob.  Does nothing if the DataBlob has no data.
+/// @param [in] blob Structure to use.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRetainData(hrgls_DataBlob blob);
+
+/// @brief Release one reference on the data associated with a DataBlob.
 ///
-/// This function will be implemented in such a way that it is robust to being
-/// called multiple times to release the same data, with the second and later calls
-/// doing nothing.
+/// The data is freed when the last reference held by any copy of the DataBlob
+/// is released.  Once a DataBlob has released all of its references, the
+/// pointer returned by hrgls_DataBlobGetData() must no longer be used and
+/// further calls do nothing, so this is robust to being called multiple times.
 /// @param [in] blob Structure to use.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobReleaseData(hrgls_DataBlob blob);
 
+/// @brief Read the number of references to the data associated with a DataBlob.
+///
+/// Counts the references held by all copies of the DataBlob.  Intended for
+/// debugging and testing; the value may change at any time if other threads
+/// hold copies.
+/// @param [in] blob Structure to use.
+/// @param [out] count Pointer to the location to store the result, 0 if the
+///        DataBlob has no data.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobGetDataReferenceCount(hrgls_DataBlob blob, uint32_t *count);
+
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for the handle types whose memory is pooled.
+///
+/// Handles that are destroyed are kept by the library and reused by later create
+/// and copy calls, so streaming does not need to go to the heap for each blob or
+/// message.  The pools are shared by all hrgls_API objects.
+typedef int32_t hrgls_HandlePoolType;
+/// @brief Pool for hrgls_DataBlob handles.
+#define hrgls_HANDLE_POOL_DATABLOB (0)
+/// @brief Pool for the reference-counted records that hold the data of hrgls_DataBlob handles.
+#define hrgls_HANDLE_POOL_DATABLOB_PAYLOAD (1)
+/// @brief Pool for hrgls_Message handles.
+#define hrgls_HANDLE_POOL_MESSAGE (2)
+
+/// @brief Read the statistics for one of the handle pools.
+/// @param [in] type Which pool to read.
+/// @param [out] hits Pointer to the location to store the number of handles that
+///        were created by reusing memory from the pool, may be NULL.
+/// @param [out] misses Pointer to the location to store the number of handles that
+///        had to be allocated, may be NULL.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_HandlePoolGetStatistics(hrgls_HandlePoolType type,
+  uint64_t *hits, uint64_t *misses);
+
+/// @brief Pre-allocate handles in one of the pools.
+///
+/// Makes sure that at least count handles of the given type can be created
+/// without allocating memory.  Useful to avoid allocating while streaming starts.
+/// @param [in] type Which pool to fill.
+/// @param [in] count Number of handles to make available.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_HandlePoolReserve(hrgls_HandlePoolType type, uint32_t count);
+
+//----------------------------------------------------------------------------------------
+/// @brief Opaque pointer to a pool of fixed-size buffers to hold hrgls_DataBlob data.
+///
+/// Buffers are allocated and freed by the library, so they can be filled by an
+/// implementation and handed to hrgls_DataBlobSetData() with hrgls_BufferPoolReturn()
+/// as the deletion function and the pool as its userData.  When the last reference
+/// to the data is released the buffer goes back into the pool to be reused.
+/// It is safe to use a pool from multiple threads.
+typedef struct hrgls_BufferPool_ *hrgls_BufferPool;
+
+/// @brief Create a buffer pool.
+///
+/// Call hrgls_BufferPoolDestroy() when done with the pool.
+/// @param [out] returnPool Pointer to the pool to be constructed.
+/// @param [in] bufferSize Size of each of the buffers in the pool, must be nonzero.
+///        Larger requests are allocated separately and not pooled.
+/// @param [in] maxFreeBuffers Most returned buffers to keep for reuse; buffers
+///        returned when this many are waiting are freed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_BufferPoolCreate(hrgls_BufferPool *returnPool,
+  uint32_t bufferSize, uint32_t maxFreeBuffers);
+
+/// @brief Destroy a buffer pool.
+///
+/// Buffers that are still in use remain valid; the pool's memory is freed
+/// once the last of them has been returned.
+/// @param [in] pool Pool to be destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_BufferPoolDestroy(hrgls_BufferPool pool);
+
+/// @brief Get a buffer from a pool.
+/// @param [in] pool Pool to take the buffer from.
+/// @param [in] size Number of bytes needed.
+/// @param [out] returnBuffer Pointer to the location to store the buffer.  Not
+///        initialized.  Must be passed to hrgls_BufferPoolReturn() when done.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_BufferPoolAcquire(hrgls_BufferPool pool, uint32_t size,
+  uint8_t **returnBuffer);
+
+/// @brief Give a buffer back to the pool it came from.
+///
+/// Has the signature of an hrgls_DeletionFunction so that it can be passed
+/// directly to hrgls_DataBlobSetData().
+/// @param [in] pool The hrgls_BufferPool the buffer was acquired from.  The buffer
+///        records its own pool, so this is only used to find the implementation that
+///        the pool came from (see hrgls_implementation.h) and may be NULL for pools
+///        made by hrgls_BufferPoolCreate().
+/// @param [in] buffer Buffer obtained from hrgls_BufferPoolAcquire(), may be NULL.
+HRGLS_EXPORT void hrgls_BufferPoolReturn(void *pool, const uint8_t *buffer);
+
+/// @brief Read the statistics for a buffer pool.
+/// @param [in] pool Pool to read.
+/// @param [out] hits Pointer to the location to store the number of acquisitions
+///        that reused a pooled buffer, may be NULL.
+/// @param [out] misses Pointer to the location to store the number of acquisitions
+///        that had to allocate, may be NULL.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_BufferPoolGetStatistics(hrgls_BufferPool pool,
+  uint64_t *hits, uint64_t *misses);
+
+/// @brief Get the pool that an hrgls_API uses for the data in the blobs it produces.
+/// @param [in] api hrgls_API created by calling hrgls_APICreate().
+/// @param [out] returnPool Pointer to the location to store the pool.  It is owned
+///        by the API and must not be destroyed by the caller.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_APIGetBufferPool(hrgls_API api, hrgls_BufferPool *returnPool);
+
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for the events that are recorded while tracing.
+///
+/// While tracing is on, each thread records the events of what it does into a ring of
+/// its own, with a timestamp and without locking or allocating, so that it can be left
+/// on without disturbing the timing of what is being traced.  hrgls_TraceDump() writes
+/// the rings to a file that the trace_to_json tool turns into a Chrome trace.  Tracing
+/// is shared by all hrgls_API objects, like the handle pools.
+typedef uint16_t hrgls_TraceEventType;
+/// @brief A blob was made by a DataBlobSource; the value is its size.
+#define hrgls_TRACE_BLOB_PRODUCED (1)
+/// @brief A blob was added to a DataBlobSource's queue; the value is the queue depth.
+#define hrgls_TRACE_BLOB_ENQUEUED (2)
+/// @brief Blobs were taken from a DataBlobSource's queue by the client; the value is how many.
+#define hrgls_TRACE_BLOB_DEQUEUED (3)
+/// @brief Blobs were dropped because a DataBlobSource could not keep them; the value is how many.
+#define hrgls_TRACE_BLOB_DROPPED (4)
+/// @brief A callback handler is about to be called with a blob or log message.
+#define hrgls_TRACE_CALLBACK_BEGIN (5)
+/// @brief A callback handler has returned.
+#define hrgls_TRACE_CALLBACK_END (6)
+/// @brief A log message was generated; the value is its level.
+#define hrgls_TRACE_MESSAGE_PRODUCED (7)
+/// @brief A function in the C interface was entered; the value names it (see hrgls_TraceEvent).
+#define hrgls_TRACE_C_ENTER (8)
+/// @brief A function in the C interface is returning; the value names it.
+#define hrgls_TRACE_C_EXIT (9)
+/// @brief First of the types that are left for clients and implementations to define.
+#define hrgls_TRACE_USER (1000)
+
+/// @brief An event as it is stored in a trace file written by hrgls_TraceDump().
+///
+/// A trace file starts with the 8 bytes "HRGLSTRC", a uint32_t version (1) and a
+/// uint32_t count of names, each of which is a uint32_t length followed by that many
+/// bytes of text.  Then come a uint64_t count of events and the events, in the byte
+/// order of the host that wrote them.  The events of each thread are in time order.
+typedef struct {
+  uint64_t time;                ///< Nanoseconds since tracing was started.
+  uint64_t object;              ///< The stream or other object that the event is about.
+  uint64_t value;               ///< Depends on the type; for hrgls_TRACE_C_ENTER and
+                                ///< hrgls_TRACE_C_EXIT, the index of a name in the file.
+  uint32_t thread;              ///< Small number that identifies the thread.
+  hrgls_TraceEventType type;    ///< One of the hrgls_TRACE_* values.
+  uint16_t reserved;            ///< Zero.
+} hrgls_TraceEvent;
+
+/// @brief Start recording events, clearing any that were recorded before.
+/// @param [in] eventsPerThread Size of each thread's ring; once it is full the oldest
+///        events are overwritten.  0 picks the default, 16384.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_TraceStart(uint32_t eventsPerThread);
+
+/// @brief Stop recording events, keeping those that were recorded for hrgls_TraceDump().
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_TraceStop(void);
+
+/// @brief Record an event if tracing is on, for use by implementations and clients.
+///
+/// This takes a timestamp and stores the event in the calling thread's ring, which
+/// takes nanoseconds; when tracing is off it does nothing.
+/// @param [in] type One of the hrgls_TRACE_* values or a value at or above hrgls_TRACE_USER.
+///        hrgls_TRACE_C_ENTER and hrgls_TRACE_C_EXIT are only recorded by the library
+///        itself and are ignored here.
+/// @param [in] object Identifies the stream or other object that the event is about.
+/// @param [in] value Depends on the type.
+HRGLS_EXPORT void hrgls_TraceRecord(hrgls_TraceEventType type, uint64_t object, uint64_t value);
+
+/// @brief Write the events in all threads' rings to a file.
+///
+/// This can be called while tracing is on; events recorded while the file is being
+/// written may or may not be included.  Only the events recorded by the implementation
+/// that the program is linked against are written.
+/// @param [in] fileName Name of the file to write, in the format described for
+///        hrgls_TraceEvent.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if the file could not
+///         be written, or another specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_TraceDump(const char *fileName);
+
 //----------------------------------------------------------------------------------------
 /// @brief Opaque pointer to C structure that stores parameters to pass to hrgls_DataBlobSourceCreate.
 typedef struct hrgls_DataBlobSourceCreateParams_ *hrgls_DataBlobSourceCreateParams;
@@ -558,7 +1344,8 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceCreateParametersSetStreamPropertie
 /// to handle a new blob.  This includes the data and a user-data pointer
 /// that the caller passed in.
 /// @param [in] blob The blob that has been received from the DataBlobSource.
-///             The handler must call ReleaseData() on the blob when it is done with it.
+///             The handler owns the blob and must destroy it with hrgls_DataBlobDestroy()
+///             when it is done with it, which also releases its reference to the data.
 /// @param [in] userData Pointer to the data that was passed into the userData
 ///             parameter for the hrgls_DataBlobSourceSetStreamCallback function, handed
 ///             back here so that the client can tell itself how to behave.  This
@@ -592,6 +1379,22 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceDestroy(hrgls_DataBlobSource strea
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceSetStreamingState(hrgls_DataBlobSource stream,
   bool running);
 
+/// @brief Change the stream properties of a DataBlobSource without recreating it.
+///
+/// May be called while streaming.  The new rate, payload size and distribution, burst
+/// length and overflow policy take effect at once, and no queued blobs are lost.  The
+/// queue capacity cannot be changed.  The producer reads the properties without locking,
+/// and each blob is made entirely under either the old ones or the new ones.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [in] props Properties to use from now on, made by hrgls_StreamPropertiesCreate().
+///        They are copied, so they may be changed or destroyed afterwards.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if props is NULL or
+///        has a different queue capacity, hrgls_STATUS_NOT_IMPLEMENTED for a stream that
+///        reads from shared memory or replays a recording, specific error code on other
+///        failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceSetStreamProperties(hrgls_DataBlobSource stream,
+  hrgls_StreamProperties props);
+
 /// @brief Set a callback function to be called by the receiving thread on each new blob.
 ///
 /// Either hrgls_DataBlobSourceSetStreamCallback() or hrgls_DataBlobSourceGetNextBlob() should
@@ -615,19 +1418,169 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceSetStreamCallback(hrgls_DataBlobSo
 /// be used to get blobs from the DataBlobSource, but not both.  If the callback handler
 /// is set, it will be called from a separate thread whenever a new blob is available.
 /// If there is no callback handler set, blobs will queue up in memory until the program calls
-/// hrgls_DataBlobSourceGetNextBlob().
+/// hrgls_DataBlobSourceGetNextBlob().  The queue holds at most the number of blobs set by
+/// hrgls_StreamPropertiesSetQueueCapacity(); what happens after that is set by
+/// hrgls_StreamPropertiesSetOverflowPolicy().
 /// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
 /// @param [in] blob A pointer to the blob that has been received.  Note: The receiver
-///        must call ReleaseData() on the blob when it is done with it and must
-///        also destroy the blob by calling hrgls_DataBlobDestroy().
-/// @param [in] timeout Specifies how long to busy-wait for a blob before returning.  If
-///        set to 0, returns immediately whether or not there is a blob.
+///        must destroy the blob by calling hrgls_DataBlobDestroy() when it is done
+///        with it, which also releases its reference to the data.
+/// @param [in] timeout Specifies how long to wait for a blob before returning.  The
+///        calling thread sleeps while it waits (it does not use CPU) and is woken as
+///        soon as a blob is enqueued by the DataBlobSource.  If set to 0, returns
+///        immediately whether or not there is a blob.
 /// @return hrgls_STATUS_OKAY on success, specific error code on failure.  Returns
 ///        hrgls_STATUS_TIMEOUT and a blob that has no data if there is not a blob available
 ///        within the specified time.
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetNextBlob(hrgls_DataBlobSource stream,
   hrgls_DataBlob *blob, struct timeval timeout);
 
+/// @brief Get all of the blobs that are available from a render stream, up to a maximum.
+///
+/// Like hrgls_DataBlobSourceGetNextBlob(), but removes as many queued blobs as are
+/// available (up to maxNum) in a single call, which costs much less per blob than
+/// calling hrgls_DataBlobSourceGetNextBlob() once for each of them.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [out] blobs Caller-provided array with room for at least maxNum blobs.  The
+///        first *returnCount entries are filled in.  Note: The receiver must destroy each
+///        returned blob by calling hrgls_DataBlobDestroy() when it is done with it.
+/// @param [in] maxNum Maximum number of blobs to return, must be at least 1.
+/// @param [out] returnCount Pointer to the location to store the number of blobs returned.
+/// @param [in] timeout Specifies how long to wait for the first blob before returning.  Once
+///        at least one blob is available, all available blobs (up to maxNum) are returned
+///        without further waiting.  If set to 0, returns immediately whether or not there
+///        are blobs.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.  Returns
+///        hrgls_STATUS_TIMEOUT and a count of 0 if there is not a blob available within
+///        the specified time.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetPendingBlobs(hrgls_DataBlobSource stream,
+  hrgls_DataBlob *blobs, uint32_t maxNum, uint32_t *returnCount, struct timeval timeout);
+
+/// @brief Read how many blobs the DataBlobSource has dropped because its queue was full.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [out] count Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetDroppedBlobCount(hrgls_DataBlobSource stream,
+  uint64_t *count);
+
+/// @brief Read statistics on the blobs made since the DataBlobSource was created.
+///
+/// The counters are kept without locking, so a snapshot taken while streaming may not
+/// be consistent between counters.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [in] stats Statistics created by hrgls_StreamStatisticsCreate() to be filled in.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetStatistics(hrgls_DataBlobSource stream,
+  hrgls_StreamStatistics stats);
+
+/// @brief Opaque pointer to a C structure holding a request for the next blob from a source.
+///
+/// Made by hrgls_DataBlobSourceGetNextBlobAsync(), which returns at once.  The request
+/// is filled in with the next blob produced (or the oldest one already queued) without
+/// any thread having to wait for it; hrgls_DataBlobRequestIsReady() checks whether that
+/// has happened and hrgls_DataBlobRequestWait() gets the blob.  Requests on a source are
+/// filled in the order they were made, ahead of calls to hrgls_DataBlobSourceGetNextBlob(),
+/// and are never filled in while a stream callback is set.
+typedef struct hrgls_DataBlobRequest_ *hrgls_DataBlobRequest;
+
+/// @brief Ask for the next blob from a render stream without waiting for it.
+///
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [out] returnRequest Pointer to the request to be constructed.  Call
+///        hrgls_DataBlobRequestDestroy() when done with it.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetNextBlobAsync(hrgls_DataBlobSource stream,
+  hrgls_DataBlobRequest *returnRequest);
+
+/// @brief Destroy a request, cancelling it if it has not been filled in.
+///
+/// A blob that filled the request but was not retrieved is released.
+/// @param [in] request Request to be destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRequestDestroy(hrgls_DataBlobRequest request);
+
+/// @brief Check, without waiting, whether hrgls_DataBlobRequestWait() would return at once.
+/// @param [in] request Request made by hrgls_DataBlobSourceGetNextBlobAsync().
+/// @param [out] ready Set to true if the request has been filled in or its source has
+///        been destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRequestIsReady(hrgls_DataBlobRequest request,
+  bool *ready);
+
+/// @brief Get the blob that fills a request.
+///
+/// Each request is filled in by a single blob, after which it is no longer associated
+/// with its source and further calls return hrgls_STATUS_NULL_OBJECT_POINTER.
+/// @param [in] request Request made by hrgls_DataBlobSourceGetNextBlobAsync().
+/// @param [out] blob Pointer to the blob that has been received.  Note: The receiver
+///        must destroy the blob by calling hrgls_DataBlobDestroy() when it is
+///        done with it, even when no blob was available.
+/// @param [in] timeout How long to wait for the blob.  {0,0} returns immediately if it
+///        has not arrived.  The calling thread sleeps while waiting.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.  Returns
+///        hrgls_STATUS_TIMEOUT and an empty blob if the blob has not arrived, and
+///        hrgls_STATUS_NULL_OBJECT_POINTER and an empty blob if the source was destroyed
+///        before it did.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRequestWait(hrgls_DataBlobRequest request,
+  hrgls_DataBlob *blob, struct timeval timeout);
+
+/// @brief Get a file descriptor that becomes readable when blobs are queued on a source.
+///
+/// Lets an event loop based on select(), poll(), or epoll wait on DataBlobSources along
+/// with its other file descriptors.  The descriptor is readable while
+/// hrgls_DataBlobSourceGetNextBlob() would return a blob without waiting; it may
+/// occasionally stay readable after the queue has been emptied, so that function should
+/// be called with a timeout of {0,0} when it is.  The descriptor belongs to the source,
+/// which closes it when it is destroyed.  The caller must only wait on it and must not
+/// read from, write to, or close it.  Only available on Linux.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [out] fd Pointer to the location to store the descriptor, or -1 on failure.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_NOT_IMPLEMENTED on platforms where
+///        it is not available, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetNotificationFD(hrgls_DataBlobSource stream,
+  int *fd);
+
+/// @brief Publish a render stream's blobs for other processes on the same host.
+///
+/// From now on, each blob is also copied once into a ring in a shared-memory segment.
+/// Other processes call hrgls_DataBlobSourceCreate() with the name "/hrgls/shm/" followed
+/// by this name to receive them; their blobs point straight into the segment and hold
+/// their place in the ring until they are released.  When the next place in the ring is
+/// still held, a blob is skipped rather than waiting for the consumer.  The ring is
+/// removed when the stream is destroyed.  Only available on Linux.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [in] name Name for the ring: 1 to 245 letters, digits, '.', '_' or '-'.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the name is not
+///        valid or the stream is already published or is attached to a ring,
+///        hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not available, specific
+///        error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourcePublishSharedMemory(hrgls_DataBlobSource stream,
+  const char *name);
+
+/// @brief Lend a render stream buffers to write its blobs into.
+///
+/// Once buffers have been provided, each blob's data is written into one of them rather
+/// than into memory the stream allocates, and hrgls_DataBlobGetData() points at it.  When
+/// the last reference to that data is released, the buffer is handed back by calling
+/// returnFunction(userData, buffer); buffers not holding a blob are handed back when the
+/// stream is destroyed.  Call this again with returned buffers to keep them in use.  A blob
+/// that finds no buffer free is dropped and counted by
+/// hrgls_DataBlobSourceGetDroppedBlobCount().  May be called while streaming.
+/// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
+/// @param [in] buffers Array of count buffers to lend, none of which may be NULL.
+/// @param [in] count Number of buffers, must be at least 1.
+/// @param [in] size Size in bytes of each buffer.  For a stream produced by this process,
+///        it must hold the largest blob its stream properties can make.
+/// @param [in] returnFunction Called once for each buffer when it is handed back, possibly
+///        from another thread; must not be NULL.
+/// @param [in] userData Passed to returnFunction.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if a parameter is not
+///        valid, hrgls_STATUS_NOT_IMPLEMENTED for a stream that reads from shared memory
+///        or replays a recording, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceProvideBuffers(hrgls_DataBlobSource stream,
+  uint8_t * const *buffers, uint32_t count, uint32_t size,
+  hrgls_DeletionFunction returnFunction, void *userData);
+
 /// @brief Gets information (including the name) about the DataBlobSource.
 ///
 /// @param [in] stream DataBlobSource created by calling hrgls_DataBlobSourceCreate().
@@ -636,6 +1589,273 @@ HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetNextBlob(hrgls_DataBlobSource s
 HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGetInfo(hrgls_DataBlobSource stream,
   hrgls_APIDataBlobSourceInfo *returnInfo);
 
+/// @brief Sets how a DataBlobSource that replays a recording paces its blobs.
+/// @param [in] stream DataBlobSource created with a name starting with "/hrgls/replay/".
+/// @param [in] pacing One of the hrgls_REPLAY_* values.  Its default value is
+///        hrgls_REPLAY_RECORDED_RATE.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the stream is not
+///         a replay or the pacing is not valid, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceSetReplayPacing(hrgls_DataBlobSource stream,
+  hrgls_ReplayPacing pacing);
+
+/// @brief Moves a DataBlobSource that replays a recording to a new place in it.
+///
+/// The next blob delivered is the first one recorded at or after the time, found with
+/// the recording's index rather than by reading through it.  Blobs that are already
+/// queued are still delivered.  When the end of the recording is reached the source
+/// stops producing until it is moved again.
+/// @param [in] stream DataBlobSource created with a name starting with "/hrgls/replay/".
+/// @param [in] time Time of the blob to move to; {0,0} rewinds to the start.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the stream is not
+///         a replay, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceSeekReplay(hrgls_DataBlobSource stream,
+  struct timeval time);
+
+//----------------------------------------------------------------------------------------
+/// @brief Opaque pointer to a C structure that holds many hrgls_DataBlobSources made at once.
+///
+/// Bringing up many sources one at a time takes several calls for each of them.  A group
+/// creates them all with the same stream properties in one call, spreading the work across
+/// the processor's cores, and turns streaming on or off for all of them in one call.  The
+/// sources in a group are used like any others, except that they are destroyed along with
+/// the group rather than one at a time.
+typedef struct hrgls_DataBlobSourceGroup_ *hrgls_DataBlobSourceGroup;
+
+/// @brief Create a DataBlobSource for each of a list of names.
+///
+/// hrgls_DataBlobSourceGroupDestroy() should be called when the application is finished
+/// with the group to avoid leaking resources.
+/// @param [out] returnGroup Pointer to location to store the result, not changed on error.
+/// @param [in] params Parameters for every source in the group, as for
+///        hrgls_DataBlobSourceCreate(); their name is not used.
+/// @param [in] names Names of the sources to create, as for
+///        hrgls_DataBlobSourceCreateParametersSetName(), or NULL to create the first count
+///        sources listed by hrgls_APIGetAvailableDataBlobSourceCount().
+/// @param [in] count Number of sources to create, which must not be 0 when names is given.
+///        When names is NULL, 0 creates one for each of the listed sources.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure, which is the
+///         error from the first source that could not be created (none are then kept).
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGroupCreate(hrgls_DataBlobSourceGroup *returnGroup,
+  hrgls_DataBlobSourceCreateParams params, const char * const *names, uint32_t count);
+
+/// @brief Destroy a group and all of its DataBlobSources.
+/// @param [in] group Group created by calling hrgls_DataBlobSourceGroupCreate().
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGroupDestroy(hrgls_DataBlobSourceGroup group);
+
+/// @brief Read how many DataBlobSources a group has.
+/// @param [in] group Group created by calling hrgls_DataBlobSourceGroupCreate().
+/// @param [out] returnCount Location to store the count.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGroupGetCount(hrgls_DataBlobSourceGroup group,
+  uint32_t *returnCount);
+
+/// @brief Get one of the DataBlobSources in a group, in the order of their names.
+///
+/// The source belongs to the group: it is valid until the group is destroyed and must not
+/// be passed to hrgls_DataBlobSourceDestroy(), which returns hrgls_STATUS_BAD_PARAMETER.
+/// @param [in] group Group created by calling hrgls_DataBlobSourceGroupCreate().
+/// @param [in] which Index of the source, less than the group's count.
+/// @param [out] returnStream Location to store the source.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGroupGetSource(hrgls_DataBlobSourceGroup group,
+  uint32_t which, hrgls_DataBlobSource *returnStream);
+
+/// @brief Set the streaming state of every DataBlobSource in a group.
+/// @param [in] group Group created by calling hrgls_DataBlobSourceGroupCreate().
+/// @param [in] running Set to true to begin streaming, false to stop.
+/// @return hrgls_STATUS_OKAY on success, or the error from the first source that failed;
+///         the others are still set.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobSourceGroupSetStreamingState(
+  hrgls_DataBlobSourceGroup group, bool running);
+
+//----------------------------------------------------------------------------------------
+/// @brief Opaque pointer to a C structure that waits for blobs from many hrgls_DataBlobSources.
+///
+/// Lets one thread service any number of hrgls_DataBlobSources on the same hrgls_API, rather
+/// than needing a thread per source or a loop that polls each of them.
+/// hrgls_DataBlobMultiplexerGetNextBlob() sleeps until any registered source has a blob
+/// queued and then takes turns among the sources that are ready, so a busy source cannot
+/// starve the others.  Blobs are taken from the same queue as hrgls_DataBlobSourceGetNextBlob(),
+/// so sources that have a stream callback set are never ready.
+typedef struct hrgls_DataBlobMultiplexer_ *hrgls_DataBlobMultiplexer;
+
+/// @brief Create a multiplexer with no sources.
+///
+/// Call hrgls_DataBlobMultiplexerDestroy() when done with it.
+/// @param [out] returnMultiplexer Pointer to the multiplexer to be constructed.
+/// @param [in] api hrgls_API that the sources to be added live inside.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMultiplexerCreate(
+  hrgls_DataBlobMultiplexer *returnMultiplexer, hrgls_API api);
+
+/// @brief Destroy a multiplexer, removing it from all of its sources.
+///
+/// Must not be called while another thread is destroying one of the sources.
+/// @param [in] multiplexer Multiplexer to be destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMultiplexerDestroy(hrgls_DataBlobMultiplexer multiplexer);
+
+/// @brief Register a source to be waited on.
+///
+/// A source that is destroyed is removed automatically.
+/// @param [in] multiplexer Multiplexer to add to.
+/// @param [in] stream Source created on the same hrgls_API as the multiplexer.
+/// @param [in] sourceId Value returned by hrgls_DataBlobMultiplexerGetNextBlob() along
+///        with blobs from this source.  Chosen by the caller; it need not be unique.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+///        already registered or is on a different hrgls_API, specific error code on
+///        other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMultiplexerAddSource(hrgls_DataBlobMultiplexer multiplexer,
+  hrgls_DataBlobSource stream, uint32_t sourceId);
+
+/// @brief Stop waiting on a source.
+/// @param [in] multiplexer Multiplexer to remove from.
+/// @param [in] stream Source that was registered by hrgls_DataBlobMultiplexerAddSource().
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+///        not registered, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMultiplexerRemoveSource(hrgls_DataBlobMultiplexer multiplexer,
+  hrgls_DataBlobSource stream);
+
+/// @brief Get the next available blob from any of the registered sources.
+/// @param [in] multiplexer Multiplexer to read from.
+/// @param [out] blob Pointer to the blob that has been received.  Note: The receiver
+///        must destroy the blob by calling hrgls_DataBlobDestroy() when it is
+///        done with it, even when no blob was available.
+/// @param [out] sourceId Set to the ID that the blob's source was registered with.
+///        Unchanged if no blob is available.  May be NULL.
+/// @param [in] timeout How long to wait for a blob.  {0,0} returns immediately
+///        if no blob is available.  The calling thread sleeps while waiting.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.  Returns
+///        hrgls_STATUS_TIMEOUT and an empty blob if no blob is available.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMultiplexerGetNextBlob(hrgls_DataBlobMultiplexer multiplexer,
+  hrgls_DataBlob *blob, uint32_t *sourceId, struct timeval timeout);
+
+//----------------------------------------------------------------------------------------
+/// @brief Data type enumeration for what an hrgls_DataBlobMerger does with a blob that is
+/// older than one it has already returned.
+typedef int32_t hrgls_LateBlobPolicy;
+/// @brief Discard the late blob, so that blobs are always returned in time order.
+#define hrgls_LATE_BLOB_DROP (0)
+/// @brief Return the late blob as soon as it arrives, out of order.
+#define hrgls_LATE_BLOB_DELIVER (1)
+
+/// @brief Opaque pointer to a C structure that merges blobs from many hrgls_DataBlobSources
+/// into a single stream in the order of their hrgls_DataBlobGetTime().
+///
+/// Works like an hrgls_DataBlobMultiplexer, except that blobs are held until they can be
+/// returned in time order.  Each source is expected to produce its blobs in time order; a
+/// heap of the oldest blob from each source picks the next one.  That blob is returned as
+/// soon as every registered source has a blob waiting, or once the system time is past its
+/// time by the reorder window, so a quiet source holds the others back by no more than
+/// the window.  A blob that arrives older than one already returned is late, and is
+/// handled by the hrgls_LateBlobPolicy.
+typedef struct hrgls_DataBlobMerger_ *hrgls_DataBlobMerger;
+
+/// @brief Create a merger with no sources.
+///
+/// Call hrgls_DataBlobMergerDestroy() when done with it.
+/// @param [out] returnMerger Pointer to the merger to be constructed.
+/// @param [in] api hrgls_API that the sources to be added live inside.
+/// @param [in] reorderWindow Longest time to hold a blob waiting for older ones from
+///        quiet sources.  Must not be negative.
+/// @param [in] latePolicy One of the hrgls_LATE_BLOB_* values.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the window or
+///        policy is not valid, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerCreate(hrgls_DataBlobMerger *returnMerger,
+  hrgls_API api, struct timeval reorderWindow, hrgls_LateBlobPolicy latePolicy);
+
+/// @brief Destroy a merger, removing it from all of its sources.
+///
+/// Blobs that it is holding are released.  Must not be called while another thread
+/// is destroying one of the sources.
+/// @param [in] merger Merger to be destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerDestroy(hrgls_DataBlobMerger merger);
+
+/// @brief Register a source to be merged.
+///
+/// A source that is destroyed is removed automatically once the blobs held from it have
+/// been returned.
+/// @param [in] merger Merger to add to.
+/// @param [in] stream Source created on the same hrgls_API as the merger.
+/// @param [in] sourceId Value returned by hrgls_DataBlobMergerGetNextBlob() along
+///        with blobs from this source.  Chosen by the caller; it need not be unique.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+///        already registered or is on a different hrgls_API, specific error code on
+///        other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerAddSource(hrgls_DataBlobMerger merger,
+  hrgls_DataBlobSource stream, uint32_t sourceId);
+
+/// @brief Stop merging a source, discarding any blobs held from it.
+/// @param [in] merger Merger to remove from.
+/// @param [in] stream Source that was registered by hrgls_DataBlobMergerAddSource().
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+///        not registered, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerRemoveSource(hrgls_DataBlobMerger merger,
+  hrgls_DataBlobSource stream);
+
+/// @brief Get the next blob in time order from any of the registered sources.
+/// @param [in] merger Merger to read from.
+/// @param [out] blob Pointer to the blob that has been received.  Note: The receiver
+///        must destroy the blob by calling hrgls_DataBlobDestroy() when it is
+///        done with it, even when no blob was available.
+/// @param [out] sourceId Set to the ID that the blob's source was registered with.
+///        Unchanged if no blob is available.  May be NULL.
+/// @param [in] timeout How long to wait for a blob.  {0,0} returns immediately
+///        if no blob is ready.  The calling thread sleeps while waiting.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.  Returns
+///        hrgls_STATUS_TIMEOUT and an empty blob if no blob is ready.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerGetNextBlob(hrgls_DataBlobMerger merger,
+  hrgls_DataBlob *blob, uint32_t *sourceId, struct timeval timeout);
+
+/// @brief Read how many late blobs the merger has seen, whether dropped or delivered.
+/// @param [in] merger Merger created by calling hrgls_DataBlobMergerCreate().
+/// @param [out] count Pointer to the location to store the result.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobMergerGetLateBlobCount(hrgls_DataBlobMerger merger,
+  uint64_t *count);
+
+//----------------------------------------------------------------------------------------
+/// @brief Opaque pointer to a C structure that writes blobs to a recording.
+///
+/// Blobs from any source are appended with their times and data, and an index of them is
+/// kept in a file alongside it (the file name followed by ".idx") so that replay can seek
+/// by time.  A recording is replayed by creating an hrgls_DataBlobSource named
+/// "/hrgls/replay/" followed by its file name.
+typedef struct hrgls_DataBlobRecorder_ *hrgls_DataBlobRecorder;
+
+/// @brief Create a recorder, replacing any file with the same name.
+///
+/// Call hrgls_DataBlobRecorderDestroy() when done with it.
+/// @param [out] returnRecorder Pointer to the recorder to be constructed.
+/// @param [in] fileName Name of the recording to write.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if the file could not
+///         be created, specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRecorderCreate(
+  hrgls_DataBlobRecorder *returnRecorder, const char *fileName);
+
+/// @brief Destroy a recorder, finishing its recording.
+/// @param [in] recorder Recorder to be destroyed.
+/// @return hrgls_STATUS_OKAY on success, specific error code on failure.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRecorderDestroy(hrgls_DataBlobRecorder recorder);
+
+/// @brief Append a blob to the recording.
+///
+/// May be called from several threads at once, including from stream callback handlers.
+/// @param [in] recorder Recorder to write to.
+/// @param [in] blob Blob to record; it is not changed.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if writing failed,
+///         specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRecorderRecord(hrgls_DataBlobRecorder recorder,
+  hrgls_DataBlob blob);
+
+/// @brief Write out everything that has been recorded so far, so that it can be replayed.
+/// @param [in] recorder Recorder to flush.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if writing failed,
+///         specific error code on other failures.
+HRGLS_EXPORT hrgls_Status hrgls_DataBlobRecorderFlush(hrgls_DataBlobRecorder recorder);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,16 +25,24 @@
 * both for the client applications and for the developer (who implements the classes
 * and methods found herein).  For understanding the API, you should look at the
 * hrgls_api_defs.hpp file.
+*
+* A client that is statically linked with a single implementation (the hrgls_direct
+* library, see the BUILD_DIRECT_IMPLEMENTATION option) is built with
+* HRGLS_DIRECT_IMPLEMENTATION defined.  It then calls that implementation's
+* definitions of the classes directly rather than going through the C layer, and
+* the DataBlob accessors are inline.  Such a client cannot load another
+* implementation by name.
 * @author Russell Taylor.
 * @date January 18, 2020.
 */
 
 #include "hrgls_api_defs.hpp"
 #include "hrgls_DataBlob_impl.hpp"
+#ifndef HRGLS_DIRECT_IMPLEMENTATION
 #include "hrgls_Message_impl.hpp"
+#include "hrgls_PerThread_impl.hpp"
 #include <chrono>
 #include <functional>
-#include <map>
 #include <thread>
 #include <mutex>
 
@@ -46,7 +54,7 @@ namespace hrgls {
     std::shared_ptr<hrgls_StreamProperties_> m_state;
     // Keep a per-thread status to make it so that a single thread only gets
     // results from methods that it calls.
-    std::map<std::thread::id, hrgls_Status> m_status;
+    PerThread<hrgls_Status> m_status;
   };
 
   StreamProperties::StreamProperties()
@@ -54,7 +62,7 @@ namespace hrgls {
     // Create our private data object
     m_private.reset(new StreamProperties_private);
     hrgls_StreamProperties ptr;
-    m_private->m_status[std::this_thread::get_id()] = hrgls_StreamPropertiesCreate(&ptr);
+    m_private->m_status.Get() = hrgls_StreamPropertiesCreate(&ptr);
     m_private->m_state.reset(ptr,
       [](hrgls_StreamProperties_ *obj) {hrgls_StreamPropertiesDestroy(obj); }
       );
@@ -63,12 +71,30 @@ namespace hrgls {
   StreamProperties::StreamProperties(const StreamProperties& copy)
   {
     m_private.reset(new StreamProperties_private());
-    *m_private = *copy.m_private;
+    if (copy.m_private) {
+      *m_private = *copy.m_private;
+    }
   }
 
   StreamProperties &StreamProperties::operator = (const StreamProperties &copy)
   {
-    *m_private = *copy.m_private;
+    if (!m_private) {
+      m_private.reset(new StreamProperties_private());
+    }
+    if (copy.m_private) {
+      *m_private = *copy.m_private;
+    }
+    return *this;
+  }
+
+  StreamProperties::StreamProperties(StreamProperties&& other) noexcept
+    : m_private(std::move(other.m_private))
+  {
+  }
+
+  StreamProperties &StreamProperties::operator = (StreamProperties &&other) noexcept
+  {
+    m_private = std::move(other.m_private);
     return *this;
   }
 
@@ -97,16 +123,17 @@ namespace hrgls {
     if (!m_private) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    hrgls_Status ret = m_private->m_status[std::this_thread::get_id()];
-    m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+    hrgls_Status &status = m_private->m_status.Get();
+    hrgls_Status ret = status;
+    status = hrgls_STATUS_OKAY;
     return ret;
   }
 
   double StreamProperties::Rate()
   {
-    double ret;
+    double ret = 0;
     if (m_private) {
-      m_private->m_status[std::this_thread::get_id()] = hrgls_StreamPropertiesGetRate(m_private->m_state.get(), &ret);
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetRate(m_private->m_state.get(), &ret);
     }
 
     return ret;
@@ -120,6 +147,136 @@ namespace hrgls {
     return hrgls_StreamPropertiesSetRate(m_private->m_state.get(), val);
   }
 
+  uint32_t StreamProperties::QueueCapacity()
+  {
+    uint32_t ret = 0;
+    if (m_private) {
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetQueueCapacity(m_private->m_state.get(), &ret);
+    }
+    return ret;
+  }
+
+  hrgls_Status StreamProperties::QueueCapacity(uint32_t val)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_StreamPropertiesSetQueueCapacity(m_private->m_state.get(), val);
+  }
+
+  hrgls_OverflowPolicy StreamProperties::OverflowPolicy()
+  {
+    hrgls_OverflowPolicy ret = hrgls_OVERFLOW_DROP_OLDEST;
+    if (m_private) {
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetOverflowPolicy(m_private->m_state.get(), &ret);
+    }
+    return ret;
+  }
+
+  hrgls_Status StreamProperties::OverflowPolicy(hrgls_OverflowPolicy val)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_StreamPropertiesSetOverflowPolicy(m_private->m_state.get(), val);
+  }
+
+  uint32_t StreamProperties::PayloadSize()
+  {
+    uint32_t ret = 0;
+    if (m_private) {
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetPayloadSize(m_private->m_state.get(), &ret);
+    }
+    return ret;
+  }
+
+  hrgls_Status StreamProperties::PayloadSize(uint32_t val)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_StreamPropertiesSetPayloadSize(m_private->m_state.get(), val);
+  }
+
+  hrgls_PayloadDistribution StreamProperties::PayloadDistribution()
+  {
+    hrgls_PayloadDistribution ret = hrgls_PAYLOAD_FIXED;
+    if (m_private) {
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetPayloadDistribution(m_private->m_state.get(), &ret);
+    }
+    return ret;
+  }
+
+  hrgls_Status StreamProperties::PayloadDistribution(hrgls_PayloadDistribution val)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_StreamPropertiesSetPayloadDistribution(m_private->m_state.get(), val);
+  }
+
+  uint32_t StreamProperties::BurstLength()
+  {
+    uint32_t ret = 0;
+    if (m_private) {
+      m_private->m_status.Get() = hrgls_StreamPropertiesGetBurstLength(m_private->m_state.get(), &ret);
+    }
+    return ret;
+  }
+
+  hrgls_Status StreamProperties::BurstLength(uint32_t val)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_StreamPropertiesSetBurstLength(m_private->m_state.get(), val);
+  }
+
+  //-----------------------------------------------------------------------
+  /// Fill in a StreamStatistics by having a C function fill in a statistics object
+  /// and reading its values.
+  /// @param [in] get Called with the object to be filled in.
+  template <class Getter>
+  static hrgls_Status ReadStreamStatistics(StreamStatistics &ret, Getter get)
+  {
+    hrgls_StreamStatistics stats;
+    hrgls_Status s = hrgls_StreamStatisticsCreate(&stats);
+    if (s != hrgls_STATUS_OKAY) {
+      return s;
+    }
+    uint64_t val;
+    std::vector<uint64_t> histogram(hrgls_STATISTICS_HISTOGRAM_BINS);
+    if (hrgls_STATUS_OKAY == (s = get(stats))) {
+      hrgls_StreamStatisticsGetProduced(stats, &val);
+      ret.Produced(val);
+      hrgls_StreamStatisticsGetDelivered(stats, &val);
+      ret.Delivered(val);
+      hrgls_StreamStatisticsGetDropped(stats, &val);
+      ret.Dropped(val);
+      hrgls_StreamStatisticsGetQueueDepth(stats, &val);
+      ret.QueueDepth(val);
+      hrgls_StreamStatisticsGetMaxQueueDepth(stats, &val);
+      ret.MaxQueueDepth(val);
+      hrgls_StreamStatisticsGetLatencyTotal(stats, &val);
+      ret.LatencyTotal(val);
+      hrgls_StreamStatisticsGetLatencyMax(stats, &val);
+      ret.LatencyMax(val);
+      hrgls_StreamStatisticsGetLatencyHistogram(stats, histogram.data(),
+        hrgls_STATISTICS_HISTOGRAM_BINS);
+      ret.LatencyHistogram(histogram);
+      hrgls_StreamStatisticsGetCallbacks(stats, &val);
+      ret.Callbacks(val);
+      hrgls_StreamStatisticsGetCallbackDurationTotal(stats, &val);
+      ret.CallbackDurationTotal(val);
+      hrgls_StreamStatisticsGetCallbackDurationMax(stats, &val);
+      ret.CallbackDurationMax(val);
+      hrgls_StreamStatisticsGetCallbackDurationHistogram(stats, histogram.data(),
+        hrgls_STATISTICS_HISTOGRAM_BINS);
+      ret.CallbackDurationHistogram(histogram);
+    }
+    hrgls_StreamStatisticsDestroy(stats);
+    return s;
+  }
 
   //-----------------------------------------------------------------------
   class API::API_private {
@@ -127,18 +284,25 @@ namespace hrgls {
     hrgls_API m_api = nullptr;
     // Keep a per-thread status to make it so that a single thread only gets
     // results from methods that it calls.
-    std::map<std::thread::id, hrgls_Status> m_status;
+    PerThread<hrgls_Status> m_status;
 
     // Information needed by our C callback handler to reformat the data
     // and call the C++ handler.
     LogMessageCallback m_cppHandler = nullptr;
+    LogMessageViewCallback m_cppViewHandler = nullptr;
     void *m_cppUserData = nullptr;
     std::mutex m_cppMutex;
   };
 
   API::API(
     ::std::string user,
-    ::std::vector<uint8_t> credentials)
+    ::std::vector<uint8_t> credentials,
+    uint32_t callbackThreads,
+    ::std::string endpoint,
+    ::std::string implementation,
+    uint32_t sourceCount,
+    double messageRate,
+    hrgls_MessageLevel messageLevel)
   {
     // Create the private api pointer we're going to use.  Check for
     // exception when creating it, to avoid passing it up to the caller.
@@ -149,32 +313,41 @@ namespace hrgls {
       return;
     }
 
-    // Create and fill in the parameters to the API creation routine
+    // Create and fill in the parameters to the API creation routine.  Once the
+    // parameter object exists, every path goes through the destroy call at the end.
     hrgls_APICreateParams params;
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APICreateParametersCreate(&params);
-    if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
-      return;
-    }
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APICreateParametersSetName(params, user.c_str());
-    if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+    hrgls_Status &s = m_private->m_status.Get();
+    s = hrgls_APICreateParametersCreate(&params);
+    if (s != hrgls_STATUS_OKAY) {
       return;
     }
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APICreateParametersSetCredentials(params,
-      credentials.data(), static_cast<uint32_t>(credentials.size()));
-    if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
-      return;
+    if (hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetName(params, user.c_str())) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetCredentials(params,
+          credentials.data(), static_cast<uint32_t>(credentials.size()))) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetCallbackThreads(params,
+          callbackThreads)) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetEndpoint(params,
+          endpoint.c_str())) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetImplementation(params,
+          implementation.c_str())) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetSourceCount(params,
+          sourceCount)) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetMessageRate(params,
+          messageRate)) &&
+        hrgls_STATUS_OKAY == (s = hrgls_APICreateParametersSetMessageLevel(params,
+          messageLevel))) {
+      // Create the API object we're going to use.
+      s = hrgls_APICreate(&m_private->m_api, params);
+      if (s != hrgls_STATUS_OKAY) {
+        m_private->m_api = nullptr;
+      }
     }
 
-    // Create the API object we're going to use.
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APICreate(&m_private->m_api, params);
-    if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
-      hrgls_APICreateParametersDestroy(params);
-      m_private->m_api = nullptr;
-      return;
+    // Destroy the parameter object we created above, keeping the first error.
+    hrgls_Status d = hrgls_APICreateParametersDestroy(params);
+    if (s == hrgls_STATUS_OKAY) {
+      s = d;
     }
-
-    // Destroy the parameter object we created above.
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APICreateParametersDestroy(params);
   }
 
   API::~API()
@@ -191,8 +364,9 @@ namespace hrgls {
     if (!m_private) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    hrgls_Status ret = m_private->m_status[std::this_thread::get_id()];
-    m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+    hrgls_Status &status = m_private->m_status.Get();
+    hrgls_Status ret = status;
+    status = hrgls_STATUS_OKAY;
     return ret;
   }
 
@@ -206,15 +380,16 @@ namespace hrgls {
     // Find out how many DataBlobSources are in the system, which will also latch the data.
     uint32_t count;
     if (hrgls_STATUS_OKAY !=
-      (m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetAvailableDataBlobSourceCount(m_private->m_api, &count))) {
+      (m_private->m_status.Get() = hrgls_APIGetAvailableDataBlobSourceCount(m_private->m_api, &count))) {
       return ret;
     }
 
     // Read each DataBlobSource's information and fill it into information to be returned.
+    ret.reserve(count);
     for (uint32_t i = 0; i < count; i++) {
       hrgls_APIDataBlobSourceInfo info;
       if (hrgls_STATUS_OKAY !=
-        (m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetAvailableDataBlobSourceInfo(m_private->m_api,
+        (m_private->m_status.Get() = hrgls_APIGetAvailableDataBlobSourceInfo(m_private->m_api,
           i, &info))) {
         ret.clear();
         return ret;
@@ -223,7 +398,7 @@ namespace hrgls {
       // Get and fill in the name.
       const char *name;
       if (hrgls_STATUS_OKAY !=
-        (m_private->m_status[std::this_thread::get_id()] = hrgls_APIDataBlobSourceGetName(info, &name))) {
+        (m_private->m_status.Get() = hrgls_APIDataBlobSourceGetName(info, &name))) {
         ret.clear();
         return ret;
       }
@@ -237,6 +412,30 @@ namespace hrgls {
     return ret;
   }
 
+  uint64_t API::GetDataBlobSourceGeneration() const
+  {
+    uint64_t ret = 0;
+    if (!m_private) {
+      return ret;
+    }
+    m_private->m_status.Get() = hrgls_APIGetDataBlobSourceGeneration(m_private->m_api, &ret);
+    return ret;
+  }
+
+  bool API::DataBlobSourcesChangedSince(uint64_t generation) const
+  {
+    return generation == 0 || GetDataBlobSourceGeneration() != generation;
+  }
+
+  hrgls_Status API::SetDataBlobSourcesChangedCallback(DataBlobSourcesChangedCallback callback,
+    void *userData)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_APISetDataBlobSourcesChangedCallback(m_private->m_api, callback, userData);
+  }
+
   hrgls_VERSION API::GetVersion() const
   {
     hrgls_VERSION ret = { 0, 0, 0 };
@@ -244,7 +443,7 @@ namespace hrgls {
       return ret;
     }
 
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetVersion(m_private->m_api, &ret);
+    m_private->m_status.Get() = hrgls_APIGetVersion(m_private->m_api, &ret);
     return ret;
   }
 
@@ -255,7 +454,7 @@ namespace hrgls {
       return ret;
     }
 
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetCurrentSystemTime(m_private->m_api, &ret);
+    m_private->m_status.Get() = hrgls_APIGetCurrentSystemTime(m_private->m_api, &ret);
     return ret;
   }
 
@@ -266,7 +465,7 @@ namespace hrgls {
       return ret;
     }
 
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetVerbosity(m_private->m_api, &ret);
+    m_private->m_status.Get() = hrgls_APIGetVerbosity(m_private->m_api, &ret);
     return ret;
   }
 
@@ -300,16 +499,15 @@ namespace hrgls {
 
     // Reformat the data into a C++ structure.
     // Call the callback handler with the data.
-    if (info->m_cppHandler) {
-      Message m(message);
+    // In the C API, we always have to destroy the message that is handed
+    // to us.  When there is a handler, the Message takes ownership of it
+    // rather than copying it and destroys it when it goes out of scope.
+    if (cb) {
+      Message m = Message::Adopt(message);
       cb(m, ud);
+    } else {
+      hrgls_MessageDestroy(message);
     }
-
-    // In the C API, we always have to destroy the blob that is handed
-    // to us, so we do so here.  The DataBlob above will have created
-    // a copy and destroyed that copy, but here we destroy the one that
-    // was passed to us.
-    hrgls_MessageDestroy(message);
   }
 
   hrgls_Status API::SetLogMessageCallback(LogMessageCallback callback,
@@ -324,18 +522,60 @@ namespace hrgls {
     std::lock_guard<std::mutex> lock(m_private->m_cppMutex);
 
     m_private->m_cppHandler = callback;
+    m_private->m_cppViewHandler = nullptr;
     m_private->m_cppUserData = userData;
 
     // If we are supposed to be calling a callback handler, then set our callback handler
     // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
     if (callback) {
-      m_private->m_status[std::this_thread::get_id()] = hrgls_APISetLogMessageCallback(m_private->m_api,
+      m_private->m_status.Get() = hrgls_APISetLogMessageCallback(m_private->m_api,
         LogMessageCallbackHandler, m_private);
     } else {
-      m_private->m_status[std::this_thread::get_id()] = hrgls_APISetLogMessageCallback(m_private->m_api,
+      m_private->m_status.Get() = hrgls_APISetLogMessageCallback(m_private->m_api,
+        nullptr, nullptr);
+    }
+    return m_private->m_status.Get();
+  }
+
+  // Wraps the borrowed C view in a C++ one, without copying the message, and calls
+  // the handler that we have been asked to use.
+  static void LogMessageViewCallbackHandler(const hrgls_MessageView *message, void *userData)
+  {
+    API::API_private *info =
+      static_cast<API::API_private*>(userData);
+
+    API::LogMessageViewCallback cb;
+    void *ud;
+    {
+      std::lock_guard<std::mutex> lock(info->m_cppMutex);
+      cb = info->m_cppViewHandler;
+      ud = info->m_cppUserData;
+    }
+    if (cb && message) {
+      cb(MessageView(*message), ud);
+    }
+  }
+
+  hrgls_Status API::SetLogMessageViewCallback(LogMessageViewCallback callback,
+    void *userData)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+
+    std::lock_guard<std::mutex> lock(m_private->m_cppMutex);
+
+    m_private->m_cppHandler = nullptr;
+    m_private->m_cppViewHandler = callback;
+    m_private->m_cppUserData = userData;
+    if (callback) {
+      m_private->m_status.Get() = hrgls_APISetLogMessageViewCallback(m_private->m_api,
+        LogMessageViewCallbackHandler, m_private);
+    } else {
+      m_private->m_status.Get() = hrgls_APISetLogMessageViewCallback(m_private->m_api,
         nullptr, nullptr);
     }
-    return m_private->m_status[std::this_thread::get_id()];
+    return m_private->m_status.Get();
   }
 
   hrgls_Status API::SetLogMessageStreamingState(bool running)
@@ -343,9 +583,51 @@ namespace hrgls {
     if (!m_private) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APISetLogMessageStreamingState(m_private->m_api,
+    m_private->m_status.Get() = hrgls_APISetLogMessageStreamingState(m_private->m_api,
       running);
-    return m_private->m_status[std::this_thread::get_id()];
+    return m_private->m_status.Get();
+  }
+
+  uint64_t API::GetDroppedLogMessageCount()
+  {
+    uint64_t ret = 0;
+    if (!m_private) {
+      return ret;
+    }
+    m_private->m_status.Get() = hrgls_APIGetDroppedLogMessageCount(m_private->m_api, &ret);
+    return ret;
+  }
+
+  StreamStatistics API::GetLogMessageStatistics()
+  {
+    StreamStatistics ret;
+    if (!m_private) {
+      return ret;
+    }
+    hrgls_API api = m_private->m_api;
+    m_private->m_status.Get() = ReadStreamStatistics(ret,
+      [api](hrgls_StreamStatistics stats) { return hrgls_APIGetLogMessageStatistics(api, stats); });
+    return ret;
+  }
+
+  hrgls_BufferPool API::GetBufferPool()
+  {
+    hrgls_BufferPool ret = nullptr;
+    if (!m_private) {
+      return ret;
+    }
+    m_private->m_status.Get() = hrgls_APIGetBufferPool(m_private->m_api, &ret);
+    return ret;
+  }
+
+  uint16_t API::StartServer(const ::std::string &endpoint)
+  {
+    uint16_t ret = 0;
+    if (!m_private) {
+      return ret;
+    }
+    m_private->m_status.Get() = hrgls_APIStartServer(m_private->m_api, endpoint.c_str(), &ret);
+    return ret;
   }
 
   std::vector<Message> API::GetPendingLogMessages(size_t maxNum)
@@ -356,23 +638,22 @@ namespace hrgls {
     }
 
     // Keep getting messages until we either have enough or get a status other
-    // than OKAY.  Push each onto the vector, then destroy it.
-    m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+    // than OKAY.  Move each onto the vector, which takes ownership of it.
+    m_private->m_status.Get() = hrgls_STATUS_OKAY;
     while ((ret.size() < maxNum) || (maxNum == 0)) {
       hrgls_Message m = nullptr;
-      m_private->m_status[std::this_thread::get_id()] = hrgls_APIGetNextLogMessage(m_private->m_api, &m);
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      m_private->m_status.Get() = hrgls_APIGetNextLogMessage(m_private->m_api, &m);
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         hrgls_MessageDestroy(m);
-        if ((m_private->m_status[std::this_thread::get_id()] == hrgls_STATUS_TIMEOUT) &&
+        if ((m_private->m_status.Get() == hrgls_STATUS_TIMEOUT) &&
             (ret.size() > 0)) {
           // We got at least one message before timing out, so things are
           // okay.
-          m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+          m_private->m_status.Get() = hrgls_STATUS_OKAY;
         }
         return ret;
       }
-      ret.push_back(m);
-      hrgls_MessageDestroy(m);
+      ret.push_back(Message::Adopt(m));
     }
 
     return ret;
@@ -383,9 +664,17 @@ namespace hrgls {
     if (!m_private) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    m_private->m_status[std::this_thread::get_id()] = hrgls_APISetLogMessageMinimumLevel(m_private->m_api,
+    m_private->m_status.Get() = hrgls_APISetLogMessageMinimumLevel(m_private->m_api,
       level);
-    return m_private->m_status[std::this_thread::get_id()];
+    return m_private->m_status.Get();
+  }
+
+  hrgls_Status API::AddReplayFile(const ::std::string &fileName)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    return hrgls_APIAddReplayFile(m_private->m_api, fileName.c_str());
   }
 
   hrgls_API API::GetRawAPI() const
@@ -398,19 +687,111 @@ namespace hrgls {
 
   namespace datablob {
 
+    //-----------------------------------------------------------------------
+    class DataBlobRequest::DataBlobRequest_private {
+    public:
+      hrgls_DataBlobRequest m_request = nullptr;
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> m_status;
+    };
+
+    DataBlobRequest::DataBlobRequest()
+    {
+      try {
+        m_private = new DataBlobRequest_private();
+      } catch (...) {
+        m_private = nullptr;
+      }
+    }
+
+    DataBlobRequest::~DataBlobRequest()
+    {
+      if (m_private && m_private->m_request) {
+        hrgls_DataBlobRequestDestroy(m_private->m_request);
+      }
+      delete m_private;
+    }
+
+    DataBlobRequest::DataBlobRequest(DataBlobRequest &&other) noexcept
+    {
+      m_private = other.m_private;
+      other.m_private = nullptr;
+    }
+
+    DataBlobRequest &DataBlobRequest::operator=(DataBlobRequest &&other) noexcept
+    {
+      if (this != &other) {
+        if (m_private && m_private->m_request) {
+          hrgls_DataBlobRequestDestroy(m_private->m_request);
+        }
+        delete m_private;
+        m_private = other.m_private;
+        other.m_private = nullptr;
+      }
+      return *this;
+    }
+
+    hrgls_Status DataBlobRequest::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    bool DataBlobRequest::IsReady()
+    {
+      bool ret = false;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_request) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobRequestIsReady(m_private->m_request, &ret);
+      return ret;
+    }
+
+    DataBlob DataBlobRequest::Wait(struct timeval timeout)
+    {
+      DataBlob emptyRet;
+      if (!m_private) {
+        return emptyRet;
+      }
+      if (!m_private->m_request) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return emptyRet;
+      }
+      hrgls_DataBlob blob = nullptr;
+      m_private->m_status.Get() = hrgls_DataBlobRequestWait(m_private->m_request, &blob, timeout);
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
+        hrgls_DataBlobDestroy(blob);
+        return emptyRet;
+      }
+      return DataBlob::Adopt(blob);
+    }
+
     //-----------------------------------------------------------------------
     class DataBlobSource::DataBlobSource_private {
     public:
       hrgls_DataBlobSource m_stream = nullptr;
       // Keep a per-thread status to make it so that a single thread only gets
       // results from methods that it calls.
-      std::map<std::thread::id, hrgls_Status> m_status;
+      PerThread<hrgls_Status> m_status;
 
       // Information needed by our C callback handler to reformat the data
       // and call the C++ handler.
       StreamCallback m_cppHandler = nullptr;
       void *m_cppUserData = nullptr;
       std::mutex m_cppMutex;
+
+      // Set for the sources of a DataBlobSourceGroup, whose handles it destroys.
+      bool m_borrowed = false;
     };
 
     DataBlobSource::DataBlobSource(
@@ -429,29 +810,29 @@ namespace hrgls {
 
       // Create and fill in the parameters to the stream creation routine
       hrgls_DataBlobSourceCreateParams params;
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceCreateParametersCreate(&params);
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      m_private->m_status.Get() = hrgls_DataBlobSourceCreateParametersCreate(&params);
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         return;
       }
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceCreateParametersSetAPI(params, api.GetRawAPI());
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      m_private->m_status.Get() = hrgls_DataBlobSourceCreateParametersSetAPI(params, api.GetRawAPI());
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         hrgls_DataBlobSourceCreateParametersDestroy(params);
         return;
       }
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceCreateParametersSetStreamProperties(params,
+      m_private->m_status.Get() = hrgls_DataBlobSourceCreateParametersSetStreamProperties(params,
         props.GetRawProperties().get());
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         hrgls_DataBlobSourceCreateParametersDestroy(params);
         return;
       }
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceCreateParametersSetName(params, source.c_str());
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      m_private->m_status.Get() = hrgls_DataBlobSourceCreateParametersSetName(params, source.c_str());
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         hrgls_DataBlobSourceCreateParametersDestroy(params);
         return;
       }
 
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceCreate(&m_private->m_stream, params);
-      if (m_private->m_status[std::this_thread::get_id()] != hrgls_STATUS_OKAY) {
+      m_private->m_status.Get() = hrgls_DataBlobSourceCreate(&m_private->m_stream, params);
+      if (m_private->m_status.Get() != hrgls_STATUS_OKAY) {
         hrgls_DataBlobSourceCreateParametersDestroy(params);
         return;
       }
@@ -463,7 +844,7 @@ namespace hrgls {
     DataBlobSource::~DataBlobSource()
     {
       // Destroy any API object we created.
-      if (m_private && m_private->m_stream) {
+      if (m_private && m_private->m_stream && !m_private->m_borrowed) {
         hrgls_DataBlobSourceDestroy(m_private->m_stream);
       }
       delete m_private;
@@ -474,8 +855,9 @@ namespace hrgls {
       if (!m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      hrgls_Status ret = m_private->m_status[std::this_thread::get_id()];
-      m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
       return ret;
     }
 
@@ -484,9 +866,18 @@ namespace hrgls {
       if (!m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceSetStreamingState(m_private->m_stream,
+      m_private->m_status.Get() = hrgls_DataBlobSourceSetStreamingState(m_private->m_stream,
         running);
-      return m_private->m_status[std::this_thread::get_id()];
+      return m_private->m_status.Get();
+    }
+
+    hrgls_Status DataBlobSource::SetStreamProperties(StreamProperties &props)
+    {
+      if (!m_private || !m_private->m_stream) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobSourceSetStreamProperties(m_private->m_stream,
+        props.GetRawProperties().get());
     }
 
     // Because we are wrapping a C+ callback handler around a C callback handler,
@@ -510,16 +901,15 @@ namespace hrgls {
 
       // Reformat the data into a C++ structure.
       // Call the callback handler with the data.
-      if (info->m_cppHandler) {
-        DataBlob f(blob);
+      // In the C API, we always have to destroy the blob that is handed
+      // to us.  When there is a handler, the DataBlob takes ownership of it
+      // rather than copying it and destroys it when it goes out of scope.
+      if (cb) {
+        DataBlob f = DataBlob::Adopt(blob);
         cb(f, ud);
+      } else {
+        hrgls_DataBlobDestroy(blob);
       }
-
-      // In the C API, we always have to destroy the blob that is handed
-      // to us, so we do so here.  The DataBlob above will have created
-      // a copy and destroyed that copy, but here we destroy the one that
-      // was passed to us.
-      hrgls_DataBlobDestroy(blob);
     }
 
     hrgls_Status DataBlobSource::SetStreamCallback(StreamCallback callback, void *userdata)
@@ -538,13 +928,13 @@ namespace hrgls {
       // If we are supposed to be calling a callback handler, then set our callback handler
       // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
       if (callback) {
-        m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceSetStreamCallback(m_private->m_stream,
+        m_private->m_status.Get() = hrgls_DataBlobSourceSetStreamCallback(m_private->m_stream,
           StreamCallbackHandler, m_private);
       } else {
-        m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceSetStreamCallback(m_private->m_stream,
+        m_private->m_status.Get() = hrgls_DataBlobSourceSetStreamCallback(m_private->m_stream,
           nullptr, nullptr);
       }
-      return m_private->m_status[std::this_thread::get_id()];
+      return m_private->m_status.Get();
     }
 
     DataBlob DataBlobSource::GetNextBlob(struct timeval timeout)
@@ -554,20 +944,155 @@ namespace hrgls {
         return emptyRet;
       }
       if (!m_private->m_stream) {
-        m_private->m_status[std::this_thread::get_id()] = hrgls_STATUS_NULL_OBJECT_POINTER;
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
         return emptyRet;
       }
       hrgls_DataBlob blob = nullptr;
-      m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceGetNextBlob(m_private->m_stream, &blob, timeout);
-      if (m_private->m_status[std::this_thread::get_id()] == hrgls_STATUS_TIMEOUT) {
+      m_private->m_status.Get() = hrgls_DataBlobSourceGetNextBlob(m_private->m_stream, &blob, timeout);
+      if (m_private->m_status.Get() == hrgls_STATUS_TIMEOUT) {
         hrgls_DataBlobDestroy(blob);
         return emptyRet;
       }
-      DataBlob ret(blob);
-      hrgls_DataBlobDestroy(blob);
+      return DataBlob::Adopt(blob);
+    }
+
+    std::vector<DataBlob> DataBlobSource::GetPendingBlobs(size_t maxNum, struct timeval timeout)
+    {
+      std::vector<DataBlob> ret;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_stream) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+
+      // Pull blobs across in chunks, waiting only for the first one.  Keep going
+      // until we either have enough or the source has no more to give us.
+      const uint32_t chunkSize = 64;
+      hrgls_DataBlob blobs[chunkSize];
+      hrgls_Status s = hrgls_STATUS_OKAY;
+      while ((maxNum == 0) || (ret.size() < maxNum)) {
+        uint32_t request = chunkSize;
+        if ((maxNum > 0) && (maxNum - ret.size() < request)) {
+          request = static_cast<uint32_t>(maxNum - ret.size());
+        }
+        uint32_t count = 0;
+        s = hrgls_DataBlobSourceGetPendingBlobs(m_private->m_stream, blobs, request,
+          &count, timeout);
+        for (uint32_t i = 0; i < count; i++) {
+          ret.push_back(DataBlob::Adopt(blobs[i]));
+        }
+        if ((s != hrgls_STATUS_OKAY) || (count < request)) {
+          break;
+        }
+        timeout = {};
+      }
+
+      if ((s == hrgls_STATUS_TIMEOUT) && (ret.size() > 0)) {
+        // We got at least one blob before timing out, so things are okay.
+        s = hrgls_STATUS_OKAY;
+      }
+      m_private->m_status.Get() = s;
       return ret;
     }
 
+    uint64_t DataBlobSource::GetDroppedBlobCount()
+    {
+      uint64_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_stream) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobSourceGetDroppedBlobCount(m_private->m_stream, &ret);
+      return ret;
+    }
+
+    StreamStatistics DataBlobSource::GetStatistics()
+    {
+      StreamStatistics ret;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_stream) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      hrgls_DataBlobSource stream = m_private->m_stream;
+      m_private->m_status.Get() = ReadStreamStatistics(ret,
+        [stream](hrgls_StreamStatistics stats) {
+          return hrgls_DataBlobSourceGetStatistics(stream, stats);
+        });
+      return ret;
+    }
+
+    DataBlobRequest DataBlobSource::GetNextBlobAsync()
+    {
+      DataBlobRequest ret;
+      if (!m_private || !ret.m_private) {
+        return ret;
+      }
+      if (!m_private->m_stream) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobSourceGetNextBlobAsync(m_private->m_stream,
+        &ret.m_private->m_request);
+      return ret;
+    }
+
+    int DataBlobSource::GetNotificationFD()
+    {
+      int ret = -1;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_stream) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobSourceGetNotificationFD(m_private->m_stream, &ret);
+      return ret;
+    }
+
+    hrgls_Status DataBlobSource::PublishSharedMemory(const std::string &name)
+    {
+      if (!m_private || !m_private->m_stream) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobSourcePublishSharedMemory(m_private->m_stream, name.c_str());
+    }
+
+    hrgls_Status DataBlobSource::ProvideBuffers(const std::vector<uint8_t*> &buffers,
+      uint32_t size, hrgls_DeletionFunction returnFunction, void *userData)
+    {
+      if (!m_private || !m_private->m_stream) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobSourceProvideBuffers(m_private->m_stream,
+        buffers.empty() ? nullptr : buffers.data(), static_cast<uint32_t>(buffers.size()),
+        size, returnFunction, userData);
+    }
+
+    hrgls_Status DataBlobSource::SetReplayPacing(hrgls_ReplayPacing pacing)
+    {
+      if (!m_private || !m_private->m_stream) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobSourceSetReplayPacing(m_private->m_stream, pacing);
+    }
+
+    hrgls_Status DataBlobSource::SeekReplay(struct timeval time)
+    {
+      if (!m_private || !m_private->m_stream) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobSourceSeekReplay(m_private->m_stream, time);
+    }
+
     DataBlobSourceDescription DataBlobSource::GetInfo()
     {
       DataBlobSourceDescription ret;
@@ -575,14 +1100,14 @@ namespace hrgls {
 
         hrgls_APIDataBlobSourceInfo info;
         if (hrgls_STATUS_OKAY !=
-            (m_private->m_status[std::this_thread::get_id()] = hrgls_DataBlobSourceGetInfo(m_private->m_stream, &info))) {
+            (m_private->m_status.Get() = hrgls_DataBlobSourceGetInfo(m_private->m_stream, &info))) {
           return DataBlobSourceDescription();
         }
 
         // Get and fill in the name.
         const char *name;
         if (hrgls_STATUS_OKAY !=
-          (m_private->m_status[std::this_thread::get_id()] = hrgls_APIDataBlobSourceGetName(info, &name))) {
+          (m_private->m_status.Get() = hrgls_APIDataBlobSourceGetName(info, &name))) {
           return DataBlobSourceDescription();
         }
         ret.Name(name);
@@ -590,6 +1115,346 @@ namespace hrgls {
       return ret;
     }
 
+    //-----------------------------------------------------------------------
+    class DataBlobSourceGroup::DataBlobSourceGroup_private {
+    public:
+      hrgls_DataBlobSourceGroup m_group = nullptr;
+      ::std::vector< ::std::unique_ptr<DataBlobSource> > m_sources;
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> m_status;
+    };
+
+    DataBlobSourceGroup::DataBlobSourceGroup(
+      API &api,
+      StreamProperties &props,
+      const ::std::vector< ::std::string > &sources)
+    {
+      try {
+        m_private = new DataBlobSourceGroup_private();
+      } catch (...) {
+        m_private = nullptr;
+        return;
+      }
+
+      // Create and fill in the parameters to the group creation routine
+      hrgls_DataBlobSourceCreateParams params;
+      hrgls_Status &status = m_private->m_status.Get();
+      status = hrgls_DataBlobSourceCreateParametersCreate(&params);
+      if (status != hrgls_STATUS_OKAY) {
+        return;
+      }
+      if (hrgls_STATUS_OKAY == (status = hrgls_DataBlobSourceCreateParametersSetAPI(params,
+            api.GetRawAPI())) &&
+          hrgls_STATUS_OKAY == (status = hrgls_DataBlobSourceCreateParametersSetStreamProperties(
+            params, props.GetRawProperties().get()))) {
+        ::std::vector<const char *> names;
+        for (size_t i = 0; i < sources.size(); i++) {
+          names.push_back(sources[i].c_str());
+        }
+        status = hrgls_DataBlobSourceGroupCreate(&m_private->m_group, params,
+          names.empty() ? nullptr : names.data(), static_cast<uint32_t>(names.size()));
+      }
+      hrgls_DataBlobSourceCreateParametersDestroy(params);
+      if (status != hrgls_STATUS_OKAY) {
+        return;
+      }
+
+      // Wrap each of the group's sources in a DataBlobSource that does not destroy it.
+      uint32_t count = 0;
+      if (hrgls_STATUS_OKAY != (status = hrgls_DataBlobSourceGroupGetCount(m_private->m_group,
+            &count))) {
+        return;
+      }
+      try {
+        for (uint32_t i = 0; i < count; i++) {
+          DataBlobSource::DataBlobSource_private *info =
+            new DataBlobSource::DataBlobSource_private();
+          info->m_borrowed = true;
+          m_private->m_sources.push_back(
+            ::std::unique_ptr<DataBlobSource>(new DataBlobSource(info)));
+          if (hrgls_STATUS_OKAY != (status = hrgls_DataBlobSourceGroupGetSource(
+                m_private->m_group, i, &info->m_stream))) {
+            return;
+          }
+        }
+      } catch (...) {
+        status = hrgls_STATUS_OUT_OF_MEMORY;
+      }
+    }
+
+    DataBlobSourceGroup::~DataBlobSourceGroup()
+    {
+      if (m_private) {
+        m_private->m_sources.clear();
+        if (m_private->m_group) {
+          hrgls_DataBlobSourceGroupDestroy(m_private->m_group);
+        }
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobSourceGroup::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    size_t DataBlobSourceGroup::Size() const
+    {
+      if (!m_private) {
+        return 0;
+      }
+      return m_private->m_sources.size();
+    }
+
+    DataBlobSource &DataBlobSourceGroup::operator[](size_t which)
+    {
+      return *m_private->m_sources[which];
+    }
+
+    hrgls_Status DataBlobSourceGroup::SetStreamingState(bool running)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobSourceGroupSetStreamingState(m_private->m_group,
+        running);
+      return m_private->m_status.Get();
+    }
+
+    //-----------------------------------------------------------------------
+    class DataBlobMultiplexer::DataBlobMultiplexer_private {
+    public:
+      hrgls_DataBlobMultiplexer m_mux = nullptr;
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> m_status;
+    };
+
+    DataBlobMultiplexer::DataBlobMultiplexer(API &api)
+    {
+      try {
+        m_private = new DataBlobMultiplexer_private();
+      } catch (...) {
+        m_private = nullptr;
+        return;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobMultiplexerCreate(&m_private->m_mux,
+        api.GetRawAPI());
+    }
+
+    DataBlobMultiplexer::~DataBlobMultiplexer()
+    {
+      if (m_private && m_private->m_mux) {
+        hrgls_DataBlobMultiplexerDestroy(m_private->m_mux);
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobMultiplexer::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    hrgls_Status DataBlobMultiplexer::AddSource(DataBlobSource &source, uint32_t sourceId)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobMultiplexerAddSource(m_private->m_mux, source.m_private->m_stream,
+        sourceId);
+    }
+
+    hrgls_Status DataBlobMultiplexer::RemoveSource(DataBlobSource &source)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobMultiplexerRemoveSource(m_private->m_mux, source.m_private->m_stream);
+    }
+
+    DataBlob DataBlobMultiplexer::GetNextBlob(uint32_t &sourceId, struct timeval timeout)
+    {
+      DataBlob emptyRet;
+      if (!m_private) {
+        return emptyRet;
+      }
+      if (!m_private->m_mux) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return emptyRet;
+      }
+      hrgls_DataBlob blob = nullptr;
+      m_private->m_status.Get() = hrgls_DataBlobMultiplexerGetNextBlob(m_private->m_mux, &blob,
+        &sourceId, timeout);
+      if (m_private->m_status.Get() == hrgls_STATUS_TIMEOUT) {
+        hrgls_DataBlobDestroy(blob);
+        return emptyRet;
+      }
+      return DataBlob::Adopt(blob);
+    }
+
+    //-----------------------------------------------------------------------
+    class DataBlobMerger::DataBlobMerger_private {
+    public:
+      hrgls_DataBlobMerger m_merger = nullptr;
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> m_status;
+    };
+
+    DataBlobMerger::DataBlobMerger(API &api, struct timeval reorderWindow,
+      hrgls_LateBlobPolicy latePolicy)
+    {
+      try {
+        m_private = new DataBlobMerger_private();
+      } catch (...) {
+        m_private = nullptr;
+        return;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobMergerCreate(&m_private->m_merger,
+        api.GetRawAPI(), reorderWindow, latePolicy);
+    }
+
+    DataBlobMerger::~DataBlobMerger()
+    {
+      if (m_private && m_private->m_merger) {
+        hrgls_DataBlobMergerDestroy(m_private->m_merger);
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobMerger::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    hrgls_Status DataBlobMerger::AddSource(DataBlobSource &source, uint32_t sourceId)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobMergerAddSource(m_private->m_merger, source.m_private->m_stream,
+        sourceId);
+    }
+
+    hrgls_Status DataBlobMerger::RemoveSource(DataBlobSource &source)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobMergerRemoveSource(m_private->m_merger, source.m_private->m_stream);
+    }
+
+    DataBlob DataBlobMerger::GetNextBlob(uint32_t &sourceId, struct timeval timeout)
+    {
+      DataBlob emptyRet;
+      if (!m_private) {
+        return emptyRet;
+      }
+      if (!m_private->m_merger) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return emptyRet;
+      }
+      hrgls_DataBlob blob = nullptr;
+      m_private->m_status.Get() = hrgls_DataBlobMergerGetNextBlob(m_private->m_merger, &blob,
+        &sourceId, timeout);
+      if (m_private->m_status.Get() == hrgls_STATUS_TIMEOUT) {
+        hrgls_DataBlobDestroy(blob);
+        return emptyRet;
+      }
+      return DataBlob::Adopt(blob);
+    }
+
+    uint64_t DataBlobMerger::GetLateBlobCount()
+    {
+      uint64_t ret = 0;
+      if (!m_private) {
+        return ret;
+      }
+      if (!m_private->m_merger) {
+        m_private->m_status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobMergerGetLateBlobCount(m_private->m_merger, &ret);
+      return ret;
+    }
+
+    //-----------------------------------------------------------------------
+    class DataBlobRecorder::DataBlobRecorder_private {
+    public:
+      hrgls_DataBlobRecorder m_recorder = nullptr;
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> m_status;
+    };
+
+    DataBlobRecorder::DataBlobRecorder(const ::std::string &fileName)
+    {
+      try {
+        m_private = new DataBlobRecorder_private();
+      } catch (...) {
+        m_private = nullptr;
+        return;
+      }
+      m_private->m_status.Get() = hrgls_DataBlobRecorderCreate(&m_private->m_recorder,
+        fileName.c_str());
+    }
+
+    DataBlobRecorder::~DataBlobRecorder()
+    {
+      if (m_private && m_private->m_recorder) {
+        hrgls_DataBlobRecorderDestroy(m_private->m_recorder);
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobRecorder::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->m_status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    hrgls_Status DataBlobRecorder::Record(const DataBlob &blob)
+    {
+      if (!m_private || !m_private->m_recorder) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobRecorderRecord(m_private->m_recorder, blob.RawDataBlob());
+    }
+
+    hrgls_Status DataBlobRecorder::Flush()
+    {
+      if (!m_private || !m_private->m_recorder) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      return hrgls_DataBlobRecorderFlush(m_private->m_recorder);
+    }
+
   } // End namespace datablob
 
 } // End namespace hrgls
+
+#endif // HRGLS_DIRECT_IMPLEMENTATION
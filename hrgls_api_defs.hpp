@@ -45,6 +45,11 @@ namespace hrgls {
   // Forward declare classes that we will befriend in namespaces we will use
   namespace datablob {
     class DataBlobSource;
+    class DataBlobMultiplexer;
+    class DataBlobMerger;
+    class DataBlobSourceGroup;
+    class DataBlobRequest;
+    class DataBlobRecorder;
   };
 
   /// @brief Stores the properties of a DataBlobSource.
@@ -72,6 +77,15 @@ namespace hrgls {
     /// @param [in] copy StreamProperties to copy from.
     StreamProperties &operator = (const StreamProperties &copy);
 
+    /// @brief Construct one StreamProperties by taking over the state of another.
+    /// @param [in] other StreamProperties to move from.  It is left empty, and
+    ///        all methods on it will report hrgls_STATUS_NULL_OBJECT_POINTER.
+    StreamProperties(StreamProperties&& other) noexcept;
+
+    /// @brief Replace the state of a StreamProperties with that of another.
+    /// @param [in] other StreamProperties to move from.  It is left empty.
+    StreamProperties &operator = (StreamProperties &&other) noexcept;
+
     /// @brief Returns the status of the most-recent operation and clears error/warnings.
     ///
     /// This should be called after the construction of a StreamProperties and after each method
@@ -91,6 +105,70 @@ namespace hrgls {
     ///         is returned here.
     hrgls_Status Rate(double rate);
 
+    /// @brief Read the number of blobs that can be queued waiting to be retrieved.
+    /// @return Capacity of the queue.
+    uint32_t QueueCapacity();
+    /// @brief Set the number of blobs that can be queued waiting to be retrieved.
+    ///
+    /// Once this many blobs are queued, new blobs are handled as described by
+    /// OverflowPolicy().  The queue is allocated when the DataBlobSource is created.
+    /// @param [in] capacity Its default value is 256.  Must be at least 1.
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status QueueCapacity(uint32_t capacity);
+
+    /// @brief Read what the DataBlobSource does when its queue is full.
+    /// @return One of the hrgls_OVERFLOW_* values.
+    hrgls_OverflowPolicy OverflowPolicy();
+    /// @brief Set what the DataBlobSource does when its queue is full.
+    /// @param [in] policy One of the hrgls_OVERFLOW_* values.  Its default value is
+    ///        hrgls_OVERFLOW_DROP_OLDEST.
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status OverflowPolicy(hrgls_OverflowPolicy policy);
+
+    /// @brief Read the typical number of bytes in each blob.
+    /// @return Payload size of the DataBlobSource.
+    uint32_t PayloadSize();
+    /// @brief Set the typical number of bytes in each blob.
+    ///
+    /// Used by DataBlobSources that generate their own data for testing, such as those
+    /// of the NULL implementation; others ignore it.  How the sizes vary around this one
+    /// is set by PayloadDistribution().
+    /// @param [in] size Its default value is 256.  Must be from 1 to 268435456 (256 MiB).
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status PayloadSize(uint32_t size);
+
+    /// @brief Read how the number of bytes in each blob varies.
+    /// @return One of the hrgls_PAYLOAD_* values.
+    hrgls_PayloadDistribution PayloadDistribution();
+    /// @brief Set how the number of bytes in each blob varies around PayloadSize().
+    /// @param [in] distribution One of the hrgls_PAYLOAD_* values.  Its default value is
+    ///        hrgls_PAYLOAD_FIXED.
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status PayloadDistribution(hrgls_PayloadDistribution distribution);
+
+    /// @brief Read the number of blobs that are sent together.
+    /// @return Length of the bursts.
+    uint32_t BurstLength();
+    /// @brief Set the number of blobs that are sent together.
+    ///
+    /// Used by DataBlobSources that generate their own data for testing, such as those
+    /// of the NULL implementation; others ignore it.  The blobs are sent in bursts of this
+    /// many at once, with the bursts spaced so that the average is still Rate().
+    /// @param [in] length Its default value is 1, which spaces all blobs evenly.  Must be
+    ///        at least 1.
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status BurstLength(uint32_t length);
+
     /// @brief Private class declared for definition and use by the API implementation.
     class StreamProperties_private;
 
@@ -99,6 +177,7 @@ namespace hrgls {
     ::std::shared_ptr<hrgls_StreamProperties_> GetRawProperties() const;
     /// @cond INTERNAL
     friend datablob::DataBlobSource;
+    friend datablob::DataBlobSourceGroup;
     /// @endcond
 
   private:
@@ -123,7 +202,7 @@ namespace hrgls {
     ~DataBlobSourceDescription() {};
 
     /// @brief Read the name of the DataBlobSource.
-    ::std::string Name() const { return m_name; };
+    const ::std::string &Name() const { return m_name; };
     /// @brief Set the name of the DataBlobSource (set in struct, not in actual DataBlobSource).
     void Name(const ::std::string name) { m_name = name; };
 
@@ -131,6 +210,131 @@ namespace hrgls {
     ::std::string m_name;
   };
 
+  /// @brief Stores statistics on what has passed through a DataBlobSource or log path.
+  ///
+  /// This class is a snapshot of the counters kept by a DataBlobSource (see
+  /// hrgls::datablob::DataBlobSource::GetStatistics()) or by an API for its log
+  /// messages (see hrgls::API::GetLogMessageStatistics()), in which case each
+  /// message counts as a blob.  It is a C++ analog of the hrgls_StreamStatistics C
+  /// structure.  It is a data-only structure and is fully implemented in the header
+  /// file.  Coupling between this and the C structure is done inside the implementation.
+  ///
+  /// Times are in nanoseconds.  The latency of a blob is the time from its
+  /// DataBlob::Time() (or Message::TimeStamp()) to when it was handed to the client,
+  /// either returned from a call or passed to a callback handler.  The histograms have
+  /// hrgls_STATISTICS_HISTOGRAM_BINS bins, the ranges of which are described there;
+  /// HistogramPercentile() estimates percentiles from them.
+
+  class StreamStatistics {
+  public:
+    StreamStatistics()
+      : m_latencyHistogram(hrgls_STATISTICS_HISTOGRAM_BINS)
+      , m_callbackDurationHistogram(hrgls_STATISTICS_HISTOGRAM_BINS) {};
+    ~StreamStatistics() {};
+
+    /// @brief Number of blobs made by the producer, including ones later dropped.
+    uint64_t Produced() const { return m_produced; };
+    void Produced(uint64_t val) { m_produced = val; };
+    /// @brief Number of blobs handed to the client.
+    uint64_t Delivered() const { return m_delivered; };
+    void Delivered(uint64_t val) { m_delivered = val; };
+    /// @brief Number of blobs dropped because their queue was full.
+    uint64_t Dropped() const { return m_dropped; };
+    void Dropped(uint64_t val) { m_dropped = val; };
+    /// @brief Number of blobs waiting in the queue when the statistics were read.
+    uint64_t QueueDepth() const { return m_queueDepth; };
+    void QueueDepth(uint64_t val) { m_queueDepth = val; };
+    /// @brief Most blobs that have been waiting in the queue at once.
+    uint64_t MaxQueueDepth() const { return m_maxQueueDepth; };
+    void MaxQueueDepth(uint64_t val) { m_maxQueueDepth = val; };
+
+    /// @brief Sum of the latencies of all delivered blobs, in nanoseconds.
+    uint64_t LatencyTotal() const { return m_latencyTotal; };
+    void LatencyTotal(uint64_t val) { m_latencyTotal = val; };
+    /// @brief Largest latency of a delivered blob, in nanoseconds.
+    uint64_t LatencyMax() const { return m_latencyMax; };
+    void LatencyMax(uint64_t val) { m_latencyMax = val; };
+    /// @brief Number of delivered blobs in each latency bin.
+    const ::std::vector<uint64_t> &LatencyHistogram() const { return m_latencyHistogram; };
+    void LatencyHistogram(const ::std::vector<uint64_t> &val) { m_latencyHistogram = val; };
+
+    /// @brief Number of calls made to the callback handler.
+    uint64_t Callbacks() const { return m_callbacks; };
+    void Callbacks(uint64_t val) { m_callbacks = val; };
+    /// @brief Sum of the time spent in the callback handler, in nanoseconds.
+    uint64_t CallbackDurationTotal() const { return m_callbackDurationTotal; };
+    void CallbackDurationTotal(uint64_t val) { m_callbackDurationTotal = val; };
+    /// @brief Longest that a single call to the callback handler took, in nanoseconds.
+    uint64_t CallbackDurationMax() const { return m_callbackDurationMax; };
+    void CallbackDurationMax(uint64_t val) { m_callbackDurationMax = val; };
+    /// @brief Number of calls to the callback handler in each duration bin.
+    const ::std::vector<uint64_t> &CallbackDurationHistogram() const
+      { return m_callbackDurationHistogram; };
+    void CallbackDurationHistogram(const ::std::vector<uint64_t> &val)
+      { m_callbackDurationHistogram = val; };
+
+    /// @brief Bin of a histogram that a time falls into.
+    /// @param [in] nanoseconds Time to find the bin for.
+    static size_t HistogramBin(uint64_t nanoseconds)
+    {
+      // Count the bits needed to hold the time.
+      size_t bits = 0;
+      for (unsigned shift = 32; shift > 0; shift /= 2) {
+        if (nanoseconds >> shift) {
+          nanoseconds >>= shift;
+          bits += shift;
+        }
+      }
+      bits += static_cast<size_t>(nanoseconds);
+      return bits < hrgls_STATISTICS_HISTOGRAM_BINS ? bits : hrgls_STATISTICS_HISTOGRAM_BINS - 1;
+    };
+
+    /// @brief Estimate a percentile of the times counted in a histogram.
+    /// @param [in] histogram LatencyHistogram() or CallbackDurationHistogram().
+    /// @param [in] fraction Fraction of the times that are at or below the result,
+    ///             between 0 and 1.
+    /// @return Upper limit of the bin that holds the percentile, in nanoseconds, or 0
+    ///         if the histogram is empty.  For the last bin, which has no upper limit,
+    ///         its lower limit is returned.
+    static uint64_t HistogramPercentile(const ::std::vector<uint64_t> &histogram,
+      double fraction)
+    {
+      uint64_t total = 0;
+      for (size_t i = 0; i < histogram.size(); i++) {
+        total += histogram[i];
+      }
+      if (total == 0) {
+        return 0;
+      }
+      uint64_t count = 0;
+      for (size_t i = 0; i < histogram.size(); i++) {
+        count += histogram[i];
+        if (count >= fraction * total || i + 1 == histogram.size()) {
+          if (i == 0) {
+            return 0;
+          }
+          return (i + 1 < hrgls_STATISTICS_HISTOGRAM_BINS) ? (uint64_t(1) << i) - 1
+            : uint64_t(1) << (i - 1);
+        }
+      }
+      return 0;
+    };
+
+  private:
+    uint64_t m_produced = 0;
+    uint64_t m_delivered = 0;
+    uint64_t m_dropped = 0;
+    uint64_t m_queueDepth = 0;
+    uint64_t m_maxQueueDepth = 0;
+    uint64_t m_latencyTotal = 0;
+    uint64_t m_latencyMax = 0;
+    ::std::vector<uint64_t> m_latencyHistogram;
+    uint64_t m_callbacks = 0;
+    uint64_t m_callbackDurationTotal = 0;
+    uint64_t m_callbackDurationMax = 0;
+    ::std::vector<uint64_t> m_callbackDurationHistogram;
+  };
+
   /// @brief Holds the data for a logging or issue Message.
   ///
   /// This class controls and reports a Message.  It wraps an
@@ -166,6 +370,31 @@ namespace hrgls {
 	  ///        Message to avoid double deletion.
 	  Message &operator = (const Message &copy);
 
+	  /// @brief Move constructor for a Message.
+	  /// @param [in] other Message to take the wrapped hrgls_Message from without
+	  ///        copying it.  It is left empty, and all methods on it will report
+	  ///        hrgls_STATUS_NULL_OBJECT_POINTER.
+	  Message(Message&& other) noexcept;
+
+	  /// @brief Move assignment for a Message.
+	  /// @param [in] other Message to take the wrapped hrgls_Message from.  It is
+	  ///        left empty.
+	  Message &operator = (Message &&other) noexcept;
+
+	  /// @brief Used internally to wrap an hrgls_Message without copying it.
+	  ///
+	  /// The returned object takes ownership of the hrgls_Message and destroys it
+	  /// in ~Message(), so the caller must not destroy it.
+	  /// @param [in] message The hrgls_Message to take ownership of.
+	  static Message Adopt(hrgls_Message message);
+
+	  /// @brief Used internally to hand off the wrapped hrgls_Message.
+	  ///
+	  /// The caller becomes responsible for calling hrgls_MessageDestroy() on the
+	  /// returned value, and this object is left empty.
+	  /// @return The wrapped hrgls_Message, or nullptr if there was none.
+	  hrgls_Message Detach();
+
 	  /// @brief Returns the status of the most-recent operation and clears error/warnings.
 	  ///
 	  /// This should be called after the construction of a Message and after each method
@@ -185,6 +414,14 @@ namespace hrgls {
     ///         is returned here.
     hrgls_Status Value(::std::string value);
 
+	  /// @brief Set the value of the message without copying it.
+	  /// @param [in] value Value to refer to, which must stay valid and unchanged for as long
+	  ///        as the library is loaded; see hrgls_MessageSetStaticValue().
+    /// @return Returns hrgls_STATUS_OKAY on success and a specific code on failure.
+    ///         GetStatus() does not need to be called after this method because it
+    ///         is returned here.
+    hrgls_Status StaticValue(const char *value);
+
 	  /// @brief Get the timestamp of the message in UTC.
 	  struct timeval TimeStamp() const;
 
@@ -215,6 +452,32 @@ namespace hrgls {
 	  Message_private * m_private = nullptr;
   };
 
+  /// @brief Borrowed view of a log Message, handed to an API::LogMessageViewCallback.
+  ///
+  /// This refers to the message rather than copying it, so it and the text that Value()
+  /// points to are only valid until the callback handler returns.  Construct a Message
+  /// from its contents to keep it longer.
+  class MessageView {
+  public:
+    /// @brief Used internally to wrap the C view that is handed to a callback handler.
+    explicit MessageView(const hrgls_MessageView &view) : m_view(view) {}
+
+    /// @brief Get the value of the message, valid only during the callback.
+    const char *Value() const { return m_view.value; }
+
+    /// @brief Get the timestamp of the message in UTC.
+    struct timeval TimeStamp() const { return m_view.timeStamp; }
+
+    /// @brief Get the level of the message.
+    hrgls_MessageLevel Level() const { return m_view.level; }
+
+    /// @brief Accessor for the wrapped C view, not used by client code.
+    const hrgls_MessageView &RawView() const { return m_view; }
+
+  private:
+    const hrgls_MessageView &m_view;
+  };
+
   //----------------------------------------------------
   // Constants defined for use below.
 
@@ -243,9 +506,42 @@ namespace hrgls {
     /// @param [in] credentials Binary credentials object for this user.
     ///             This is used to verify the user and provide appropriate access.
     ///             Will use NO_CREDENTIALS if this is not specified.
+    /// @param [in] callbackThreads Number of threads to call the log-message and stream
+    ///             callback handlers from.  When 0 (the default), handlers are called
+    ///             directly by the threads that produce the messages and blobs, so a
+    ///             slow handler holds up production.  Otherwise they are called from a
+    ///             pool of this many threads; calls for the same DataBlobSource (and
+    ///             for the log messages) are made one at a time in order, while those for
+    ///             different sources run in parallel.  Blobs and messages waiting for a
+    ///             handler are queued as described in StreamProperties::QueueCapacity().
+    /// @param [in] endpoint When empty (the default), DataBlobSources are local.  Otherwise
+    ///             "host:port" of an API elsewhere that has called StartServer();
+    ///             GetAvailableDataBlobSources() then lists its sources, and each
+    ///             DataBlobSource created on this API streams from one of them over a
+    ///             connection of its own.
+    /// @param [in] implementation When empty (the default), the API is implemented by the
+    ///             library that the program is linked against.  Otherwise the file name
+    ///             of a shared library that implements it, which is loaded the first time
+    ///             it is named; this API and all of the objects obtained from it are then
+    ///             implemented by that library.  See hrgls_implementation.h.
+    /// @param [in] sourceCount Number of DataBlobSources advertised by implementations
+    ///             that generate their own data for testing, such as the NULL
+    ///             implementation; others ignore it.  Must be at least 1.
+    /// @param [in] messageRate Messages/second generated while log messages are
+    ///             streaming by such implementations, counting those below the minimum
+    ///             level that are not sent.  Must not be negative.
+    /// @param [in] messageLevel Lowest level of the messages that such implementations
+    ///             generate.  They cycle through those of the hrgls_MESSAGE_MINIMUM_*
+    ///             levels that are at least this one, or all have this level if none are.
     API(
       ::std::string user = ANONYMOUS_USER,
-      ::std::vector<uint8_t> credentials = NO_CREDENTIALS);
+      ::std::vector<uint8_t> credentials = NO_CREDENTIALS,
+      uint32_t callbackThreads = 0,
+      ::std::string endpoint = "",
+      ::std::string implementation = "",
+      uint32_t sourceCount = 2,
+      double messageRate = 10,
+      hrgls_MessageLevel messageLevel = hrgls_MESSAGE_MINIMUM_INFO);
     /// @brief Destroy the object, closing all API objects obtained from it.
     ~API();
 
@@ -261,6 +557,28 @@ namespace hrgls {
     /// @brief Return a vector of descriptions of available DataBlobSources.
     ::std::vector<DataBlobSourceDescription> GetAvailableDataBlobSources() const;
 
+    /// @brief Return the generation of the list of available DataBlobSources.
+    ///
+    /// See hrgls_APIGetDataBlobSourceGeneration(); 0 means that the list is not tracked.
+    uint64_t GetDataBlobSourceGeneration() const;
+
+    /// @brief Tells whether GetAvailableDataBlobSources() may return a different list than
+    ///        it did when GetDataBlobSourceGeneration() returned generation.
+    bool DataBlobSourcesChangedSince(uint64_t generation) const;
+
+    /// @brief Callback handler type declaration for changes to the list of DataBlobSources.
+    typedef hrgls_DataBlobSourcesChangedCallback DataBlobSourcesChangedCallback;
+
+    /// @brief Sets up a handler to be called each time the list of DataBlobSources changes.
+    ///
+    /// See hrgls_APISetDataBlobSourcesChangedCallback() for when it is called.
+    /// @param [in] callback Function to call, or nullptr to remove the handler.
+    /// @param [in] userData Pointer that will be passed into the callback handler.
+    /// @return hrgls_STATUS_OKAY on success, a specific error code on failure.
+    ///         GetStatus() should not be called after this method, since it is returned here.
+    hrgls_Status SetDataBlobSourcesChangedCallback(DataBlobSourcesChangedCallback callback,
+        void *userData = nullptr);
+
     /// @brief Return the current version.
     hrgls_VERSION GetVersion() const;
 
@@ -293,6 +611,24 @@ namespace hrgls {
     hrgls_Status SetLogMessageCallback(LogMessageCallback callback,
         void *userData = nullptr);
 
+    /// @brief Callback handler type declaration for borrowing log messages.
+    typedef void(*LogMessageViewCallback)(const MessageView &message, void *userData);
+
+    /// @brief Sets up a handler to be lent each log message as it comes in when enabled.
+    ///
+    /// This works like SetLogMessageCallback(), except that the handler is given a view
+    /// that is only valid during the call rather than a Message of its own, which saves
+    /// creating and copying a Message for each call; see hrgls_APISetLogMessageViewCallback().
+    /// Only one of the two kinds of handler is used at a time: setting either one, even
+    /// to nullptr, removes the other.
+    /// @param [in] callback Function to call for each message, or nullptr to disable.
+    /// @param [in] userData Pointer that will be passed into the callback handler along with
+    ///        each message.
+    /// @return hrgls_STATUS_OKAY on success, a specific error code on failure.
+    ///         GetStatus() should not be called after this method, since it is returned here.
+    hrgls_Status SetLogMessageViewCallback(LogMessageViewCallback callback,
+        void *userData = nullptr);
+
     /// @brief Turns delivery of log messages on or off.
     ///
     /// The API is not initially sending messages.  Call this
@@ -312,6 +648,29 @@ namespace hrgls {
     ///         if none are available.
     ::std::vector<Message> GetPendingLogMessages(size_t maxNum = 0);
 
+    /// @brief Reads how many log messages have been dropped because their queue was full.
+    ///
+    /// Messages queue up to a fixed limit when neither a callback handler nor
+    /// GetPendingLogMessages() is keeping up with them; after that the oldest are dropped.
+    /// @return Number of messages dropped since the API was created.
+    uint64_t GetDroppedLogMessageCount();
+
+    /// @brief Reads statistics on the log messages generated since the API was created.
+    ///
+    /// Each message counts as a blob; see StreamStatistics for what is counted.  The
+    /// counters are kept without locking, so a snapshot taken while messages are being
+    /// generated may not be consistent between counters.
+    /// @return Snapshot of the statistics.
+    StreamStatistics GetLogMessageStatistics();
+
+    /// @brief Gets the pool that buffers for the data of produced blobs come from.
+    ///
+    /// The pool is owned by the API and lives as long as it does, or until the last
+    /// blob using one of its buffers is destroyed, whichever is later.  Its statistics
+    /// show how often producing a blob was able to reuse a buffer.
+    /// @return Pool on success, nullptr on failure.
+    hrgls_BufferPool GetBufferPool();
+
     /// @brief Sets the range of message levels to be returned.
     ///
     /// This method filters log messages so that only those of sufficient urgency
@@ -321,6 +680,38 @@ namespace hrgls {
     ///         GetStatus() should not be called after this method, since it is returned here.
     hrgls_Status SetLogMessageMinimumLevel(hrgls_MessageLevel level);
 
+    /// @brief Serves this API's DataBlobSources to APIs on other hosts.
+    ///
+    /// Listens for connections from APIs constructed with an endpoint.  Each remote
+    /// DataBlobSource is served by a local one that is created with the remote one's
+    /// StreamProperties, so its Rate() and OverflowPolicy() apply at the producer.  Blobs
+    /// are sent with their original times, as many at a time as have queued up, without
+    /// waiting for the consumer to ask for each.  When the consumer or the network falls
+    /// behind, the connection stops accepting data and blobs back up into the local
+    /// source's queue, where the overflow policy decides what happens to them.  The server
+    /// is stopped when the API is destroyed.  Only available on Linux.
+    /// @param [in] endpoint Address and port to listen on, of the form "host:port".  The
+    ///        host may be empty to listen on all addresses and the port may be 0 to pick
+    ///        a free one.
+    /// @return The port that is being listened on, or 0 on failure.  GetStatus() reports
+    ///         hrgls_STATUS_BAD_PARAMETER if the endpoint is not valid or the API is already
+    ///         serving, hrgls_STATUS_CONNECTION_FAILED if it could not listen there, and
+    ///         hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not available.
+    uint16_t StartServer(const ::std::string &endpoint);
+
+    /// @brief Makes a recording available as a DataBlobSource.
+    ///
+    /// The recording, written by a DataBlobRecorder, is listed by
+    /// GetAvailableDataBlobSources() under the name "/hrgls/replay/" followed by the file
+    /// name.  Constructing a DataBlobSource with that name replays it, whether or not it
+    /// has been added here.  Only available on Linux.
+    /// @param [in] fileName Recording to add.
+    /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the file is not
+    ///         a recording or this API gets its sources from a remote endpoint,
+    ///         hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not available.
+    ///         GetStatus() should not be called after this method.
+    hrgls_Status AddReplayFile(const ::std::string &fileName);
+
     /// @brief Private class declared for definition and use by the API implementation.
     class API_private;
 
@@ -331,6 +722,9 @@ namespace hrgls {
     // Share our protected information with classes that make use of us.
     /// @cond INTERNAL
     friend datablob::DataBlobSource;
+    friend datablob::DataBlobSourceGroup;
+    friend datablob::DataBlobMultiplexer;
+    friend datablob::DataBlobMerger;
     /// @endcond
 
   private:
@@ -347,10 +741,12 @@ namespace hrgls {
   /// The GetStatus() method should be called after each method (including
   /// the constructor) to make sure that the operation was a success.
   ///
-  /// The client code must call ReleaseData() at least once to avoid
-  /// leaking the blob memory.  It must not attempt to access the pointer
-  /// returned by Data() once ReleaseData() has been called.  Destroying the
-  /// object does not release the underlying data.
+  /// The blob data is reference counted and shared by all copies of a DataBlob,
+  /// so copying a DataBlob never copies its data.  Each copy releases its
+  /// reference when it is destroyed or when ReleaseData() is called on it, and
+  /// the data is freed when the last reference is released.  Client code must
+  /// not access the pointer returned by Data() once ReleaseData() has been called
+  /// on the copy it came from.
 
     class DataBlob {
     public:
@@ -359,20 +755,42 @@ namespace hrgls {
 
       /// @brief Used internally to construct based on an hrgls_DataBlob.
       ///
-      /// Makes a copy of the hrgls_DataBlob and destroys the copy during the
-      /// deconstruction.  Does not call ReleaseData() upon destruction -- the
-      /// client is responsible for doing this.
+      /// Makes a copy of the hrgls_DataBlob, sharing its data, and destroys the
+      /// copy during the deconstruction.
       /// @param [in] blob hrgls_DataBlob that is copied to construct this class.
       DataBlob(hrgls_DataBlob blob);
-      /// @brief Destroy the blob object.  Does not release blob data.
+      /// @brief Destroy the blob object, releasing its reference to the blob data.
       ~DataBlob();
 
-      /// @brief Constructs by copying the DataBlob passed in.
+      /// @brief Constructs by copying the DataBlob passed in, sharing its data.
       DataBlob(const DataBlob& copy);
       /// @brief Destroys any previous blob and copies from the specified blob.
       /// @return Reference to the DataBlob.
       DataBlob& operator = (const DataBlob& copy);
 
+      /// @brief Constructs by taking over the blob held by another DataBlob.
+      ///
+      /// Does not cross the API boundary.  The moved-from DataBlob is left empty,
+      /// and all methods on it will report hrgls_STATUS_NULL_OBJECT_POINTER.
+      DataBlob(DataBlob&& other) noexcept;
+      /// @brief Destroys any previous blob and takes over the specified blob.
+      /// @return Reference to the DataBlob.
+      DataBlob& operator = (DataBlob&& other) noexcept;
+
+      /// @brief Used internally to wrap an hrgls_DataBlob without copying it.
+      ///
+      /// The returned object takes ownership of the hrgls_DataBlob and destroys it
+      /// in ~DataBlob(), so the caller must not destroy it.
+      /// @param [in] blob The hrgls_DataBlob to take ownership of.
+      static DataBlob Adopt(hrgls_DataBlob blob);
+
+      /// @brief Used internally to hand off the wrapped hrgls_DataBlob.
+      ///
+      /// The caller becomes responsible for calling hrgls_DataBlobDestroy() on the
+      /// returned value, and this object is left empty.
+      /// @return The wrapped hrgls_DataBlob, or nullptr if there was none.
+      hrgls_DataBlob Detach();
+
       /// @brief Returns the status of the most-recent operation and clears error/warnings.
       ///
       /// This should be called after the construction of an DataBlob and after each method
@@ -387,21 +805,38 @@ namespace hrgls {
 
       /// @brief Const pointer to the binary blob data.
       ///
-      /// This pointer remains valid until the client code calls ReleaseData() on any
-      /// of the copies of this DataBlob or on the underlying C struct.
+      /// This pointer remains valid until ReleaseData() is called on this DataBlob
+      /// or it is destroyed.  Other copies keep the data alive for as long as they
+      /// hold references to it.
       const uint8_t* Data() const;
       /// @brief Size of the binary DataBlob data.
+      ///
+      /// Data() and Size() describe data that is a single segment of less than 4 GiB.
+      /// For other data they return nullptr and 0, GetStatus() reports
+      /// hrgls_STATUS_SEGMENTED_DATA, and the data is read with SegmentData().
       uint32_t Size() const;
 
+      /// @brief Number of separate segments that the data is made of, 0 if there is none.
+      uint32_t SegmentCount() const;
+      /// @brief Const pointer to one segment of the data, which remains valid as long as
+      /// the pointer returned by Data() would.
+      /// @param [in] which Index of the segment, less than SegmentCount().
+      const uint8_t* SegmentData(uint32_t which) const;
+      /// @brief Size of one segment of the data.
+      /// @param [in] which Index of the segment, less than SegmentCount().
+      uint64_t SegmentSize(uint32_t which) const;
+      /// @brief Size of all of the segments of the data together.
+      uint64_t TotalSize() const;
+
       /// @brief Release the underlying DataBlob data associated with this DataBlob.
       ///
       /// DataBlobs are large enough that copying their data can cause significant
       /// performance issues, so the API passes pointers to data that is allocated
       /// when the DataBlob is received rather than copying the data.  Calling
-      /// ReleaseData() passed through the API and does the appropriate deletion
-      /// for this memory.  This must be done explicitly by the client code to avoid
-      /// leaking memory.  Once this has been done, the pointer returned by Data()
-      /// becomes invalid and must not be accessed.
+      /// ReleaseData() drops this copy's reference to the data ahead of its
+      /// destruction; the last reference to be released passes through the API
+      /// and does the appropriate deletion for this memory.  Once this has been
+      /// done, the pointer returned by Data() must not be accessed.
       void ReleaseData();
 
       /// @brief Used internally to get access to the harnessed C struct.
@@ -416,11 +851,68 @@ namespace hrgls {
 
     /// @brief Callback handler type declaration for returning DataBlobs from a DataBlobSource.
     ///
-    /// The callback handler must call ReleaseData() on each blob it receives to avoid
-    /// leaking memory.  It can queue blobs for processing by other threads, but then these
-    /// threads must call ReleaseData() on one of the copies of the blobs.
+    /// The callback handler can copy the blobs it receives to queue them for processing
+    /// by other threads; the copies share the data, which is freed once the last copy
+    /// has been released or destroyed.
     typedef void (*StreamCallback)(DataBlob &blob, void *userData);
 
+    /// @brief Holds a request for a blob made by DataBlobSource::GetNextBlobAsync().
+    ///
+    /// The request is filled in with the next blob from its source as soon as one is
+    /// produced, without any thread having to wait for it.  IsReady() checks whether
+    /// that has happened and Wait() returns the blob, sleeping until it arrives if need
+    /// be.  Requests on a source are filled in the order they were made, ahead of any
+    /// call to DataBlobSource::GetNextBlob().  Destroying a request that has not been
+    /// filled in cancels it.  The GetStatus() method should be called after each method
+    /// to make sure that the operation was a success.
+    class DataBlobRequest {
+    public:
+      /// @brief Constructs a request that is not associated with a source.
+      DataBlobRequest();
+      ~DataBlobRequest();
+
+      /// @brief Takes over the request held by another DataBlobRequest.
+      ///
+      /// The moved-from DataBlobRequest is left not associated with a source.
+      DataBlobRequest(DataBlobRequest &&other) noexcept;
+      /// @return Reference to the DataBlobRequest.
+      DataBlobRequest &operator=(DataBlobRequest &&other) noexcept;
+
+      DataBlobRequest(const DataBlobRequest &) = delete;
+      DataBlobRequest &operator=(const DataBlobRequest &) = delete;
+
+      /// @brief Returns the status of the most-recent operation and clears error/warnings.
+      /// @return hrgls_Status returned by the most-recent operation on the wrapped
+      ///         class, or other errors in case the object itself is broken.
+      hrgls_Status GetStatus();
+
+      /// @brief Checks, without waiting, whether Wait() would return immediately.
+      /// @return True if the request has been filled in or its source has been destroyed.
+      bool IsReady();
+
+      /// @brief Returns the blob that fills the request.
+      ///
+      /// Each request is filled in by a single blob, after which it is no longer
+      /// associated with its source.
+      /// @param [in] timeout How long to wait for the blob, default returns immediately
+      ///         if it has not arrived.
+      /// @return The blob on success; GetStatus() then reports hrgls_STATUS_OKAY.  A blob
+      ///         with empty data if it did not arrive in time (hrgls_STATUS_TIMEOUT), the
+      ///         source was destroyed first, or the request is not associated with a
+      ///         source (hrgls_STATUS_NULL_OBJECT_POINTER).
+      DataBlob Wait(struct timeval timeout = {});
+
+      /// @brief Private class declared for definition and use by the API implementation.
+      class DataBlobRequest_private;
+
+    private:
+      /// @cond INTERNAL
+      friend DataBlobSource;
+      /// @endcond
+
+      DataBlobRequest_private *m_private = nullptr;
+    };
+
     /// @brief Holds the data and methods for controlling a DataBlobSource.
     ///
     /// This class controls and reports a DataBlobSource.  It wraps an
@@ -443,6 +935,11 @@ namespace hrgls {
       /// @param [in] props Used to control the stream properties (rate, etc.)
       /// @param [in] source Entity name of the DataBlobSource (available by calling
       ///        hrgls::API::GetAvailableDataBlobSources(); defaults to any available DataBlobSource.
+      ///        A name of the form "/hrgls/shm/name" attaches to the blobs published with
+      ///        PublishSharedMemory("name"), usually by another process.  A name of the
+      ///        form "/hrgls/replay/file" replays the recording in that file, which was
+      ///        written by a DataBlobRecorder; its blobs point straight into the file's
+      ///        mapping in memory rather than being copied (Linux only).
       DataBlobSource(
         API &api,
         StreamProperties &props,
@@ -470,9 +967,9 @@ namespace hrgls {
       ///        handle each blob as it comes in when streaming is started.  Set to nullptr
       ///        to disable handling streaming blobs.  The function must be able to handle
       ///        blobs at full rate to avoid filling up memory as un-handled blobs queue.
-      ///        The callback handler must call ReleaseData() on each blob it receives to avoid
-      ///        leaking memory.  It can queue blobs for processing by other threads, but then these
-      ///        threads must call ReleaseData() on one of the copies of the blobs.
+      ///        The callback handler can copy the blobs it receives to queue them for processing
+      ///        by other threads; the copies share the data, which is freed once the last copy
+      ///        has been released or destroyed.
       /// @param [in] userData Pointer that will be passed into the callback handler along with
       ///        each blob.  Often type-cast into a class or structure pointer to let the
       ///        handler know what it should do with each blob.
@@ -489,18 +986,149 @@ namespace hrgls {
       ///         GetStatus() should not be called after this method, since it is returned here.
       hrgls_Status SetStreamingState(bool running = true);
 
+      /// @brief Changes the StreamProperties without recreating the DataBlobSource.
+      ///
+      /// May be called while streaming.  The new Rate(), PayloadSize(),
+      /// PayloadDistribution(), BurstLength() and OverflowPolicy() take effect at once,
+      /// and queued blobs are kept.  The producer reads them without locking, and each
+      /// blob is made entirely under either the old properties or the new ones.
+      /// @param [in] props Properties to use from now on, which are copied.  Their
+      ///        QueueCapacity() must be the one that the source was created with.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the queue
+      ///         capacity differs, hrgls_STATUS_NOT_IMPLEMENTED for a source that reads
+      ///         from shared memory or replays a recording, a specific error code on other
+      ///         failures.  GetStatus() should not be called after this method.
+      hrgls_Status SetStreamProperties(StreamProperties &props);
+
       /// @brief Reads the next-available blob queued by streaming.
       ///
       /// This method should be called after SetStreamingState() is called to start streaming.
       /// Either this method or SetStreamCallback() should be used to retrieve blobs; if
       /// SetStreamCallback() method is used, GetNextBlob() will always return empty blobs.
       /// @param [in] timeout How long to wait for a new blob, default returns immediately
-      ///         if no blob is available.
+      ///         if no blob is available.  The calling thread sleeps while waiting and
+      ///         is woken as soon as a blob arrives.
       /// @return Retrieves the next available queued blob on the stream, or a blob
-      ///         with empty data if none is available.  The receiver must call ReleaseData()
-      ///         on any non-empty blob when it is done with it to avoid leaking memory.
+      ///         with empty data if none is available.  The data is released when the
+      ///         returned blob and all of its copies are destroyed or released.
       DataBlob GetNextBlob(struct timeval timeout = {});
 
+      /// @brief Reads all available blobs queued by streaming, up to a maximum.
+      ///
+      /// Like GetNextBlob(), but returns as many queued blobs as are available in a
+      /// single call, which is much cheaper per blob than calling GetNextBlob() for
+      /// each of them when blobs arrive at a high rate.
+      /// @param [in] maxNum Maximum number of blobs to return, default is 0 for unlimited.
+      /// @param [in] timeout How long to wait for the first blob, default returns immediately
+      ///         if no blob is available.  Once a blob is available, all available blobs
+      ///         are returned without further waiting.
+      /// @return Retrieves the available queued blobs in the order they were produced, or
+      ///         an empty vector if none are available; GetStatus() then reports
+      ///         hrgls_STATUS_TIMEOUT.
+      ::std::vector<DataBlob> GetPendingBlobs(size_t maxNum = 0, struct timeval timeout = {});
+
+      /// @brief Asks for the next blob without waiting for it.
+      ///
+      /// Returns at once with a request that is filled in by the next blob produced (or
+      /// the oldest one already queued), so that a thread can start other work and
+      /// collect the blob later.  Like GetNextBlob(), requests are never filled in while
+      /// a stream callback is set.
+      /// @return Request for the next blob.  Use DataBlobRequest::Wait() to get it.
+      DataBlobRequest GetNextBlobAsync();
+
+      /// @brief Gets a file descriptor that becomes readable when blobs are queued.
+      ///
+      /// Lets an event loop based on select(), poll(), or epoll wait on DataBlobSources
+      /// along with its other file descriptors.  The descriptor is readable while
+      /// GetNextBlob() and GetPendingBlobs() would return a blob without waiting; it
+      /// may occasionally stay readable after the queue has been emptied, so those
+      /// methods should be called with a timeout of zero when it is.  The descriptor
+      /// belongs to the DataBlobSource, which closes it when it is destroyed.  The
+      /// caller must only wait on it and must not read from, write to, or close it.
+      /// Only available on Linux.
+      /// @return The descriptor on success, -1 on failure (hrgls_STATUS_NOT_IMPLEMENTED on
+      ///         platforms where it is not available).
+      int GetNotificationFD();
+
+      /// @brief Publishes this DataBlobSource's blobs for other processes on the same host.
+      ///
+      /// From now on, each blob is also copied once into a ring in a shared-memory segment.
+      /// Other processes (or this one) construct a DataBlobSource with the name
+      /// "/hrgls/shm/" followed by this name to receive them; their blobs point straight
+      /// into the segment rather than being copied again, and hold their place in the
+      /// ring until they are released.  When the next place in the ring is still held, a
+      /// blob is skipped rather than waiting for the consumer, which then counts it as
+      /// dropped.  Each consumer gets every blob, subject to its own StreamProperties,
+      /// and only while its streaming state is on.  The ring is removed when this
+      /// DataBlobSource is destroyed.  Only available on Linux.
+      /// @param [in] name Name for the ring: 1 to 245 letters, digits, '.', '_' or '-'.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the name is
+      ///         not valid or this source is already published or is itself attached to a
+      ///         ring, hrgls_STATUS_NOT_IMPLEMENTED on platforms where it is not available,
+      ///         a specific error code on other failures.  GetStatus() should not be called
+      ///         after this method.
+      hrgls_Status PublishSharedMemory(const ::std::string &name);
+
+      /// @brief Lends the DataBlobSource buffers to write its blobs into.
+      ///
+      /// Once buffers have been provided, each blob's data is written into one of
+      /// them rather than into memory the source allocates, and the blob's data points
+      /// at it.  When the last reference to that data is released, the buffer is
+      /// handed back by calling returnFunction(userData, buffer); buffers not holding
+      /// a blob are handed back when the DataBlobSource is destroyed.  Call this again
+      /// with returned buffers to keep them in use.  A blob that finds no buffer free
+      /// is dropped and counted by GetDroppedBlobCount().  May be called while streaming.
+      /// @param [in] buffers Buffers to lend, none of which may be NULL.
+      /// @param [in] size Size in bytes of each buffer.  For a source produced by this
+      ///        process, it must hold the largest blob its StreamProperties can make.
+      /// @param [in] returnFunction Called once for each buffer when it is handed back,
+      ///        possibly from another thread; must not be NULL.
+      /// @param [in] userData Passed to returnFunction.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if a parameter
+      ///         is not valid, hrgls_STATUS_NOT_IMPLEMENTED for a source that reads from
+      ///         shared memory or replays a recording, a specific error code on other
+      ///         failures.  GetStatus() should not be called after this method.
+      hrgls_Status ProvideBuffers(const ::std::vector<uint8_t*> &buffers, uint32_t size,
+        hrgls_DeletionFunction returnFunction, void *userData);
+
+      /// @brief Reads how many blobs have been dropped because the queue was full.
+      ///
+      /// The size of the queue and what happens when it fills are set by the
+      /// QueueCapacity() and OverflowPolicy() of the StreamProperties that the
+      /// DataBlobSource was created with.  Blobs are never dropped under
+      /// hrgls_OVERFLOW_BLOCK_PRODUCER.
+      /// @return Number of blobs dropped since the DataBlobSource was created.
+      uint64_t GetDroppedBlobCount();
+
+      /// @brief Reads statistics on the blobs made since the DataBlobSource was created.
+      ///
+      /// See StreamStatistics for what is counted.  The counters are kept without
+      /// locking, so a snapshot taken while streaming may not be consistent between
+      /// counters; for example, a blob may be counted as delivered but not yet as produced.
+      /// @return Snapshot of the statistics.
+      StreamStatistics GetStatistics();
+
+      /// @brief Sets how a DataBlobSource that replays a recording paces its blobs.
+      /// @param [in] pacing hrgls_REPLAY_RECORDED_RATE (the default) to space blobs out as
+      ///        they were recorded, or hrgls_REPLAY_AS_FAST_AS_POSSIBLE to deliver them as
+      ///        fast as they are consumed, usually along with hrgls_OVERFLOW_BLOCK_PRODUCER
+      ///        so that none are dropped.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if this is not a
+      ///         replay or the pacing is not valid.  GetStatus() should not be called after
+      ///         this method.
+      hrgls_Status SetReplayPacing(hrgls_ReplayPacing pacing);
+
+      /// @brief Moves a DataBlobSource that replays a recording to a new place in it.
+      ///
+      /// The next blob delivered is the first one recorded at or after the time, found
+      /// with the recording's index rather than by reading through it.  Blobs that are
+      /// already queued are still delivered.  When the end of the recording is reached
+      /// the source stops producing until it is moved again.
+      /// @param [in] time Time of the blob to move to; {0,0} rewinds to the start.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if this is not a
+      ///         replay.  GetStatus() should not be called after this method.
+      hrgls_Status SeekReplay(struct timeval time);
+
       /// @brief Get the description (including the name) about the DataBlobSource.
       ///
       /// This returns the information needed to refer to the DataBlobSource in
@@ -513,9 +1141,261 @@ namespace hrgls {
       class DataBlobSource_private;
 
     private:
+      /// @cond INTERNAL
+      friend DataBlobMultiplexer;
+      friend DataBlobMerger;
+      friend DataBlobSourceGroup;
+
+      /// @brief Wraps a source that belongs to a DataBlobSourceGroup.
+      explicit DataBlobSource(DataBlobSource_private *info) : m_private(info) {}
+      /// @endcond
+
       DataBlobSource_private *m_private = nullptr;
     };
 
+    /// @brief Creates, starts and stops many DataBlobSources together.
+    ///
+    /// Bringing up thousands of sources one at a time costs several calls for each of them.
+    /// A group creates them all with the same StreamProperties, spreading the work across
+    /// the processor's cores, and turns streaming on or off for all of them at once.  The
+    /// sources are reached with operator[] and are used like any others, except that they
+    /// are destroyed along with the group.  The GetStatus() method should be called after
+    /// the constructor to make sure that every source was created.
+    class DataBlobSourceGroup {
+    public:
+      /// @brief Creates a DataBlobSource for each of a list of names.
+      /// @param [in] api API object that the DataBlobSources live inside.
+      /// @param [in] props Stream properties used by every source in the group.
+      /// @param [in] sources Names of the sources to create, as for the DataBlobSource
+      ///        constructor.  An empty list creates one for each of the DataBlobSources
+      ///        reported by API::GetAvailableDataBlobSources().  If any of them cannot be
+      ///        created the group is left empty and GetStatus() reports the first error.
+      DataBlobSourceGroup(
+        API &api,
+        StreamProperties &props,
+        const ::std::vector< ::std::string > &sources = ::std::vector< ::std::string >()
+      );
+
+      /// @brief Destroys the group and all of its DataBlobSources.
+      ~DataBlobSourceGroup();
+
+      DataBlobSourceGroup(const DataBlobSourceGroup &) = delete;
+      DataBlobSourceGroup &operator=(const DataBlobSourceGroup &) = delete;
+
+      /// @brief Returns the status of the most-recent operation and clears error/warnings.
+      /// @return hrgls_Status returned by the most-recent operation on the wrapped
+      ///         class, or other errors in case the object itself is broken.
+      hrgls_Status GetStatus();
+
+      /// @brief Number of DataBlobSources in the group.
+      size_t Size() const;
+
+      /// @brief One of the DataBlobSources, in the order of their names.
+      /// @param [in] which Index of the source, which must be less than Size().
+      DataBlobSource &operator[](size_t which);
+
+      /// @brief Sets the streaming state of every DataBlobSource in the group.
+      /// @param [in] running Set to true to begin streaming, false to stop.
+      /// @return hrgls_STATUS_OKAY on success, or the error from the first source that
+      ///         failed; the others are still set.  GetStatus() should not be called
+      ///         after this method.
+      hrgls_Status SetStreamingState(bool running);
+
+      /// @brief Private class declared for definition and use by the API implementation.
+      class DataBlobSourceGroup_private;
+
+    private:
+      DataBlobSourceGroup_private *m_private = nullptr;
+    };
+
+    /// @brief Waits for blobs from many DataBlobSources in a single place.
+    ///
+    /// Lets one thread service any number of DataBlobSources on the same API, rather
+    /// than needing a thread per source or a loop that polls each of them.  Sources
+    /// are registered with AddSource() along with an ID that is returned with each of
+    /// their blobs.  GetNextBlob() sleeps until any of them has a blob queued and
+    /// then takes turns among the sources that are ready, so a busy source cannot
+    /// starve the others.  Blobs are taken from the same queue as
+    /// DataBlobSource::GetNextBlob(), so sources that have a stream callback set
+    /// are never ready.  A source can be registered with more than one multiplexer.
+    /// The GetStatus() method should be called after each method (including the
+    /// constructor) to make sure that the operation was a success.
+    class DataBlobMultiplexer {
+    public:
+      /// @brief Creates a DataBlobMultiplexer with no sources.
+      /// @param [in] api API object that the sources to be added live inside.
+      DataBlobMultiplexer(API &api);
+
+      /// @brief Destroys a DataBlobMultiplexer, removing it from all of its sources.
+      ///
+      /// Must not be called while another thread is destroying one of the sources.
+      ~DataBlobMultiplexer();
+
+      DataBlobMultiplexer(const DataBlobMultiplexer &) = delete;
+      DataBlobMultiplexer &operator=(const DataBlobMultiplexer &) = delete;
+
+      /// @brief Returns the status of the most-recent operation and clears error/warnings.
+      /// @return hrgls_Status returned by the most-recent operation on the wrapped
+      ///         class, or other errors in case the object itself is broken.
+      hrgls_Status GetStatus();
+
+      /// @brief Registers a source to be waited on.
+      ///
+      /// A source that is destroyed is removed automatically.
+      /// @param [in] source DataBlobSource created on the same API as this multiplexer.
+      /// @param [in] sourceId Value returned by GetNextBlob() along with blobs from this
+      ///        source.  Chosen by the caller; it need not be unique.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+      ///         already registered or is on a different API, a specific error code on other
+      ///         failures.  GetStatus() should not be called after this method.
+      hrgls_Status AddSource(DataBlobSource &source, uint32_t sourceId);
+
+      /// @brief Stops waiting on a source.
+      /// @param [in] source DataBlobSource that was registered with AddSource().
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+      ///         not registered, a specific error code on other failures.
+      ///         GetStatus() should not be called after this method.
+      hrgls_Status RemoveSource(DataBlobSource &source);
+
+      /// @brief Reads the next-available blob from any of the registered sources.
+      /// @param [out] sourceId Set to the ID that the blob's source was registered with.
+      ///         Unchanged if no blob is returned.
+      /// @param [in] timeout How long to wait for a blob, default returns immediately
+      ///         if no blob is available.  The calling thread sleeps while waiting and
+      ///         is woken as soon as any of the sources queues a blob.
+      /// @return The next blob, or a blob with empty data if none is available;
+      ///         GetStatus() then reports hrgls_STATUS_TIMEOUT.
+      DataBlob GetNextBlob(uint32_t &sourceId, struct timeval timeout = {});
+
+      /// @brief Private class declared for definition and use by the API implementation.
+      class DataBlobMultiplexer_private;
+
+    private:
+      DataBlobMultiplexer_private *m_private = nullptr;
+    };
+
+    /// @brief Merges blobs from many DataBlobSources into one stream in Time() order.
+    ///
+    /// Used like a DataBlobMultiplexer, except that GetNextBlob() returns blobs in the
+    /// order of their DataBlob::Time() rather than as they arrive.  Each source is
+    /// expected to produce its blobs in time order, and a heap of the oldest blob held
+    /// from each source picks the next one.  That blob is returned as soon as every
+    /// registered source has a blob waiting, or once the system time is past its time
+    /// by the reorder window, so a quiet source holds the others back by no more than
+    /// the window.  A blob that arrives older than one already returned is late, and is
+    /// either dropped or returned at once depending on the hrgls_LateBlobPolicy.
+    /// The GetStatus() method should be called after each method (including the
+    /// constructor) to make sure that the operation was a success.
+    class DataBlobMerger {
+    public:
+      /// @brief Creates a DataBlobMerger with no sources.
+      /// @param [in] api API object that the sources to be added live inside.
+      /// @param [in] reorderWindow Longest time to hold a blob waiting for older ones
+      ///        from quiet sources.  Must not be negative.
+      /// @param [in] latePolicy One of the hrgls_LATE_BLOB_* values.
+      DataBlobMerger(API &api, struct timeval reorderWindow,
+        hrgls_LateBlobPolicy latePolicy = hrgls_LATE_BLOB_DROP);
+
+      /// @brief Destroys a DataBlobMerger, removing it from all of its sources.
+      ///
+      /// Must not be called while another thread is destroying one of the sources.
+      ~DataBlobMerger();
+
+      DataBlobMerger(const DataBlobMerger &) = delete;
+      DataBlobMerger &operator=(const DataBlobMerger &) = delete;
+
+      /// @brief Returns the status of the most-recent operation and clears error/warnings.
+      /// @return hrgls_Status returned by the most-recent operation on the wrapped
+      ///         class, or other errors in case the object itself is broken.
+      hrgls_Status GetStatus();
+
+      /// @brief Registers a source to be merged.
+      ///
+      /// A source that is destroyed is removed automatically once the blobs held
+      /// from it have been returned.
+      /// @param [in] source DataBlobSource created on the same API as this merger.
+      /// @param [in] sourceId Value returned by GetNextBlob() along with blobs from this
+      ///        source.  Chosen by the caller; it need not be unique.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+      ///         already registered or is on a different API, a specific error code on other
+      ///         failures.  GetStatus() should not be called after this method.
+      hrgls_Status AddSource(DataBlobSource &source, uint32_t sourceId);
+
+      /// @brief Stops merging a source, discarding any blobs held from it.
+      /// @param [in] source DataBlobSource that was registered with AddSource().
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_BAD_PARAMETER if the source is
+      ///         not registered, a specific error code on other failures.
+      ///         GetStatus() should not be called after this method.
+      hrgls_Status RemoveSource(DataBlobSource &source);
+
+      /// @brief Reads the next blob in time order from any of the registered sources.
+      /// @param [out] sourceId Set to the ID that the blob's source was registered with.
+      ///         Unchanged if no blob is returned.
+      /// @param [in] timeout How long to wait for a blob, default returns immediately
+      ///         if no blob is ready.  The calling thread sleeps while waiting.
+      /// @return The next blob, or a blob with empty data if none is ready;
+      ///         GetStatus() then reports hrgls_STATUS_TIMEOUT.
+      DataBlob GetNextBlob(uint32_t &sourceId, struct timeval timeout = {});
+
+      /// @brief Reports how many late blobs this merger has seen.
+      /// @return Number of blobs that arrived older than one already returned, whether
+      ///         they were dropped or delivered.
+      uint64_t GetLateBlobCount();
+
+      /// @brief Private class declared for definition and use by the API implementation.
+      class DataBlobMerger_private;
+
+    private:
+      DataBlobMerger_private *m_private = nullptr;
+    };
+
+    /// @brief Writes blobs to a recording that can be replayed by a DataBlobSource.
+    ///
+    /// Blobs from any source are appended with their times and data, and an index of
+    /// them is kept in a file alongside it (the file name followed by ".idx") so that
+    /// replay can seek by time.  A recording is replayed by constructing a DataBlobSource
+    /// named "/hrgls/replay/" followed by its file name.  The GetStatus() method should
+    /// be called after the constructor to make sure that the file was created.
+    class DataBlobRecorder {
+    public:
+      /// @brief Creates a recorder, replacing any file with the same name.
+      /// @param [in] fileName Name of the recording to write.
+      DataBlobRecorder(const ::std::string &fileName);
+
+      /// @brief Finishes the recording and destroys the recorder.
+      ~DataBlobRecorder();
+
+      DataBlobRecorder(const DataBlobRecorder &) = delete;
+      DataBlobRecorder &operator=(const DataBlobRecorder &) = delete;
+
+      /// @brief Returns the status of the most-recent operation and clears error/warnings.
+      /// @return hrgls_Status returned by the most-recent operation on the wrapped
+      ///         class, or other errors in case the object itself is broken.
+      hrgls_Status GetStatus();
+
+      /// @brief Appends a blob to the recording.
+      ///
+      /// May be called from several threads at once, including from stream callback
+      /// handlers.
+      /// @param [in] blob Blob to record.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if writing failed,
+      ///         a specific error code on other failures.  GetStatus() should not be
+      ///         called after this method.
+      hrgls_Status Record(const DataBlob &blob);
+
+      /// @brief Writes out everything that has been recorded so far, so that it can be
+      /// replayed.
+      /// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_FILE_ERROR if writing failed.
+      ///         GetStatus() should not be called after this method.
+      hrgls_Status Flush();
+
+      /// @brief Private class declared for definition and use by the API implementation.
+      class DataBlobRecorder_private;
+
+    private:
+      DataBlobRecorder_private *m_private = nullptr;
+    };
+
   } // End datablob namespace
 
 } // End hrgls namespace
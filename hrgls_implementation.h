@@ -0,0 +1,350 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * @file hrgls_implementation.h
+ * @brief Function table through which implementations loaded at run time are called.
+ *
+ * An implementation of the API can be built as a shared library of its own and named
+ * by hrgls_APICreateParametersSetImplementation() rather than being linked into the
+ * program.  Such a library exports hrgls_GetImplementation(), which returns a table of
+ * pointers to its versions of all of the functions in hrgls_api.h.  The library that the
+ * program is linked against loads it and passes calls on through the table.
+ *
+ * So that calls can be passed on, every opaque handle that an implementation returns
+ * must point to a structure whose first member is a pointer to that implementation's
+ * table.  Functions that are given a handle use it to find the implementation that made
+ * it; the handle-less creation functions (hrgls_DataBlobCreate() and the like) and the
+ * handle pools always use the linked implementation.  Objects from different
+ * implementations cannot be mixed, for example by adding a DataBlobSource to a
+ * DataBlobMultiplexer from another.  A library built from hrgls_internal_wrap.cpp meets
+ * these requirements; on ELF platforms it must be linked with -Bsymbolic so that its
+ * calls to its own functions are not bound to those of the library that loaded it.
+ */
+
+#include <hrgls_api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Version of the function table described here.
+///
+/// Later versions only add functions to the end of the table, so an implementation
+/// that provides a later version can be used by a loader that asks for an earlier one.
+#define hrgls_IMPLEMENTATION_VERSION (11)
+
+/// @brief Name of the function that a loadable implementation exports.
+#define hrgls_IMPLEMENTATION_ENTRY_POINT "hrgls_GetImplementation"
+
+/// @brief Table of an implementation's functions, one for each function in hrgls_api.h
+/// with the hrgls_ prefix removed from its name.
+typedef struct hrgls_Implementation_ {
+  /// Version of the table, at least the one that was asked for.
+  uint32_t version;
+
+  // Error handling.
+  const char *(*ErrorMessage)(hrgls_Status status);
+
+  // Log messages.
+  hrgls_Status (*MessageCreate)(hrgls_Message *returnMessage);
+  hrgls_Status (*MessageCopy)(hrgls_Message *returnMessage, hrgls_Message MessageToCopy);
+  hrgls_Status (*MessageDestroy)(hrgls_Message obj);
+  hrgls_Status (*MessageGetValue)(hrgls_Message obj, const char **val);
+  hrgls_Status (*MessageSetValue)(hrgls_Message obj, const char *val);
+  hrgls_Status (*MessageGetTimeStamp)(hrgls_Message obj, struct timeval *val);
+  hrgls_Status (*MessageSetTimeStamp)(hrgls_Message obj, struct timeval val);
+  hrgls_Status (*MessageGetLevel)(hrgls_Message obj, hrgls_MessageLevel *val);
+  hrgls_Status (*MessageSetLevel)(hrgls_Message obj, hrgls_MessageLevel val);
+
+  // API creation parameters.
+  hrgls_Status (*APICreateParametersCreate)(hrgls_APICreateParams *returnParams);
+  hrgls_Status (*APICreateParametersDestroy)(hrgls_APICreateParams params);
+  hrgls_Status (*APICreateParametersGetName)(hrgls_APICreateParams params,
+    const char **returnName);
+  hrgls_Status (*APICreateParametersSetName)(hrgls_APICreateParams params,
+    const char *name);
+  hrgls_Status (*APICreateParametersGetCredentials)(hrgls_APICreateParams params,
+    const uint8_t **returnCredentials, uint32_t *returnSize);
+  hrgls_Status (*APICreateParametersSetCredentials)(hrgls_APICreateParams params,
+    const uint8_t *credentials, uint32_t size);
+  hrgls_Status (*APICreateParametersGetCallbackThreads)(hrgls_APICreateParams params,
+    uint32_t *returnCount);
+  hrgls_Status (*APICreateParametersSetCallbackThreads)(hrgls_APICreateParams params,
+    uint32_t count);
+  hrgls_Status (*APICreateParametersGetEndpoint)(hrgls_APICreateParams params,
+    const char **returnEndpoint);
+  hrgls_Status (*APICreateParametersSetEndpoint)(hrgls_APICreateParams params,
+    const char *endpoint);
+  hrgls_Status (*APICreateParametersGetImplementation)(hrgls_APICreateParams params,
+    const char **returnImplementation);
+  hrgls_Status (*APICreateParametersSetImplementation)(hrgls_APICreateParams params,
+    const char *implementation);
+
+  // APIs and the DataBlobSources they list.
+  hrgls_Status (*APICreate)(hrgls_API *returnAPI, hrgls_APICreateParams params);
+  hrgls_Status (*APIDestroy)(hrgls_API api);
+  hrgls_Status (*APIGetVersion)(hrgls_API api, hrgls_VERSION *returnVersion);
+  hrgls_Status (*APIGetCurrentSystemTime)(hrgls_API api, struct timeval *returnTime);
+  hrgls_Status (*APIGetVerbosity)(hrgls_API api, uint16_t *returnVerbosity);
+  hrgls_Status (*APISetVerbosity)(hrgls_API api, uint16_t verbosity);
+  hrgls_Status (*APIDataBlobSourceGetName)(hrgls_APIDataBlobSourceInfo info,
+    const char **returnName);
+  hrgls_Status (*APIGetAvailableDataBlobSourceCount)(hrgls_API api, uint32_t *returnCount);
+  hrgls_Status (*APIGetAvailableDataBlobSourceInfo)(hrgls_API api, uint32_t which,
+    hrgls_APIDataBlobSourceInfo *returnInfo);
+  hrgls_Status (*APISetLogMessageStreamingState)(hrgls_API api, bool running);
+  hrgls_Status (*APISetLogMessageCallback)(hrgls_API api, hrgls_LogMessageCallback handler,
+    void *userData);
+  hrgls_Status (*APIGetNextLogMessage)(hrgls_API api, hrgls_Message *message);
+  hrgls_Status (*APIGetDroppedLogMessageCount)(hrgls_API api, uint64_t *count);
+  hrgls_Status (*APISetLogMessageMinimumLevel)(hrgls_API api, hrgls_MessageLevel level);
+  hrgls_Status (*APIStartServer)(hrgls_API api, const char *endpoint, uint16_t *returnPort);
+  hrgls_Status (*APIAddReplayFile)(hrgls_API api, const char *fileName);
+
+  // Stream properties.
+  hrgls_Status (*StreamPropertiesCreate)(hrgls_StreamProperties *returnProp);
+  hrgls_Status (*StreamPropertiesDestroy)(hrgls_StreamProperties prop);
+  hrgls_Status (*StreamPropertiesGetRate)(hrgls_StreamProperties prop, double *val);
+  hrgls_Status (*StreamPropertiesSetRate)(hrgls_StreamProperties prop, double val);
+  hrgls_Status (*StreamPropertiesGetQueueCapacity)(hrgls_StreamProperties prop,
+    uint32_t *val);
+  hrgls_Status (*StreamPropertiesSetQueueCapacity)(hrgls_StreamProperties prop,
+    uint32_t val);
+  hrgls_Status (*StreamPropertiesGetOverflowPolicy)(hrgls_StreamProperties prop,
+    hrgls_OverflowPolicy *val);
+  hrgls_Status (*StreamPropertiesSetOverflowPolicy)(hrgls_StreamProperties prop,
+    hrgls_OverflowPolicy val);
+
+  // DataBlobs.
+  hrgls_Status (*DataBlobCreate)(hrgls_DataBlob *returnBlob);
+  hrgls_Status (*DataBlobCopy)(hrgls_DataBlob *returnBlob, hrgls_DataBlob blobToCopy);
+  hrgls_Status (*DataBlobDestroy)(hrgls_DataBlob blob);
+  hrgls_Status (*DataBlobGetTime)(hrgls_DataBlob blob, struct timeval *val);
+  hrgls_Status (*DataBlobSetTime)(hrgls_DataBlob blob, struct timeval val);
+  hrgls_Status (*DataBlobGetData)(hrgls_DataBlob blob, const uint8_t **data,
+    uint32_t *size);
+  hrgls_Status (*DataBlobSetData)(hrgls_DataBlob blob, const uint8_t *data, uint32_t size,
+    hrgls_DeletionFunction deleteFunction, void *userData);
+  hrgls_Status (*DataBlobRetainData)(hrgls_DataBlob blob);
+  hrgls_Status (*DataBlobReleaseData)(hrgls_DataBlob blob);
+  hrgls_Status (*DataBlobGetDataReferenceCount)(hrgls_DataBlob blob, uint32_t *count);
+
+  // Handle pools.
+  hrgls_Status (*HandlePoolGetStatistics)(hrgls_HandlePoolType type, uint64_t *hits,
+    uint64_t *misses);
+  hrgls_Status (*HandlePoolReserve)(hrgls_HandlePoolType type, uint32_t count);
+
+  // Buffer pools.
+  hrgls_Status (*BufferPoolCreate)(hrgls_BufferPool *returnPool, uint32_t bufferSize,
+    uint32_t maxFreeBuffers);
+  hrgls_Status (*BufferPoolDestroy)(hrgls_BufferPool pool);
+  hrgls_Status (*BufferPoolAcquire)(hrgls_BufferPool pool, uint32_t size,
+    uint8_t **returnBuffer);
+  void (*BufferPoolReturn)(void *pool, const uint8_t *buffer);
+  hrgls_Status (*BufferPoolGetStatistics)(hrgls_BufferPool pool, uint64_t *hits,
+    uint64_t *misses);
+  hrgls_Status (*APIGetBufferPool)(hrgls_API api, hrgls_BufferPool *returnPool);
+
+  // DataBlobSource creation parameters.
+  hrgls_Status (*DataBlobSourceCreateParametersCreate)(
+    hrgls_DataBlobSourceCreateParams *returnParams);
+  hrgls_Status (*DataBlobSourceCreateParametersDestroy)(
+    hrgls_DataBlobSourceCreateParams params);
+  hrgls_Status (*DataBlobSourceCreateParametersSetAPI)(
+    hrgls_DataBlobSourceCreateParams params, hrgls_API api);
+  hrgls_Status (*DataBlobSourceCreateParametersSetName)(
+    hrgls_DataBlobSourceCreateParams params, const char *name);
+  hrgls_Status (*DataBlobSourceCreateParametersSetStreamProperties)(
+    hrgls_DataBlobSourceCreateParams params, hrgls_StreamProperties properties);
+
+  // DataBlobSources.
+  hrgls_Status (*DataBlobSourceCreate)(hrgls_DataBlobSource *returnStream,
+    hrgls_DataBlobSourceCreateParams params);
+  hrgls_Status (*DataBlobSourceDestroy)(hrgls_DataBlobSource stream);
+  hrgls_Status (*DataBlobSourceSetStreamingState)(hrgls_DataBlobSource stream,
+    bool running);
+  hrgls_Status (*DataBlobSourceSetStreamCallback)(hrgls_DataBlobSource stream,
+    hrgls_DataBlobSourceCallback handler, void *userData);
+  hrgls_Status (*DataBlobSourceGetNextBlob)(hrgls_DataBlobSource stream,
+    hrgls_DataBlob *blob, struct timeval timeout);
+  hrgls_Status (*DataBlobSourceGetPendingBlobs)(hrgls_DataBlobSource stream,
+    hrgls_DataBlob *blobs, uint32_t maxNum, uint32_t *returnCount, struct timeval timeout);
+  hrgls_Status (*DataBlobSourceGetDroppedBlobCount)(hrgls_DataBlobSource stream,
+    uint64_t *count);
+  hrgls_Status (*DataBlobSourceGetNextBlobAsync)(hrgls_DataBlobSource stream,
+    hrgls_DataBlobRequest *returnRequest);
+  hrgls_Status (*DataBlobRequestDestroy)(hrgls_DataBlobRequest request);
+  hrgls_Status (*DataBlobRequestIsReady)(hrgls_DataBlobRequest request, bool *ready);
+  hrgls_Status (*DataBlobRequestWait)(hrgls_DataBlobRequest request, hrgls_DataBlob *blob,
+    struct timeval timeout);
+  hrgls_Status (*DataBlobSourceGetNotificationFD)(hrgls_DataBlobSource stream, int *fd);
+  hrgls_Status (*DataBlobSourcePublishSharedMemory)(hrgls_DataBlobSource stream,
+    const char *name);
+  hrgls_Status (*DataBlobSourceGetInfo)(hrgls_DataBlobSource stream,
+    hrgls_APIDataBlobSourceInfo *returnInfo);
+  hrgls_Status (*DataBlobSourceSetReplayPacing)(hrgls_DataBlobSource stream,
+    hrgls_ReplayPacing pacing);
+  hrgls_Status (*DataBlobSourceSeekReplay)(hrgls_DataBlobSource stream,
+    struct timeval time);
+
+  // DataBlobMultiplexers.
+  hrgls_Status (*DataBlobMultiplexerCreate)(hrgls_DataBlobMultiplexer *returnMultiplexer,
+    hrgls_API api);
+  hrgls_Status (*DataBlobMultiplexerDestroy)(hrgls_DataBlobMultiplexer multiplexer);
+  hrgls_Status (*DataBlobMultiplexerAddSource)(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlobSource stream, uint32_t sourceId);
+  hrgls_Status (*DataBlobMultiplexerRemoveSource)(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlobSource stream);
+  hrgls_Status (*DataBlobMultiplexerGetNextBlob)(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlob *blob, uint32_t *sourceId, struct timeval timeout);
+
+  // DataBlobRecorders.
+  hrgls_Status (*DataBlobRecorderCreate)(hrgls_DataBlobRecorder *returnRecorder,
+    const char *fileName);
+  hrgls_Status (*DataBlobRecorderDestroy)(hrgls_DataBlobRecorder recorder);
+  hrgls_Status (*DataBlobRecorderRecord)(hrgls_DataBlobRecorder recorder,
+    hrgls_DataBlob blob);
+  hrgls_Status (*DataBlobRecorderFlush)(hrgls_DataBlobRecorder recorder);
+
+  // Added in version 2: load generation.
+  hrgls_Status (*APICreateParametersGetSourceCount)(hrgls_APICreateParams params,
+    uint32_t *returnCount);
+  hrgls_Status (*APICreateParametersSetSourceCount)(hrgls_APICreateParams params,
+    uint32_t count);
+  hrgls_Status (*APICreateParametersGetMessageRate)(hrgls_APICreateParams params,
+    double *returnRate);
+  hrgls_Status (*APICreateParametersSetMessageRate)(hrgls_APICreateParams params,
+    double rate);
+  hrgls_Status (*APICreateParametersGetMessageLevel)(hrgls_APICreateParams params,
+    hrgls_MessageLevel *returnLevel);
+  hrgls_Status (*APICreateParametersSetMessageLevel)(hrgls_APICreateParams params,
+    hrgls_MessageLevel level);
+  hrgls_Status (*StreamPropertiesGetPayloadSize)(hrgls_StreamProperties prop, uint32_t *val);
+  hrgls_Status (*StreamPropertiesSetPayloadSize)(hrgls_StreamProperties prop, uint32_t val);
+  hrgls_Status (*StreamPropertiesGetPayloadDistribution)(hrgls_StreamProperties prop,
+    hrgls_PayloadDistribution *val);
+  hrgls_Status (*StreamPropertiesSetPayloadDistribution)(hrgls_StreamProperties prop,
+    hrgls_PayloadDistribution val);
+  hrgls_Status (*StreamPropertiesGetBurstLength)(hrgls_StreamProperties prop, uint32_t *val);
+  hrgls_Status (*StreamPropertiesSetBurstLength)(hrgls_StreamProperties prop, uint32_t val);
+
+  // Added in version 3: statistics.
+  hrgls_Status (*StreamStatisticsCreate)(hrgls_StreamStatistics *returnStats);
+  hrgls_Status (*StreamStatisticsDestroy)(hrgls_StreamStatistics stats);
+  hrgls_Status (*StreamStatisticsGetProduced)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetDelivered)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetDropped)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetQueueDepth)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetMaxQueueDepth)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetLatencyTotal)(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds);
+  hrgls_Status (*StreamStatisticsGetLatencyMax)(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds);
+  hrgls_Status (*StreamStatisticsGetLatencyHistogram)(hrgls_StreamStatistics stats,
+    uint64_t *counts, uint32_t size);
+  hrgls_Status (*StreamStatisticsGetCallbacks)(hrgls_StreamStatistics stats,
+    uint64_t *returnCount);
+  hrgls_Status (*StreamStatisticsGetCallbackDurationTotal)(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds);
+  hrgls_Status (*StreamStatisticsGetCallbackDurationMax)(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds);
+  hrgls_Status (*StreamStatisticsGetCallbackDurationHistogram)(hrgls_StreamStatistics stats,
+    uint64_t *counts, uint32_t size);
+  hrgls_Status (*APIGetLogMessageStatistics)(hrgls_API api, hrgls_StreamStatistics stats);
+  hrgls_Status (*DataBlobSourceGetStatistics)(hrgls_DataBlobSource stream,
+    hrgls_StreamStatistics stats);
+
+  // Added in version 4: borrowed log messages.
+  hrgls_Status (*MessageSetStaticValue)(hrgls_Message obj, const char *val);
+  hrgls_Status (*InternString)(const char *val, const char **returnInterned);
+  hrgls_Status (*APISetLogMessageViewCallback)(hrgls_API api,
+    hrgls_LogMessageViewCallback handler, void *userData);
+
+  // Added in version 5: tracing.  Like the handle pools, these are handle-less and are
+  // always called in the implementation that the program is linked against.
+  hrgls_Status (*TraceStart)(uint32_t eventsPerThread);
+  hrgls_Status (*TraceStop)(void);
+  void (*TraceRecord)(hrgls_TraceEventType type, uint64_t object, uint64_t value);
+  hrgls_Status (*TraceDump)(const char *fileName);
+
+  // Added in version 6: tracking changes to the list of DataBlobSources.
+  hrgls_Status (*APIGetDataBlobSourceGeneration)(hrgls_API api, uint64_t *returnGeneration);
+  hrgls_Status (*APISetDataBlobSourcesChangedCallback)(hrgls_API api,
+    hrgls_DataBlobSourcesChangedCallback handler, void *userData);
+
+  // Added in version 7: groups of DataBlobSources.
+  hrgls_Status (*DataBlobSourceGroupCreate)(hrgls_DataBlobSourceGroup *returnGroup,
+    hrgls_DataBlobSourceCreateParams params, const char * const *names, uint32_t count);
+  hrgls_Status (*DataBlobSourceGroupDestroy)(hrgls_DataBlobSourceGroup group);
+  hrgls_Status (*DataBlobSourceGroupGetCount)(hrgls_DataBlobSourceGroup group,
+    uint32_t *returnCount);
+  hrgls_Status (*DataBlobSourceGroupGetSource)(hrgls_DataBlobSourceGroup group,
+    uint32_t which, hrgls_DataBlobSource *returnStream);
+  hrgls_Status (*DataBlobSourceGroupSetStreamingState)(hrgls_DataBlobSourceGroup group,
+    bool running);
+
+  // Added in version 8: DataBlobs made of several segments.
+  hrgls_Status (*DataBlobSetSegments)(hrgls_DataBlob blob,
+    const hrgls_DataBlobSegment *segments, uint32_t count);
+  hrgls_Status (*DataBlobGetSegmentCount)(hrgls_DataBlob blob, uint32_t *count);
+  hrgls_Status (*DataBlobGetSegment)(hrgls_DataBlob blob, uint32_t which,
+    const uint8_t **data, uint64_t *size);
+  hrgls_Status (*DataBlobGetTotalSize)(hrgls_DataBlob blob, uint64_t *size);
+
+  // Added in version 9: buffers provided by the client.
+  hrgls_Status (*DataBlobSourceProvideBuffers)(hrgls_DataBlobSource stream,
+    uint8_t * const *buffers, uint32_t count, uint32_t size,
+    hrgls_DeletionFunction returnFunction, void *userData);
+
+  // Added in version 10: changing stream properties while streaming.
+  hrgls_Status (*DataBlobSourceSetStreamProperties)(hrgls_DataBlobSource stream,
+    hrgls_StreamProperties props);
+
+  // Added in version 11: merging DataBlobSources in time order.
+  hrgls_Status (*DataBlobMergerCreate)(hrgls_DataBlobMerger *returnMerger, hrgls_API api,
+    struct timeval reorderWindow, hrgls_LateBlobPolicy latePolicy);
+  hrgls_Status (*DataBlobMergerDestroy)(hrgls_DataBlobMerger merger);
+  hrgls_Status (*DataBlobMergerAddSource)(hrgls_DataBlobMerger merger,
+    hrgls_DataBlobSource stream, uint32_t sourceId);
+  hrgls_Status (*DataBlobMergerRemoveSource)(hrgls_DataBlobMerger merger,
+    hrgls_DataBlobSource stream);
+  hrgls_Status (*DataBlobMergerGetNextBlob)(hrgls_DataBlobMerger merger, hrgls_DataBlob *blob,
+    uint32_t *sourceId, struct timeval timeout);
+  hrgls_Status (*DataBlobMergerGetLateBlobCount)(hrgls_DataBlobMerger merger, uint64_t *count);
+
+} hrgls_Implementation;
+
+/// @brief Type of hrgls_GetImplementation(), for looking it up in a loaded library.
+typedef const hrgls_Implementation *(*hrgls_GetImplementationFunction)(uint32_t version);
+
+/// @brief Get the function table for the implementation in this library.
+/// @param [in] version Version of the table that the caller was built against,
+///        normally hrgls_IMPLEMENTATION_VERSION.
+/// @return Table that is valid as long as the library is loaded, or NULL if the
+///         implementation does not provide that version.
+HRGLS_EXPORT const hrgls_Implementation *hrgls_GetImplementation(uint32_t version);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,11 +19,35 @@
 #include "hrgls_api_defs.hpp"
 #include "hrgls_DataBlob_impl.hpp"
 #include "hrgls_Message_impl.hpp"
+#include "hrgls_PerThread_impl.hpp"
+#include "hrgls_implementation.h"
+#include "hrgls_Handle_impl.hpp"
 #include <string.h>
+#include <algorithm>
 #include <iostream>
 #include <math.h>
-#include <map>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <cstddef>
+#include <map>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
 
 //----------------------------------------------------------------------------
 // Static callback handler function that takes in a C++ callback for a message
@@ -32,6 +56,11 @@
 // info has been defined.
 static void LogMessageCallback(hrgls::Message &message, void *userData);
 
+//----------------------------------------------------------------------------
+// Static callback handler function that passes a borrowed log message from the
+// C++ callback on to a C one.  Declared here and defined later, like the above.
+static void LogMessageViewCallback(const hrgls::MessageView &message, void *userData);
+
 //----------------------------------------------------------------------------
 // Static callback handler function that takes in a C++ callback for a stream
 // and a pointer to the info needed to turn it into a C callback.
@@ -39,6 +68,495 @@ static void LogMessageCallback(hrgls::Message &message, void *userData);
 // info has been defined.
 static void DataBlobSourceCallback(hrgls::datablob::DataBlob &blob, void *userData);
 
+//----------------------------------------------------------------------------
+/// @brief Recycles the memory for one type of C handle structure.
+///
+/// Handles are created and destroyed for every blob and message that passes
+/// through the API, often by several threads at once.  Rather than going to the
+/// heap each time, freed handles are kept on a small per-thread free list, so
+/// the common case of a thread destroying handles and then creating more takes
+/// no lock.  Threads that build up more than they use hand the excess to a
+/// shared list that other threads refill from.  There is one library-wide pool
+/// per handle type because the handle functions are not tied to an hrgls_API.
+template <class T>
+class HandlePool {
+public:
+  /// @brief The pool for this handle type.  It is never destroyed, so handles can
+  /// safely be freed by threads that are still running at program exit.
+  static HandlePool &Get()
+  {
+    static HandlePool *pool = new HandlePool;
+    return *pool;
+  }
+
+  /// @brief Construct a default-initialized handle.  Throws std::bad_alloc on failure.
+  T *Create()
+  {
+    void *mem = Take();
+    if (mem) {
+      m_hits++;
+    } else {
+      m_misses++;
+      mem = ::operator new(sizeof(Node));
+    }
+    return new (mem) T();
+  }
+
+  /// @brief Destroy a handle created by Create(), keeping its memory for reuse.
+  void Destroy(T *obj)
+  {
+    obj->~T();
+    Give(obj);
+  }
+
+  /// @brief Make sure that at least count handles can be created without allocating.
+  void Reserve(size_t count)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_sharedCount < count) {
+      Node *n = static_cast<Node*>(::operator new(sizeof(Node)));
+      n->next = m_shared;
+      m_shared = n;
+      m_sharedCount++;
+    }
+  }
+
+  uint64_t Hits() const { return m_hits.load(); }
+  uint64_t Misses() const { return m_misses.load(); }
+
+private:
+  /// Free memory is threaded through a list of nodes big enough for a T.
+  union Node {
+    Node *next;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  /// Handles freed by one thread, returned to the shared list at thread exit.
+  struct Cache {
+    Node *head = nullptr;
+    size_t count = 0;
+    ~Cache() { HandlePool::Get().GiveShared(head); }
+  };
+
+  static const size_t LocalMax = 64;      ///< Most handles kept per thread.
+  static const size_t SharedMax = 4096;   ///< Most handles kept in the shared list.
+
+  static Cache &Local()
+  {
+    static thread_local Cache cache;
+    return cache;
+  }
+
+  void *Take()
+  {
+    Cache &c = Local();
+    if (!c.head) {
+      // Refill half of our local list from the shared one.
+      std::lock_guard<std::mutex> lock(m_mutex);
+      while (m_shared && (c.count < LocalMax / 2)) {
+        Node *n = m_shared;
+        m_shared = n->next;
+        m_sharedCount--;
+        n->next = c.head;
+        c.head = n;
+        c.count++;
+      }
+    }
+    Node *n = c.head;
+    if (n) {
+      c.head = n->next;
+      c.count--;
+    }
+    return n;
+  }
+
+  void Give(void *mem)
+  {
+    Cache &c = Local();
+    Node *n = static_cast<Node*>(mem);
+    n->next = c.head;
+    c.head = n;
+    if (++c.count > LocalMax) {
+      // Hand the oldest half of our list to the shared one.
+      Node *keep = c.head;
+      for (size_t i = 1; i < LocalMax / 2; i++) {
+        keep = keep->next;
+      }
+      Node *rest = keep->next;
+      keep->next = nullptr;
+      GiveShared(rest);
+      c.count = LocalMax / 2;
+    }
+  }
+
+  void GiveShared(Node *list)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (list) {
+      Node *n = list;
+      list = n->next;
+      if (m_sharedCount < SharedMax) {
+        n->next = m_shared;
+        m_shared = n;
+        m_sharedCount++;
+      } else {
+        ::operator delete(n);
+      }
+    }
+  }
+
+  std::mutex m_mutex;
+  Node *m_shared = nullptr;
+  size_t m_sharedCount = 0;
+  std::atomic<uint64_t> m_hits{ 0 };
+  std::atomic<uint64_t> m_misses{ 0 };
+};
+
+//----------------------------------------------------------------------------
+/// @brief Per-thread rings of trace events, behind the hrgls_Trace* functions.
+///
+/// Each thread that records an event is given a ring of its own that only it writes,
+/// so recording takes no lock and no atomic read-modify-write operation: the thread
+/// stores the event and then publishes the ring's new count of events.  A thread that
+/// exits leaves its ring to be dumped, and the ring is reused by the next thread that
+/// needs one.  Dump() copies each ring while its thread may still be writing to it and
+/// then throws away the entries that may have been overwritten while it copied them.
+/// Timestamps are read from the processor's time-stamp counter where there is one and
+/// converted to nanoseconds when the rings are dumped.
+class TraceRecorder {
+public:
+  /// @brief The library's recorder.  It is never destroyed, so that threads that are
+  /// still running at program exit can record and give up their rings.
+  static TraceRecorder &Get()
+  {
+    static TraceRecorder *recorder = new TraceRecorder;
+    return *recorder;
+  }
+
+  bool Enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  /// @brief Start recording into rings of the given size, clearing all rings.
+  void Start(uint32_t eventsPerThread)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity.store(eventsPerThread > 0 ? eventsPerThread : DefaultCapacity);
+    m_startTicks = Ticks();
+    m_startNanoseconds = SteadyNanoseconds();
+    m_generation.fetch_add(1);
+    m_enabled.store(true);
+  }
+
+  void Stop() { m_enabled.store(false); }
+
+  /// @brief Store an event in the calling thread's ring.
+  void Record(hrgls_TraceEventType type, uint64_t object, uint64_t value)
+  {
+    Ring *r = MyRing();
+    if (!r) {
+      return;
+    }
+    uint64_t i = r->count.load(std::memory_order_relaxed);
+    Slot &s = r->slots[i % r->slotCount];
+
+    // Readers that see any of these stores also see the count from before them.
+    std::atomic_thread_fence(std::memory_order_release);
+    s.time.store(Ticks(), std::memory_order_relaxed);
+    s.object.store(object, std::memory_order_relaxed);
+    s.value.store(value, std::memory_order_relaxed);
+    s.threadAndType.store((static_cast<uint64_t>(type) << 32) | r->thread,
+      std::memory_order_relaxed);
+    r->count.store(i + 1, std::memory_order_release);
+  }
+
+  /// @brief Write all rings' events from the current generation to a file.
+  hrgls_Status Dump(const char *fileName)
+  {
+    std::vector<hrgls_TraceEvent> events;
+    std::vector<const char *> names;
+    std::map<uint64_t, uint64_t> nameIndices;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      uint64_t generation = m_generation.load();
+      uint64_t ticks = Ticks() - m_startTicks;
+      uint64_t nanoseconds = SteadyNanoseconds() - m_startNanoseconds;
+      double scale = ticks > 0 ? static_cast<double>(nanoseconds) / ticks : 1;
+      for (Ring *r : m_rings) {
+        if (r->generation.load() != generation) {
+          continue;
+        }
+        size_t first = events.size();
+        uint64_t end = r->count.load(std::memory_order_acquire);
+        uint64_t begin = end > r->capacity ? end - r->capacity : 0;
+        for (uint64_t i = begin; i < end; i++) {
+          const Slot &s = r->slots[i % r->slotCount];
+          hrgls_TraceEvent e = {};
+          uint64_t time = s.time.load(std::memory_order_relaxed);
+          e.time = time > m_startTicks ? static_cast<uint64_t>((time - m_startTicks) * scale) : 0;
+          e.object = s.object.load(std::memory_order_relaxed);
+          e.value = s.value.load(std::memory_order_relaxed);
+          uint64_t threadAndType = s.threadAndType.load(std::memory_order_relaxed);
+          e.thread = static_cast<uint32_t>(threadAndType);
+          e.type = static_cast<hrgls_TraceEventType>(threadAndType >> 32);
+          events.push_back(e);
+        }
+
+        // The thread may have overwritten the oldest entries while we read them: it may be
+        // writing entry count, in the slot of entry count - slotCount, or any after it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = r->count.load(std::memory_order_relaxed);
+        uint64_t valid = now >= r->slotCount ? now - r->slotCount + 1 : 0;
+        if (valid > begin) {
+          size_t drop = static_cast<size_t>(std::min(valid - begin, end - begin));
+          events.erase(events.begin() + first, events.begin() + first + drop);
+        }
+      }
+
+      // The names of C functions were recorded as pointers to their static text.
+      for (hrgls_TraceEvent &e : events) {
+        if (e.type == hrgls_TRACE_C_ENTER || e.type == hrgls_TRACE_C_EXIT) {
+          auto found = nameIndices.find(e.value);
+          if (found == nameIndices.end()) {
+            found = nameIndices.insert(std::make_pair(e.value, names.size())).first;
+            names.push_back(reinterpret_cast<const char *>(e.value));
+          }
+          e.value = found->second;
+        }
+      }
+    }
+
+    FILE *f = fopen(fileName, "wb");
+    if (!f) {
+      return hrgls_STATUS_FILE_ERROR;
+    }
+    bool ok = fwrite("HRGLSTRC", 1, 8, f) == 8;
+    uint32_t version = 1;
+    uint32_t nameCount = static_cast<uint32_t>(names.size());
+    ok = ok && fwrite(&version, sizeof(version), 1, f) == 1;
+    ok = ok && fwrite(&nameCount, sizeof(nameCount), 1, f) == 1;
+    for (const char *name : names) {
+      uint32_t length = static_cast<uint32_t>(strlen(name));
+      ok = ok && fwrite(&length, sizeof(length), 1, f) == 1;
+      ok = ok && fwrite(name, 1, length, f) == length;
+    }
+    uint64_t eventCount = events.size();
+    ok = ok && fwrite(&eventCount, sizeof(eventCount), 1, f) == 1;
+    ok = ok && (events.empty() ||
+      fwrite(events.data(), sizeof(hrgls_TraceEvent), events.size(), f) == events.size());
+    ok = (fclose(f) == 0) && ok;
+    return ok ? hrgls_STATUS_OKAY : hrgls_STATUS_FILE_ERROR;
+  }
+
+private:
+  static const uint32_t DefaultCapacity = 16384;
+
+  /// One event, stored in atomics so that it can be read while it is being written.
+  struct Slot {
+    std::atomic<uint64_t> time{ 0 };
+    std::atomic<uint64_t> object{ 0 };
+    std::atomic<uint64_t> value{ 0 };
+    std::atomic<uint64_t> threadAndType{ 0 };
+  };
+
+  /// Keeps the newest capacity events, with one more slot for the event that its thread
+  /// may be in the middle of writing while the ring is dumped.
+  struct Ring {
+    explicit Ring(uint32_t size)
+      : capacity(size), slotCount(uint64_t(size) + 1), slots(new Slot[slotCount]) {}
+    const uint32_t capacity;
+    const uint64_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> count{ 0 };       ///< Events ever stored since it was cleared.
+    std::atomic<uint64_t> generation{ 0 };  ///< Start() that it was last cleared for.
+    std::atomic<bool> owned{ true };        ///< Whether a running thread is using it.
+    uint32_t thread = 0;                    ///< Number of the thread that last used it.
+  };
+
+  /// The calling thread's ring and number.
+  struct Owner {
+    Ring *ring = nullptr;
+    uint32_t thread = 0;
+    ~Owner()
+    {
+      if (ring) {
+        ring->owned.store(false);
+      }
+    }
+  };
+
+  static Owner &Local()
+  {
+    static thread_local Owner owner;
+    return owner;
+  }
+
+  static uint64_t SteadyNanoseconds()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static uint64_t Ticks()
+  {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return SteadyNanoseconds();
+#endif
+  }
+
+  /// The calling thread's ring, cleared for the current generation, or nullptr if one
+  /// could not be allocated.
+  Ring *MyRing()
+  {
+    Owner &o = Local();
+    uint64_t generation = m_generation.load(std::memory_order_relaxed);
+    if (o.ring && o.ring->generation.load(std::memory_order_relaxed) == generation) {
+      return o.ring;
+    }
+    if (o.thread == 0) {
+      o.thread = m_nextThread.fetch_add(1) + 1;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t capacity = m_capacity.load();
+    if (o.ring && o.ring->capacity != capacity) {
+      o.ring->owned.store(false);
+      o.ring = nullptr;
+    }
+    for (size_t i = 0; !o.ring && i < m_rings.size(); i++) {
+      bool owned = false;
+      if (m_rings[i]->capacity == capacity &&
+          m_rings[i]->owned.compare_exchange_strong(owned, true)) {
+        o.ring = m_rings[i];
+      }
+    }
+    if (!o.ring) {
+      try {
+        m_rings.push_back(new Ring(capacity));
+      } catch (...) {
+        return nullptr;
+      }
+      o.ring = m_rings.back();
+    }
+    o.ring->thread = o.thread;
+    o.ring->count.store(0);
+    o.ring->generation.store(m_generation.load());
+    return o.ring;
+  }
+
+  std::atomic<bool> m_enabled{ false };
+  std::atomic<uint64_t> m_generation{ 0 };
+  std::atomic<uint32_t> m_capacity{ DefaultCapacity };
+  std::atomic<uint32_t> m_nextThread{ 0 };
+
+  /// Guards the list of rings and the start time.
+  std::mutex m_mutex;
+  std::vector<Ring *> m_rings;
+  uint64_t m_startTicks = 0;
+  uint64_t m_startNanoseconds = 0;
+};
+
+/// @brief Records entry to a C function when constructed and exit when destroyed.
+struct hrgls_TraceScope {
+  hrgls_TraceScope(const char *name, const void *object)
+    : m_name(name), m_object(object)
+  {
+    if (TraceRecorder::Get().Enabled()) {
+      TraceRecorder::Get().Record(hrgls_TRACE_C_ENTER, reinterpret_cast<uint64_t>(m_object),
+        reinterpret_cast<uint64_t>(m_name));
+    }
+  }
+  ~hrgls_TraceScope()
+  {
+    if (TraceRecorder::Get().Enabled()) {
+      TraceRecorder::Get().Record(hrgls_TRACE_C_EXIT, reinterpret_cast<uint64_t>(m_object),
+        reinterpret_cast<uint64_t>(m_name));
+    }
+  }
+  const char *m_name;
+  const void *m_object;
+};
+
+/// @brief Traces the C function that it is used in while tracing is on.
+#define hrgls_TRACE_C_FUNCTION(object) hrgls_TraceScope hrgls_traceScope(__func__, object)
+
+//----------------------------------------------------------------------------
+// Our handles begin with an hrgls_Handle_, declared in hrgls_Handle_impl.hpp.
+hrgls_Implementation hrgls_ThisImplementation;
+
+/// Pass a call on a handle that was made by a loaded implementation on to it, through
+/// its function table.  Checking costs one comparison for handles made here.
+#define hrgls_FORWARD(handle, function, args) \
+  if (handle && hrgls_ImplementationOf(handle) != &hrgls_ThisImplementation) { \
+    return hrgls_ImplementationOf(handle)->function args; \
+  }
+
+//----------------------------------------------------------------------------
+/// @brief Find the function table of an implementation library, loading it if needed.
+///
+/// Libraries are never unloaded, because blobs, messages and threads that came from
+/// them may outlive the APIs that were created from them.
+/// @param [in] fileName Library to load, as given to dlopen() or LoadLibrary().
+/// @param [out] returnImplementation Location to store the table.
+/// @return hrgls_STATUS_OKAY on success, hrgls_STATUS_IMPLEMENTATION_NOT_FOUND if the
+///         library or its entry point is missing or it has no compatible table.
+static hrgls_Status hrgls_LoadImplementation(const ::std::string &fileName,
+  const hrgls_Implementation **returnImplementation)
+{
+  static std::mutex *mutex = new std::mutex;
+  static std::map< ::std::string, const hrgls_Implementation *> *loaded =
+    new std::map< ::std::string, const hrgls_Implementation *>;
+
+  std::lock_guard<std::mutex> lock(*mutex);
+  std::map< ::std::string, const hrgls_Implementation *>::const_iterator it =
+    loaded->find(fileName);
+  if (it != loaded->end()) {
+    *returnImplementation = it->second;
+    return hrgls_STATUS_OKAY;
+  }
+
+  const hrgls_Implementation *impl = nullptr;
+#ifdef _WIN32
+  HMODULE lib = LoadLibraryA(fileName.c_str());
+  if (!lib) {
+    return hrgls_STATUS_IMPLEMENTATION_NOT_FOUND;
+  }
+  hrgls_GetImplementationFunction get = reinterpret_cast<hrgls_GetImplementationFunction>(
+    GetProcAddress(lib, hrgls_IMPLEMENTATION_ENTRY_POINT));
+  if (get) {
+    impl = get(hrgls_IMPLEMENTATION_VERSION);
+  }
+  if (!impl || impl->version < hrgls_IMPLEMENTATION_VERSION) {
+    FreeLibrary(lib);
+    return hrgls_STATUS_IMPLEMENTATION_NOT_FOUND;
+  }
+#else
+  // Each library keeps its symbols to itself, so that several implementations of the
+  // same functions can be loaded at once.
+  void *lib = dlopen(fileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!lib) {
+    return hrgls_STATUS_IMPLEMENTATION_NOT_FOUND;
+  }
+  hrgls_GetImplementationFunction get = reinterpret_cast<hrgls_GetImplementationFunction>(
+    dlsym(lib, hrgls_IMPLEMENTATION_ENTRY_POINT));
+  if (get) {
+    impl = get(hrgls_IMPLEMENTATION_VERSION);
+  }
+  if (!impl || impl->version < hrgls_IMPLEMENTATION_VERSION) {
+    dlclose(lib);
+    return hrgls_STATUS_IMPLEMENTATION_NOT_FOUND;
+  }
+#endif
+  try {
+    (*loaded)[fileName] = impl;
+  } catch (...) {
+    // We can still use it, we just look it up again next time.
+  }
+  *returnImplementation = impl;
+  return hrgls_STATUS_OKAY;
+}
+
 //----------------------------------------------------------------------------
 // The externally-linkable, "C" interface, parts of the wrapper.
 
@@ -72,6 +590,14 @@ extern "C" {
       return "Object method called with NULL object pointer";
     case hrgls_STATUS_INTERNAL_EXCEPTION:
       return "Exception thrown inside implementation";
+    case hrgls_STATUS_CONNECTION_FAILED:
+      return "Connection to remote endpoint failed";
+    case hrgls_STATUS_FILE_ERROR:
+      return "File read or write failed";
+    case hrgls_STATUS_IMPLEMENTATION_NOT_FOUND:
+      return "Implementation library not found or not compatible";
+    case hrgls_STATUS_SEGMENTED_DATA:
+      return "Blob data must be read one segment at a time";
 
     default:
       return "Unrecognized error code";
@@ -84,9 +610,15 @@ extern "C" {
   //----------------------------------------------------------------------------
   /// APICreateParams structures and methods.
 
-  struct hrgls_APICreateParams_ {
+  struct hrgls_APICreateParams_ : hrgls_Handle_ {
     ::std::string name;
     ::std::vector<uint8_t> credentials;
+    uint32_t callbackThreads = 0;
+    ::std::string endpoint;
+    ::std::string implementation;
+    uint32_t sourceCount = 2;
+    double messageRate = 10;
+    hrgls_MessageLevel messageLevel = hrgls_MESSAGE_MINIMUM_INFO;
   };
 
   hrgls_Status hrgls_APICreateParametersCreate(hrgls_APICreateParams *returnParams)
@@ -105,6 +637,7 @@ extern "C" {
 
   hrgls_Status hrgls_APICreateParametersDestroy(hrgls_APICreateParams params)
   {
+    hrgls_FORWARD(params, APICreateParametersDestroy, (params));
     hrgls_Status s = hrgls_STATUS_OKAY;
     if (!params) {
       return hrgls_STATUS_DELETE_OF_NULL_POINTER;
@@ -120,6 +653,7 @@ extern "C" {
   hrgls_Status hrgls_APICreateParametersGetName(hrgls_APICreateParams params,
     const char **returnName)
   {
+    hrgls_FORWARD(params, APICreateParametersGetName, (params, returnName));
     hrgls_Status s = hrgls_STATUS_OKAY;
     if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
@@ -135,6 +669,7 @@ extern "C" {
   hrgls_Status hrgls_APICreateParametersSetName(hrgls_APICreateParams params,
     const char *name)
   {
+    hrgls_FORWARD(params, APICreateParametersSetName, (params, name));
     hrgls_Status s = hrgls_STATUS_OKAY;
     if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
@@ -150,6 +685,8 @@ extern "C" {
   hrgls_Status hrgls_APICreateParametersGetCredentials(hrgls_APICreateParams params,
     const uint8_t **returnCredentials, uint32_t *returnSize)
   {
+    hrgls_FORWARD(params, APICreateParametersGetCredentials,
+      (params, returnCredentials, returnSize));
     hrgls_Status s = hrgls_STATUS_OKAY;
     if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
@@ -169,6 +706,7 @@ extern "C" {
   hrgls_Status hrgls_APICreateParametersSetCredentials(hrgls_APICreateParams params,
     const uint8_t *credentials, uint32_t size)
   {
+    hrgls_FORWARD(params, APICreateParametersSetCredentials, (params, credentials, size));
     hrgls_Status s = hrgls_STATUS_OKAY;
     if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
@@ -186,888 +724,3259 @@ extern "C" {
     return s;
   }
 
-
-
-  //----------------------------------------------------------------------------
-  /// hrgls_APIDataBlobSourceInfo structures and methods.
-
-  struct hrgls_APIDataBlobSourceInfo_ {
-    std::string name;
-  };
-
-  //----------------------------------------------------------------------------
-  /// API structures and methods.
-
-  struct hrgls_API_ {
-    hrgls::API *api = nullptr;
-
-    ::std::map< ::std::thread::id, ::std::vector<struct hrgls_APIDataBlobSourceInfo_> >
-      latchedDataBlobSourceInfos;
-
-    /// C callback function that was registered
-    hrgls_LogMessageCallback CHandler = nullptr;
-
-    /// UserData parameter that was given to us when the callback function was registered.
-    void *CUserData = nullptr;
-  };
-
-  hrgls_Status hrgls_APICreate(hrgls_API *returnAPI, hrgls_APICreateParams params)
+  hrgls_Status hrgls_APICreateParametersGetCallbackThreads(hrgls_APICreateParams params,
+    uint32_t *returnCount)
   {
-    hrgls_Status s;
-
-    // Check the parameters.
-    if (!returnAPI || !params) {
+    hrgls_FORWARD(params, APICreateParametersGetCallbackThreads, (params, returnCount));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnCount) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnCount = params->callbackThreads;
+    return hrgls_STATUS_OKAY;
+  }
 
-    // Pull the parameters out so that we can pass them to the constructor.
-    const char *retString;
-    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetName(params, &retString))) {
-      *returnAPI = nullptr;
-      return s;
+  hrgls_Status hrgls_APICreateParametersSetCallbackThreads(hrgls_APICreateParams params,
+    uint32_t count)
+  {
+    hrgls_FORWARD(params, APICreateParametersSetCallbackThreads, (params, count));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    std::string name = retString;
+    params->callbackThreads = count;
+    return hrgls_STATUS_OKAY;
+  }
 
-    uint32_t size;
-    const uint8_t *retCreds;
-    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetCredentials(
-        params, &retCreds, &size))) {
-      *returnAPI = nullptr;
-      return s;
+  hrgls_Status hrgls_APICreateParametersGetEndpoint(hrgls_APICreateParams params,
+    const char **returnEndpoint)
+  {
+    hrgls_FORWARD(params, APICreateParametersGetEndpoint, (params, returnEndpoint));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    std::vector<uint8_t> credentials;
-    credentials.assign(retCreds, retCreds + size);
-
-    // Attempt to construct the object.
-    s = hrgls_STATUS_OKAY;
-    hrgls_API ret;
-    try {
-      ret = new hrgls_API_;
-    } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+    if (!returnEndpoint) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    try {
-      ret->api = new hrgls::API(name, credentials);
-    } catch (...) {
-      s = hrgls_STATUS_INTERNAL_EXCEPTION;
-      ret->api = nullptr;
-      delete ret;
-      ret = nullptr;
+    *returnEndpoint = params->endpoint.c_str();
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_APICreateParametersSetEndpoint(hrgls_APICreateParams params,
+    const char *endpoint)
+  {
+    hrgls_FORWARD(params, APICreateParametersSetEndpoint, (params, endpoint));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    *returnAPI = ret;
-    if (ret) {
-      return ret->api->GetStatus();
+    if (!endpoint) {
+      params->endpoint = "";
     } else {
-      return s;
+      params->endpoint = endpoint;
     }
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIDestroy(hrgls_API api)
+  hrgls_Status hrgls_APICreateParametersGetImplementation(hrgls_APICreateParams params,
+    const char **returnImplementation)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
-      s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
-    } else {
-      if (!api->api) {
-        s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
-      } else {
+    hrgls_FORWARD(params, APICreateParametersGetImplementation, (params, returnImplementation));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnImplementation) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnImplementation = params->implementation.c_str();
+    return hrgls_STATUS_OKAY;
+  }
 
-        try {
-          delete api->api;
-        } catch (...) {
-          s = hrgls_STATUS_DELETION_FAILED;
-        }
-        api->api = nullptr;
-      }
-      try {
-        delete api;
-      } catch (...) {
-        s = hrgls_STATUS_DELETION_FAILED;
-      }
+  hrgls_Status hrgls_APICreateParametersSetImplementation(hrgls_APICreateParams params,
+    const char *implementation)
+  {
+    hrgls_FORWARD(params, APICreateParametersSetImplementation, (params, implementation));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    return s;
+    if (!implementation) {
+      params->implementation = "";
+    } else {
+      params->implementation = implementation;
+    }
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIGetAvailableDataBlobSourceCount(hrgls_API api,
+  hrgls_Status hrgls_APICreateParametersGetSourceCount(hrgls_APICreateParams params,
     uint32_t *returnCount)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(params, APICreateParametersGetSourceCount, (params, returnCount));
+    if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
     if (!returnCount) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnCount = params->sourceCount;
+    return hrgls_STATUS_OKAY;
+  }
 
-    // Try to get the object info.
-    ::std::vector<hrgls::DataBlobSourceDescription> objs;
-    try {
-      objs = api->api->GetAvailableDataBlobSources();
-      if (hrgls_STATUS_OKAY != (s = api->api->GetStatus())) {
-        return s;
-      }
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+  hrgls_Status hrgls_APICreateParametersSetSourceCount(hrgls_APICreateParams params,
+    uint32_t count)
+  {
+    hrgls_FORWARD(params, APICreateParametersSetSourceCount, (params, count));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-
-    // Store the  info in our latched location, allocating space as needed.
-    // This will enable us to read back from it in a consistent state using the
-    // info-reading function.  We delete any old information while we're doing this.
-    try {
-      api->latchedDataBlobSourceInfos[::std::this_thread::get_id()].clear();
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    if (count == 0) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    try {
-      for (size_t i = 0; i < objs.size(); i++) {
-        struct hrgls_APIDataBlobSourceInfo_ info;
-        info.name = objs[i].Name().c_str();
+    params->sourceCount = count;
+    return hrgls_STATUS_OKAY;
+  }
 
-        api->latchedDataBlobSourceInfos[::std::this_thread::get_id()].push_back(info);
-      }
-    } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
+  hrgls_Status hrgls_APICreateParametersGetMessageRate(hrgls_APICreateParams params,
+    double *returnRate)
+  {
+    hrgls_FORWARD(params, APICreateParametersGetMessageRate, (params, returnRate));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-
-    // Return the count.
-    *returnCount = static_cast<uint32_t>(api->latchedDataBlobSourceInfos[::std::this_thread::get_id()].size());
-    return s;
+    if (!returnRate) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnRate = params->messageRate;
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIGetAvailableDataBlobSourceInfo(hrgls_API api, uint32_t which,
-    hrgls_APIDataBlobSourceInfo *returnInfo)
+  hrgls_Status hrgls_APICreateParametersSetMessageRate(hrgls_APICreateParams params,
+    double rate)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(params, APICreateParametersSetMessageRate, (params, rate));
+    if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnInfo) {
+    // Written this way so that NaN is rejected too.
+    if (!(rate >= 0)) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-    if (which >= api->latchedDataBlobSourceInfos[::std::this_thread::get_id()].size()) {
+    params->messageRate = rate;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_APICreateParametersGetMessageLevel(hrgls_APICreateParams params,
+    hrgls_MessageLevel *returnLevel)
+  {
+    hrgls_FORWARD(params, APICreateParametersGetMessageLevel, (params, returnLevel));
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnLevel) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-
-    *returnInfo = &api->latchedDataBlobSourceInfos[::std::this_thread::get_id()][which];
-    return s;
+    *returnLevel = params->messageLevel;
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIGetVersion(hrgls_API api, hrgls_VERSION *returnVersion)
+  hrgls_Status hrgls_APICreateParametersSetMessageLevel(hrgls_APICreateParams params,
+    hrgls_MessageLevel level)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(params, APICreateParametersSetMessageLevel, (params, level));
+    if (!params) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnVersion) {
+    params->messageLevel = level;
+    return hrgls_STATUS_OKAY;
+  }
+
+
+
+  //----------------------------------------------------------------------------
+  /// hrgls_StreamStatistics structures and methods.
+
+  struct hrgls_StreamStatistics_ : hrgls_Handle_ {
+    hrgls::StreamStatistics stats;
+  };
+
+  hrgls_Status hrgls_StreamStatisticsCreate(hrgls_StreamStatistics *returnStats)
+  {
+    if (returnStats == nullptr) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-
     try {
-      *returnVersion = api->api->GetVersion();
+      *returnStats = new hrgls_StreamStatistics_;
     } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+      return hrgls_STATUS_OUT_OF_MEMORY;
     }
-    return api->api->GetStatus();
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIGetCurrentSystemTime(hrgls_API api, struct timeval *returnTime)
+  hrgls_Status hrgls_StreamStatisticsDestroy(hrgls_StreamStatistics stats)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsDestroy, (stats));
+    if (!stats) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    delete stats;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_StreamStatisticsGetProduced(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
+  {
+    hrgls_FORWARD(stats, StreamStatisticsGetProduced, (stats, returnCount));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnTime) {
+    if (!returnCount) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnCount = stats->stats.Produced();
+    return hrgls_STATUS_OKAY;
+  }
 
-    try {
-      *returnTime = api->api->GetCurrentSystemTime();
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+  hrgls_Status hrgls_StreamStatisticsGetDelivered(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
+  {
+    hrgls_FORWARD(stats, StreamStatisticsGetDelivered, (stats, returnCount));
+    if (!stats) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    return api->api->GetStatus();
+    if (!returnCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnCount = stats->stats.Delivered();
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APIGetVerbosity(hrgls_API api, uint16_t *returnVerbosity)
+  hrgls_Status hrgls_StreamStatisticsGetDropped(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetDropped, (stats, returnCount));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnVerbosity) {
+    if (!returnCount) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnCount = stats->stats.Dropped();
+    return hrgls_STATUS_OKAY;
+  }
 
-    try {
-      *returnVerbosity = api->api->GetVerbosity();
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+  hrgls_Status hrgls_StreamStatisticsGetQueueDepth(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
+  {
+    hrgls_FORWARD(stats, StreamStatisticsGetQueueDepth, (stats, returnCount));
+    if (!stats) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    return api->api->GetStatus();
+    if (!returnCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnCount = stats->stats.QueueDepth();
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_APISetVerbosity(hrgls_API api, uint16_t verbosity)
+  hrgls_Status hrgls_StreamStatisticsGetMaxQueueDepth(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetMaxQueueDepth, (stats, returnCount));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-
-    try {
-      api->api->SetVerbosity(verbosity);
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    if (!returnCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    return api->api->GetStatus();
+    *returnCount = stats->stats.MaxQueueDepth();
+    return hrgls_STATUS_OKAY;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageStreamingState(hrgls_API api, bool running)
+  hrgls_Status hrgls_StreamStatisticsGetLatencyTotal(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetLatencyTotal, (stats, returnNanoseconds));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    try {
-      return api->api->SetLogMessageStreamingState(running);
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    if (!returnNanoseconds) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnNanoseconds = stats->stats.LatencyTotal();
+    return hrgls_STATUS_OKAY;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageCallback(hrgls_API api,
-    hrgls_LogMessageCallback handler, void *userData)
+  hrgls_Status hrgls_StreamStatisticsGetLatencyMax(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds)
   {
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetLatencyMax, (stats, returnNanoseconds));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    api->CHandler = handler;
-    api->CUserData = userData;
-    // If we are supposed to be calling a callback handler, then set our callback handler
-    // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
-    try {
-      if (!handler) {
-        return api->api->SetLogMessageCallback(nullptr, nullptr);
-      }
-      return api->api->SetLogMessageCallback(LogMessageCallback, api);
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    if (!returnNanoseconds) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnNanoseconds = stats->stats.LatencyMax();
+    return hrgls_STATUS_OKAY;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_APIGetNextLogMessage(hrgls_API api, hrgls_Message *message)
+  hrgls_Status hrgls_StreamStatisticsGetCallbacks(hrgls_StreamStatistics stats,
+    uint64_t *returnCount)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetCallbacks, (stats, returnCount));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!message) {
+    if (!returnCount) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnCount = stats->stats.Callbacks();
+    return hrgls_STATUS_OKAY;
+  }
 
-    // Get at most a single message.
-    try {
-      ::std::vector<::hrgls::Message> ret = api->api->GetPendingLogMessages(1);
-      if (ret.size() > 0) {
-        // Copy the first (only) message into the pointed-to return location.
-        if (hrgls_STATUS_OKAY != (s = hrgls_MessageCopy(message, ret.front().RawMessage()))) {
-          return s;
-        }
-      }
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+  hrgls_Status hrgls_StreamStatisticsGetCallbackDurationTotal(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds)
+  {
+    hrgls_FORWARD(stats, StreamStatisticsGetCallbackDurationTotal, (stats, returnNanoseconds));
+    if (!stats) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-
-    return api->api->GetStatus();
+    if (!returnNanoseconds) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnNanoseconds = stats->stats.CallbackDurationTotal();
+    return hrgls_STATUS_OKAY;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageMinimumLevel(hrgls_API api, hrgls_MessageLevel level)
+  hrgls_Status hrgls_StreamStatisticsGetCallbackDurationMax(hrgls_StreamStatistics stats,
+    uint64_t *returnNanoseconds)
   {
-    if (!api) {
+    hrgls_FORWARD(stats, StreamStatisticsGetCallbackDurationMax, (stats, returnNanoseconds));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    try {
-      return api->api->SetLogMessageMinimumLevel(level);
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    if (!returnNanoseconds) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
+    *returnNanoseconds = stats->stats.CallbackDurationMax();
+    return hrgls_STATUS_OKAY;
   }
 
-  //----------------------------------------------------------------------------
-  /// hrgls_StreamProperties structures and methods.
-
-  struct hrgls_StreamProperties_ {
-    hrgls::StreamProperties *props = nullptr;
-  };
-
-  hrgls_Status hrgls_StreamPropertiesCreate(hrgls_StreamProperties *returnProp)
+  /// Copy as much of a histogram as fits into an array, zeroing the rest of the array.
+  static hrgls_Status hrgls_CopyHistogram(const ::std::vector<uint64_t> &histogram,
+    uint64_t *counts, uint32_t size)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (returnProp == nullptr) {
+    if (!counts) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-
-    hrgls_StreamProperties ret;
-    try {
-      // Construct the object
-      ret = new hrgls_StreamProperties_;
-      ret->props = new hrgls::StreamProperties();
-      s = ret->props->GetStatus();
-    } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+    for (uint32_t i = 0; i < size; i++) {
+      counts[i] = (i < histogram.size()) ? histogram[i] : 0;
     }
-
-    *returnProp = ret;
-    return s;
+    return hrgls_STATUS_OKAY;
   }
 
-  hrgls_Status hrgls_StreamPropertiesDestroy(hrgls_StreamProperties prop)
+  hrgls_Status hrgls_StreamStatisticsGetLatencyHistogram(hrgls_StreamStatistics stats,
+    uint64_t *counts, uint32_t size)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!prop || !prop->props) {
-      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
-    } try {
-      delete prop->props;
-      delete prop;
-    } catch (...) {
-      s = hrgls_STATUS_DELETION_FAILED;
+    hrgls_FORWARD(stats, StreamStatisticsGetLatencyHistogram, (stats, counts, size));
+    if (!stats) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    return s;
+    return hrgls_CopyHistogram(stats->stats.LatencyHistogram(), counts, size);
   }
 
-  hrgls_Status hrgls_StreamPropertiesGetRate(hrgls_StreamProperties prop, double *val)
+  hrgls_Status hrgls_StreamStatisticsGetCallbackDurationHistogram(
+    hrgls_StreamStatistics stats, uint64_t *counts, uint32_t size)
   {
-    if (!prop || !prop->props) {
+    hrgls_FORWARD(stats, StreamStatisticsGetCallbackDurationHistogram, (stats, counts, size));
+    if (!stats) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-
-    try {
-      *val = prop->props->Rate();
-      return prop->props->GetStatus();
-    } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
-    }
+    return hrgls_CopyHistogram(stats->stats.CallbackDurationHistogram(), counts, size);
   }
 
-  hrgls_Status hrgls_StreamPropertiesSetRate(hrgls_StreamProperties prop, double val)
+  /// Copy statistics that a loaded implementation filled into one of its own objects
+  /// into one of ours, which it cannot fill in itself.
+  static hrgls_Status hrgls_CopyForwardedStatistics(const hrgls_Implementation *impl,
+    hrgls_StreamStatistics theirs, hrgls_StreamStatistics stats)
   {
-    if (!prop || !prop->props) {
-      return hrgls_STATUS_NULL_OBJECT_POINTER;
-    }
+    hrgls_Status s = hrgls_STATUS_OKAY;
     try {
-      return prop->props->Rate(val);
+      uint64_t produced = 0, delivered = 0, dropped = 0, queueDepth = 0, maxQueueDepth = 0;
+      uint64_t latencyTotal = 0, latencyMax = 0;
+      uint64_t callbacks = 0, callbackDurationTotal = 0, callbackDurationMax = 0;
+      ::std::vector<uint64_t> latency(hrgls_STATISTICS_HISTOGRAM_BINS);
+      ::std::vector<uint64_t> callbackDuration(hrgls_STATISTICS_HISTOGRAM_BINS);
+      if (hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetProduced(theirs, &produced)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetDelivered(theirs, &delivered)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetDropped(theirs, &dropped)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetQueueDepth(theirs, &queueDepth)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetMaxQueueDepth(theirs,
+            &maxQueueDepth)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetLatencyTotal(theirs,
+            &latencyTotal)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetLatencyMax(theirs, &latencyMax)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetLatencyHistogram(theirs,
+            latency.data(), hrgls_STATISTICS_HISTOGRAM_BINS)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetCallbacks(theirs, &callbacks)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetCallbackDurationTotal(theirs,
+            &callbackDurationTotal)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetCallbackDurationMax(theirs,
+            &callbackDurationMax)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamStatisticsGetCallbackDurationHistogram(theirs,
+            callbackDuration.data(), hrgls_STATISTICS_HISTOGRAM_BINS))) {
+        hrgls::StreamStatistics &ours = stats->stats;
+        ours.Produced(produced);
+        ours.Delivered(delivered);
+        ours.Dropped(dropped);
+        ours.QueueDepth(queueDepth);
+        ours.MaxQueueDepth(maxQueueDepth);
+        ours.LatencyTotal(latencyTotal);
+        ours.LatencyMax(latencyMax);
+        ours.LatencyHistogram(latency);
+        ours.Callbacks(callbacks);
+        ours.CallbackDurationTotal(callbackDurationTotal);
+        ours.CallbackDurationMax(callbackDurationMax);
+        ours.CallbackDurationHistogram(callbackDuration);
+      }
     } catch (...) {
-      return hrgls_STATUS_INTERNAL_EXCEPTION;
+      s = hrgls_STATUS_INTERNAL_EXCEPTION;
     }
+    return s;
   }
 
   //----------------------------------------------------------------------------
-  /// hrgls_Message structures and methods.
+  /// hrgls_APIDataBlobSourceInfo structures and methods.
 
-  struct hrgls_Message_ {
-	  std::string value;
-	  struct timeval timeStamp;
-	  hrgls_MessageLevel level;
+  struct hrgls_APIDataBlobSourceInfo_ : hrgls_Handle_ {
+    std::string name;
   };
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageCreate(hrgls_Message *returnMessage)
-  {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  hrgls_Message ret;
-	  try {
-		  ret = new hrgls_Message_;
-	  } catch (...) {
-		  s = hrgls_STATUS_OUT_OF_MEMORY;
-		  ret = nullptr;
-	  }
-	  *returnMessage = ret;
-	  return s;
-  }
+  /// Source information latched by hrgls_APIGetAvailableDataBlobSourceCount(), along
+  /// with the generation of the list that it was read from.
+  struct hrgls_LatchedDataBlobSourceInfos_ {
+    uint64_t generation = 0;
+    ::std::vector<struct hrgls_APIDataBlobSourceInfo_> infos;
+  };
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageCopy(hrgls_Message *returnMessage, hrgls_Message MessageToCopy)
-  {
-          if (!MessageToCopy) {
-            return hrgls_STATUS_BAD_PARAMETER;
-          }
+  //----------------------------------------------------------------------------
+  /// API structures and methods.
 
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  hrgls_Message ret;
-	  try {
-		  ret = new hrgls_Message_;
-	  } catch (...) {
-		  s = hrgls_STATUS_OUT_OF_MEMORY;
-		  ret = nullptr;
-	  }
+  struct hrgls_API_ : hrgls_Handle_ {
+    hrgls::API *api = nullptr;
 
-	  *ret = *MessageToCopy;
+    /// Source information latched by each thread's last call to
+    /// hrgls_APIGetAvailableDataBlobSourceCount(), kept until that thread calls again
+    /// after the list has changed.
+    hrgls::PerThread<struct hrgls_LatchedDataBlobSourceInfos_> latchedDataBlobSourceInfos;
 
-	  *returnMessage = ret;
-	  return s;
-  }
+    /// C callback function that was registered
+    hrgls_LogMessageCallback CHandler = nullptr;
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageDestroy(hrgls_Message obj)
+    /// C callback function that borrows messages, if that kind was registered instead.
+    hrgls_LogMessageViewCallback CViewHandler = nullptr;
+
+    /// UserData parameter that was given to us when the callback function was registered.
+    void *CUserData = nullptr;
+
+    /// Keeps the callbacks from reading the handler while it is being changed.
+    std::mutex CMutex;
+  };
+
+  /// Create an API in a loaded implementation, copying our parameters into its own.
+  static hrgls_Status hrgls_ForwardAPICreate(const hrgls_Implementation *impl,
+    hrgls_API *returnAPI, const hrgls_APICreateParams_ &params)
   {
+    *returnAPI = nullptr;
+    hrgls_APICreateParams p;
+    hrgls_Status s = impl->APICreateParametersCreate(&p);
+    if (s != hrgls_STATUS_OKAY) {
+      return s;
+    }
+    if (hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetName(p, params.name.c_str())) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetCredentials(p,
+          params.credentials.data(), static_cast<uint32_t>(params.credentials.size()))) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetCallbackThreads(p,
+          params.callbackThreads)) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetEndpoint(p,
+          params.endpoint.c_str())) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetSourceCount(p,
+          params.sourceCount)) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetMessageRate(p,
+          params.messageRate)) &&
+        hrgls_STATUS_OKAY == (s = impl->APICreateParametersSetMessageLevel(p,
+          params.messageLevel))) {
+      s = impl->APICreate(returnAPI, p);
+    }
+    impl->APICreateParametersDestroy(p);
+    return s;
+  }
+
+  hrgls_Status hrgls_APICreate(hrgls_API *returnAPI, hrgls_APICreateParams params)
+  {
+    hrgls_Status s;
+
+    // Check the parameters.
+    if (!returnAPI || !params) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    // Pull the parameters out so that we can pass them to the constructor.
+    const char *retString;
+    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetName(params, &retString))) {
+      *returnAPI = nullptr;
+      return s;
+    }
+    std::string name = retString;
+
+    uint32_t size;
+    const uint8_t *retCreds;
+    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetCredentials(
+        params, &retCreds, &size))) {
+      *returnAPI = nullptr;
+      return s;
+    }
+    std::vector<uint8_t> credentials;
+    credentials.assign(retCreds, retCreds + size);
+
+    uint32_t callbackThreads;
+    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetCallbackThreads(
+        params, &callbackThreads))) {
+      *returnAPI = nullptr;
+      return s;
+    }
+
+    if (hrgls_STATUS_OKAY != (s = hrgls_APICreateParametersGetEndpoint(params, &retString))) {
+      *returnAPI = nullptr;
+      return s;
+    }
+    std::string endpoint = retString;
+
+    // If another implementation was asked for, it makes the API and everything that
+    // comes from it.  Naming this library itself just gets us here again.
+    if (!params->implementation.empty()) {
+      const hrgls_Implementation *impl = nullptr;
+      if (hrgls_STATUS_OKAY != (s = hrgls_LoadImplementation(params->implementation, &impl))) {
+        *returnAPI = nullptr;
+        return s;
+      }
+      if (impl != &hrgls_ThisImplementation) {
+        return hrgls_ForwardAPICreate(impl, returnAPI, *params);
+      }
+    }
+
+    // Attempt to construct the object.
+    s = hrgls_STATUS_OKAY;
+    hrgls_API ret;
+    try {
+      ret = new hrgls_API_;
+    } catch (...) {
+      *returnAPI = nullptr;
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    try {
+      ret->api = new hrgls::API(name, credentials, callbackThreads, endpoint, "",
+        params->sourceCount, params->messageRate, params->messageLevel);
+    } catch (...) {
+      s = hrgls_STATUS_INTERNAL_EXCEPTION;
+      ret->api = nullptr;
+      delete ret;
+      ret = nullptr;
+    }
+    // An API that could not be set up (a bad endpoint, for example) is not handed
+    // back; the caller only gets the status.
+    if (ret && (s = ret->api->GetStatus()) != hrgls_STATUS_OKAY) {
+      delete ret->api;
+      delete ret;
+      ret = nullptr;
+    }
+    *returnAPI = ret;
+    return s;
+  }
+
+  hrgls_Status hrgls_APIDestroy(hrgls_API api)
+  {
+    hrgls_FORWARD(api, APIDestroy, (api));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    } else {
+      if (!api->api) {
+        s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
+      } else {
+
+        try {
+          delete api->api;
+        } catch (...) {
+          s = hrgls_STATUS_DELETION_FAILED;
+        }
+        api->api = nullptr;
+      }
+      try {
+        delete api;
+      } catch (...) {
+        s = hrgls_STATUS_DELETION_FAILED;
+      }
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_APIGetAvailableDataBlobSourceCount(hrgls_API api,
+    uint32_t *returnCount)
+  {
+    hrgls_FORWARD(api, APIGetAvailableDataBlobSourceCount, (api, returnCount));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    // If the list has not changed since this thread last latched it, what we latched
+    // then is still current.  The generation is read before the list, so a change made
+    // while we read it makes the next call read it again.
+    struct hrgls_LatchedDataBlobSourceInfos_ &latched = api->latchedDataBlobSourceInfos.Get();
+    uint64_t generation;
+    try {
+      generation = api->api->GetDataBlobSourceGeneration();
+      if (hrgls_STATUS_OKAY != (s = api->api->GetStatus())) {
+        return s;
+      }
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    if (generation != 0 && generation == latched.generation) {
+      *returnCount = static_cast<uint32_t>(latched.infos.size());
+      return s;
+    }
+
+    // Try to get the object info.
+    ::std::vector<hrgls::DataBlobSourceDescription> objs;
+    try {
+      objs = api->api->GetAvailableDataBlobSources();
+      if (hrgls_STATUS_OKAY != (s = api->api->GetStatus())) {
+        return s;
+      }
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+
+    // Store the  info in our latched location, allocating space as needed.
+    // This will enable us to read back from it in a consistent state using the
+    // info-reading function.  We delete any old information while we're doing this.
+    latched.generation = 0;
+    try {
+      latched.infos.resize(objs.size());
+      for (size_t i = 0; i < objs.size(); i++) {
+        latched.infos[i].name = objs[i].Name();
+      }
+      latched.generation = generation;
+    } catch (...) {
+      latched.infos.clear();
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+    }
+
+    // Return the count.
+    *returnCount = static_cast<uint32_t>(latched.infos.size());
+    return s;
+  }
+
+  hrgls_Status hrgls_APIGetAvailableDataBlobSourceInfo(hrgls_API api, uint32_t which,
+    hrgls_APIDataBlobSourceInfo *returnInfo)
+  {
+    hrgls_FORWARD(api, APIGetAvailableDataBlobSourceInfo, (api, which, returnInfo));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnInfo) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    ::std::vector<struct hrgls_APIDataBlobSourceInfo_> &latched =
+      api->latchedDataBlobSourceInfos.Get().infos;
+    if (which >= latched.size()) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    *returnInfo = &latched[which];
+    return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIGetDataBlobSourceGeneration(hrgls_API api,
+    uint64_t *returnGeneration)
+  {
+    hrgls_FORWARD(api, APIGetDataBlobSourceGeneration, (api, returnGeneration));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnGeneration) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *returnGeneration = api->api->GetDataBlobSourceGeneration();
+      return api->api->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APISetDataBlobSourcesChangedCallback(hrgls_API api,
+    hrgls_DataBlobSourcesChangedCallback handler, void *userData)
+  {
+    hrgls_FORWARD(api, APISetDataBlobSourcesChangedCallback, (api, handler, userData));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return api->api->SetDataBlobSourcesChangedCallback(handler, userData);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_APIGetVersion(hrgls_API api, hrgls_VERSION *returnVersion)
+  {
+    hrgls_FORWARD(api, APIGetVersion, (api, returnVersion));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnVersion) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    try {
+      *returnVersion = api->api->GetVersion();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    return api->api->GetStatus();
+  }
+
+  hrgls_Status hrgls_APIGetCurrentSystemTime(hrgls_API api, struct timeval *returnTime)
+  {
+    hrgls_FORWARD(api, APIGetCurrentSystemTime, (api, returnTime));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnTime) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    try {
+      *returnTime = api->api->GetCurrentSystemTime();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    return api->api->GetStatus();
+  }
+
+  hrgls_Status hrgls_APIGetVerbosity(hrgls_API api, uint16_t *returnVerbosity)
+  {
+    hrgls_FORWARD(api, APIGetVerbosity, (api, returnVerbosity));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnVerbosity) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    try {
+      *returnVerbosity = api->api->GetVerbosity();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    return api->api->GetStatus();
+  }
+
+  hrgls_Status hrgls_APISetVerbosity(hrgls_API api, uint16_t verbosity)
+  {
+    hrgls_FORWARD(api, APISetVerbosity, (api, verbosity));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+
+    try {
+      api->api->SetVerbosity(verbosity);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    return api->api->GetStatus();
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageStreamingState(hrgls_API api, bool running)
+  {
+    hrgls_FORWARD(api, APISetLogMessageStreamingState, (api, running));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return api->api->SetLogMessageStreamingState(running);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageCallback(hrgls_API api,
+    hrgls_LogMessageCallback handler, void *userData)
+  {
+    hrgls_FORWARD(api, APISetLogMessageCallback, (api, handler, userData));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    {
+      std::lock_guard<std::mutex> lock(api->CMutex);
+      api->CHandler = handler;
+      api->CViewHandler = nullptr;
+      api->CUserData = userData;
+    }
+    // If we are supposed to be calling a callback handler, then set our callback handler
+    // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
+    try {
+      if (!handler) {
+        return api->api->SetLogMessageCallback(nullptr, nullptr);
+      }
+      return api->api->SetLogMessageCallback(LogMessageCallback, api);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageViewCallback(hrgls_API api,
+    hrgls_LogMessageViewCallback handler, void *userData)
+  {
+    hrgls_FORWARD(api, APISetLogMessageViewCallback, (api, handler, userData));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    {
+      std::lock_guard<std::mutex> lock(api->CMutex);
+      api->CHandler = nullptr;
+      api->CViewHandler = handler;
+      api->CUserData = userData;
+    }
+    try {
+      if (!handler) {
+        return api->api->SetLogMessageViewCallback(nullptr, nullptr);
+      }
+      return api->api->SetLogMessageViewCallback(LogMessageViewCallback, api);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIGetNextLogMessage(hrgls_API api, hrgls_Message *message)
+  {
+    hrgls_FORWARD(api, APIGetNextLogMessage, (api, message));
+    hrgls_TRACE_C_FUNCTION(api);
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!message) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    // Get at most a single message.
+    try {
+      ::std::vector<::hrgls::Message> ret = api->api->GetPendingLogMessages(1);
+      if (ret.size() > 0) {
+        // Hand the first (only) message to the caller without copying it.
+        *message = ret.front().Detach();
+        if (!*message) {
+          return hrgls_STATUS_NULL_OBJECT_POINTER;
+        }
+      }
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+
+    return api->api->GetStatus();
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIGetDroppedLogMessageCount(hrgls_API api, uint64_t *count)
+  {
+    hrgls_FORWARD(api, APIGetDroppedLogMessageCount, (api, count));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!count) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *count = api->api->GetDroppedLogMessageCount();
+      return api->api->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIGetLogMessageStatistics(hrgls_API api,
+    hrgls_StreamStatistics stats)
+  {
+    if (api && hrgls_ImplementationOf(api) != &hrgls_ThisImplementation) {
+      const hrgls_Implementation *impl = hrgls_ImplementationOf(api);
+      if (!stats) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      hrgls_StreamStatistics theirs = nullptr;
+      hrgls_Status s = impl->StreamStatisticsCreate(&theirs);
+      if (s == hrgls_STATUS_OKAY &&
+          hrgls_STATUS_OKAY == (s = impl->APIGetLogMessageStatistics(api, theirs))) {
+        s = hrgls_CopyForwardedStatistics(impl, theirs, stats);
+      }
+      if (theirs) {
+        impl->StreamStatisticsDestroy(theirs);
+      }
+      return s;
+    }
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!stats) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      stats->stats = api->api->GetLogMessageStatistics();
+      return api->api->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIGetBufferPool(hrgls_API api, hrgls_BufferPool *returnPool)
+  {
+    hrgls_FORWARD(api, APIGetBufferPool, (api, returnPool));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnPool) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *returnPool = api->api->GetBufferPool();
+      return api->api->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_TraceStart(uint32_t eventsPerThread)
+  {
+    try {
+      TraceRecorder::Get().Start(eventsPerThread);
+      return hrgls_STATUS_OKAY;
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_TraceStop(void)
+  {
+    TraceRecorder::Get().Stop();
+    return hrgls_STATUS_OKAY;
+  }
+
+  HRGLS_EXPORT void hrgls_TraceRecord(hrgls_TraceEventType type, uint64_t object, uint64_t value)
+  {
+    if (type == hrgls_TRACE_C_ENTER || type == hrgls_TRACE_C_EXIT) {
+      return;
+    }
+    if (TraceRecorder::Get().Enabled()) {
+      TraceRecorder::Get().Record(type, object, value);
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_TraceDump(const char *fileName)
+  {
+    if (!fileName) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      return TraceRecorder::Get().Dump(fileName);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APISetLogMessageMinimumLevel(hrgls_API api, hrgls_MessageLevel level)
+  {
+    hrgls_FORWARD(api, APISetLogMessageMinimumLevel, (api, level));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return api->api->SetLogMessageMinimumLevel(level);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIAddReplayFile(hrgls_API api, const char *fileName)
+  {
+    hrgls_FORWARD(api, APIAddReplayFile, (api, fileName));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!fileName) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      return api->api->AddReplayFile(fileName);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_APIStartServer(hrgls_API api, const char *endpoint,
+    uint16_t *returnPort)
+  {
+    hrgls_FORWARD(api, APIStartServer, (api, endpoint, returnPort));
+    if (!api) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!endpoint) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      uint16_t port = api->api->StartServer(endpoint);
+      hrgls_Status s = api->api->GetStatus();
+      if (s == hrgls_STATUS_OKAY && returnPort) {
+        *returnPort = port;
+      }
+      return s;
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  /// hrgls_StreamProperties structures and methods.
+
+  struct hrgls_StreamProperties_ : hrgls_Handle_ {
+    hrgls::StreamProperties *props = nullptr;
+  };
+
+  hrgls_Status hrgls_StreamPropertiesCreate(hrgls_StreamProperties *returnProp)
+  {
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (returnProp == nullptr) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    hrgls_StreamProperties ret;
+    try {
+      // Construct the object
+      ret = new hrgls_StreamProperties_;
+      ret->props = new hrgls::StreamProperties();
+      s = ret->props->GetStatus();
+    } catch (...) {
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+      ret = nullptr;
+    }
+
+    *returnProp = ret;
+    return s;
+  }
+
+  hrgls_Status hrgls_StreamPropertiesDestroy(hrgls_StreamProperties prop)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesDestroy, (prop));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    } try {
+      delete prop->props;
+      delete prop;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetRate(hrgls_StreamProperties prop, double *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetRate, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+
+    try {
+      *val = prop->props->Rate();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetRate(hrgls_StreamProperties prop, double val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetRate, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->Rate(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetQueueCapacity(hrgls_StreamProperties prop, uint32_t *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetQueueCapacity, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!val) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *val = prop->props->QueueCapacity();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetQueueCapacity(hrgls_StreamProperties prop, uint32_t val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetQueueCapacity, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->QueueCapacity(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetOverflowPolicy(hrgls_StreamProperties prop,
+    hrgls_OverflowPolicy *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetOverflowPolicy, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!val) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *val = prop->props->OverflowPolicy();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetOverflowPolicy(hrgls_StreamProperties prop,
+    hrgls_OverflowPolicy val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetOverflowPolicy, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->OverflowPolicy(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetPayloadSize(hrgls_StreamProperties prop,
+    uint32_t *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetPayloadSize, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!val) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *val = prop->props->PayloadSize();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetPayloadSize(hrgls_StreamProperties prop,
+    uint32_t val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetPayloadSize, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->PayloadSize(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetPayloadDistribution(hrgls_StreamProperties prop,
+    hrgls_PayloadDistribution *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetPayloadDistribution, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!val) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *val = prop->props->PayloadDistribution();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetPayloadDistribution(hrgls_StreamProperties prop,
+    hrgls_PayloadDistribution val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetPayloadDistribution, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->PayloadDistribution(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesGetBurstLength(hrgls_StreamProperties prop,
+    uint32_t *val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesGetBurstLength, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!val) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *val = prop->props->BurstLength();
+      return prop->props->GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_StreamPropertiesSetBurstLength(hrgls_StreamProperties prop,
+    uint32_t val)
+  {
+    hrgls_FORWARD(prop, StreamPropertiesSetBurstLength, (prop, val));
+    if (!prop || !prop->props) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return prop->props->BurstLength(val);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+  /// hrgls_Message structures and methods.
+
+  struct hrgls_Message_ : hrgls_Handle_ {
+	  std::string value;
+	  const char *staticValue = nullptr;  ///< Used instead of value when not null.
+	  struct timeval timeStamp;
+	  hrgls_MessageLevel level;
+  };
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageCreate(hrgls_Message *returnMessage)
+  {
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  hrgls_Message ret;
+	  try {
+		  ret = HandlePool<hrgls_Message_>::Get().Create();
+	  } catch (...) {
+		  s = hrgls_STATUS_OUT_OF_MEMORY;
+		  ret = nullptr;
+	  }
+	  *returnMessage = ret;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageCopy(hrgls_Message *returnMessage, hrgls_Message MessageToCopy)
+  {
+    hrgls_FORWARD(MessageToCopy, MessageCopy, (returnMessage, MessageToCopy));
+          if (!MessageToCopy) {
+            return hrgls_STATUS_BAD_PARAMETER;
+          }
+
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  hrgls_Message ret;
+	  try {
+		  ret = HandlePool<hrgls_Message_>::Get().Create();
+		  *ret = *MessageToCopy;
+	  } catch (...) {
+		  s = hrgls_STATUS_OUT_OF_MEMORY;
+		  ret = nullptr;
+	  }
+
+	  *returnMessage = ret;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageDestroy(hrgls_Message obj)
+  {
+	  hrgls_FORWARD(obj, MessageDestroy, (obj));
 	  hrgls_Status s = hrgls_STATUS_OKAY;
 	  if (!obj) {
 		  return hrgls_STATUS_DELETE_OF_NULL_POINTER;
 	  }
 	  try {
-		  delete obj;
+		  HandlePool<hrgls_Message_>::Get().Destroy(obj);
 	  } catch (...) {
 		  s = hrgls_STATUS_DELETION_FAILED;
 	  }
 	  return s;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageGetValue(hrgls_Message obj, const char **val)
+  HRGLS_EXPORT hrgls_Status hrgls_MessageGetValue(hrgls_Message obj, const char **val)
+  {
+	  hrgls_FORWARD(obj, MessageGetValue, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  if (!val) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+
+	  *val = obj->staticValue ? obj->staticValue : obj->value.c_str();
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageSetValue(hrgls_Message obj, const char *val)
+  {
+	  hrgls_FORWARD(obj, MessageSetValue, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  if (!val) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+	  obj->value = val;
+	  obj->staticValue = nullptr;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageSetStaticValue(hrgls_Message obj, const char *val)
+  {
+	  hrgls_FORWARD(obj, MessageSetStaticValue, (obj, val));
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  if (!val) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+	  obj->value.clear();
+	  obj->staticValue = val;
+	  return hrgls_STATUS_OKAY;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_InternString(const char *val, const char **returnInterned)
+  {
+	  if (!val || !returnInterned) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+	  // The table is never destroyed, so that its strings stay valid for messages that
+	  // are destroyed during program exit.  Its entries do not move when it grows.
+	  static std::mutex mutex;
+	  static std::unordered_set<std::string> *table = new std::unordered_set<std::string>();
+	  try {
+		  std::lock_guard<std::mutex> lock(mutex);
+		  *returnInterned = table->insert(val).first->c_str();
+	  } catch (...) {
+		  return hrgls_STATUS_OUT_OF_MEMORY;
+	  }
+	  return hrgls_STATUS_OKAY;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageGetTimeStamp(hrgls_Message obj, struct timeval *val)
+  {
+	  hrgls_FORWARD(obj, MessageGetTimeStamp, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  if (!val) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+
+	  *val = obj->timeStamp;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageSetTimeStamp(hrgls_Message obj, struct timeval val)
+  {
+	  hrgls_FORWARD(obj, MessageSetTimeStamp, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  obj->timeStamp = val;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageGetLevel(hrgls_Message obj, hrgls_MessageLevel *val)
+  {
+	  hrgls_FORWARD(obj, MessageGetLevel, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  if (!val) {
+		  return hrgls_STATUS_BAD_PARAMETER;
+	  }
+
+	  *val = obj->level;
+	  return s;
+  }
+
+  HRGLS_EXPORT hrgls_Status hrgls_MessageSetLevel(hrgls_Message obj, hrgls_MessageLevel val)
+  {
+	  hrgls_FORWARD(obj, MessageSetLevel, (obj, val));
+	  hrgls_Status s = hrgls_STATUS_OKAY;
+	  if (!obj) {
+		  return hrgls_STATUS_NULL_OBJECT_POINTER;
+	  }
+	  obj->level = val;
+	  return s;
+  }
+
+  //----------------------------------------------------------------------------
+  /// hrgls_DataBlob structures and methods.  The structures, which are shared with
+  /// the DataBlob class in direct builds, are in hrgls_Handle_impl.hpp.
+
+  /// Drop one reference on a payload, deleting the data and the payload when
+  /// it was the last one.
+  static void hrgls_DataBlobPayloadRelease(hrgls_DataBlobPayload_ *payload)
+  {
+    if (payload->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      for (uint32_t i = 0; i < payload->segmentCount; i++) {
+        // We check to make sure we have a deletion function before deleting.
+        // It is not an error to not have a deletion function, though it is likely
+        // to cause a memory leak.
+        const hrgls_DataBlobSegment &segment = payload->Segment(i);
+        if (segment.deleteFunction) {
+          segment.deleteFunction(segment.userData, segment.data);
+        }
+      }
+      HandlePool<hrgls_DataBlobPayload_>::Get().Destroy(payload);
+    }
+  }
+
+  /// Release all of the references that a handle holds on its payload.
+  static void hrgls_DataBlobReleaseAll(hrgls_DataBlob blob)
+  {
+    while (blob->heldReferences > 0) {
+      blob->heldReferences--;
+      hrgls_DataBlobPayloadRelease(blob->payload);
+    }
+    blob->payload = nullptr;
+  }
+
+  hrgls_Status hrgls_DataBlobCreate(hrgls_DataBlob *returnBlob)
+  {
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    hrgls_DataBlob ret;
+    try {
+      ret = HandlePool<hrgls_DataBlob_>::Get().Create();
+    } catch (...) {
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+      ret = nullptr;
+    }
+    *returnBlob = ret;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobCopy(hrgls_DataBlob* returnBlob, hrgls_DataBlob blobToCopy)
+  {
+    hrgls_FORWARD(blobToCopy, DataBlobCopy, (returnBlob, blobToCopy));
+    if (!blobToCopy || !returnBlob) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    // Create a return blob to store the copy into.
+    hrgls_DataBlob ret;
+    try {
+      ret = HandlePool<hrgls_DataBlob_>::Get().Create();
+    }
+    catch (...) {
+      *returnBlob = nullptr;
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+
+    // Copy the fields from the original blob, sharing its data.
+    ret->time = blobToCopy->time;
+    if (blobToCopy->payload) {
+      blobToCopy->payload->refCount.fetch_add(1, std::memory_order_relaxed);
+      ret->payload = blobToCopy->payload;
+      ret->heldReferences = 1;
+    }
+
+    *returnBlob = ret;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobDestroy(hrgls_DataBlob blob)
+  {
+    hrgls_FORWARD(blob, DataBlobDestroy, (blob));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!blob) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    try {
+      hrgls_DataBlobReleaseAll(blob);
+      HandlePool<hrgls_DataBlob_>::Get().Destroy(blob);
+    }
+    catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobGetTime(hrgls_DataBlob blob, struct timeval *val)
+  {
+    hrgls_FORWARD(blob, DataBlobGetTime, (blob, val));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    *val = blob->time;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSetTime(hrgls_DataBlob im, struct timeval val)
+  {
+    hrgls_FORWARD(im, DataBlobSetTime, (im, val));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!im) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    im->time = val;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobGetData(hrgls_DataBlob blob, const uint8_t** data, uint32_t* size)
+  {
+    hrgls_FORWARD(blob, DataBlobGetData, (blob, data, size));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    *data = nullptr;
+    *size = 0;
+    if (blob->payload) {
+      if (!blob->payload->InOnePiece()) {
+        return hrgls_STATUS_SEGMENTED_DATA;
+      }
+      *data = blob->payload->first.data;
+      *size = static_cast<uint32_t>(blob->payload->totalSize);
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSetData(hrgls_DataBlob blob, const uint8_t* data, uint32_t size,
+    hrgls_DeletionFunction deleteFunction, void* userData)
+  {
+    hrgls_FORWARD(blob, DataBlobSetData, (blob, data, size, deleteFunction, userData));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+
+    // Let go of any data we were referring to before.
+    hrgls_DataBlobReleaseAll(blob);
+    if (!data && !deleteFunction) {
+      return s;
+    }
+
+    hrgls_DataBlobPayload_ *payload;
+    try {
+      payload = HandlePool<hrgls_DataBlobPayload_>::Get().Create();
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    payload->first.data = data;
+    payload->first.size = size;
+    payload->first.deleteFunction = deleteFunction;
+    payload->first.userData = userData;
+    payload->totalSize = size;
+    blob->payload = payload;
+    blob->heldReferences = 1;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSetSegments(hrgls_DataBlob blob,
+    const hrgls_DataBlobSegment *segments, uint32_t count)
+  {
+    hrgls_FORWARD(blob, DataBlobSetSegments, (blob, segments, count));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (count > 0 && !segments) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    uint64_t totalSize = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if ((!segments[i].data && segments[i].size > 0) ||
+          segments[i].size > UINT64_MAX - totalSize) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      totalSize += segments[i].size;
+    }
+
+    // Let go of any data we were referring to before.
+    hrgls_DataBlobReleaseAll(blob);
+    if (count == 0) {
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_DataBlobPayload_ *payload;
+    try {
+      payload = HandlePool<hrgls_DataBlobPayload_>::Get().Create();
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    if (count > 1) {
+      try {
+        payload->rest.reset(new hrgls_DataBlobSegment[count - 1]);
+      } catch (...) {
+        HandlePool<hrgls_DataBlobPayload_>::Get().Destroy(payload);
+        return hrgls_STATUS_OUT_OF_MEMORY;
+      }
+      std::copy(segments + 1, segments + count, payload->rest.get());
+    }
+    payload->first = segments[0];
+    payload->segmentCount = count;
+    payload->totalSize = totalSize;
+    blob->payload = payload;
+    blob->heldReferences = 1;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobGetSegmentCount(hrgls_DataBlob blob, uint32_t *count)
+  {
+    hrgls_FORWARD(blob, DataBlobGetSegmentCount, (blob, count));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!count) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *count = blob->payload ? blob->payload->segmentCount : 0;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobGetSegment(hrgls_DataBlob blob, uint32_t which,
+    const uint8_t **data, uint64_t *size)
+  {
+    hrgls_FORWARD(blob, DataBlobGetSegment, (blob, which, data, size));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!data || !size || !blob->payload || which >= blob->payload->segmentCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    const hrgls_DataBlobSegment &segment = blob->payload->Segment(which);
+    *data = segment.data;
+    *size = segment.size;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobGetTotalSize(hrgls_DataBlob blob, uint64_t *size)
+  {
+    hrgls_FORWARD(blob, DataBlobGetTotalSize, (blob, size));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!size) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *size = blob->payload ? blob->payload->totalSize : 0;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobRetainData(hrgls_DataBlob blob)
+  {
+    hrgls_FORWARD(blob, DataBlobRetainData, (blob));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (blob->payload) {
+      blob->payload->refCount.fetch_add(1, std::memory_order_relaxed);
+      blob->heldReferences++;
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobReleaseData(hrgls_DataBlob blob)
+  {
+    hrgls_FORWARD(blob, DataBlobReleaseData, (blob));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    // Releasing a handle that no longer holds any references does nothing, so
+    // this is robust to being called more than once.
+    if (blob->heldReferences > 0) {
+      blob->heldReferences--;
+      hrgls_DataBlobPayloadRelease(blob->payload);
+      if (blob->heldReferences == 0) {
+        blob->payload = nullptr;
+      }
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobGetDataReferenceCount(hrgls_DataBlob blob, uint32_t *count)
+  {
+    hrgls_FORWARD(blob, DataBlobGetDataReferenceCount, (blob, count));
+    if (!blob) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!count) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    if (blob->payload) {
+      *count = blob->payload->refCount.load(std::memory_order_acquire);
+    } else {
+      *count = 0;
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  //----------------------------------------------------------------------------
+  /// Handle pool statistics.
+
+  hrgls_Status hrgls_HandlePoolGetStatistics(hrgls_HandlePoolType type,
+    uint64_t *hits, uint64_t *misses)
+  {
+    uint64_t h, m;
+    switch (type) {
+    case hrgls_HANDLE_POOL_DATABLOB:
+      h = HandlePool<hrgls_DataBlob_>::Get().Hits();
+      m = HandlePool<hrgls_DataBlob_>::Get().Misses();
+      break;
+    case hrgls_HANDLE_POOL_DATABLOB_PAYLOAD:
+      h = HandlePool<hrgls_DataBlobPayload_>::Get().Hits();
+      m = HandlePool<hrgls_DataBlobPayload_>::Get().Misses();
+      break;
+    case hrgls_HANDLE_POOL_MESSAGE:
+      h = HandlePool<hrgls_Message_>::Get().Hits();
+      m = HandlePool<hrgls_Message_>::Get().Misses();
+      break;
+    default:
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    if (hits) {
+      *hits = h;
+    }
+    if (misses) {
+      *misses = m;
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_HandlePoolReserve(hrgls_HandlePoolType type, uint32_t count)
+  {
+    try {
+      switch (type) {
+      case hrgls_HANDLE_POOL_DATABLOB:
+        HandlePool<hrgls_DataBlob_>::Get().Reserve(count);
+        break;
+      case hrgls_HANDLE_POOL_DATABLOB_PAYLOAD:
+        HandlePool<hrgls_DataBlobPayload_>::Get().Reserve(count);
+        break;
+      case hrgls_HANDLE_POOL_MESSAGE:
+        HandlePool<hrgls_Message_>::Get().Reserve(count);
+        break;
+      default:
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  //----------------------------------------------------------------------------
+  /// hrgls_BufferPool structures and methods.
+
+  /// Stored just before the memory of each buffer handed out by a pool, so a
+  /// buffer can find its way home without the caller keeping track of its pool.
+  struct hrgls_BufferHeader_ {
+    hrgls_BufferPool_ *pool;
+    size_t capacity;
+    hrgls_BufferHeader_ *next;
+  };
+
+  /// Size of the header rounded up so the buffer after it is maximally aligned.
+  static const size_t hrgls_BufferHeaderSize =
+    (sizeof(hrgls_BufferHeader_) + alignof(std::max_align_t) - 1)
+    / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+  struct hrgls_BufferPool_ : hrgls_Handle_ {
+    size_t bufferSize = 0;
+    size_t maxFreeBuffers = 0;
+
+    std::mutex mutex;
+    hrgls_BufferHeader_ *freeList = nullptr;
+    size_t freeCount = 0;
+    bool destroyed = false;
+
+    /// One reference for the owner plus one for each buffer that is out.
+    std::atomic<size_t> refCount{ 1 };
+
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+  };
+
+  static void hrgls_BufferPoolRelease(hrgls_BufferPool pool)
+  {
+    if (pool->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete pool;
+    }
+  }
+
+  hrgls_Status hrgls_BufferPoolCreate(hrgls_BufferPool *returnPool,
+    uint32_t bufferSize, uint32_t maxFreeBuffers)
+  {
+    if (!returnPool) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnPool = nullptr;
+    if (bufferSize == 0) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    hrgls_BufferPool ret;
+    try {
+      ret = new hrgls_BufferPool_;
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    ret->bufferSize = bufferSize;
+    ret->maxFreeBuffers = maxFreeBuffers;
+    *returnPool = ret;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_BufferPoolDestroy(hrgls_BufferPool pool)
+  {
+    hrgls_FORWARD(pool, BufferPoolDestroy, (pool));
+    if (!pool) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    hrgls_BufferHeader_ *list;
+    {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      pool->destroyed = true;
+      list = pool->freeList;
+      pool->freeList = nullptr;
+      pool->freeCount = 0;
+    }
+    while (list) {
+      hrgls_BufferHeader_ *h = list;
+      list = h->next;
+      ::operator delete(h);
+    }
+    hrgls_BufferPoolRelease(pool);
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_BufferPoolAcquire(hrgls_BufferPool pool, uint32_t size,
+    uint8_t **returnBuffer)
+  {
+    hrgls_FORWARD(pool, BufferPoolAcquire, (pool, size, returnBuffer));
+    if (!pool) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnBuffer) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnBuffer = nullptr;
+
+    hrgls_BufferHeader_ *h = nullptr;
+    if (size <= pool->bufferSize) {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      h = pool->freeList;
+      if (h) {
+        pool->freeList = h->next;
+        pool->freeCount--;
+      }
+    }
+    if (h) {
+      pool->hits++;
+    } else {
+      pool->misses++;
+      size_t capacity = (size <= pool->bufferSize) ? pool->bufferSize : size;
+      try {
+        h = static_cast<hrgls_BufferHeader_*>(::operator new(hrgls_BufferHeaderSize + capacity));
+      } catch (...) {
+        return hrgls_STATUS_OUT_OF_MEMORY;
+      }
+      h->pool = pool;
+      h->capacity = capacity;
+    }
+    h->next = nullptr;
+    pool->refCount.fetch_add(1, std::memory_order_relaxed);
+    *returnBuffer = reinterpret_cast<uint8_t*>(h) + hrgls_BufferHeaderSize;
+    return hrgls_STATUS_OKAY;
+  }
+
+  void hrgls_BufferPoolReturn(void *userData, const uint8_t *buffer)
+  {
+    // The pool is only needed to find which implementation the buffer belongs to.
+    hrgls_BufferPool owner = static_cast<hrgls_BufferPool>(userData);
+    hrgls_FORWARD(owner, BufferPoolReturn, (userData, buffer));
+    if (!buffer) {
+      return;
+    }
+    hrgls_BufferHeader_ *h = reinterpret_cast<hrgls_BufferHeader_*>(
+      const_cast<uint8_t*>(buffer) - hrgls_BufferHeaderSize);
+    hrgls_BufferPool pool = h->pool;
+    bool kept = false;
+    if (h->capacity == pool->bufferSize) {
+      std::lock_guard<std::mutex> lock(pool->mutex);
+      if (!pool->destroyed && pool->freeCount < pool->maxFreeBuffers) {
+        h->next = pool->freeList;
+        pool->freeList = h;
+        pool->freeCount++;
+        kept = true;
+      }
+    }
+    if (!kept) {
+      ::operator delete(h);
+    }
+    hrgls_BufferPoolRelease(pool);
+  }
+
+  hrgls_Status hrgls_BufferPoolGetStatistics(hrgls_BufferPool pool,
+    uint64_t *hits, uint64_t *misses)
+  {
+    hrgls_FORWARD(pool, BufferPoolGetStatistics, (pool, hits, misses));
+    if (!pool) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (hits) {
+      *hits = pool->hits.load();
+    }
+    if (misses) {
+      *misses = pool->misses.load();
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  //----------------------------------------------------------------------------
+  /// hrgls_APIDataBlobSourceInfo structures and methods.
+
+  hrgls_Status hrgls_APIDataBlobSourceGetName(
+    hrgls_APIDataBlobSourceInfo info, const char **returnName)
+  {
+    hrgls_FORWARD(info, APIDataBlobSourceGetName, (info, returnName));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!info) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnName) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    *returnName = info->name.c_str();
+    return s;
+  }
+
+
+  //----------------------------------------------------------------------------
+  /// DataBlobSource structures and methods.
+
+  struct hrgls_DataBlobSourceCreateParams_ : hrgls_Handle_ {
+    hrgls_API api = nullptr;
+    hrgls_StreamProperties streamProperties = nullptr;
+    ::std::string name;
+  };
+
+  hrgls_Status hrgls_DataBlobSourceCreateParametersCreate(
+    hrgls_DataBlobSourceCreateParams *returnParams)
+  {
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    hrgls_DataBlobSourceCreateParams ret;
+    try {
+      ret = new hrgls_DataBlobSourceCreateParams_;
+    } catch (...) {
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+      ret = nullptr;
+    }
+    *returnParams = ret;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSourceCreateParametersDestroy(
+    hrgls_DataBlobSourceCreateParams params)
+  {
+    hrgls_FORWARD(params, DataBlobSourceCreateParametersDestroy, (params));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!params) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    try {
+      delete params;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSourceCreateParametersSetAPI(
+    hrgls_DataBlobSourceCreateParams params, hrgls_API api)
+  {
+    hrgls_FORWARD(params, DataBlobSourceCreateParametersSetAPI, (params, api));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    params->api = api;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSourceCreateParametersSetStreamProperties(
+    hrgls_DataBlobSourceCreateParams params, hrgls_StreamProperties properties)
+  {
+    hrgls_FORWARD(params, DataBlobSourceCreateParametersSetStreamProperties, (params, properties));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    params->streamProperties = properties;
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobSourceCreateParametersSetName(
+    hrgls_DataBlobSourceCreateParams params, const char *name)
+  {
+    hrgls_FORWARD(params, DataBlobSourceCreateParametersSetName, (params, name));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!params) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!name) {
+      params->name = "";
+    } else {
+      params->name = name;
+    }
+    return s;
+  }
+
+  struct hrgls_DataBlobSource_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobSource *stream = nullptr;
+
+    /// C callback function that was registered
+    hrgls_DataBlobSourceCallback CHandler = nullptr;
+
+    /// UserData parameter that was given to us when the callback function was registered.
+    void *CUserData = nullptr;
+
+    /// Last info retrieved.
+    struct hrgls_APIDataBlobSourceInfo_ info;
+
+    /// Set for the sources of a DataBlobSourceGroup, which are destroyed along with it.
+    bool ownedByGroup = false;
+  };
+
+  /// Copy our stream properties into ones made by a loaded implementation.  The copy,
+  /// if one was made, must be destroyed through the implementation even on failure.
+  static hrgls_Status hrgls_CopyStreamProperties(const hrgls_Implementation *impl,
+    hrgls::StreamProperties &from, hrgls_StreamProperties *returnProps)
+  {
+    *returnProps = nullptr;
+    hrgls_Status s;
+    try {
+      if (hrgls_STATUS_OKAY == (s = impl->StreamPropertiesCreate(returnProps)) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetRate(*returnProps, from.Rate())) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetQueueCapacity(*returnProps,
+            from.QueueCapacity())) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetOverflowPolicy(*returnProps,
+            from.OverflowPolicy())) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetPayloadSize(*returnProps,
+            from.PayloadSize())) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetPayloadDistribution(*returnProps,
+            from.PayloadDistribution())) &&
+          hrgls_STATUS_OKAY == (s = impl->StreamPropertiesSetBurstLength(*returnProps,
+            from.BurstLength()))) {
+        return hrgls_STATUS_OKAY;
+      }
+    } catch (...) {
+      s = hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    return s;
+  }
+
+  /// Copy our creation parameters and stream properties into ones made by the loaded
+  /// implementation of their API, and create something on it with them.
+  static hrgls_Status hrgls_ForwardWithCreateParams(hrgls_DataBlobSourceCreateParams params,
+    const std::function<hrgls_Status(const hrgls_Implementation *impl,
+      hrgls_DataBlobSourceCreateParams p)> &create)
+  {
+    const hrgls_Implementation *impl = hrgls_ImplementationOf(params->api);
+    hrgls_DataBlobSourceCreateParams p;
+    hrgls_Status s = impl->DataBlobSourceCreateParametersCreate(&p);
+    if (s != hrgls_STATUS_OKAY) {
+      return s;
+    }
+    hrgls_StreamProperties props = nullptr;
+    if (hrgls_STATUS_OKAY == (s = impl->DataBlobSourceCreateParametersSetAPI(p, params->api)) &&
+        hrgls_STATUS_OKAY == (s = impl->DataBlobSourceCreateParametersSetName(p,
+          params->name.c_str())) &&
+        params->streamProperties) {
+      if (hrgls_STATUS_OKAY == (s = hrgls_CopyStreamProperties(impl,
+            *params->streamProperties->props, &props))) {
+        s = impl->DataBlobSourceCreateParametersSetStreamProperties(p, props);
+      }
+    }
+    if (s == hrgls_STATUS_OKAY) {
+      s = create(impl, p);
+    }
+    impl->DataBlobSourceCreateParametersDestroy(p);
+    if (props) {
+      impl->StreamPropertiesDestroy(props);
+    }
+    return s;
+  }
+
+  /// Create a DataBlobSource on an API from a loaded implementation.
+  static hrgls_Status hrgls_ForwardDataBlobSourceCreate(hrgls_DataBlobSource *returnStream,
+    hrgls_DataBlobSourceCreateParams params)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  if (!val) {
-		  return hrgls_STATUS_BAD_PARAMETER;
-	  }
+    *returnStream = nullptr;
+    return hrgls_ForwardWithCreateParams(params,
+      [returnStream](const hrgls_Implementation *impl, hrgls_DataBlobSourceCreateParams p) {
+        return impl->DataBlobSourceCreate(returnStream, p);
+      });
+  }
 
-	  *val = obj->value.c_str();
-	  return s;
+  hrgls_Status hrgls_DataBlobSourceCreate(hrgls_DataBlobSource *returnStream,
+    hrgls_DataBlobSourceCreateParams params)
+  {
+    hrgls_Status s;
+
+    // Check the parameters.
+    if (!returnStream || !params || !params->api) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    if (hrgls_ImplementationOf(params->api) != &hrgls_ThisImplementation) {
+      return hrgls_ForwardDataBlobSourceCreate(returnStream, params);
+    }
+
+    // Attempt to construct the object.
+    s = hrgls_STATUS_OKAY;
+    hrgls_DataBlobSource ret;
+    try {
+      ret = new hrgls_DataBlobSource_;
+    } catch (...) {
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+      ret = nullptr;
+    }
+    try {
+      // Get the C++ parameters out of the C structure pointers.
+      hrgls::StreamProperties *prop = nullptr;
+      if (params->streamProperties) { prop = params->streamProperties->props; }
+      ret->stream = new hrgls::datablob::DataBlobSource(*params->api->api, *prop,
+        params->name);
+    } catch (...) {
+      s = hrgls_STATUS_OUT_OF_MEMORY;
+      ret->stream = nullptr;
+      delete ret;
+      ret = nullptr;
+    }
+    *returnStream = ret;
+    return ret->stream->GetStatus();
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageSetValue(hrgls_Message obj, const char *val)
+  hrgls_Status hrgls_DataBlobSourceDestroy(hrgls_DataBlobSource stream)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  if (!val) {
-		  return hrgls_STATUS_BAD_PARAMETER;
-	  }
-	  obj->value = val;
-	  return s;
+    hrgls_FORWARD(stream, DataBlobSourceDestroy, (stream));
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    if (!stream) {
+      s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    } else if (stream->ownedByGroup) {
+      s = hrgls_STATUS_BAD_PARAMETER;
+    } else {
+      if (!stream->stream) {
+        s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
+      } else {
+        try {
+          delete stream->stream;
+        } catch (...) {
+          s = hrgls_STATUS_DELETION_FAILED;
+        }
+        stream->stream = nullptr;
+      }
+      try {
+        delete stream;
+      } catch (...) {
+        s = hrgls_STATUS_DELETION_FAILED;
+      }
+    }
+    return s;
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageGetTimeStamp(hrgls_Message obj, struct timeval *val)
+  hrgls_Status hrgls_DataBlobSourceSetStreamingState(hrgls_DataBlobSource stream,
+    bool running)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  if (!val) {
-		  return hrgls_STATUS_BAD_PARAMETER;
-	  }
+    hrgls_FORWARD(stream, DataBlobSourceSetStreamingState, (stream, running));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return stream->stream->SetStreamingState(running);
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
 
-	  *val = obj->timeStamp;
-	  return s;
+  hrgls_Status hrgls_DataBlobSourceSetStreamCallback(hrgls_DataBlobSource stream,
+    hrgls_DataBlobSourceCallback handler, void *userData)
+  {
+    hrgls_FORWARD(stream, DataBlobSourceSetStreamCallback, (stream, handler, userData));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    stream->CHandler = handler;
+    stream->CUserData = userData;
+    try {
+      // If we are supposed to be calling a callback handler, then set our callback handler
+      // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
+      if (!handler) {
+        return stream->stream->SetStreamCallback(nullptr, nullptr);
+      }
+      return stream->stream->SetStreamCallback(DataBlobSourceCallback, stream);
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageSetTimeStamp(hrgls_Message obj, struct timeval val)
+  hrgls_Status hrgls_DataBlobSourceGetNextBlob(hrgls_DataBlobSource stream,
+    hrgls_DataBlob * blob, struct timeval timeout)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  obj->timeStamp = val;
-	  return s;
+    hrgls_FORWARD(stream, DataBlobSourceGetNextBlob, (stream, blob, timeout));
+    hrgls_TRACE_C_FUNCTION(stream);
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!blob) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      hrgls::datablob::DataBlob f = stream->stream->GetNextBlob(timeout);
+      hrgls_Status s = stream->stream->GetStatus();
+
+      // Hand the wrapped blob to the caller without copying it.  There is
+      // always a blob to destroy, even when there is no data.
+      *blob = f.Detach();
+      if (!*blob) {
+        hrgls_Status cs = hrgls_DataBlobCreate(blob);
+        if (cs != hrgls_STATUS_OKAY) {
+          return cs;
+        }
+      }
+      return s;
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageGetLevel(hrgls_Message obj, hrgls_MessageLevel *val)
+  hrgls_Status hrgls_DataBlobSourceGetPendingBlobs(hrgls_DataBlobSource stream,
+    hrgls_DataBlob *blobs, uint32_t maxNum, uint32_t *returnCount, struct timeval timeout)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  if (!val) {
-		  return hrgls_STATUS_BAD_PARAMETER;
-	  }
+    hrgls_FORWARD(stream, DataBlobSourceGetPendingBlobs,
+      (stream, blobs, maxNum, returnCount, timeout));
+    hrgls_TRACE_C_FUNCTION(stream);
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!blobs || !returnCount || maxNum == 0) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnCount = 0;
+    try {
+      ::std::vector<hrgls::datablob::DataBlob> f = stream->stream->GetPendingBlobs(maxNum, timeout);
+      hrgls_Status s = stream->stream->GetStatus();
+
+      // Hand the wrapped blobs to the caller without copying them.
+      for (size_t i = 0; i < f.size(); i++) {
+        hrgls_DataBlob b = f[i].Detach();
+        if (b) {
+          blobs[(*returnCount)++] = b;
+        }
+      }
+      return s;
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
 
-	  *val = obj->level;
-	  return s;
+  hrgls_Status hrgls_DataBlobSourceGetDroppedBlobCount(hrgls_DataBlobSource stream,
+    uint64_t *count)
+  {
+    hrgls_FORWARD(stream, DataBlobSourceGetDroppedBlobCount, (stream, count));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!count) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *count = stream->stream->GetDroppedBlobCount();
+      return stream->stream->GetStatus();
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_DataBlobSourceGetStatistics(hrgls_DataBlobSource stream,
+    hrgls_StreamStatistics stats)
+  {
+    if (stream && hrgls_ImplementationOf(stream) != &hrgls_ThisImplementation) {
+      const hrgls_Implementation *impl = hrgls_ImplementationOf(stream);
+      if (!stats) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      hrgls_StreamStatistics theirs = nullptr;
+      hrgls_Status s = impl->StreamStatisticsCreate(&theirs);
+      if (s == hrgls_STATUS_OKAY &&
+          hrgls_STATUS_OKAY == (s = impl->DataBlobSourceGetStatistics(stream, theirs))) {
+        s = hrgls_CopyForwardedStatistics(impl, theirs, stats);
+      }
+      if (theirs) {
+        impl->StreamStatisticsDestroy(theirs);
+      }
+      return s;
+    }
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!stats) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      stats->stats = stream->stream->GetStatistics();
+      return stream->stream->GetStatus();
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  struct hrgls_DataBlobRequest_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobRequest request;
+  };
+
+  hrgls_Status hrgls_DataBlobSourceGetNextBlobAsync(hrgls_DataBlobSource stream,
+    hrgls_DataBlobRequest *returnRequest)
+  {
+    hrgls_FORWARD(stream, DataBlobSourceGetNextBlobAsync, (stream, returnRequest));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!returnRequest) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnRequest = nullptr;
+    hrgls_DataBlobRequest ret;
+    try {
+      ret = new hrgls_DataBlobRequest_;
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    try {
+      ret->request = stream->stream->GetNextBlobAsync();
+      hrgls_Status s = stream->stream->GetStatus();
+      if (s != hrgls_STATUS_OKAY) {
+        delete ret;
+        return s;
+      }
+    } catch (...) {
+      delete ret;
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+    *returnRequest = ret;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobRequestDestroy(hrgls_DataBlobRequest request)
+  {
+    hrgls_FORWARD(request, DataBlobRequestDestroy, (request));
+    if (!request) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    try {
+      delete request;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobRequestIsReady(hrgls_DataBlobRequest request, bool *ready)
+  {
+    hrgls_FORWARD(request, DataBlobRequestIsReady, (request, ready));
+    if (!request) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!ready) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *ready = request->request.IsReady();
+      return request->request.GetStatus();
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
+
+  hrgls_Status hrgls_DataBlobRequestWait(hrgls_DataBlobRequest request,
+    hrgls_DataBlob *blob, struct timeval timeout)
+  {
+    hrgls_FORWARD(request, DataBlobRequestWait, (request, blob, timeout));
+    if (!request) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!blob) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      hrgls::datablob::DataBlob f = request->request.Wait(timeout);
+      hrgls_Status s = request->request.GetStatus();
+
+      // Hand the wrapped blob to the caller without copying it.  There is
+      // always a blob to destroy, even when there is no data.
+      *blob = f.Detach();
+      if (!*blob) {
+        hrgls_Status cs = hrgls_DataBlobCreate(blob);
+        if (cs != hrgls_STATUS_OKAY) {
+          return cs;
+        }
+      }
+      return s;
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  HRGLS_EXPORT hrgls_Status hrgls_MessageSetLevel(hrgls_Message obj, hrgls_MessageLevel val)
+  hrgls_Status hrgls_DataBlobSourceGetNotificationFD(hrgls_DataBlobSource stream, int *fd)
   {
-	  hrgls_Status s = hrgls_STATUS_OKAY;
-	  if (!obj) {
-		  return hrgls_STATUS_NULL_OBJECT_POINTER;
-	  }
-	  obj->level = val;
-	  return s;
+    hrgls_FORWARD(stream, DataBlobSourceGetNotificationFD, (stream, fd));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!fd) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      *fd = stream->stream->GetNotificationFD();
+      return stream->stream->GetStatus();
+    } catch (...) {
+      *fd = -1;
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  //----------------------------------------------------------------------------
-  /// hrgls_DataBlob structures and methods.
-
-  struct hrgls_DataBlob_ {
-    const uint8_t *data = nullptr;
-    uint32_t size = 0;
-    struct timeval time = { 0, 0 };
-    hrgls_DeletionFunction deleteFunction = nullptr;
-    void *deleteFunctionUserData = nullptr;
-  };
-
-  hrgls_Status hrgls_DataBlobCreate(hrgls_DataBlob *returnBlob)
+  hrgls_Status hrgls_DataBlobSourcePublishSharedMemory(hrgls_DataBlobSource stream,
+    const char *name)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    hrgls_DataBlob ret;
+    hrgls_FORWARD(stream, DataBlobSourcePublishSharedMemory, (stream, name));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!name) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
     try {
-      ret = new hrgls_DataBlob_;
+      return stream->stream->PublishSharedMemory(name);
     } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
-    *returnBlob = ret;
-    return s;
   }
 
-  hrgls_Status hrgls_DataBlobCopy(hrgls_DataBlob* returnBlob, hrgls_DataBlob blobToCopy)
+  hrgls_Status hrgls_DataBlobSourceSetStreamProperties(hrgls_DataBlobSource stream,
+    hrgls_StreamProperties props)
   {
-    if (!blobToCopy) {
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!props || !props->props) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-    hrgls_Status s = hrgls_STATUS_OKAY;
-
-    // Create a return blob to store the copy into.
-    hrgls_DataBlob ret;
-    try {
-      ret = new hrgls_DataBlob_;
+    // Properties are always made here, so a loaded implementation gets a copy.
+    if (hrgls_ImplementationOf(stream) != &hrgls_ThisImplementation) {
+      const hrgls_Implementation *impl = hrgls_ImplementationOf(stream);
+      hrgls_StreamProperties copy = nullptr;
+      hrgls_Status s = hrgls_CopyStreamProperties(impl, *props->props, &copy);
+      if (s == hrgls_STATUS_OKAY) {
+        s = impl->DataBlobSourceSetStreamProperties(stream, copy);
+      }
+      if (copy) {
+        impl->StreamPropertiesDestroy(copy);
+      }
+      return s;
     }
-    catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+    try {
+      return stream->stream->SetStreamProperties(*props->props);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
-
-    // Copy the fields from the original blob.
-    ret->size = blobToCopy->size;
-    ret->data = blobToCopy->data;
-    ret->deleteFunction = blobToCopy->deleteFunction;
-    ret->deleteFunctionUserData = blobToCopy->deleteFunctionUserData;
-
-    *returnBlob = ret;
-    return s;
   }
 
-  hrgls_Status hrgls_DataBlobDestroy(hrgls_DataBlob blob)
+  hrgls_Status hrgls_DataBlobSourceProvideBuffers(hrgls_DataBlobSource stream,
+    uint8_t * const *buffers, uint32_t count, uint32_t size,
+    hrgls_DeletionFunction returnFunction, void *userData)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!blob) {
-      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    hrgls_FORWARD(stream, DataBlobSourceProvideBuffers,
+      (stream, buffers, count, size, returnFunction, userData));
+    if (!stream) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    try {
-      delete blob;
+    if (!buffers || count == 0) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    catch (...) {
-      s = hrgls_STATUS_DELETION_FAILED;
+    try {
+      return stream->stream->ProvideBuffers(std::vector<uint8_t*>(buffers, buffers + count),
+        size, returnFunction, userData);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
-    return s;
   }
 
-  hrgls_Status hrgls_DataBlobGetTime(hrgls_DataBlob blob, struct timeval *val)
+  hrgls_Status hrgls_DataBlobSourceSetReplayPacing(hrgls_DataBlobSource stream,
+    hrgls_ReplayPacing pacing)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!blob) {
+    hrgls_FORWARD(stream, DataBlobSourceSetReplayPacing, (stream, pacing));
+    if (!stream) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    *val = blob->time;
-    return s;
+    try {
+      return stream->stream->SetReplayPacing(pacing);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  hrgls_Status hrgls_DataBlobSetTime(hrgls_DataBlob im, struct timeval val)
+  hrgls_Status hrgls_DataBlobSourceSeekReplay(hrgls_DataBlobSource stream,
+    struct timeval time)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!im) {
+    hrgls_FORWARD(stream, DataBlobSourceSeekReplay, (stream, time));
+    if (!stream) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    im->time = val;
-    return s;
+    try {
+      return stream->stream->SeekReplay(time);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  hrgls_Status hrgls_DataBlobGetData(hrgls_DataBlob blob, const uint8_t** data, uint32_t* size)
+  hrgls_Status hrgls_DataBlobSourceGetInfo(hrgls_DataBlobSource stream,
+    hrgls_APIDataBlobSourceInfo *returnInfo)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!blob) {
+    hrgls_FORWARD(stream, DataBlobSourceGetInfo, (stream, returnInfo));
+    if (!stream) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    *data = blob->data;
-    *size = blob->size;
-    return s;
+    if (!returnInfo) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      hrgls::DataBlobSourceDescription  info;
+      info = stream->stream->GetInfo();
+      stream->info.name = info.Name();
+      *returnInfo = &stream->info;
+      return stream->stream->GetStatus();
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  hrgls_Status hrgls_DataBlobSetData(hrgls_DataBlob blob, const uint8_t* data, uint32_t size,
-    hrgls_DeletionFunction deleteFunction, void* userData)
+  //----------------------------------------------------------------------------
+  /// hrgls_DataBlobSourceGroup structures and methods.
+
+  struct hrgls_DataBlobSourceGroup_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobSourceGroup *group = nullptr;
+
+    /// Handles for the group's sources, in the same order.
+    std::vector<hrgls_DataBlobSource> sources;
+  };
+
+  hrgls_Status hrgls_DataBlobSourceGroupCreate(hrgls_DataBlobSourceGroup *returnGroup,
+    hrgls_DataBlobSourceCreateParams params, const char * const *names, uint32_t count)
+  {
+    // Check the parameters.
+    if (!returnGroup || !params || !params->api || !params->streamProperties ||
+        (names && count == 0)) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    if (hrgls_ImplementationOf(params->api) != &hrgls_ThisImplementation) {
+      return hrgls_ForwardWithCreateParams(params,
+        [returnGroup, names, count](const hrgls_Implementation *impl,
+            hrgls_DataBlobSourceCreateParams p) {
+          return impl->DataBlobSourceGroupCreate(returnGroup, p, names, count);
+        });
+    }
+
+    hrgls_DataBlobSourceGroup ret = nullptr;
+    try {
+      // An empty list asks the group for all of the sources.
+      ::std::vector< ::std::string > list;
+      if (names) {
+        for (uint32_t i = 0; i < count; i++) {
+          list.push_back(names[i] ? names[i] : "");
+        }
+      } else if (count > 0) {
+        ::std::vector<hrgls::DataBlobSourceDescription> all =
+          params->api->api->GetAvailableDataBlobSources();
+        hrgls_Status s = params->api->api->GetStatus();
+        if (s != hrgls_STATUS_OKAY) {
+          return s;
+        }
+        if (count > all.size()) {
+          return hrgls_STATUS_BAD_PARAMETER;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+          list.push_back(all[i].Name());
+        }
+      }
+
+      ret = new hrgls_DataBlobSourceGroup_;
+      ret->group = new hrgls::datablob::DataBlobSourceGroup(*params->api->api,
+        *params->streamProperties->props, list);
+      hrgls_Status s = ret->group->GetStatus();
+      if (s != hrgls_STATUS_OKAY) {
+        delete ret->group;
+        delete ret;
+        return s;
+      }
+      for (size_t i = 0; i < ret->group->Size(); i++) {
+        ret->sources.push_back(new hrgls_DataBlobSource_);
+        ret->sources.back()->stream = &(*ret->group)[i];
+        ret->sources.back()->ownedByGroup = true;
+      }
+    } catch (...) {
+      if (ret) {
+        for (size_t i = 0; i < ret->sources.size(); i++) {
+          delete ret->sources[i];
+        }
+        delete ret->group;
+        delete ret;
+      }
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    *returnGroup = ret;
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status hrgls_DataBlobSourceGroupDestroy(hrgls_DataBlobSourceGroup group)
   {
+    hrgls_FORWARD(group, DataBlobSourceGroupDestroy, (group));
+    if (!group) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
     hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!blob) {
-      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    try {
+      // The sources stop calling their handlers, which are passed our handles for
+      // them, before we delete the handles.
+      delete group->group;
+      for (size_t i = 0; i < group->sources.size(); i++) {
+        delete group->sources[i];
+      }
+      delete group;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
     }
-    blob->data = data;
-    blob->size = size;
-    blob->deleteFunction = deleteFunction;
-    blob->deleteFunctionUserData = userData;
     return s;
   }
 
-  hrgls_Status hrgls_DataBlobReleaseData(hrgls_DataBlob blob)
+  hrgls_Status hrgls_DataBlobSourceGroupGetCount(hrgls_DataBlobSourceGroup group,
+    uint32_t *returnCount)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!blob) {
+    hrgls_FORWARD(group, DataBlobSourceGroupGetCount, (group, returnCount));
+    if (!group) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (blob->deleteFunction) {
-      // We check to make sure we have a deletion function before deleting.
-      // It is not an error to not have a deletion function, though it is likely
-      // to cause a memory leak.
-      blob->deleteFunction(blob->deleteFunctionUserData, blob->data);
+    if (!returnCount) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    return s;
+    *returnCount = static_cast<uint32_t>(group->sources.size());
+    return hrgls_STATUS_OKAY;
   }
 
-  //----------------------------------------------------------------------------
-  /// hrgls_APIDataBlobSourceInfo structures and methods.
-
-  hrgls_Status hrgls_APIDataBlobSourceGetName(
-    hrgls_APIDataBlobSourceInfo info, const char **returnName)
+  hrgls_Status hrgls_DataBlobSourceGroupGetSource(hrgls_DataBlobSourceGroup group,
+    uint32_t which, hrgls_DataBlobSource *returnStream)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!info) {
+    hrgls_FORWARD(group, DataBlobSourceGroupGetSource, (group, which, returnStream));
+    if (!group) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnName) {
+    if (!returnStream || which >= group->sources.size()) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-
-    *returnName = info->name.c_str();
-    return s;
+    *returnStream = group->sources[which];
+    return hrgls_STATUS_OKAY;
   }
 
+  hrgls_Status hrgls_DataBlobSourceGroupSetStreamingState(
+    hrgls_DataBlobSourceGroup group, bool running)
+  {
+    hrgls_FORWARD(group, DataBlobSourceGroupSetStreamingState, (group, running));
+    if (!group) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return group->group->SetStreamingState(running);
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
 
   //----------------------------------------------------------------------------
-  /// DataBlobSource structures and methods.
+  /// hrgls_DataBlobMultiplexer structures and methods.
 
-  struct hrgls_DataBlobSourceCreateParams_ {
-    hrgls_API api = nullptr;
-    hrgls_StreamProperties streamProperties = nullptr;
-    ::std::string name;
+  struct hrgls_DataBlobMultiplexer_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobMultiplexer *mux = nullptr;
   };
 
-  hrgls_Status hrgls_DataBlobSourceCreateParametersCreate(
-    hrgls_DataBlobSourceCreateParams *returnParams)
+  hrgls_Status hrgls_DataBlobMultiplexerCreate(hrgls_DataBlobMultiplexer *returnMultiplexer,
+    hrgls_API api)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    hrgls_DataBlobSourceCreateParams ret;
+    hrgls_FORWARD(api, DataBlobMultiplexerCreate, (returnMultiplexer, api));
+    if (!returnMultiplexer || !api) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnMultiplexer = nullptr;
+    hrgls_DataBlobMultiplexer ret;
     try {
-      ret = new hrgls_DataBlobSourceCreateParams_;
+      ret = new hrgls_DataBlobMultiplexer_;
     } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+      return hrgls_STATUS_OUT_OF_MEMORY;
     }
-    *returnParams = ret;
-    return s;
+    try {
+      ret->mux = new hrgls::datablob::DataBlobMultiplexer(*api->api);
+    } catch (...) {
+      delete ret;
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    *returnMultiplexer = ret;
+    return ret->mux->GetStatus();
   }
 
-  hrgls_Status hrgls_DataBlobSourceCreateParametersDestroy(
-    hrgls_DataBlobSourceCreateParams params)
+  hrgls_Status hrgls_DataBlobMultiplexerDestroy(hrgls_DataBlobMultiplexer multiplexer)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!params) {
+    hrgls_FORWARD(multiplexer, DataBlobMultiplexerDestroy, (multiplexer));
+    if (!multiplexer) {
       return hrgls_STATUS_DELETE_OF_NULL_POINTER;
     }
+    hrgls_Status s = hrgls_STATUS_OKAY;
     try {
-      delete params;
+      delete multiplexer->mux;
+      delete multiplexer;
     } catch (...) {
       s = hrgls_STATUS_DELETION_FAILED;
     }
     return s;
   }
 
-  hrgls_Status hrgls_DataBlobSourceCreateParametersSetAPI(
-    hrgls_DataBlobSourceCreateParams params, hrgls_API api)
+  hrgls_Status hrgls_DataBlobMultiplexerAddSource(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlobSource stream, uint32_t sourceId)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!params) {
+    // Sources can only be waited on by a multiplexer from the same implementation.
+    if (multiplexer && stream &&
+        hrgls_ImplementationOf(stream) != hrgls_ImplementationOf(multiplexer)) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    hrgls_FORWARD(multiplexer, DataBlobMultiplexerAddSource, (multiplexer, stream, sourceId));
+    if (!multiplexer || !multiplexer->mux) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    params->api = api;
-    return s;
+    if (!stream || !stream->stream) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      return multiplexer->mux->AddSource(*stream->stream, sourceId);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  hrgls_Status hrgls_DataBlobSourceCreateParametersSetStreamProperties(
-    hrgls_DataBlobSourceCreateParams params, hrgls_StreamProperties properties)
+  hrgls_Status hrgls_DataBlobMultiplexerRemoveSource(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlobSource stream)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!params) {
+    if (multiplexer && stream &&
+        hrgls_ImplementationOf(stream) != hrgls_ImplementationOf(multiplexer)) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    hrgls_FORWARD(multiplexer, DataBlobMultiplexerRemoveSource, (multiplexer, stream));
+    if (!multiplexer || !multiplexer->mux) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    params->streamProperties = properties;
-    return s;
+    if (!stream || !stream->stream) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      return multiplexer->mux->RemoveSource(*stream->stream);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
   }
 
-  hrgls_Status hrgls_DataBlobSourceCreateParametersSetName(
-    hrgls_DataBlobSourceCreateParams params, const char *name)
+  hrgls_Status hrgls_DataBlobMultiplexerGetNextBlob(hrgls_DataBlobMultiplexer multiplexer,
+    hrgls_DataBlob *blob, uint32_t *sourceId, struct timeval timeout)
   {
-    hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!params) {
+    hrgls_FORWARD(multiplexer, DataBlobMultiplexerGetNextBlob,
+      (multiplexer, blob, sourceId, timeout));
+    hrgls_TRACE_C_FUNCTION(multiplexer);
+    if (!multiplexer || !multiplexer->mux) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!name) {
-      params->name = "";
-    } else {
-      params->name = name;
+    if (!blob) {
+      return hrgls_STATUS_BAD_PARAMETER;
     }
-    return s;
-  }
-
-  struct hrgls_DataBlobSource_ {
-    hrgls::datablob::DataBlobSource *stream = nullptr;
+    try {
+      uint32_t id = 0;
+      hrgls::datablob::DataBlob f = multiplexer->mux->GetNextBlob(id, timeout);
+      hrgls_Status s = multiplexer->mux->GetStatus();
+      if ((s == hrgls_STATUS_OKAY) && sourceId) {
+        *sourceId = id;
+      }
 
-    /// C callback function that was registered
-    hrgls_DataBlobSourceCallback CHandler = nullptr;
+      // Hand the wrapped blob to the caller without copying it.  There is
+      // always a blob to destroy, even when there is no data.
+      *blob = f.Detach();
+      if (!*blob) {
+        hrgls_Status cs = hrgls_DataBlobCreate(blob);
+        if (cs != hrgls_STATUS_OKAY) {
+          return cs;
+        }
+      }
+      return s;
+    }
+    catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
+    }
+  }
 
-    /// UserData parameter that was given to us when the callback function was registered.
-    void *CUserData = nullptr;
+  //----------------------------------------------------------------------------
+  /// hrgls_DataBlobMerger structures and methods.
 
-    /// Last info retrieved.
-    struct hrgls_APIDataBlobSourceInfo_ info;
+  struct hrgls_DataBlobMerger_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobMerger *merger = nullptr;
   };
 
-  hrgls_Status hrgls_DataBlobSourceCreate(hrgls_DataBlobSource *returnStream,
-    hrgls_DataBlobSourceCreateParams params)
+  hrgls_Status hrgls_DataBlobMergerCreate(hrgls_DataBlobMerger *returnMerger,
+    hrgls_API api, struct timeval reorderWindow, hrgls_LateBlobPolicy latePolicy)
   {
-    hrgls_Status s;
-
-    // Check the parameters.
-    if (!returnStream || !params || !params->api) {
+    hrgls_FORWARD(api, DataBlobMergerCreate, (returnMerger, api, reorderWindow, latePolicy));
+    if (!returnMerger || !api) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
-
-    // Attempt to construct the object.
-    s = hrgls_STATUS_OKAY;
-    hrgls_DataBlobSource ret;
+    *returnMerger = nullptr;
+    hrgls_DataBlobMerger ret;
     try {
-      ret = new hrgls_DataBlobSource_;
+      ret = new hrgls_DataBlobMerger_;
     } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret = nullptr;
+      return hrgls_STATUS_OUT_OF_MEMORY;
     }
     try {
-      // Get the C++ parameters out of the C structure pointers.
-      hrgls::StreamProperties *prop = nullptr;
-      if (params->streamProperties) { prop = params->streamProperties->props; }
-      ret->stream = new hrgls::datablob::DataBlobSource(*params->api->api, *prop,
-        params->name);
+      ret->merger = new hrgls::datablob::DataBlobMerger(*api->api, reorderWindow, latePolicy);
     } catch (...) {
-      s = hrgls_STATUS_OUT_OF_MEMORY;
-      ret->stream = nullptr;
       delete ret;
-      ret = nullptr;
+      return hrgls_STATUS_OUT_OF_MEMORY;
     }
-    *returnStream = ret;
-    return ret->stream->GetStatus();
+    hrgls_Status s = ret->merger->GetStatus();
+    if (s != hrgls_STATUS_OKAY) {
+      delete ret->merger;
+      delete ret;
+      return s;
+    }
+    *returnMerger = ret;
+    return s;
   }
 
-  hrgls_Status hrgls_DataBlobSourceDestroy(hrgls_DataBlobSource stream)
+  hrgls_Status hrgls_DataBlobMergerDestroy(hrgls_DataBlobMerger merger)
   {
+    hrgls_FORWARD(merger, DataBlobMergerDestroy, (merger));
+    if (!merger) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
     hrgls_Status s = hrgls_STATUS_OKAY;
-    if (!stream) {
-      s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
-    } else {
-      if (!stream->stream) {
-        s = hrgls_STATUS_DELETE_OF_NULL_POINTER;
-      } else {
-        try {
-          delete stream->stream;
-        } catch (...) {
-          s = hrgls_STATUS_DELETION_FAILED;
-        }
-        stream->stream = nullptr;
-      }
-      try {
-        delete stream;
-      } catch (...) {
-        s = hrgls_STATUS_DELETION_FAILED;
-      }
+    try {
+      delete merger->merger;
+      delete merger;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
     }
     return s;
   }
 
-  hrgls_Status hrgls_DataBlobSourceSetStreamingState(hrgls_DataBlobSource stream,
-    bool running)
+  hrgls_Status hrgls_DataBlobMergerAddSource(hrgls_DataBlobMerger merger,
+    hrgls_DataBlobSource stream, uint32_t sourceId)
   {
-    if (!stream) {
+    // Sources can only be merged by a merger from the same implementation.
+    if (merger && stream && hrgls_ImplementationOf(stream) != hrgls_ImplementationOf(merger)) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    hrgls_FORWARD(merger, DataBlobMergerAddSource, (merger, stream, sourceId));
+    if (!merger || !merger->merger) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
+    if (!stream || !stream->stream) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
     try {
-      return stream->stream->SetStreamingState(running);
+      return merger->merger->AddSource(*stream->stream, sourceId);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
-    catch (...) {
+  }
+
+  hrgls_Status hrgls_DataBlobMergerRemoveSource(hrgls_DataBlobMerger merger,
+    hrgls_DataBlobSource stream)
+  {
+    if (merger && stream && hrgls_ImplementationOf(stream) != hrgls_ImplementationOf(merger)) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    hrgls_FORWARD(merger, DataBlobMergerRemoveSource, (merger, stream));
+    if (!merger || !merger->merger) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    if (!stream || !stream->stream) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    try {
+      return merger->merger->RemoveSource(*stream->stream);
+    } catch (...) {
       return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
   }
 
-  hrgls_Status hrgls_DataBlobSourceSetStreamCallback(hrgls_DataBlobSource stream,
-    hrgls_DataBlobSourceCallback handler, void *userData)
+  hrgls_Status hrgls_DataBlobMergerGetNextBlob(hrgls_DataBlobMerger merger,
+    hrgls_DataBlob *blob, uint32_t *sourceId, struct timeval timeout)
   {
-    if (!stream) {
+    hrgls_FORWARD(merger, DataBlobMergerGetNextBlob, (merger, blob, sourceId, timeout));
+    hrgls_TRACE_C_FUNCTION(merger);
+    if (!merger || !merger->merger) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    stream->CHandler = handler;
-    stream->CUserData = userData;
+    if (!blob) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
     try {
-      // If we are supposed to be calling a callback handler, then set our callback handler
-      // as the intercept.  If not, then set it to nullptr so that no callbacks are called.
-      if (!handler) {
-        return stream->stream->SetStreamCallback(nullptr, nullptr);
+      uint32_t id = 0;
+      hrgls::datablob::DataBlob f = merger->merger->GetNextBlob(id, timeout);
+      hrgls_Status s = merger->merger->GetStatus();
+      if ((s == hrgls_STATUS_OKAY) && sourceId) {
+        *sourceId = id;
       }
-      return stream->stream->SetStreamCallback(DataBlobSourceCallback, stream);
+
+      // Hand the wrapped blob to the caller without copying it.  There is
+      // always a blob to destroy, even when there is no data.
+      *blob = f.Detach();
+      if (!*blob) {
+        hrgls_Status cs = hrgls_DataBlobCreate(blob);
+        if (cs != hrgls_STATUS_OKAY) {
+          return cs;
+        }
+      }
+      return s;
     }
     catch (...) {
       return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
   }
 
-  hrgls_Status hrgls_DataBlobSourceGetNextBlob(hrgls_DataBlobSource stream,
-    hrgls_DataBlob * blob, struct timeval timeout)
+  hrgls_Status hrgls_DataBlobMergerGetLateBlobCount(hrgls_DataBlobMerger merger,
+    uint64_t *count)
   {
-    if (!stream) {
+    hrgls_FORWARD(merger, DataBlobMergerGetLateBlobCount, (merger, count));
+    if (!merger || !merger->merger) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!blob) {
+    if (!count) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
     try {
-      hrgls::datablob::DataBlob f = stream->stream->GetNextBlob(timeout);
-      hrgls_Status s = hrgls_DataBlobCopy(blob, f.RawDataBlob());
-      if (s != hrgls_STATUS_OKAY) {
-        return s;
-      }
-      return stream->stream->GetStatus();
+      *count = merger->merger->GetLateBlobCount();
+      return merger->merger->GetStatus();
     }
     catch (...) {
       return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
   }
 
-  hrgls_Status hrgls_DataBlobSourceGetInfo(hrgls_DataBlobSource stream,
-    hrgls_APIDataBlobSourceInfo *returnInfo)
+  //----------------------------------------------------------------------------
+  /// hrgls_DataBlobRecorder structures and methods.
+
+  struct hrgls_DataBlobRecorder_ : hrgls_Handle_ {
+    hrgls::datablob::DataBlobRecorder *recorder = nullptr;
+  };
+
+  hrgls_Status hrgls_DataBlobRecorderCreate(hrgls_DataBlobRecorder *returnRecorder,
+    const char *fileName)
   {
-    if (!stream) {
+    if (!returnRecorder || !fileName) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    *returnRecorder = nullptr;
+    hrgls_DataBlobRecorder ret;
+    try {
+      ret = new hrgls_DataBlobRecorder_;
+    } catch (...) {
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    try {
+      ret->recorder = new hrgls::datablob::DataBlobRecorder(fileName);
+    } catch (...) {
+      delete ret;
+      return hrgls_STATUS_OUT_OF_MEMORY;
+    }
+    *returnRecorder = ret;
+    return ret->recorder->GetStatus();
+  }
+
+  hrgls_Status hrgls_DataBlobRecorderDestroy(hrgls_DataBlobRecorder recorder)
+  {
+    hrgls_FORWARD(recorder, DataBlobRecorderDestroy, (recorder));
+    if (!recorder) {
+      return hrgls_STATUS_DELETE_OF_NULL_POINTER;
+    }
+    hrgls_Status s = hrgls_STATUS_OKAY;
+    try {
+      delete recorder->recorder;
+      delete recorder;
+    } catch (...) {
+      s = hrgls_STATUS_DELETION_FAILED;
+    }
+    return s;
+  }
+
+  hrgls_Status hrgls_DataBlobRecorderRecord(hrgls_DataBlobRecorder recorder,
+    hrgls_DataBlob blob)
+  {
+    hrgls_FORWARD(recorder, DataBlobRecorderRecord, (recorder, blob));
+    if (!recorder || !recorder->recorder) {
       return hrgls_STATUS_NULL_OBJECT_POINTER;
     }
-    if (!returnInfo) {
+    if (!blob) {
       return hrgls_STATUS_BAD_PARAMETER;
     }
     try {
-      hrgls::DataBlobSourceDescription  info;
-      info = stream->stream->GetInfo();
-      stream->info.name = info.Name();
-      *returnInfo = &stream->info;
-      return stream->stream->GetStatus();
+      // The copy shares the caller's data rather than duplicating it.
+      hrgls::datablob::DataBlob b(blob);
+      return recorder->recorder->Record(b);
+    } catch (...) {
+      return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
-    catch (...) {
+  }
+
+  hrgls_Status hrgls_DataBlobRecorderFlush(hrgls_DataBlobRecorder recorder)
+  {
+    hrgls_FORWARD(recorder, DataBlobRecorderFlush, (recorder));
+    if (!recorder || !recorder->recorder) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    try {
+      return recorder->recorder->Flush();
+    } catch (...) {
       return hrgls_STATUS_INTERNAL_EXCEPTION;
     }
   }
 
+  //----------------------------------------------------------------------------
+  /// Function table for loading this library as an implementation.
+
+  static void hrgls_FillImplementation()
+  {
+    hrgls_Implementation &t = hrgls_ThisImplementation;
+    t.version = hrgls_IMPLEMENTATION_VERSION;
+      t.ErrorMessage = hrgls_ErrorMessage;
+      t.MessageCreate = hrgls_MessageCreate;
+      t.MessageCopy = hrgls_MessageCopy;
+      t.MessageDestroy = hrgls_MessageDestroy;
+      t.MessageGetValue = hrgls_MessageGetValue;
+      t.MessageSetValue = hrgls_MessageSetValue;
+      t.MessageGetTimeStamp = hrgls_MessageGetTimeStamp;
+      t.MessageSetTimeStamp = hrgls_MessageSetTimeStamp;
+      t.MessageGetLevel = hrgls_MessageGetLevel;
+      t.MessageSetLevel = hrgls_MessageSetLevel;
+      t.APICreateParametersCreate = hrgls_APICreateParametersCreate;
+      t.APICreateParametersDestroy = hrgls_APICreateParametersDestroy;
+      t.APICreateParametersGetName = hrgls_APICreateParametersGetName;
+      t.APICreateParametersSetName = hrgls_APICreateParametersSetName;
+      t.APICreateParametersGetCredentials = hrgls_APICreateParametersGetCredentials;
+      t.APICreateParametersSetCredentials = hrgls_APICreateParametersSetCredentials;
+      t.APICreateParametersGetCallbackThreads = hrgls_APICreateParametersGetCallbackThreads;
+      t.APICreateParametersSetCallbackThreads = hrgls_APICreateParametersSetCallbackThreads;
+      t.APICreateParametersGetEndpoint = hrgls_APICreateParametersGetEndpoint;
+      t.APICreateParametersSetEndpoint = hrgls_APICreateParametersSetEndpoint;
+      t.APICreateParametersGetImplementation = hrgls_APICreateParametersGetImplementation;
+      t.APICreateParametersSetImplementation = hrgls_APICreateParametersSetImplementation;
+      t.APICreate = hrgls_APICreate;
+      t.APIDestroy = hrgls_APIDestroy;
+      t.APIGetVersion = hrgls_APIGetVersion;
+      t.APIGetCurrentSystemTime = hrgls_APIGetCurrentSystemTime;
+      t.APIGetVerbosity = hrgls_APIGetVerbosity;
+      t.APISetVerbosity = hrgls_APISetVerbosity;
+      t.APIDataBlobSourceGetName = hrgls_APIDataBlobSourceGetName;
+      t.APIGetAvailableDataBlobSourceCount = hrgls_APIGetAvailableDataBlobSourceCount;
+      t.APIGetAvailableDataBlobSourceInfo = hrgls_APIGetAvailableDataBlobSourceInfo;
+      t.APISetLogMessageStreamingState = hrgls_APISetLogMessageStreamingState;
+      t.APISetLogMessageCallback = hrgls_APISetLogMessageCallback;
+      t.APIGetNextLogMessage = hrgls_APIGetNextLogMessage;
+      t.APIGetDroppedLogMessageCount = hrgls_APIGetDroppedLogMessageCount;
+      t.APISetLogMessageMinimumLevel = hrgls_APISetLogMessageMinimumLevel;
+      t.APIStartServer = hrgls_APIStartServer;
+      t.APIAddReplayFile = hrgls_APIAddReplayFile;
+      t.StreamPropertiesCreate = hrgls_StreamPropertiesCreate;
+      t.StreamPropertiesDestroy = hrgls_StreamPropertiesDestroy;
+      t.StreamPropertiesGetRate = hrgls_StreamPropertiesGetRate;
+      t.StreamPropertiesSetRate = hrgls_StreamPropertiesSetRate;
+      t.StreamPropertiesGetQueueCapacity = hrgls_StreamPropertiesGetQueueCapacity;
+      t.StreamPropertiesSetQueueCapacity = hrgls_StreamPropertiesSetQueueCapacity;
+      t.StreamPropertiesGetOverflowPolicy = hrgls_StreamPropertiesGetOverflowPolicy;
+      t.StreamPropertiesSetOverflowPolicy = hrgls_StreamPropertiesSetOverflowPolicy;
+      t.DataBlobCreate = hrgls_DataBlobCreate;
+      t.DataBlobCopy = hrgls_DataBlobCopy;
+      t.DataBlobDestroy = hrgls_DataBlobDestroy;
+      t.DataBlobGetTime = hrgls_DataBlobGetTime;
+      t.DataBlobSetTime = hrgls_DataBlobSetTime;
+      t.DataBlobGetData = hrgls_DataBlobGetData;
+      t.DataBlobSetData = hrgls_DataBlobSetData;
+      t.DataBlobRetainData = hrgls_DataBlobRetainData;
+      t.DataBlobReleaseData = hrgls_DataBlobReleaseData;
+      t.DataBlobGetDataReferenceCount = hrgls_DataBlobGetDataReferenceCount;
+      t.HandlePoolGetStatistics = hrgls_HandlePoolGetStatistics;
+      t.HandlePoolReserve = hrgls_HandlePoolReserve;
+      t.BufferPoolCreate = hrgls_BufferPoolCreate;
+      t.BufferPoolDestroy = hrgls_BufferPoolDestroy;
+      t.BufferPoolAcquire = hrgls_BufferPoolAcquire;
+      t.BufferPoolReturn = hrgls_BufferPoolReturn;
+      t.BufferPoolGetStatistics = hrgls_BufferPoolGetStatistics;
+      t.APIGetBufferPool = hrgls_APIGetBufferPool;
+      t.DataBlobSourceCreateParametersCreate = hrgls_DataBlobSourceCreateParametersCreate;
+      t.DataBlobSourceCreateParametersDestroy = hrgls_DataBlobSourceCreateParametersDestroy;
+      t.DataBlobSourceCreateParametersSetAPI = hrgls_DataBlobSourceCreateParametersSetAPI;
+      t.DataBlobSourceCreateParametersSetName = hrgls_DataBlobSourceCreateParametersSetName;
+      t.DataBlobSourceCreateParametersSetStreamProperties = hrgls_DataBlobSourceCreateParametersSetStreamProperties;
+      t.DataBlobSourceCreate = hrgls_DataBlobSourceCreate;
+      t.DataBlobSourceDestroy = hrgls_DataBlobSourceDestroy;
+      t.DataBlobSourceSetStreamingState = hrgls_DataBlobSourceSetStreamingState;
+      t.DataBlobSourceSetStreamCallback = hrgls_DataBlobSourceSetStreamCallback;
+      t.DataBlobSourceGetNextBlob = hrgls_DataBlobSourceGetNextBlob;
+      t.DataBlobSourceGetPendingBlobs = hrgls_DataBlobSourceGetPendingBlobs;
+      t.DataBlobSourceGetDroppedBlobCount = hrgls_DataBlobSourceGetDroppedBlobCount;
+      t.DataBlobSourceGetNextBlobAsync = hrgls_DataBlobSourceGetNextBlobAsync;
+      t.DataBlobRequestDestroy = hrgls_DataBlobRequestDestroy;
+      t.DataBlobRequestIsReady = hrgls_DataBlobRequestIsReady;
+      t.DataBlobRequestWait = hrgls_DataBlobRequestWait;
+      t.DataBlobSourceGetNotificationFD = hrgls_DataBlobSourceGetNotificationFD;
+      t.DataBlobSourcePublishSharedMemory = hrgls_DataBlobSourcePublishSharedMemory;
+      t.DataBlobSourceGetInfo = hrgls_DataBlobSourceGetInfo;
+      t.DataBlobSourceSetReplayPacing = hrgls_DataBlobSourceSetReplayPacing;
+      t.DataBlobSourceSeekReplay = hrgls_DataBlobSourceSeekReplay;
+      t.DataBlobMultiplexerCreate = hrgls_DataBlobMultiplexerCreate;
+      t.DataBlobMultiplexerDestroy = hrgls_DataBlobMultiplexerDestroy;
+      t.DataBlobMultiplexerAddSource = hrgls_DataBlobMultiplexerAddSource;
+      t.DataBlobMultiplexerRemoveSource = hrgls_DataBlobMultiplexerRemoveSource;
+      t.DataBlobMultiplexerGetNextBlob = hrgls_DataBlobMultiplexerGetNextBlob;
+      t.DataBlobRecorderCreate = hrgls_DataBlobRecorderCreate;
+      t.DataBlobRecorderDestroy = hrgls_DataBlobRecorderDestroy;
+      t.DataBlobRecorderRecord = hrgls_DataBlobRecorderRecord;
+      t.DataBlobRecorderFlush = hrgls_DataBlobRecorderFlush;
+      t.APICreateParametersGetSourceCount = hrgls_APICreateParametersGetSourceCount;
+      t.APICreateParametersSetSourceCount = hrgls_APICreateParametersSetSourceCount;
+      t.APICreateParametersGetMessageRate = hrgls_APICreateParametersGetMessageRate;
+      t.APICreateParametersSetMessageRate = hrgls_APICreateParametersSetMessageRate;
+      t.APICreateParametersGetMessageLevel = hrgls_APICreateParametersGetMessageLevel;
+      t.APICreateParametersSetMessageLevel = hrgls_APICreateParametersSetMessageLevel;
+      t.StreamPropertiesGetPayloadSize = hrgls_StreamPropertiesGetPayloadSize;
+      t.StreamPropertiesSetPayloadSize = hrgls_StreamPropertiesSetPayloadSize;
+      t.StreamPropertiesGetPayloadDistribution = hrgls_StreamPropertiesGetPayloadDistribution;
+      t.StreamPropertiesSetPayloadDistribution = hrgls_StreamPropertiesSetPayloadDistribution;
+      t.StreamPropertiesGetBurstLength = hrgls_StreamPropertiesGetBurstLength;
+      t.StreamPropertiesSetBurstLength = hrgls_StreamPropertiesSetBurstLength;
+      t.StreamStatisticsCreate = hrgls_StreamStatisticsCreate;
+      t.StreamStatisticsDestroy = hrgls_StreamStatisticsDestroy;
+      t.StreamStatisticsGetProduced = hrgls_StreamStatisticsGetProduced;
+      t.StreamStatisticsGetDelivered = hrgls_StreamStatisticsGetDelivered;
+      t.StreamStatisticsGetDropped = hrgls_StreamStatisticsGetDropped;
+      t.StreamStatisticsGetQueueDepth = hrgls_StreamStatisticsGetQueueDepth;
+      t.StreamStatisticsGetMaxQueueDepth = hrgls_StreamStatisticsGetMaxQueueDepth;
+      t.StreamStatisticsGetLatencyTotal = hrgls_StreamStatisticsGetLatencyTotal;
+      t.StreamStatisticsGetLatencyMax = hrgls_StreamStatisticsGetLatencyMax;
+      t.StreamStatisticsGetLatencyHistogram = hrgls_StreamStatisticsGetLatencyHistogram;
+      t.StreamStatisticsGetCallbacks = hrgls_StreamStatisticsGetCallbacks;
+      t.StreamStatisticsGetCallbackDurationTotal = hrgls_StreamStatisticsGetCallbackDurationTotal;
+      t.StreamStatisticsGetCallbackDurationMax = hrgls_StreamStatisticsGetCallbackDurationMax;
+      t.StreamStatisticsGetCallbackDurationHistogram = hrgls_StreamStatisticsGetCallbackDurationHistogram;
+      t.APIGetLogMessageStatistics = hrgls_APIGetLogMessageStatistics;
+      t.DataBlobSourceGetStatistics = hrgls_DataBlobSourceGetStatistics;
+      t.MessageSetStaticValue = hrgls_MessageSetStaticValue;
+      t.InternString = hrgls_InternString;
+      t.APISetLogMessageViewCallback = hrgls_APISetLogMessageViewCallback;
+      t.TraceStart = hrgls_TraceStart;
+      t.TraceStop = hrgls_TraceStop;
+      t.TraceRecord = hrgls_TraceRecord;
+      t.TraceDump = hrgls_TraceDump;
+      t.APIGetDataBlobSourceGeneration = hrgls_APIGetDataBlobSourceGeneration;
+      t.APISetDataBlobSourcesChangedCallback = hrgls_APISetDataBlobSourcesChangedCallback;
+      t.DataBlobSourceGroupCreate = hrgls_DataBlobSourceGroupCreate;
+      t.DataBlobSourceGroupDestroy = hrgls_DataBlobSourceGroupDestroy;
+      t.DataBlobSourceGroupGetCount = hrgls_DataBlobSourceGroupGetCount;
+      t.DataBlobSourceGroupGetSource = hrgls_DataBlobSourceGroupGetSource;
+      t.DataBlobSourceGroupSetStreamingState = hrgls_DataBlobSourceGroupSetStreamingState;
+      t.DataBlobSetSegments = hrgls_DataBlobSetSegments;
+      t.DataBlobGetSegmentCount = hrgls_DataBlobGetSegmentCount;
+      t.DataBlobGetSegment = hrgls_DataBlobGetSegment;
+      t.DataBlobGetTotalSize = hrgls_DataBlobGetTotalSize;
+      t.DataBlobSourceProvideBuffers = hrgls_DataBlobSourceProvideBuffers;
+      t.DataBlobSourceSetStreamProperties = hrgls_DataBlobSourceSetStreamProperties;
+      t.DataBlobMergerCreate = hrgls_DataBlobMergerCreate;
+      t.DataBlobMergerDestroy = hrgls_DataBlobMergerDestroy;
+      t.DataBlobMergerAddSource = hrgls_DataBlobMergerAddSource;
+      t.DataBlobMergerRemoveSource = hrgls_DataBlobMergerRemoveSource;
+      t.DataBlobMergerGetNextBlob = hrgls_DataBlobMergerGetNextBlob;
+      t.DataBlobMergerGetLateBlobCount = hrgls_DataBlobMergerGetLateBlobCount;
+  }
+
+  const hrgls_Implementation *hrgls_GetImplementation(uint32_t version)
+  {
+    static std::once_flag filled;
+    std::call_once(filled, hrgls_FillImplementation);
+    if (version > hrgls_IMPLEMENTATION_VERSION) {
+      return nullptr;
+    }
+    return &hrgls_ThisImplementation;
+  }
+
 }
 
 //-----------------------------------------------------------
@@ -1078,15 +3987,40 @@ static void LogMessageCallback(hrgls::Message &message, void *userData)
   // Get a pointer to the information we need to service the callback.
   if (!userData) { return; }
   hrgls_API info = static_cast<hrgls_API>(userData);
+  hrgls_LogMessageCallback handler;
+  void *handlerUserData;
+  {
+    std::lock_guard<std::mutex> lock(info->CMutex);
+    handler = info->CHandler;
+    handlerUserData = info->CUserData;
+  }
 
-  if (info->CHandler) {
+  if (handler) {
     // Make a copy of the message to hand to the callback handler so that
     // they will destroy it just as they would one that is returned by
     // GetNextMessage().  This is extra work for this case, but it makes the
     // interface consistent between these two cases.
     hrgls_Message copy;
     hrgls_MessageCopy(&copy, message.RawMessage());
-    info->CHandler(copy, info->CUserData);
+    handler(copy, handlerUserData);
+  }
+}
+
+static void LogMessageViewCallback(const hrgls::MessageView &message, void *userData)
+{
+  if (!userData) { return; }
+  hrgls_API info = static_cast<hrgls_API>(userData);
+  hrgls_LogMessageViewCallback handler;
+  void *handlerUserData;
+  {
+    std::lock_guard<std::mutex> lock(info->CMutex);
+    handler = info->CViewHandler;
+    handlerUserData = info->CUserData;
+  }
+
+  // The view is only borrowed for the call, so it is passed on as it is.
+  if (handler) {
+    handler(&message.RawView(), handlerUserData);
   }
 }
 
@@ -1117,6 +4051,11 @@ class hrgls::StreamProperties::StreamProperties_private {
 public:
   hrgls_Status      status = hrgls_STATUS_OKAY;
   double          rate = 30;
+  uint32_t        queueCapacity = 256;
+  hrgls_OverflowPolicy overflowPolicy = hrgls_OVERFLOW_DROP_OLDEST;
+  uint32_t        payloadSize = 256;
+  hrgls_PayloadDistribution payloadDistribution = hrgls_PAYLOAD_FIXED;
+  uint32_t        burstLength = 1;
 };
 
 hrgls::StreamProperties::StreamProperties()
@@ -1132,12 +4071,30 @@ hrgls::StreamProperties::~StreamProperties()
 hrgls::StreamProperties::StreamProperties(const hrgls::StreamProperties &copy)
 {
   m_private.reset(new StreamProperties_private());
-  *m_private = *copy.m_private;
+  if (copy.m_private) {
+    *m_private = *copy.m_private;
+  }
 }
 
 hrgls::StreamProperties &hrgls::StreamProperties::operator = (const hrgls::StreamProperties &copy)
 {
-  *m_private = *copy.m_private;
+  if (!m_private) {
+    m_private.reset(new StreamProperties_private());
+  }
+  if (copy.m_private) {
+    *m_private = *copy.m_private;
+  }
+  return *this;
+}
+
+hrgls::StreamProperties::StreamProperties(hrgls::StreamProperties &&other) noexcept
+  : m_private(std::move(other.m_private))
+{
+}
+
+hrgls::StreamProperties &hrgls::StreamProperties::operator = (hrgls::StreamProperties &&other) noexcept
+{
+  m_private = std::move(other.m_private);
   return *this;
 }
 
@@ -1170,3 +4127,116 @@ hrgls_Status hrgls::StreamProperties::Rate(double rate)
   m_private->rate = rate;
   return hrgls_STATUS_OKAY;
 }
+
+uint32_t hrgls::StreamProperties::QueueCapacity()
+{
+  if (!m_private) {
+    return 0;
+  }
+  m_private->status = hrgls_STATUS_OKAY;
+  return m_private->queueCapacity;
+}
+
+hrgls_Status hrgls::StreamProperties::QueueCapacity(uint32_t capacity)
+{
+  if (!m_private) {
+    return hrgls_STATUS_NULL_OBJECT_POINTER;
+  }
+  if (capacity == 0) {
+    return hrgls_STATUS_BAD_PARAMETER;
+  }
+  m_private->queueCapacity = capacity;
+  return hrgls_STATUS_OKAY;
+}
+
+hrgls_OverflowPolicy hrgls::StreamProperties::OverflowPolicy()
+{
+  if (!m_private) {
+    return hrgls_OVERFLOW_DROP_OLDEST;
+  }
+  m_private->status = hrgls_STATUS_OKAY;
+  return m_private->overflowPolicy;
+}
+
+hrgls_Status hrgls::StreamProperties::OverflowPolicy(hrgls_OverflowPolicy policy)
+{
+  if (!m_private) {
+    return hrgls_STATUS_NULL_OBJECT_POINTER;
+  }
+  switch (policy) {
+  case hrgls_OVERFLOW_DROP_OLDEST:
+  case hrgls_OVERFLOW_DROP_NEWEST:
+  case hrgls_OVERFLOW_BLOCK_PRODUCER:
+    m_private->overflowPolicy = policy;
+    return hrgls_STATUS_OKAY;
+  default:
+    return hrgls_STATUS_BAD_PARAMETER;
+  }
+}
+
+uint32_t hrgls::StreamProperties::PayloadSize()
+{
+  if (!m_private) {
+    return 0;
+  }
+  m_private->status = hrgls_STATUS_OKAY;
+  return m_private->payloadSize;
+}
+
+hrgls_Status hrgls::StreamProperties::PayloadSize(uint32_t size)
+{
+  if (!m_private) {
+    return hrgls_STATUS_NULL_OBJECT_POINTER;
+  }
+  if (size == 0 || size > (1u << 28)) {
+    return hrgls_STATUS_BAD_PARAMETER;
+  }
+  m_private->payloadSize = size;
+  return hrgls_STATUS_OKAY;
+}
+
+hrgls_PayloadDistribution hrgls::StreamProperties::PayloadDistribution()
+{
+  if (!m_private) {
+    return hrgls_PAYLOAD_FIXED;
+  }
+  m_private->status = hrgls_STATUS_OKAY;
+  return m_private->payloadDistribution;
+}
+
+hrgls_Status hrgls::StreamProperties::PayloadDistribution(hrgls_PayloadDistribution distribution)
+{
+  if (!m_private) {
+    return hrgls_STATUS_NULL_OBJECT_POINTER;
+  }
+  switch (distribution) {
+  case hrgls_PAYLOAD_FIXED:
+  case hrgls_PAYLOAD_UNIFORM:
+  case hrgls_PAYLOAD_EXPONENTIAL:
+    m_private->payloadDistribution = distribution;
+    return hrgls_STATUS_OKAY;
+  default:
+    return hrgls_STATUS_BAD_PARAMETER;
+  }
+}
+
+uint32_t hrgls::StreamProperties::BurstLength()
+{
+  if (!m_private) {
+    return 0;
+  }
+  m_private->status = hrgls_STATUS_OKAY;
+  return m_private->burstLength;
+}
+
+hrgls_Status hrgls::StreamProperties::BurstLength(uint32_t length)
+{
+  if (!m_private) {
+    return hrgls_STATUS_NULL_OBJECT_POINTER;
+  }
+  if (length == 0) {
+    return hrgls_STATUS_BAD_PARAMETER;
+  }
+  m_private->burstLength = length;
+  return hrgls_STATUS_OKAY;
+}
@@ -24,547 +24,3940 @@
 #endif
 
 #include "hrgls_api_defs.hpp"
+#include "hrgls_PerThread_impl.hpp"
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+// The DataBlob methods are inline in a direct build, so we need their definitions.
+#include "hrgls_DataBlob_impl.hpp"
+#endif
 #include <iostream>
 #include <chrono>
 #include <ctime>
 #include <set>
 #include <thread>
 #include <mutex>
-#include <list>
+#include <condition_variable>
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <algorithm>
 #include <fstream>
 #include <atomic>
+#include <memory>
+#include <type_traits>
+#include <random>
 #include <string.h>
-
-static std::vector<char> GetFile(std::string fileName)
-{
-  std::vector<char> ret;
-  FILE *f = fopen(fileName.c_str(), "rb");
-  if (!f) { return ret; }
-
-  // Read the DataBlob into memory after finding its size.
-  fseek(f, 0L, SEEK_END);
-  long data_size = ftell(f);
-  fseek(f, 0L, SEEK_SET);
-  ret.resize(data_size);
-  fread(ret.data(), sizeof(ret.data()[0]), data_size, f);
-  fclose(f);
-  return ret;
-}
-
-static void myDelete(void * /*userdata*/, const uint8_t *data)
-{
-  // delete the data array that was allocated when we set it below.
-  delete[] data;
-}
+#include "hrgls_Recording_impl.hpp"
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+// The shared-memory, network and replay transports only use the public classes.
+#include "hrgls_SharedMemory_impl.hpp"
+#include "hrgls_Network_impl.hpp"
+#include "hrgls_Replay_impl.hpp"
+#endif
 
 namespace hrgls {
 
-  class API::API_private {
+  //------------------------------------------------------------------------------
+  /// @brief Deadline-based scheduler that is shared by all of the producers on an API.
+  ///
+  /// Each producer (DataBlobSource or log-message generator) registers a Task with the
+  /// scheduler rather than running its own polling thread.  A small, fixed set of worker
+  /// threads sleeps on a condition variable until the earliest deadline comes due, runs
+  /// the task, and then reschedules it at the time it asks for.  Tasks are never run on
+  /// more than one thread at a time, so each producer sees its own calls in order.
+  ///
+  /// Tasks that are driven by external events (for example, a frame-ready interrupt
+  /// from a real device) can park themselves by returning Clock::time_point::max()
+  /// and be made due immediately from any thread by calling Wake().  Post() runs a
+  /// one-shot task as soon as a worker is available.
+  class Scheduler {
   public:
-    // Keeps track of current verbosity level, defaults to 0 (no messages)
-    uint16_t verbosity = 0;
+    typedef std::chrono::steady_clock Clock;
+    typedef uint64_t TaskId;
+
+    /// @brief Called when a task comes due.
+    ///
+    /// On entry, next holds the time the task was due.  The task should set it to
+    /// the time it next wants to run (Clock::time_point::max() to park until Wake()
+    /// is called) and return true, or return false to be removed from the scheduler.
+    typedef std::function<bool(Clock::time_point &next)> Task;
+
+    /// @brief Start the worker threads.
+    /// @param [in] numThreads Number of workers, 0 picks a small number based on
+    ///        the hardware concurrency.
+    Scheduler(unsigned numThreads = 0)
+    {
+      if (numThreads == 0) {
+        numThreads = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+      }
+      for (unsigned i = 0; i < numThreads; i++) {
+        m_workers.push_back(std::thread(&Scheduler::Worker, this));
+      }
+    }
 
-    // Keep a per-thread status to make it so that a single thread only gets
-    // results from methods that it calls.
-    std::map<std::thread::id, hrgls_Status> status;
-    ::std::vector<DataBlobSourceDescription> rends;
+    /// @brief Stop and join the worker threads; pending tasks are not run.
+    ~Scheduler()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+      }
+      m_wakeup.notify_all();
+      for (auto &t : m_workers) {
+        t.join();
+      }
+    }
 
-    /// Thread that generates DataBlobs and either sends them to the callback
-    /// handler or stores them locally to be gotten one by one.
-    std::thread myThread;
-    volatile bool quitThread = false;   ///< Time to quit the thread.
+    /// @brief Add a task to be run at the specified time.
+    ///
+    /// A time of Clock::time_point::max() adds the task parked, so that it is not run
+    /// until Wake() is called and adding it wakes none of the workers.
+    /// @return Identifier that can be passed to Wake() and Cancel().
+    TaskId Schedule(Clock::time_point when, Task task)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      TaskId id = ++m_nextId;
+      Entry &e = m_tasks[id];
+      e.task = std::move(task);
+      if (when != Clock::time_point::max()) {
+        Push(id, e, when);
+      }
+      return id;
+    }
 
-    // Are we running?  If so, generate messages asynchronously and put into
-    // list.
-    bool messageStreaming = false;
+    /// @brief Add a task to be run as soon as possible.  Can be called from any thread.
+    TaskId Post(Task task) { return Schedule(Clock::now(), task); }
 
-    /// Callback handler registered with us, along with its userdata and a mutex
-    /// that is used to ensure that we read and update both data values atomically.
-    std::mutex callbackMutex;
-    LogMessageCallback callbackHandler = nullptr;
-    void *callbackUserData = nullptr;
+    /// @brief Make a task due immediately.  Can be called from any thread.
+    ///
+    /// If the task is currently running, it will be run again as soon as it returns
+    /// (unless it returns false).  This is how external events feed the scheduler.
+    void Wake(TaskId id)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_tasks.find(id);
+      if (it == m_tasks.end()) {
+        return;
+      }
+      if (it->second.running) {
+        it->second.wakeRequested = true;
+      } else {
+        Push(id, it->second, Clock::now());
+      }
+    }
 
-    /// List of messages that have come in with no callback handler to deal
-    /// with them.  They are retrieved by GetNextLogMessage()
-    std::mutex storedMessagesMutex;
-    std::list<Message> storedMessages;
-    hrgls_MessageLevel minLevel = hrgls_MESSAGE_MINIMUM_INFO;
+    /// @brief Make many tasks due immediately, taking the lock and waking the workers
+    /// once for all of them rather than once each.
+    void Wake(const std::vector<TaskId> &ids)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < ids.size(); i++) {
+          auto it = m_tasks.find(ids[i]);
+          if (it == m_tasks.end()) {
+            continue;
+          }
+          if (it->second.running) {
+            it->second.wakeRequested = true;
+          } else {
+            HeapEntry h;
+            h.when = now;
+            h.id = ids[i];
+            h.generation = ++it->second.generation;
+            m_heap.push_back(h);
+            std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+          }
+        }
+      }
+      m_wakeup.notify_all();
+    }
+
+    /// @brief Remove a task, waiting for it to finish if it is running on another thread.
+    ///
+    /// Once this returns the task will not be called again.
+    void Cancel(TaskId id)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      auto it = m_tasks.find(id);
+      if (it == m_tasks.end()) {
+        return;
+      }
+      if (!it->second.running) {
+        m_tasks.erase(it);
+        return;
+      }
+      it->second.cancelled = true;
+      if (it->second.runningOn == std::this_thread::get_id()) {
+        // A task is cancelling itself; it will be removed when it returns.
+        return;
+      }
+      m_taskDone.wait(lock, [this, id]() { return m_tasks.find(id) == m_tasks.end(); });
+    }
+
+    /// @brief Remove many tasks, taking the lock once for all of them; otherwise the
+    /// same as calling Cancel() on each.
+    void Cancel(const std::vector<TaskId> &ids)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      std::vector<TaskId> running;
+      for (size_t i = 0; i < ids.size(); i++) {
+        auto it = m_tasks.find(ids[i]);
+        if (it == m_tasks.end()) {
+          continue;
+        }
+        if (!it->second.running) {
+          m_tasks.erase(it);
+          continue;
+        }
+        it->second.cancelled = true;
+        if (it->second.runningOn != std::this_thread::get_id()) {
+          running.push_back(ids[i]);
+        }
+      }
+      for (size_t i = 0; i < running.size(); i++) {
+        TaskId id = running[i];
+        m_taskDone.wait(lock, [this, id]() { return m_tasks.find(id) == m_tasks.end(); });
+      }
+    }
+
+  private:
+    struct Entry {
+      Task task;
+      uint64_t generation = 0;          ///< Heap entries with an older generation are stale.
+      bool running = false;
+      bool cancelled = false;
+      bool wakeRequested = false;
+      std::thread::id runningOn;
+    };
+    struct HeapEntry {
+      Clock::time_point when;
+      TaskId id;
+      uint64_t generation;
+      bool operator > (const HeapEntry &o) const { return when > o.when; }
+    };
+
+    /// Must be called with the mutex locked.
+    void Push(TaskId id, Entry &e, Clock::time_point when)
+    {
+      HeapEntry h;
+      h.when = when;
+      h.id = id;
+      h.generation = ++e.generation;
+      bool earliest = m_heap.empty() || (when < m_heap.front().when);
+      m_heap.push_back(h);
+      std::push_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+      if (earliest) {
+        m_wakeup.notify_one();
+      }
+    }
+
+    void Worker()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (!m_quit) {
+        if (m_heap.empty()) {
+          m_wakeup.wait(lock);
+          continue;
+        }
+        HeapEntry top = m_heap.front();
+        if (top.when > Clock::now()) {
+          m_wakeup.wait_until(lock, top.when);
+          continue;
+        }
+        std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<HeapEntry>());
+        m_heap.pop_back();
+
+        // Let another worker handle the next deadline while we run this one.
+        if (!m_heap.empty()) {
+          m_wakeup.notify_one();
+        }
+
+        auto it = m_tasks.find(top.id);
+        if (it == m_tasks.end() || it->second.generation != top.generation ||
+            it->second.running) {
+          continue;
+        }
+        Entry &e = it->second;
+        e.running = true;
+        e.wakeRequested = false;
+        e.runningOn = std::this_thread::get_id();
+        Task task = e.task;
+
+        lock.unlock();
+        Clock::time_point next = top.when;
+        bool keep = false;
+        try {
+          keep = task(next);
+        } catch (...) {
+          keep = false;
+        }
+        lock.lock();
+
+        // The entry cannot have been erased while it was running.
+        it = m_tasks.find(top.id);
+        Entry &done = it->second;
+        done.running = false;
+        if (!keep || done.cancelled) {
+          m_tasks.erase(it);
+          m_taskDone.notify_all();
+        } else if (done.wakeRequested) {
+          Push(top.id, done, Clock::now());
+        } else if (next != Clock::time_point::max()) {
+          Push(top.id, done, next);
+        }
+      }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;     ///< Signalled when the earliest deadline changes.
+    std::condition_variable m_taskDone;   ///< Signalled when a running task is removed.
+    std::map<TaskId, Entry> m_tasks;
+    std::vector<HeapEntry> m_heap;        ///< Min-heap on deadline.
+    TaskId m_nextId = 0;
+    bool m_quit = false;
+    std::vector<std::thread> m_workers;
   };
 
-  static void LogMessageThread(API::API_private *info)
-  {
-      if (!info) { return; }
+  //------------------------------------------------------------------------------
+  /// @brief Work-stealing thread pool that runs callback handlers off of the producers.
+  ///
+  /// Used when an API is created with callback threads, so that a slow handler does not
+  /// hold up the scheduler that drives the producers.  Each worker has its own queue of
+  /// tasks; tasks submitted from a worker go onto its own queue, others are spread among
+  /// the workers.  A worker whose queue is empty takes the oldest task from the back of
+  /// another's, and sleeps only when there is no work anywhere.  The pool makes no
+  /// promises about order; each producer keeps its handler calls in order by having at
+  /// most one task in the pool at a time.
+  class CallbackPool {
+  public:
+    typedef std::function<void()> Task;
 
-      // Keeps track of how long since we sent a message.
-      auto lastMessage = std::chrono::system_clock::now();
+    /// @brief Start the worker threads.
+    /// @param [in] numThreads Number of workers, at least one is started.
+    explicit CallbackPool(unsigned numThreads)
+    {
+      if (numThreads == 0) {
+        numThreads = 1;
+      }
+      for (unsigned i = 0; i < numThreads; i++) {
+        m_workers.emplace_back(new Worker);
+      }
+      for (unsigned i = 0; i < numThreads; i++) {
+        m_workers[i]->thread = std::thread(&CallbackPool::Run, this, i);
+      }
+    }
 
-      hrgls_MessageLevel level = hrgls_MESSAGE_MINIMUM_INFO;
+    /// @brief Stop the workers once they finish the tasks they are running.
+    ///
+    /// Tasks that have not started are discarded.
+    ~CallbackPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_quit = true;
+      }
+      m_wakeup.notify_all();
+      for (size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i]->thread.join();
+      }
+    }
 
-      do {
-          // See if we are streaming.
-          if (info->messageStreaming) {
-              // See if it is time to create a new message.
-              auto now = std::chrono::system_clock::now();
-              std::chrono::duration<float> dt = now - lastMessage;
-              double interval = 0.1;
-              if (dt.count() > interval) {
-
-                  lastMessage = now;
-
-                  // Create a message with cycling level.
-                  ::std::chrono::microseconds uSecSinceEpoch =
-                      ::std::chrono::duration_cast<::std::chrono::microseconds>(now.time_since_epoch());
-                  struct timeval nowTV;
-                  nowTV.tv_sec = static_cast<uint32_t>(uSecSinceEpoch.count() / 1000000);
-                  nowTV.tv_usec = static_cast<uint32_t>(uSecSinceEpoch.count() - nowTV.tv_sec * 1000000);
-                  Message m("value of the message", nowTV, level);
-
-                  // Update the level, cycling between those available.
-                  switch (level) {
-                  case hrgls_MESSAGE_MINIMUM_INFO:
-                      level = hrgls_MESSAGE_MINIMUM_WARNING;
-                      break;
-                  case hrgls_MESSAGE_MINIMUM_WARNING:
-                      level = hrgls_MESSAGE_MINIMUM_ERROR;
-                      break;
-                  case hrgls_MESSAGE_MINIMUM_ERROR:
-                      level = hrgls_MESSAGE_MINIMUM_CRITICAL_ERROR;
-                      break;
-                  default:
-                      level = hrgls_MESSAGE_MINIMUM_INFO;
-                  }
-
-                  // If we're above the threshold, insert the message.
-                  if (m.Level() >= info->minLevel) {
-                      // Need to guard the access to the callback handler and userdata with a
-                      // mutex so that we don't get half of the information due to a race with the
-                      // main thread.
-                      hrgls::API::LogMessageCallback callbackHandler;
-                      void *callbackUserData;
-                      {
-                          std::lock_guard<std::mutex> lock(info->callbackMutex);
-                          callbackHandler = info->callbackHandler;
-                          callbackUserData = info->callbackUserData;
-                      }
-
-                      // If we have a callback handler, call it.  If not, queue the message
-                      // for later delivery.
-                      if (callbackHandler) {
-                          callbackHandler(m, callbackUserData);
-                      } else {
-                          // Store message onto the vector for GetNextLogMessage.
-                          std::lock_guard<std::mutex> lock(info->storedMessagesMutex);
-                          info->storedMessages.push_back(m);
-                      }
-                  }
-
-              } // if time for a new blob
-
-          } // if running
-
-          std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      } while (!info->quitThread);
-  }
+    /// @brief Queue a task to be run on one of the workers.
+    void Submit(Task task)
+    {
+      size_t which;
+      if (CurrentPool() == this) {
+        which = CurrentWorker();
+      } else {
+        which = m_nextWorker++ % m_workers.size();
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_workers[which]->mutex);
+        m_workers[which]->tasks.push_front(std::move(task));
+      }
 
-  API::API(
-        ::std::string user,
-        ::std::vector<uint8_t> credentials)
-  {
-    //------------------------------------------------------------------------------
-    // Construct the data we'll need to enable a test program to try out all of our
-    // features.
-    m_private = new API_private;
-    m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
-
-    // Construct two DataBlobSource descriptions.
-    DataBlobSourceDescription rend;
-    rend.Name("/hrgls/null/DataBlobSource/1");
-    m_private->rends.push_back(rend);
-    rend.Name("/hrgls/null/DataBlobSource/2");
-    m_private->rends.push_back(rend);
-
-    /// Start our thread that polls the remote interface and receives messages,
-    /// passing it a pointer to our private stream information.
-    m_private->myThread = std::thread(LogMessageThread, m_private);
-    return;
-  }
+      // Count the task before checking for sleepers; a worker going to sleep
+      // counts itself before checking for tasks, so one of us will see the other.
+      m_pending++;
+      if (m_idle.load() > 0) {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_wakeup.notify_one();
+      }
+    }
 
-  API::~API()
-  {
-    // Stop my thread.
-    if (m_private) {
-        if (m_private->verbosity > 200) {
-          std::cout << "API::~API(): Destroying API:" << std::endl;
+  private:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<Task> tasks;   ///< Owner takes from the front, thieves from the back.
+      std::thread thread;
+    };
+
+    static CallbackPool *&CurrentPool()
+    {
+      static thread_local CallbackPool *pool = nullptr;
+      return pool;
+    }
+
+    static size_t &CurrentWorker()
+    {
+      static thread_local size_t worker = 0;
+      return worker;
+    }
+
+    bool TryTake(size_t self, Task &task)
+    {
+      {
+        Worker &w = *m_workers[self];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.tasks.empty()) {
+          task = std::move(w.tasks.front());
+          w.tasks.pop_front();
+          return true;
+        }
+      }
+      for (size_t i = 1; i < m_workers.size(); i++) {
+        Worker &w = *m_workers[(self + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.tasks.empty()) {
+          task = std::move(w.tasks.back());
+          w.tasks.pop_back();
+          return true;
         }
-        m_private->quitThread = true;
-        m_private->myThread.join();
+      }
+      return false;
     }
 
-    delete m_private;
-  }
+    void Run(size_t self)
+    {
+      CurrentPool() = this;
+      CurrentWorker() = self;
+      while (true) {
+        Task task;
+        if (TryTake(self, task)) {
+          m_pending--;
+          task();
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_idle++;
+        m_wakeup.wait(lock, [this]() { return m_quit || m_pending.load() > 0; });
+        m_idle--;
+        if (m_quit) {
+          return;
+        }
+      }
+    }
 
-  hrgls_Status API::GetStatus()
-  {
-    if (!m_private) {
-      return hrgls_STATUS_NULL_OBJECT_POINTER;
-    } else {
-      hrgls_Status ret = m_private->status[std::this_thread::get_id()];
-      m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
-      return ret;
+    std::vector< std::unique_ptr<Worker> > m_workers;
+    std::atomic<size_t> m_nextWorker{ 0 };
+    std::atomic<long> m_pending{ 0 };     ///< Tasks queued but not yet taken.
+    std::atomic<int> m_idle{ 0 };         ///< Workers asleep or about to be.
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeup;
+    bool m_quit = false;
+  };
+
+  //------------------------------------------------------------------------------
+  /// @brief Fixed-capacity, lock-free queue with one producer and one consumer.
+  ///
+  /// Used for the blobs and messages that are waiting to be retrieved, so that
+  /// enqueueing does not allocate and the queue cannot grow without bound.  Only
+  /// one thread may push at a time and only one thread may pop at a time; the
+  /// producer and consumer do not need to synchronize with each other.  Callers
+  /// that have several consumer threads serialize them with a mutex of their own.
+  template <class T>
+  class SpscRing {
+  public:
+    explicit SpscRing(size_t capacity)
+      : m_capacity(capacity > 0 ? capacity : 1)
+      , m_slots(new Slot[m_capacity])
+    {
     }
-  }
 
-  ::std::vector<DataBlobSourceDescription> API::GetAvailableDataBlobSources() const
+    ~SpscRing() { Clear(); }
+
+    size_t Capacity() const { return m_capacity; }
+
+    /// @brief Number of entries queued.  Exact only when called by the producer or consumer.
+    size_t Size() const
+    {
+      return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const { return Size() == 0; }
+
+    /// @brief Producer side: add an entry by moving from it.
+    /// @return False, leaving the value untouched, if the ring is full.
+    bool TryPush(T &&value)
+    {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail - m_head.load(std::memory_order_acquire) >= m_capacity) {
+        return false;
+      }
+      new (SlotAt(tail)) T(std::move(value));
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// @brief Consumer side: the oldest entry, which stays queued until Pop().
+    /// @return Pointer to the entry, or nullptr if the ring is empty.
+    T *Front()
+    {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_tail.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      return SlotAt(head);
+    }
+
+    /// @brief Consumer side: remove the entry returned by Front(), which must not be null.
+    void Pop()
+    {
+      size_t head = m_head.load(std::memory_order_relaxed);
+      SlotAt(head)->~T();
+      m_head.store(head + 1, std::memory_order_release);
+    }
+
+    /// @brief Consumer side: remove and destroy all entries.
+    void Clear()
+    {
+      while (Front()) {
+        Pop();
+      }
+    }
+
+  private:
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+    T *SlotAt(size_t index) { return reinterpret_cast<T*>(&m_slots[index % m_capacity]); }
+
+    const size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // The consumer writes the head and the producer writes the tail; keep them on
+    // separate cache lines so that the two sides do not contend.
+    std::atomic<size_t> m_head{ 0 };
+    char m_pad[64];
+    std::atomic<size_t> m_tail{ 0 };
+  };
+
+  /// @brief Number of log messages that are queued before the oldest are dropped.
+  static const size_t LogMessageQueueCapacity = 1024;
+
+  /// @brief Size of the data in each blob that the null DataBlobSources send.
+  static const uint32_t NullBlobSize = 256;
+
+  /// @brief Most log messages that the generator makes before letting other tasks have
+  /// a turn on the scheduler.
+  static const size_t LogMessageBatchSize = 64;
+
+  /// @brief Text of the generated log messages, which they refer to rather than copy.
+  static const char LogMessageText[] = "value of the message";
+
+  /// @brief Most blobs that a DataBlobSource's producer sends before letting other
+  /// tasks have a turn on the scheduler, unless its bursts are longer.
+  static const size_t ProducerBatchSize = 64;
+
+  /// @brief Fewest DataBlobSources that a DataBlobSourceGroup gives to each of the threads
+  /// that construct them, so that small groups are not slowed by starting threads.
+  static const size_t GroupSourcesPerThread = 256;
+
+  /// @brief Most returned blob-data buffers that each API keeps for reuse.
+  static const uint32_t BufferPoolMaxFreeBuffers = 1024;
+
+  /// @brief Most bytes of returned buffers that the pool of a DataBlobSource with larger
+  /// blobs than the API's pool handles keeps for reuse.
+  static const uint64_t BufferPoolMaxFreeBytes = 64 * 1024 * 1024;
+
+  /// @brief Most callbacks that a drain task makes before letting other producers'
+  /// tasks have a turn on its CallbackPool worker.
+  static const size_t CallbackBatchSize = 32;
+
+  /// @brief Most blobs that a replay task sends before letting other producers' tasks
+  /// have a turn on the scheduler.
+  static const size_t ReplayBatchSize = 64;
+
+  /// @brief Value of a replaying source's pending seek when there is none.
+  static const size_t NoReplaySeek = static_cast<size_t>(-1);
+
+  /// @brief Compute the next deadline for a periodic producer running at rate per second.
+  ///
+  /// Deadlines advance by exactly one period from the previous deadline so that the
+  /// average rate does not drift.  If we have fallen more than a few periods behind
+  /// (the machine was suspended, or the rate was just raised), we resynchronize to now
+  /// rather than emitting a burst to catch up.
+  static Scheduler::Clock::time_point NextPeriodicDeadline(
+    Scheduler::Clock::time_point due, double rate)
   {
-    if (!m_private) {
-      ::std::vector<DataBlobSourceDescription> ret;
-      return ret;
-    } else {
-      return m_private->rends;
+    auto now = Scheduler::Clock::now();
+    if (rate <= 0) {
+      // Not producing; check back periodically in case the rate changes.
+      return now + std::chrono::milliseconds(100);
+    }
+    auto period = std::chrono::duration_cast<Scheduler::Clock::duration>(
+      std::chrono::duration<double>(1.0 / rate));
+    if (period.count() <= 0) {
+      period = Scheduler::Clock::duration(1);
+    }
+    auto next = due + period;
+    if (now - next > 4 * period) {
+      next = now + period;
     }
+    return next;
   }
 
-  hrgls_VERSION API::GetVersion() const
+  /// @brief Read the current wall-clock time as a timeval in UTC.
+  static struct timeval WallClockTimeval()
   {
-    /// @todo Update whenever the version changes.
-    hrgls_VERSION ret = { 0, 1, 0 };
+    ::std::chrono::microseconds uSecSinceEpoch =
+      ::std::chrono::duration_cast<::std::chrono::microseconds>(
+        ::std::chrono::system_clock::now().time_since_epoch());
+    struct timeval ret;
+    ret.tv_sec = static_cast<uint32_t>(uSecSinceEpoch.count() / 1000000);
+    ret.tv_usec = static_cast<uint32_t>(uSecSinceEpoch.count() - ret.tv_sec * 1000000);
     return ret;
   }
 
-  struct timeval API::GetCurrentSystemTime() const
+  /// @brief Read the current wall-clock time, in the same clock as WallClockTimeval().
+  static int64_t WallClockNanoseconds()
   {
-    struct timeval ret = {};
-    if (m_private) {
-      ::std::chrono::time_point<::std::chrono::system_clock> myTime =
-        ::std::chrono::system_clock::now();
-      ::std::chrono::microseconds uSecSinceEpoch =
-        ::std::chrono::duration_cast<::std::chrono::microseconds>(myTime.time_since_epoch());
-      ret.tv_sec = static_cast<uint32_t>(uSecSinceEpoch.count() / 1000000);
-      ret.tv_usec = static_cast<uint32_t>(uSecSinceEpoch.count() - ret.tv_sec * 1000000);
-    }
-    return ret;
+    return ::std::chrono::duration_cast<::std::chrono::nanoseconds>(
+      ::std::chrono::system_clock::now().time_since_epoch()).count();
   }
 
-  uint16_t API::GetVerbosity() const
+  /// @brief Record a trace event about one of our streams or APIs, if tracing is on.
+  static inline void Trace(hrgls_TraceEventType type, const void *object, uint64_t value = 0)
   {
-    uint16_t ret = 0;
-    if (m_private) {
-      ret = m_private->verbosity;
-    }
-    return ret;
+    hrgls_TraceRecord(type, reinterpret_cast<uint64_t>(object), value);
   }
 
-  hrgls_Status API::SetVerbosity(uint16_t verbosity)
-  {
-    if (!m_private) {
-      return hrgls_STATUS_NULL_OBJECT_POINTER;
+  /// @brief Number of shards that the counts of a StatisticsCounters are spread across.
+  static const size_t StatisticsShards = 8;
+
+  //------------------------------------------------------------------------------
+  /// @brief Counters behind a StreamStatistics, updated from many threads without locking.
+  ///
+  /// Each thread that counts something is given one of StatisticsShards shards, in
+  /// the order in which threads first count, and adds to that shard's counters with
+  /// relaxed atomic operations.  The producer and callback threads of a stream
+  /// therefore do not contend for a lock or (unless there are more threads than
+  /// shards) for cache lines while they count; consumers that take from the queue
+  /// count into one more shard, as described for DeliveredBatch.  Read() sums the
+  /// shards, so it is only a snapshot: counts made while it runs may or may not be
+  /// included.
+  class StatisticsCounters {
+    struct Shard;
+
+  public:
+    /// @brief Count blobs made by the producer.
+    void CountProduced(uint64_t count = 1) { Add(MyShard().produced, count); }
+
+    /// @brief Count a blob or message handed to the client from the queue.
+    ///
+    /// Like DeliveredBatch, this must be called with the lock that keeps the
+    /// queue's consumers from taking entries at the same time held.
+    /// @param [in] time When it was made, from its Time() or TimeStamp().
+    void CountDelivered(struct timeval time) { DeliveredBatch(*this).Count(time); }
+
+    /// @brief Count a blob or message handed to a callback handler and the call itself.
+    /// @param [in] time When it was made.
+    /// @param [in] start WallClockNanoseconds() just before the call, which is also
+    ///             when it was delivered.
+    /// @param [in] end WallClockNanoseconds() just after the call.
+    void CountCallback(struct timeval time, int64_t start, int64_t end)
+    {
+      uint64_t latency = Latency(time, start);
+      uint64_t duration = end > start ? static_cast<uint64_t>(end - start) : 0;
+      Shard &s = MyShard();
+      Add(s.delivered, 1);
+      Add(s.latencyTotal, latency);
+      Max(s.latencyMax, latency);
+      Add(s.latency[StreamStatistics::HistogramBin(latency)], 1);
+      Add(s.callbacks, 1);
+      Add(s.callbackDurationTotal, duration);
+      Max(s.callbackDurationMax, duration);
+      Add(s.callbackDuration[StreamStatistics::HistogramBin(duration)], 1);
     }
-    m_private->verbosity = verbosity;
-    if (m_private->verbosity > 200) {
-      std::cout << "API::SetVerbosity(): New verbosity: " << verbosity << std::endl;
+
+    /// @brief Counts a batch of blobs or messages handed to the client from the queue.
+    ///
+    /// Entries are only taken from the queue with a lock held, so these counts go to
+    /// a shard of their own that has only one writer at a time and can be updated
+    /// without atomic read-modify-write operations.  The clock is read once, for the
+    /// first entry, and the totals are added to the shard when the batch is destroyed.
+    class DeliveredBatch {
+    public:
+      explicit DeliveredBatch(StatisticsCounters &counters) : m_shard(counters.m_consumer) {}
+      ~DeliveredBatch()
+      {
+        if (m_count > 0) {
+          Increase(m_shard.delivered, m_count);
+          Increase(m_shard.latencyTotal, m_latencyTotal);
+          if (m_latencyMax > m_shard.latencyMax.load(std::memory_order_relaxed)) {
+            m_shard.latencyMax.store(m_latencyMax, std::memory_order_relaxed);
+          }
+        }
+      }
+
+      /// @brief Count one entry, made at time.
+      void Count(struct timeval time)
+      {
+        if (m_count++ == 0) {
+          m_now = WallClockNanoseconds();
+        }
+        uint64_t latency = Latency(time, m_now);
+        m_latencyTotal += latency;
+        m_latencyMax = std::max(m_latencyMax, latency);
+        Increase(m_shard.latency[StreamStatistics::HistogramBin(latency)], 1);
+      }
+
+    private:
+      Shard &m_shard;
+      int64_t m_now = 0;
+      uint64_t m_count = 0;
+      uint64_t m_latencyTotal = 0;
+      uint64_t m_latencyMax = 0;
+    };
+
+    /// @brief Note the depth of the queue after adding to it.
+    void CountQueueDepth(size_t depth)
+    {
+      if (depth > m_maxQueueDepth.load(std::memory_order_relaxed)) {
+        Max(m_maxQueueDepth, depth);
+      }
+    }
+
+    /// @brief Fill in everything but the number dropped and the current queue depth,
+    /// which the stream keeps track of itself.
+    void Read(StreamStatistics &ret) const
+    {
+      uint64_t produced = 0, delivered = 0, latencyTotal = 0, latencyMax = 0;
+      uint64_t callbacks = 0, callbackDurationTotal = 0, callbackDurationMax = 0;
+      std::vector<uint64_t> latency(hrgls_STATISTICS_HISTOGRAM_BINS);
+      std::vector<uint64_t> callbackDuration(hrgls_STATISTICS_HISTOGRAM_BINS);
+      for (size_t i = 0; i <= StatisticsShards; i++) {
+        const Shard &s = i < StatisticsShards ? m_shards[i] : m_consumer;
+        produced += s.produced.load(std::memory_order_relaxed);
+        delivered += s.delivered.load(std::memory_order_relaxed);
+        latencyTotal += s.latencyTotal.load(std::memory_order_relaxed);
+        latencyMax = std::max(latencyMax, s.latencyMax.load(std::memory_order_relaxed));
+        callbacks += s.callbacks.load(std::memory_order_relaxed);
+        callbackDurationTotal += s.callbackDurationTotal.load(std::memory_order_relaxed);
+        callbackDurationMax = std::max(callbackDurationMax,
+          s.callbackDurationMax.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < hrgls_STATISTICS_HISTOGRAM_BINS; b++) {
+          latency[b] += s.latency[b].load(std::memory_order_relaxed);
+          callbackDuration[b] += s.callbackDuration[b].load(std::memory_order_relaxed);
+        }
+      }
+      ret.Produced(produced);
+      ret.Delivered(delivered);
+      ret.MaxQueueDepth(m_maxQueueDepth.load(std::memory_order_relaxed));
+      ret.LatencyTotal(latencyTotal);
+      ret.LatencyMax(latencyMax);
+      ret.LatencyHistogram(latency);
+      ret.Callbacks(callbacks);
+      ret.CallbackDurationTotal(callbackDurationTotal);
+      ret.CallbackDurationMax(callbackDurationMax);
+      ret.CallbackDurationHistogram(callbackDuration);
+    }
+
+  private:
+    /// @brief Nanoseconds from time until now, or 0 if the clock went backwards.
+    static uint64_t Latency(struct timeval time, int64_t now)
+    {
+      int64_t made = static_cast<int64_t>(time.tv_sec) * 1000000000 +
+        static_cast<int64_t>(time.tv_usec) * 1000;
+      return now > made ? static_cast<uint64_t>(now - made) : 0;
+    }
+
+    struct Shard {
+      std::atomic<uint64_t> produced{ 0 };
+      std::atomic<uint64_t> delivered{ 0 };
+      std::atomic<uint64_t> latencyTotal{ 0 };
+      std::atomic<uint64_t> latencyMax{ 0 };
+      std::atomic<uint64_t> callbacks{ 0 };
+      std::atomic<uint64_t> callbackDurationTotal{ 0 };
+      std::atomic<uint64_t> callbackDurationMax{ 0 };
+      std::atomic<uint64_t> latency[hrgls_STATISTICS_HISTOGRAM_BINS];
+      std::atomic<uint64_t> callbackDuration[hrgls_STATISTICS_HISTOGRAM_BINS];
+      char pad[64];   ///< Keeps the next shard's counters off of our last cache line.
+
+      Shard()
+      {
+        for (size_t b = 0; b < hrgls_STATISTICS_HISTOGRAM_BINS; b++) {
+          latency[b].store(0, std::memory_order_relaxed);
+          callbackDuration[b].store(0, std::memory_order_relaxed);
+        }
+      }
+    };
+
+    static void Add(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+      counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /// @brief Add to a counter that only one thread at a time writes.
+    static void Increase(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static void Max(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+      uint64_t was = counter.load(std::memory_order_relaxed);
+      while (value > was &&
+        !counter.compare_exchange_weak(was, value, std::memory_order_relaxed)) {
+      }
+    }
+
+    Shard &MyShard()
+    {
+      static std::atomic<size_t> nextThread(0);
+      static thread_local size_t shard = nextThread++ % StatisticsShards;
+      return m_shards[shard];
+    }
+
+    Shard m_shards[StatisticsShards];
+    Shard m_consumer;   ///< Written only by DeliveredBatch, with the queue locked.
+    std::atomic<uint64_t> m_maxQueueDepth{ 0 };
+  };
+
+  //------------------------------------------------------------------------------
+  /// @brief The DataBlobSources that an API makes available, indexed by name.
+  ///
+  /// Sources are only ever added.  Each addition increases the generation, which can
+  /// be read without locking so that clients can ask whether the list has changed
+  /// without copying it, and calls the changed handler if there is one.  Looking a
+  /// source up by name takes constant time, so opening each of many sources does not
+  /// take time in proportion to how many there are.
+  class DataBlobSourceRegistry {
+  public:
+    /// @brief Generation of the list, which starts at 1 and is never 0.
+    uint64_t Generation() const { return m_generation.load(); }
+
+    /// @brief Copy of the list, in the order the sources were added.
+    ::std::vector<DataBlobSourceDescription> List() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_sources;
+    }
+
+    /// @brief Find a source by name, or the first one if the name is empty.
+    /// @return True if it was found.
+    bool Find(const ::std::string &name, DataBlobSourceDescription &ret) const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (name.empty()) {
+        if (m_sources.empty()) {
+          return false;
+        }
+        ret = m_sources.front();
+        return true;
+      }
+      auto found = m_index.find(name);
+      if (found == m_index.end()) {
+        return false;
+      }
+      ret = m_sources[found->second];
+      return true;
+    }
+
+    /// @brief Add a source unless there is one by that name already.
+    ///
+    /// The changed handler is called, with the registry unlocked, if the source was added.
+    void Add(const DataBlobSourceDescription &d)
+    {
+      uint64_t generation;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_index.insert(std::make_pair(d.Name(), m_sources.size())).second) {
+          return;
+        }
+        try {
+          m_sources.push_back(d);
+        } catch (...) {
+          m_index.erase(d.Name());
+          throw;
+        }
+        generation = m_generation.fetch_add(1) + 1;
+      }
+
+      // Calling with the handler's lock held means that once SetChangedCallback()
+      // returns, the handler that it replaced is not running.
+      std::lock_guard<std::mutex> lock(m_callbackMutex);
+      if (m_callback) {
+        m_callback(generation, m_callbackUserData);
+      }
+    }
+
+    void SetChangedCallback(API::DataBlobSourcesChangedCallback callback, void *userData)
+    {
+      std::lock_guard<std::mutex> lock(m_callbackMutex);
+      m_callback = callback;
+      m_callbackUserData = userData;
+    }
+
+  private:
+    mutable std::mutex m_mutex;   ///< Guards the list and its index.
+    ::std::vector<DataBlobSourceDescription> m_sources;
+    std::unordered_map< ::std::string, size_t> m_index;
+    std::atomic<uint64_t> m_generation{ 1 };
+
+    std::mutex m_callbackMutex;
+    API::DataBlobSourcesChangedCallback m_callback = nullptr;
+    void *m_callbackUserData = nullptr;
+  };
+
+  class API::API_private {
+  public:
+    // Keeps track of current verbosity level, defaults to 0 (no messages)
+    uint16_t verbosity = 0;
+
+    // Keep a per-thread status to make it so that a single thread only gets
+    // results from methods that it calls.
+    PerThread<hrgls_Status> status;
+
+    /// Descriptions of our DataBlobSources, which AddReplayFile() adds to while
+    /// others may be reading them.
+    DataBlobSourceRegistry rends;
+
+    // Are we running?  If so, generate messages asynchronously and put into
+    // list.
+    std::atomic<bool> messageStreaming{ false };
+
+    /// Callback handler registered with us, along with its userdata and a mutex
+    /// that is used to ensure that we read and update both data values atomically.
+    /// At most one of the two kinds of handler is set.
+    std::mutex callbackMutex;
+    LogMessageCallback callbackHandler = nullptr;
+    LogMessageViewCallback viewCallbackHandler = nullptr;
+    void *callbackUserData = nullptr;
+
+    /// List of messages that have come in with no callback handler to deal
+    /// with them.  They are retrieved by GetNextLogMessage(), with the mutex
+    /// serializing consumers.  When the ring is full the producer takes the mutex
+    /// to drop the oldest message, which is counted in droppedMessages.
+    std::mutex storedMessagesMutex;
+    SpscRing<Message> storedMessages{ LogMessageQueueCapacity };
+    std::atomic<uint64_t> droppedMessages{ 0 };
+
+    /// Everything else reported by GetLogMessageStatistics(), with each message
+    /// counted as a blob.
+    StatisticsCounters statistics;
+
+    /// Lowest level of message to deliver, which the generator checks before it makes
+    /// anything, so that filtered-out messages cost nothing but the check.
+    std::atomic<hrgls_MessageLevel> minLevel{ hrgls_MESSAGE_MINIMUM_INFO };
+
+    /// Level of the next message to be generated, which cycles through the standard
+    /// levels from the lowest one that we were asked to generate, at messageRate.
+    hrgls_MessageLevel nextLevel = hrgls_MESSAGE_MINIMUM_INFO;
+    hrgls_MessageLevel messageLevel = hrgls_MESSAGE_MINIMUM_INFO;
+    double messageRate = 10;
+
+    /// Pool that the DataBlobSources on this API take the buffers for their blob
+    /// data from.  It is destroyed by ~API() once the scheduler has stopped.
+    hrgls_BufferPool bufferPool = nullptr;
+
+    /// When the API was created with callback threads, handlers are called from this
+    /// pool rather than from the scheduler.  Messages for the handler are queued on
+    /// storedMessages like any others and delivered in order by a drain task, at most
+    /// one of which is in the pool at a time (tracked by logDrainScheduled).  The
+    /// pool is declared just before the scheduler so that it is stopped after the
+    /// producers and before the state that its tasks use is destroyed.
+    std::unique_ptr<CallbackPool> callbackPool;
+    std::atomic<bool> logDrainScheduled{ false };
+
+    /// "host:port" of the server that our DataBlobSources come from, if they are remote.
+    std::string endpoint;
+
+#ifdef __linux__
+    /// Server started by StartServer(), which ~API() stops before the rest of our
+    /// state is destroyed because its connections have DataBlobSources of their own.
+    std::mutex serverMutex;
+    std::unique_ptr<NetworkServer> server;
+#endif
+
+    /// Scheduler shared by the log-message generator and all DataBlobSources on
+    /// this API, along with the task that generates log messages.  It is declared
+    /// last so that its workers are stopped before the rest of our state is destroyed.
+    Scheduler::TaskId logTask = 0;
+    Scheduler scheduler;
+
+    /// Store a message onto the ring for GetNextLogMessage() or a drain task, making
+    /// room by dropping the oldest if the consumer has fallen behind.
+    void StoreMessage(Message &&m)
+    {
+      if (!storedMessages.TryPush(std::move(m))) {
+        std::lock_guard<std::mutex> lock(storedMessagesMutex);
+        if (storedMessages.Front()) {
+          storedMessages.Pop();
+          droppedMessages++;
+        }
+        storedMessages.TryPush(std::move(m));
+      }
+      statistics.CountQueueDepth(storedMessages.Size());
+    }
+
+    /// Calls the log-message callback handler, counting the message as delivered and
+    /// timing the call.
+    void CallHandler(API::LogMessageCallback handler, Message &m, void *userData)
+    {
+      Trace(hrgls_TRACE_CALLBACK_BEGIN, this);
+      int64_t start = WallClockNanoseconds();
+      handler(m, userData);
+      statistics.CountCallback(m.TimeStamp(), start, WallClockNanoseconds());
+      Trace(hrgls_TRACE_CALLBACK_END, this);
+    }
+
+    /// Lends a message to the borrowing callback handler, counting and timing it.
+    void CallHandler(API::LogMessageViewCallback handler, const hrgls_MessageView &view,
+      void *userData)
+    {
+      Trace(hrgls_TRACE_CALLBACK_BEGIN, this);
+      int64_t start = WallClockNanoseconds();
+      handler(MessageView(view), userData);
+      statistics.CountCallback(view.timeStamp, start, WallClockNanoseconds());
+      Trace(hrgls_TRACE_CALLBACK_END, this);
+    }
+
+    /// Called by the producer after storing a message, to make sure that a drain
+    /// task will deliver it.
+    void ScheduleLogDrain()
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!logDrainScheduled.exchange(true)) {
+        callbackPool->Submit([this]() { DrainLogMessages(); });
+      }
+    }
+
+    /// Runs on the callback pool to hand stored messages to the callback handler.
+    void DrainLogMessages()
+    {
+      for (size_t i = 0; i < CallbackBatchSize; i++) {
+        Message m;
+        {
+          std::lock_guard<std::mutex> lock(storedMessagesMutex);
+          if (!storedMessages.Front()) {
+            break;
+          }
+          m = std::move(*storedMessages.Front());
+          storedMessages.Pop();
+        }
+        API::LogMessageCallback handler;
+        API::LogMessageViewCallback viewHandler;
+        void *userData;
+        {
+          std::lock_guard<std::mutex> lock(callbackMutex);
+          handler = callbackHandler;
+          viewHandler = viewCallbackHandler;
+          userData = callbackUserData;
+        }
+        if (handler) {
+          CallHandler(handler, m, userData);
+        } else if (viewHandler) {
+          hrgls_MessageView view = {};
+          hrgls_MessageGetValue(m.RawMessage(), &view.value);
+          view.timeStamp = m.TimeStamp();
+          view.level = m.Level();
+          CallHandler(viewHandler, view, userData);
+        }
+      }
+
+      // Keep going if there is more, otherwise mark that we are done.  A message
+      // stored after we check sees the flag cleared and schedules a new drain.
+      bool again = !storedMessages.Empty();
+      if (!again) {
+        logDrainScheduled.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        again = !storedMessages.Empty() && !logDrainScheduled.exchange(true);
+      }
+      if (again) {
+        callbackPool->Submit([this]() { DrainLogMessages(); });
+      }
+    }
+  };
+
+  /// @brief The standard message levels, in increasing order.
+  static const hrgls_MessageLevel StandardMessageLevels[] = {
+    hrgls_MESSAGE_MINIMUM_INFO, hrgls_MESSAGE_MINIMUM_WARNING,
+    hrgls_MESSAGE_MINIMUM_ERROR, hrgls_MESSAGE_MINIMUM_CRITICAL_ERROR
+  };
+
+  /// @brief Level of the first generated message: the lowest standard level that is at
+  /// least the lowest one asked for, or that one itself if none are.
+  static hrgls_MessageLevel FirstMessageLevel(hrgls_MessageLevel lowest)
+  {
+    for (hrgls_MessageLevel l : StandardMessageLevels) {
+      if (l >= lowest) {
+        return l;
+      }
+    }
+    return lowest;
+  }
+
+  /// @brief Level of the message after one of the given level, cycling back to the first.
+  static hrgls_MessageLevel NextMessageLevel(hrgls_MessageLevel level, hrgls_MessageLevel lowest)
+  {
+    for (hrgls_MessageLevel l : StandardMessageLevels) {
+      if (l > level) {
+        return l;
+      }
+    }
+    return FirstMessageLevel(lowest);
+  }
+
+  /// Scheduled task that generates log messages at the API's message rate while
+  /// streaming is on and parks itself (generates no wakeups) while it is off or the
+  /// rate is zero, since the rate is fixed when the API is created.  When it
+  /// has fallen behind it makes up to LogMessageBatchSize of the messages that are due
+  /// before letting other tasks have a turn, so that high rates are not limited by
+  /// the cost of rescheduling.
+  static bool LogMessageTask(API::API_private *info, Scheduler::Clock::time_point &next)
+  {
+      if (!info->messageStreaming || info->messageRate <= 0) {
+          next = Scheduler::Clock::time_point::max();
+          return true;
+      }
+
+      size_t made = 0;
+      do {
+          next = NextPeriodicDeadline(next, info->messageRate);
+
+          // Update the level, cycling between those available.
+          hrgls_MessageLevel level = info->nextLevel;
+          info->nextLevel = NextMessageLevel(level, info->messageLevel);
+
+          // If we're below the threshold, skip the message before making anything.
+          if (level < info->minLevel.load(std::memory_order_relaxed)) {
+              continue;
+          }
+          struct timeval now = WallClockTimeval();
+          info->statistics.CountProduced();
+          Trace(hrgls_TRACE_MESSAGE_PRODUCED, info, level);
+
+          // Need to guard the access to the callback handler and userdata with a
+          // mutex so that we don't get half of the information due to a race with the
+          // main thread.
+          hrgls::API::LogMessageCallback callbackHandler;
+          hrgls::API::LogMessageViewCallback viewCallbackHandler;
+          void *callbackUserData;
+          {
+              std::lock_guard<std::mutex> lock(info->callbackMutex);
+              callbackHandler = info->callbackHandler;
+              viewCallbackHandler = info->viewCallbackHandler;
+              callbackUserData = info->callbackUserData;
+          }
+
+          // A borrowing handler called from here is lent a view of the message on our
+          // stack, so nothing is allocated for it.
+          if (viewCallbackHandler && !info->callbackPool) {
+              hrgls_MessageView view = { LogMessageText, now, level };
+              info->CallHandler(viewCallbackHandler, view, callbackUserData);
+              continue;
+          }
+
+          // If we have a callback handler, call it, or have the callback pool
+          // call it if we have one.  If not, queue the message for later delivery.
+          // The text is static, so the message refers to it rather than copying it.
+          Message m;
+          m.StaticValue(LogMessageText);
+          m.TimeStamp(now);
+          m.Level(level);
+          if (callbackHandler && !info->callbackPool) {
+              info->CallHandler(callbackHandler, m, callbackUserData);
+          } else {
+              info->StoreMessage(std::move(m));
+              if (callbackHandler || viewCallbackHandler) {
+                  info->ScheduleLogDrain();
+              }
+          }
+      } while (++made < LogMessageBatchSize && next <= Scheduler::Clock::now());
+      return true;
+  }
+
+  API::API(
+        ::std::string user,
+        ::std::vector<uint8_t> credentials,
+        uint32_t callbackThreads,
+        ::std::string endpoint,
+        ::std::string implementation,
+        uint32_t sourceCount,
+        double messageRate,
+        hrgls_MessageLevel messageLevel)
+  {
+    // The C layer chooses the implementation before we are constructed, so the
+    // implementation parameter is not used here.  A client built directly against us
+    // has no C layer to load another one.
+
+    //------------------------------------------------------------------------------
+    // Construct the data we'll need to enable a test program to try out all of our
+    // features.
+    m_private = new API_private;
+    m_private->status.Get() = hrgls_STATUS_OKAY;
+#ifdef HRGLS_DIRECT_IMPLEMENTATION
+    if (!implementation.empty()) {
+      m_private->status.Get() = hrgls_STATUS_IMPLEMENTATION_NOT_FOUND;
+    }
+#endif
+
+    // Make the pool for blob data, sized for the blobs that we send.
+    if (hrgls_BufferPoolCreate(&m_private->bufferPool, NullBlobSize,
+          BufferPoolMaxFreeBuffers) != hrgls_STATUS_OKAY) {
+      m_private->status.Get() = hrgls_STATUS_OUT_OF_MEMORY;
+    }
+
+    // Start the threads to call callback handlers on, if we were asked to.
+    if (callbackThreads > 0) {
+      m_private->callbackPool.reset(new CallbackPool(callbackThreads));
+    }
+
+    // An API with an endpoint gets its DataBlobSources from there; we connect to it
+    // when they are listed or created.
+    if (!endpoint.empty()) {
+#ifdef __linux__
+      std::string host, port;
+      if (!NetParseEndpoint(endpoint, host, port)) {
+        m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+      }
+      m_private->endpoint = endpoint;
+#else
+      m_private->status.Get() = hrgls_STATUS_NOT_IMPLEMENTED;
+#endif
+    }
+
+    // Construct the DataBlobSource descriptions that we were asked for.
+    if (sourceCount == 0 || !(messageRate >= 0)) {
+      m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+    }
+    for (uint32_t i = 1; i <= sourceCount; i++) {
+      DataBlobSourceDescription rend;
+      rend.Name("/hrgls/null/DataBlobSource/" + std::to_string(i));
+      m_private->rends.Add(rend);
+    }
+    m_private->messageRate = messageRate;
+    m_private->messageLevel = messageLevel;
+    m_private->nextLevel = FirstMessageLevel(messageLevel);
+
+    /// Register the task that generates log messages.  It parks itself until
+    /// streaming is turned on.
+    API_private *info = m_private;
+    m_private->logTask = m_private->scheduler.Post(
+      [info](Scheduler::Clock::time_point &next) { return LogMessageTask(info, next); });
+    return;
+  }
+
+  API::~API()
+  {
+    // Stop my thread.
+    if (m_private) {
+        if (m_private->verbosity > 200) {
+          std::cout << "API::~API(): Destroying API:" << std::endl;
+        }
+        m_private->scheduler.Cancel(m_private->logTask);
+#ifdef __linux__
+        m_private->server.reset();
+#endif
+    }
+
+    // Destroying the private data stops the scheduler, so nothing can be taking
+    // buffers from the pool once it is gone.  Blobs may still hold buffers, which
+    // remain valid until they are returned.
+    hrgls_BufferPool pool = m_private ? m_private->bufferPool : nullptr;
+    delete m_private;
+    if (pool) {
+      hrgls_BufferPoolDestroy(pool);
+    }
+  }
+
+  hrgls_Status API::GetStatus()
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    } else {
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+  }
+
+  ::std::vector<DataBlobSourceDescription> API::GetAvailableDataBlobSources() const
+  {
+    if (!m_private) {
+      ::std::vector<DataBlobSourceDescription> ret;
+      return ret;
+    }
+    m_private->status.Get() = hrgls_STATUS_OKAY;
+    if (m_private->endpoint.empty()) {
+      return m_private->rends.List();
+    }
+
+    // Ask the server for its list.
+    ::std::vector<DataBlobSourceDescription> ret;
+#ifdef __linux__
+    int fd = NetConnect(m_private->endpoint);
+    std::vector<uint8_t> payload;
+    uint32_t type, length;
+    if (fd >= 0 && NetSendFrame(fd, NetFrameList, payload)) {
+      NetReader reader(fd);
+      if (reader.ReadHeader(type, length) && type == NetFrameSources &&
+          reader.ReadPayload(length, payload)) {
+        NetParser parser(payload);
+        uint32_t count = parser.Get32();
+        for (uint32_t i = 0; i < count && parser.Ok(); i++) {
+          DataBlobSourceDescription d;
+          d.Name(parser.GetString());
+          ret.push_back(d);
+        }
+        if (parser.Ok()) {
+          close(fd);
+          return ret;
+        }
+        ret.clear();
+      }
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+#endif
+    m_private->status.Get() = hrgls_STATUS_CONNECTION_FAILED;
+    return ret;
+  }
+
+  uint64_t API::GetDataBlobSourceGeneration() const
+  {
+    if (!m_private) {
+      return 0;
+    }
+    m_private->status.Get() = hrgls_STATUS_OKAY;
+
+    // We are not told when a server's list changes.
+    if (!m_private->endpoint.empty()) {
+      return 0;
+    }
+    return m_private->rends.Generation();
+  }
+
+  bool API::DataBlobSourcesChangedSince(uint64_t generation) const
+  {
+    return generation == 0 || GetDataBlobSourceGeneration() != generation;
+  }
+
+  hrgls_Status API::SetDataBlobSourcesChangedCallback(DataBlobSourcesChangedCallback callback,
+    void *userData)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    m_private->rends.SetChangedCallback(callback, userData);
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status API::AddReplayFile(const ::std::string &fileName)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+#ifdef __linux__
+    if (!m_private->endpoint.empty()) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    ReplayFile *file = ReplayFile::Open(fileName);
+    if (!file) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+    file->Unref();
+    DataBlobSourceDescription d;
+    d.Name(ReplayFile::NamePrefix() + fileName);
+    m_private->rends.Add(d);
+    return hrgls_STATUS_OKAY;
+#else
+    (void)fileName;
+    return hrgls_STATUS_NOT_IMPLEMENTED;
+#endif
+  }
+
+  uint16_t API::StartServer(const ::std::string &endpoint)
+  {
+    if (!m_private) {
+      return 0;
+    }
+#ifdef __linux__
+    std::lock_guard<std::mutex> lock(m_private->serverMutex);
+    if (m_private->server) {
+      m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+      return 0;
+    }
+    hrgls_Status s;
+    m_private->server.reset(NetworkServer::Start(*this, endpoint, s));
+    m_private->status.Get() = s;
+    return m_private->server ? m_private->server->Port() : 0;
+#else
+    (void)endpoint;
+    m_private->status.Get() = hrgls_STATUS_NOT_IMPLEMENTED;
+    return 0;
+#endif
+  }
+
+  hrgls_VERSION API::GetVersion() const
+  {
+    /// @todo Update whenever the version changes.
+    hrgls_VERSION ret = { 0, 1, 0 };
+    return ret;
+  }
+
+  struct timeval API::GetCurrentSystemTime() const
+  {
+    struct timeval ret = {};
+    if (m_private) {
+      ret = WallClockTimeval();
+    }
+    return ret;
+  }
+
+  uint16_t API::GetVerbosity() const
+  {
+    uint16_t ret = 0;
+    if (m_private) {
+      ret = m_private->verbosity;
+    }
+    return ret;
+  }
+
+  hrgls_Status API::SetVerbosity(uint16_t verbosity)
+  {
+    if (!m_private) {
+      return hrgls_STATUS_NULL_OBJECT_POINTER;
+    }
+    m_private->verbosity = verbosity;
+    if (m_private->verbosity > 200) {
+      std::cout << "API::SetVerbosity(): New verbosity: " << verbosity << std::endl;
+    }
+    return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status API::SetLogMessageCallback(LogMessageCallback callback,
+      void *userdata)
+  {
+      if (!m_private) {
+          return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+
+      // Lock the thread mutices for callback and streaming while we change
+      // the state.
+      {
+        std::lock_guard<std::mutex> lock(m_private->callbackMutex);
+
+        // Set the streaming callback handler.
+        m_private->callbackHandler = callback;
+        m_private->viewCallbackHandler = nullptr;
+        m_private->callbackUserData = userdata;
+      }
+
+      // Flush all stored messages.
+      std::lock_guard<std::mutex> lock2(m_private->storedMessagesMutex);
+      m_private->storedMessages.Clear();
+
+      return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status API::SetLogMessageViewCallback(LogMessageViewCallback callback,
+      void *userdata)
+  {
+      if (!m_private) {
+          return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_private->callbackMutex);
+        m_private->callbackHandler = nullptr;
+        m_private->viewCallbackHandler = callback;
+        m_private->callbackUserData = userdata;
+      }
+
+      // Flush all stored messages, as SetLogMessageCallback() does.
+      std::lock_guard<std::mutex> lock2(m_private->storedMessagesMutex);
+      m_private->storedMessages.Clear();
+
+      return hrgls_STATUS_OKAY;
+  }
+
+  hrgls_Status API::SetLogMessageStreamingState(bool running)
+  {
+      if (!m_private) {
+          return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      m_private->messageStreaming = running;
+      if (running) {
+        m_private->scheduler.Wake(m_private->logTask);
+      }
+      return hrgls_STATUS_OKAY;
+  }
+
+  uint64_t API::GetDroppedLogMessageCount()
+  {
+      if (!m_private) {
+          return 0;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return m_private->droppedMessages.load();
+  }
+
+  StreamStatistics API::GetLogMessageStatistics()
+  {
+      StreamStatistics ret;
+      if (!m_private) {
+          return ret;
+      }
+      m_private->statistics.Read(ret);
+      ret.Dropped(m_private->droppedMessages.load());
+      ret.QueueDepth(m_private->storedMessages.Size());
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return ret;
+  }
+
+  hrgls_BufferPool API::GetBufferPool()
+  {
+      if (!m_private) {
+          return nullptr;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return m_private->bufferPool;
+  }
+
+  std::vector<Message> API::GetPendingLogMessages(size_t maxNum)
+  {
+      std::vector<Message> ret;
+      if (!m_private) {
+          return ret;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+
+      std::lock_guard<std::mutex> lock2(m_private->storedMessagesMutex);
+      Message *front;
+      StatisticsCounters::DeliveredBatch delivered(m_private->statistics);
+      while (((maxNum == 0) || (ret.size() < maxNum)) &&
+             (front = m_private->storedMessages.Front()) ) {
+        ret.push_back(std::move(*front));
+        m_private->storedMessages.Pop();
+        delivered.Count(ret.back().TimeStamp());
+      }
+      if (ret.size() == 0) {
+        m_private->status.Get() = hrgls_STATUS_TIMEOUT;
+      }
+      return ret;
+  }
+
+  hrgls_Status API::SetLogMessageMinimumLevel(hrgls_MessageLevel level)
+  {
+      if (!m_private) {
+          return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      m_private->minLevel = level;
+      return m_private->status.Get() = hrgls_STATUS_OKAY;
+  }
+
+  namespace datablob {
+
+    /// Convert a timeout into a deadline, treating negative timeouts as zero.
+    static std::chrono::steady_clock::time_point DeadlineAfter(struct timeval timeout)
+    {
+      auto wait = std::chrono::seconds(timeout.tv_sec) +
+        std::chrono::microseconds(timeout.tv_usec);
+      if (wait.count() < 0) {
+        wait = std::chrono::microseconds(0);
+      }
+      return std::chrono::steady_clock::now() + wait;
+    }
+
+    //------------------------------------------------------------------------------
+    class DataBlobMultiplexer::DataBlobMultiplexer_private {
+    public:
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> status;
+      API *api = nullptr;
+
+      /// Registered sources, with the ID to report for each.  The mutex protects
+      /// the list and serializes consumers, who block on the condition until a
+      /// source signals that it has stored a blob (or we are being destroyed).
+      /// Sources are served round-robin starting at next.
+      struct Member {
+        DataBlobSource::DataBlobSource_private *source;
+        uint32_t id;
+      };
+      std::mutex mutex;
+      std::condition_variable condition;
+      std::vector<Member> members;
+      size_t next = 0;
+      std::atomic<int> waitingConsumers{ 0 };
+      bool quitting = false;
+
+      /// Called by a source's producer after pushing, to wake a consumer if one is
+      /// asleep.  The caller has already fenced after the push.
+      void Notify()
+      {
+        if (waitingConsumers.load() > 0) {
+          { std::lock_guard<std::mutex> lock(mutex); }
+          condition.notify_one();
+        }
+      }
+
+      /// Find, register or unregister a source.  The caller must hold the source's
+      /// multiplexersMutex and then our mutex.  Defined after DataBlobSource_private.
+      bool Has(DataBlobSource::DataBlobSource_private *source) const;
+      void Join(DataBlobSource::DataBlobSource_private *source, uint32_t id);
+      bool Leave(DataBlobSource::DataBlobSource_private *source, uint32_t &id);
+
+      /// Wake anyone who is waiting and remove ourselves from every source.
+      void Detach();
+    };
+
+    //------------------------------------------------------------------------------
+    class DataBlobRequest::DataBlobRequest_private {
+    public:
+      /// Shared with the source until it is filled in.  The source only holds a weak
+      /// reference, so a request whose handle has been destroyed is skipped.
+      struct State {
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool done = false;      ///< Filled in, or the source is gone.
+        bool haveBlob = false;
+        DataBlob blob;
+      };
+      std::shared_ptr<State> state;
+
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> status;
+    };
+
+    DataBlobRequest::DataBlobRequest()
+    {
+      m_private = new DataBlobRequest_private;
+    }
+
+    DataBlobRequest::~DataBlobRequest()
+    {
+      delete m_private;
+    }
+
+    DataBlobRequest::DataBlobRequest(DataBlobRequest &&other) noexcept
+    {
+      m_private = other.m_private;
+      other.m_private = nullptr;
+    }
+
+    DataBlobRequest &DataBlobRequest::operator=(DataBlobRequest &&other) noexcept
+    {
+      if (this != &other) {
+        delete m_private;
+        m_private = other.m_private;
+        other.m_private = nullptr;
+      }
+      return *this;
+    }
+
+    hrgls_Status DataBlobRequest::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    bool DataBlobRequest::IsReady()
+    {
+      if (!m_private) {
+        return false;
+      }
+      if (!m_private->state) {
+        m_private->status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return false;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      std::lock_guard<std::mutex> lock(m_private->state->mutex);
+      return m_private->state->done;
+    }
+
+    DataBlob DataBlobRequest::Wait(struct timeval timeout)
+    {
+      if (!m_private) {
+        return DataBlob();
+      }
+      std::shared_ptr<DataBlobRequest_private::State> state = m_private->state;
+      if (!state) {
+        m_private->status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return DataBlob();
+      }
+      std::unique_lock<std::mutex> lock(state->mutex);
+      if (!state->condition.wait_until(lock, DeadlineAfter(timeout),
+            [state]() { return state->done; })) {
+        m_private->status.Get() = hrgls_STATUS_TIMEOUT;
+        return DataBlob();
+      }
+
+      // Filled in or abandoned, either way we are done with the source.
+      m_private->state.reset();
+      if (!state->haveBlob) {
+        m_private->status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return DataBlob();
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return std::move(state->blob);
+    }
+
+    //------------------------------------------------------------------------------
+    /// @brief Buffers that a client lent to a DataBlobSource in one call to
+    /// ProvideBuffers(), and how to give them back.
+    ///
+    /// Each buffer is given back once, either when the last reference to the data of
+    /// the blob that was written into it is released or, if it is not holding a blob,
+    /// when the source is destroyed.  This lives until all of them have been given
+    /// back, so blobs can outlive their source.
+    struct ProvidedBuffers {
+      hrgls_DeletionFunction returnFunction = nullptr;
+      void *userData = nullptr;
+      uint32_t size = 0;
+      std::atomic<size_t> lent{ 0 };   ///< Buffers that have not been given back.
+
+      /// @brief Give a buffer back to the client; an hrgls_DeletionFunction.
+      static void Return(void *provider, const uint8_t *buffer)
+      {
+        ProvidedBuffers *p = static_cast<ProvidedBuffers*>(provider);
+        p->returnFunction(p->userData, buffer);
+        if (p->lent.fetch_sub(1) == 1) {
+          delete p;
+        }
+      }
+    };
+
+    /// @brief A buffer that a client lent to a DataBlobSource that is not holding a blob.
+    struct ProvidedBuffer {
+      uint8_t *buffer;
+      ProvidedBuffers *provider;
+    };
+
+    /// @brief What a DataBlobSource that makes its own blobs has been asked to produce.
+    ///
+    /// Made from its StreamProperties by the thread that sets them and handed to the
+    /// producer task whole, so that the task reads plain fields without locking and
+    /// never sees half of a change.
+    struct StreamConfig {
+      double rate = 30;
+      uint32_t burstLength = 1;
+      uint32_t payloadSize = NullBlobSize;
+      hrgls_PayloadDistribution payloadDistribution = hrgls_PAYLOAD_FIXED;
+
+      /// The data we send in each blob, enough for the largest one, and the pool that
+      /// we copy it into.  That is the API's pool unless our blobs are larger than its
+      /// buffers, in which case we make a pool of our own sized for the typical blob.
+      std::vector<char> blobToSend;
+      hrgls_BufferPool bufferPool = nullptr;
+      hrgls_BufferPool ownBufferPool = nullptr;
+
+      ~StreamConfig()
+      {
+        // Buffers from our pool that are still in use keep it alive until they are returned.
+        if (ownBufferPool) {
+          hrgls_BufferPoolDestroy(ownBufferPool);
+        }
+      }
+
+      /// @brief Make the configuration for a set of properties.
+      /// @param [in] apiPool Pool to use when our blobs fit in its buffers.
+      /// @return nullptr if we could not allocate what we need.
+      static StreamConfig *Create(StreamProperties &props, hrgls_BufferPool apiPool)
+      {
+        std::unique_ptr<StreamConfig> ret(new StreamConfig);
+        ret->rate = props.Rate();
+        ret->burstLength = props.BurstLength();
+        ret->payloadSize = props.PayloadSize();
+        ret->payloadDistribution = props.PayloadDistribution();
+        uint32_t maxSize = ret->MaxPayloadSize();
+        ret->blobToSend.resize(maxSize);
+        for (size_t i = 0; i < maxSize; i++) {
+          ret->blobToSend[i] = static_cast<char>(i % 256);
+        }
+        ret->bufferPool = apiPool;
+        if (ret->payloadSize > NullBlobSize) {
+          uint32_t maxFree = static_cast<uint32_t>(std::max<uint64_t>(1,
+            std::min<uint64_t>(BufferPoolMaxFreeBuffers, BufferPoolMaxFreeBytes / ret->payloadSize)));
+          if (hrgls_BufferPoolCreate(&ret->ownBufferPool, ret->payloadSize, maxFree) !=
+                hrgls_STATUS_OKAY) {
+            return nullptr;
+          }
+          ret->bufferPool = ret->ownBufferPool;
+        }
+        return ret.release();
+      }
+
+      /// @brief Largest blob that our payload distribution can produce.
+      uint32_t MaxPayloadSize() const
+      {
+        switch (payloadDistribution) {
+        case hrgls_PAYLOAD_UNIFORM:
+          return 2 * payloadSize - 1;
+        case hrgls_PAYLOAD_EXPONENTIAL:
+          return 8 * payloadSize;
+        default:
+          return payloadSize;
+        }
+      }
+
+      /// @brief Choose the size of the next blob to send.
+      uint32_t NextPayloadSize(std::minstd_rand &random) const
+      {
+        switch (payloadDistribution) {
+        case hrgls_PAYLOAD_UNIFORM:
+          return std::uniform_int_distribution<uint32_t>(1, 2 * payloadSize - 1)(random);
+        case hrgls_PAYLOAD_EXPONENTIAL: {
+          double size = std::exponential_distribution<double>(1.0 / payloadSize)(random);
+          return static_cast<uint32_t>(std::min(std::max(size, 1.0),
+            static_cast<double>(MaxPayloadSize())));
+        }
+        default:
+          return payloadSize;
+        }
+      }
+    };
+
+    static std::atomic<size_t> numCreatedDataBlobSources(0);
+    class DataBlobSource::DataBlobSource_private {
+    public:
+      API *api = nullptr;
+      std::string streamName;
+      StreamProperties properties;   ///< As the source was created.
+
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> status;
+      std::string name;
+      std::atomic<bool> running{ false };
+
+      /// Task on the API's scheduler that generates DataBlobs and either sends them
+      /// to the callback handler or stores them locally to be gotten one by one.
+      Scheduler *scheduler = nullptr;
+      Scheduler::TaskId task = 0;
+      bool quitting = false;   ///< Set when we are being destroyed.
+
+      /// The API's pool for blob data.
+      hrgls_BufferPool bufferPool = nullptr;
+
+      /// What the producer task makes, which only it touches once it is running, and
+      /// the replacement most recently published by SetStreamProperties(), which it
+      /// takes at the start of its next run.  configMutex only serializes publishers.
+      /// The largest blob that the newest configuration can make is kept for other
+      /// threads, along with the random sequence of sizes that the producer draws from.
+      std::unique_ptr<StreamConfig> config;
+      std::atomic<StreamConfig*> newConfig{ nullptr };
+      std::mutex configMutex;
+      std::atomic<uint32_t> maxPayloadSize{ 0 };
+      std::minstd_rand payloadRandom;
+
+      /// @brief Start using the configuration most recently published, if there is one.
+      /// @return True if the configuration changed.  Only called by the producer task.
+      bool TakeNewConfig()
+      {
+        if (!newConfig.load(std::memory_order_acquire)) {
+          return false;
+        }
+        config.reset(newConfig.exchange(nullptr, std::memory_order_acq_rel));
+        return true;
+      }
+
+      /// Callback handler registered with us, along with its userdata and a mutex
+      /// that is used to ensure that we read and update both data values atomically.
+      std::mutex callbackMutex;
+      StreamCallback callbackHandler = nullptr;
+      void *callbackUserData = nullptr;
+
+      /// Ring of blobs that have come in with no callback handler to deal with
+      /// them, sized by the QueueCapacity of our StreamProperties.  The producer
+      /// task pushes without locking.  They are retrieved by GetNextBlob() or
+      /// GetPendingBlobs(), which hold storedBlobsMutex to serialize consumers
+      /// and block on storedBlobsCondition until the producer task signals that
+      /// a blob has been added (or that the source is being destroyed).  The
+      /// producer only takes the mutex to notify sleeping consumers and to drop
+      /// the oldest blob when the ring is full.
+      std::mutex storedBlobsMutex;
+      std::condition_variable storedBlobsCondition;
+      std::unique_ptr< SpscRing<DataBlob> > storedBlobs;
+      std::atomic<int> waitingConsumers{ 0 };
+
+      /// What to do when the ring is full, and how many blobs have been dropped.
+      std::atomic<hrgls_OverflowPolicy> overflowPolicy{ hrgls_OVERFLOW_DROP_OLDEST };
+      std::atomic<uint64_t> droppedBlobs{ 0 };
+
+      /// Buffers lent to us by ProvideBuffers() that are free to hold a blob.  Once
+      /// the client has provided any, blobs are only written into them, and a blob
+      /// that finds none free is dropped.
+      std::mutex providedMutex;
+      std::vector<ProvidedBuffer> providedFree;
+      std::atomic<bool> usingProvidedBuffers{ false };
+
+      /// @brief Get a buffer to write a blob into and how to give it back: one that
+      /// the client provided if it has provided any, otherwise one from our pool.
+      /// @return False if there is none, in which case the blob should be dropped.
+      bool AcquireBuffer(hrgls_BufferPool pool, uint32_t size, uint8_t *&data,
+        hrgls_DeletionFunction &release, void *&releaseUserData)
+      {
+        if (!usingProvidedBuffers.load()) {
+          release = hrgls_BufferPoolReturn;
+          releaseUserData = pool;
+          return hrgls_BufferPoolAcquire(pool, size, &data) == hrgls_STATUS_OKAY;
+        }
+
+        // The most recently freed buffer is the one most likely to be in the cache.
+        std::lock_guard<std::mutex> lock(providedMutex);
+        for (size_t i = providedFree.size(); i-- > 0; ) {
+          if (providedFree[i].provider->size >= size) {
+            data = providedFree[i].buffer;
+            release = ProvidedBuffers::Return;
+            releaseUserData = providedFree[i].provider;
+            providedFree[i] = providedFree.back();
+            providedFree.pop_back();
+            return true;
+          }
+        }
+        return false;
+      }
+
+      /// Everything else reported by GetStatistics().  Blobs are counted as produced
+      /// when they are handed to DeliverBlob() (or dropped before getting there) and as
+      /// delivered wherever a consumer takes them from the ring or a handler is called.
+      StatisticsCounters statistics;
+
+      /// Under hrgls_OVERFLOW_BLOCK_PRODUCER, a blob that did not fit is held by the
+      /// producer task, which parks until a consumer makes room and wakes it.  Only
+      /// touched by the producer task.
+      DataBlob heldBlob;
+      bool haveHeldBlob = false;
+      std::atomic<bool> producerWaiting{ false };
+
+      /// Multiplexers that we are registered with, which are notified along with
+      /// our own consumers.  The count lets the producer skip the mutex when there
+      /// are none.  The mutex is locked before that of any multiplexer.
+      std::mutex multiplexersMutex;
+      std::vector<DataBlobMultiplexer::DataBlobMultiplexer_private*> multiplexers;
+      std::atomic<size_t> multiplexerCount{ 0 };
+
+      /// The API's callback pool, if it has one.  Blobs for the callback handler are
+      /// then stored like any others and delivered in order by a drain task, at most
+      /// one of which is in the pool at a time (tracked by drainScheduled).  The
+      /// destructor waits on storedBlobsCondition until activeDrains, which is only
+      /// decremented with storedBlobsMutex locked, drops to zero.
+      CallbackPool *callbackPool = nullptr;
+      std::atomic<bool> drainScheduled{ false };
+      std::atomic<int> activeDrains{ 0 };
+
+      /// Requests from GetNextBlobAsync() that are waiting for a blob, oldest first,
+      /// guarded by storedBlobsMutex.  The count lets the producer skip the mutex when
+      /// there are none.  Requests whose handles have been destroyed are dropped when a
+      /// blob reaches them, or by the next GetNextBlobAsync() if no blob comes (the
+      /// source is stopped or has a stream callback set).
+      std::deque< std::weak_ptr<DataBlobRequest::DataBlobRequest_private::State> > requests;
+      std::atomic<size_t> requestCount{ 0 };
+
+      /// eventfd that is kept readable while blobs are queued, created by the first
+      /// call to GetNotificationFD().  notifySignaled records whether it has been
+      /// written to since it was last drained, so that it is only written once.
+      std::atomic<int> notifyFD{ -1 };
+      std::atomic<bool> notifySignaled{ false };
+
+#ifdef __linux__
+      /// Shared-memory ring that the producer task copies each blob into, once
+      /// PublishSharedMemory() has been called.
+      std::atomic<SharedBlobRing*> publishedRing{ nullptr };
+
+      /// For a source attached to a ring published by another DataBlobSource, which
+      /// has a thread that reads the ring in place of a producer task.
+      SharedBlobRing *sharedRing = nullptr;
+      std::thread sharedReader;
+      std::atomic<bool> sharedReaderQuit{ false };
+
+      /// Body of the thread that hands blobs from the shared ring to our consumers.
+      /// Starts with the next blob to be published.  While streaming is off, blobs
+      /// are skipped without being claimed.
+      void ReadSharedRing()
+      {
+        uint64_t next = sharedRing->Head();
+        uint64_t count = sharedRing->SlotCount();
+        while (!sharedReaderQuit) {
+          uint64_t head = sharedRing->Head();
+          if (next >= head) {
+            if (sharedRing->Closed()) {
+              return;
+            }
+            sharedRing->WaitForPublish(head, 100);
+            continue;
+          }
+          if (!running) {
+            next = head;
+            continue;
+          }
+          if (head - next > count) {
+            droppedBlobs += head - count - next;
+            statistics.CountProduced(head - count - next);
+            Trace(hrgls_TRACE_BLOB_DROPPED, this, head - count - next);
+            next = head - count;
+          }
+          hrgls_DataBlob blob;
+          if (!sharedRing->Claim(next++, &blob)) {
+            droppedBlobs++;
+            statistics.CountProduced();
+            Trace(hrgls_TRACE_BLOB_DROPPED, this, 1);
+            continue;
+          }
+          if (!DeliverBlob(DataBlob::Adopt(blob))) {
+            // Held back by the block-producer policy; we are not a scheduler task, so
+            // poll for room.
+            while (!sharedReaderQuit && !StoreHeldBlob()) {
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (callbackPool && HaveCallbackHandler()) {
+              ScheduleDrain();
+            }
+          }
+        }
+      }
+
+      /// For a source on an API with an endpoint, the connection to the server and the
+      /// thread that reads blobs from it in place of a producer task.  The mutex
+      /// serializes the frames that we send.  remoteLost is set if the connection fails
+      /// other than by our shutting it down.
+      int remoteFD = -1;
+      std::mutex remoteSendMutex;
+      std::thread remoteReader;
+      std::atomic<bool> remoteReaderQuit{ false };
+      std::atomic<bool> remoteLost{ false };
+
+      /// For a source that replays a recording, which has a replay task in place of the
+      /// producer task.  replaySeek holds the record that SeekReplay() has asked to
+      /// move to, for the task to pick up; the rest is only touched by the task, which
+      /// paces blobs from the record and time that it (re)started at.
+      ReplayFile *replay = nullptr;
+      std::atomic<hrgls_ReplayPacing> replayPacing{ hrgls_REPLAY_RECORDED_RATE };
+      std::atomic<size_t> replaySeek{ NoReplaySeek };
+      size_t replayNext = 0;
+      hrgls_ReplayPacing replayLastPacing = hrgls_REPLAY_RECORDED_RATE;
+      bool replayRestart = true;
+      Scheduler::Clock::time_point replayStartTime;
+      int64_t replayStartRecord = 0;
+
+      /// Connect to the server and ask it to open the named source with our
+      /// properties, setting our names from its reply.
+      hrgls_Status OpenRemote(const std::string &endpoint, const std::string &source)
+      {
+        remoteFD = NetConnect(endpoint);
+        if (remoteFD < 0) {
+          return hrgls_STATUS_CONNECTION_FAILED;
+        }
+        std::vector<uint8_t> request;
+        NetPutString(request, source);
+        NetPutProperties(request, properties);
+        NetReader reader(remoteFD);
+        uint32_t type, length;
+        std::vector<uint8_t> reply;
+        if (!NetSendFrame(remoteFD, NetFrameOpen, request) ||
+            !reader.ReadHeader(type, length) || type != NetFrameOpened ||
+            !reader.ReadPayload(length, reply)) {
+          return hrgls_STATUS_CONNECTION_FAILED;
+        }
+        NetParser parser(reply);
+        hrgls_Status s = static_cast<hrgls_Status>(parser.Get32());
+        std::string opened = parser.GetString();
+        if (!parser.Ok()) {
+          return hrgls_STATUS_CONNECTION_FAILED;
+        }
+        if (s != hrgls_STATUS_OKAY) {
+          return s;
+        }
+        name = opened;
+        streamName = opened;
+        NetClearTimeout(remoteFD);
+        return hrgls_STATUS_OKAY;
+      }
+
+      /// Body of the thread that hands blobs from the server to our consumers, reading
+      /// the data of each straight into a buffer from the API's pool.  Blobs keep the
+      /// times that they were given by the server's source.  Ones that arrive while
+      /// streaming is off (sent before the server heard that it was) are dropped.
+      void ReadRemote()
+      {
+        NetReader reader(remoteFD);
+        uint32_t type, length;
+        while (reader.ReadHeader(type, length)) {
+          if (type != NetFrameBlobs) {
+            if (!reader.Read(nullptr, length)) {
+              break;
+            }
+            continue;
+          }
+          uint8_t word[4];
+          if (length < sizeof(word) || !reader.Read(word, sizeof(word))) {
+            break;
+          }
+          uint32_t count = GetLittle32(word);
+          uint64_t remaining = length - sizeof(word);
+          bool ok = true;
+          for (uint32_t i = 0; ok && i < count; i++) {
+            uint8_t header[NetBlobHeaderSize];
+            if (remaining < sizeof(header) || !reader.Read(header, sizeof(header))) {
+              ok = false;
+              break;
+            }
+            remaining -= sizeof(header);
+            struct timeval time;
+            time.tv_sec = static_cast<decltype(time.tv_sec)>(GetLittle64(header));
+            time.tv_usec = static_cast<decltype(time.tv_usec)>(GetLittle32(header + 8));
+            uint32_t size = GetLittle32(header + 12);
+            if (size > remaining) {
+              ok = false;
+              break;
+            }
+            remaining -= size;
+
+            uint8_t *data = nullptr;
+            hrgls_DeletionFunction release;
+            void *releaseUserData;
+            if (!running || !AcquireBuffer(bufferPool, size, data, release, releaseUserData)) {
+              ok = reader.Read(nullptr, size);
+              if (running) {
+                droppedBlobs++;
+                statistics.CountProduced();
+                Trace(hrgls_TRACE_BLOB_DROPPED, this, 1);
+              }
+              continue;
+            }
+            if (!reader.Read(data, size)) {
+              release(releaseUserData, data);
+              ok = false;
+              break;
+            }
+            hrgls_DataBlob blob;
+            hrgls_DataBlobCreate(&blob);
+            hrgls_DataBlobSetTime(blob, time);
+            hrgls_DataBlobSetData(blob, data, size, release, releaseUserData);
+            if (!DeliverBlob(DataBlob::Adopt(blob))) {
+              // Held back by the block-producer policy.  While we wait, the connection
+              // fills up and the server's source starts queueing.
+              while (!remoteReaderQuit && !StoreHeldBlob()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+              }
+              if (callbackPool && HaveCallbackHandler()) {
+                ScheduleDrain();
+              }
+            }
+          }
+          if (!ok || (remaining > 0 && !reader.Read(nullptr, remaining))) {
+            break;
+          }
+        }
+        if (!remoteReaderQuit) {
+          remoteLost = true;
+        }
+      }
+
+      /// Tell the server to turn streaming on or off.
+      hrgls_Status SendRemoteStreamingState(bool on)
+      {
+        std::vector<uint8_t> request;
+        PutLittle32(request, on ? 1 : 0);
+        std::lock_guard<std::mutex> lock(remoteSendMutex);
+        if (remoteLost || !NetSendFrame(remoteFD, NetFrameStreaming, request)) {
+          return hrgls_STATUS_CONNECTION_FAILED;
+        }
+        return hrgls_STATUS_OKAY;
+      }
+
+      /// Tell the server to change the properties of our stream.
+      hrgls_Status SendRemoteProperties(StreamProperties &props)
+      {
+        std::vector<uint8_t> request;
+        NetPutProperties(request, props);
+        std::lock_guard<std::mutex> lock(remoteSendMutex);
+        if (remoteLost || !NetSendFrame(remoteFD, NetFrameProperties, request)) {
+          return hrgls_STATUS_CONNECTION_FAILED;
+        }
+        return hrgls_STATUS_OKAY;
+      }
+#endif
+
+      /// Called by the producer to hand a new blob to the callback handler, unless
+      /// the API has a callback pool, or else to queue it for later delivery, either
+      /// by GetNextBlob() or by the pool.
+      /// @return False if the blob is being held until a consumer makes room.
+      bool DeliverBlob(DataBlob &&blob)
+      {
+        statistics.CountProduced();
+        Trace(hrgls_TRACE_BLOB_PRODUCED, this, blob.Size());
+
+        // Need to guard the access to the callback handler and userdata with a
+        // mutex so that we don't get half of the information due to a race with the
+        // main thread.
+        StreamCallback handler;
+        void *userData;
+        {
+          std::lock_guard<std::mutex> lock(callbackMutex);
+          handler = callbackHandler;
+          userData = callbackUserData;
+        }
+        if (handler && !callbackPool) {
+          CallHandler(handler, blob, userData);
+          return true;
+        }
+        bool stored = StoreBlob(std::move(blob));
+        if (handler) {
+          ScheduleDrain();
+        }
+        return stored;
+      }
+
+      /// Calls the stream callback handler with a blob, counting it as delivered and
+      /// timing the call.
+      void CallHandler(StreamCallback handler, DataBlob &blob, void *userData)
+      {
+        Trace(hrgls_TRACE_CALLBACK_BEGIN, this);
+        int64_t start = WallClockNanoseconds();
+        handler(blob, userData);
+        statistics.CountCallback(blob.Time(), start, WallClockNanoseconds());
+        Trace(hrgls_TRACE_CALLBACK_END, this);
+      }
+
+      /// Hands queued blobs to waiting requests.  Must be called with storedBlobsMutex
+      /// locked, by a consumer or by the producer acting as one.
+      void FillRequests()
+      {
+        bool filled = false;
+        while (!requests.empty() && storedBlobs->Front()) {
+          std::shared_ptr<DataBlobRequest::DataBlobRequest_private::State> state =
+            requests.front().lock();
+          requests.pop_front();
+          requestCount--;
+          if (!state) {
+            continue;
+          }
+          statistics.CountDelivered(storedBlobs->Front()->Time());
+          Trace(hrgls_TRACE_BLOB_DEQUEUED, this, 1);
+          {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->blob = std::move(*storedBlobs->Front());
+            state->haveBlob = true;
+            state->done = true;
+          }
+          storedBlobs->Pop();
+          state->condition.notify_all();
+          filled = true;
+        }
+        if (filled) {
+          WakeProducerIfWaiting();
+          ClearNotificationIfEmpty();
+        }
+      }
+
+      /// Marks the notification descriptor readable if it is not already.
+      void SignalNotification(int fd)
+      {
+#ifdef __linux__
+        if (!notifySignaled.exchange(true)) {
+          uint64_t one = 1;
+          ssize_t ret = write(fd, &one, sizeof(one));
+          (void)ret;
+        }
+#else
+        (void)fd;
+#endif
+      }
+
+      /// Called by consumers with storedBlobsMutex locked after removing blobs, to
+      /// make the notification descriptor unreadable once the queue is empty.  The
+      /// descriptor is drained before the flag is cleared, so a producer that sees the
+      /// cleared flag writes after the drain, and the queue is checked again after
+      /// clearing in case the producer pushed while the flag was still set.
+      void ClearNotificationIfEmpty()
+      {
+#ifdef __linux__
+        int fd = notifyFD.load();
+        if (fd < 0 || !storedBlobs->Empty() || !notifySignaled.load()) {
+          return;
+        }
+        uint64_t count;
+        ssize_t ret = read(fd, &count, sizeof(count));
+        (void)ret;
+        notifySignaled.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!storedBlobs->Empty()) {
+          SignalNotification(fd);
+        }
+#endif
+      }
+
+      bool HaveCallbackHandler()
+      {
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        return callbackHandler != nullptr;
+      }
+
+      /// Called by the producer after storing a blob for the callback handler, to
+      /// make sure that a drain task will deliver it.
+      void ScheduleDrain()
+      {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!drainScheduled.exchange(true)) {
+          activeDrains++;
+          callbackPool->Submit([this]() { DrainCallbacks(); });
+        }
+      }
+
+      /// Runs on the callback pool to hand stored blobs to the callback handler.
+      void DrainCallbacks()
+      {
+        bool stop = false;
+        for (size_t i = 0; i < CallbackBatchSize; i++) {
+          DataBlob blob;
+          {
+            std::lock_guard<std::mutex> lock(storedBlobsMutex);
+            if (quitting || !storedBlobs->Front()) {
+              stop = quitting;
+              break;
+            }
+            blob = std::move(*storedBlobs->Front());
+            storedBlobs->Pop();
+          }
+          WakeProducerIfWaiting();
+
+          StreamCallback handler;
+          void *userData;
+          {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            handler = callbackHandler;
+            userData = callbackUserData;
+          }
+          if (handler) {
+            CallHandler(handler, blob, userData);
+          }
+        }
+
+        // Keep going if there is more, otherwise mark that we are done.  A blob
+        // stored after we check sees the flag cleared and schedules a new drain.
+        bool again = !stop && !storedBlobs->Empty();
+        if (!stop && !again) {
+          drainScheduled.store(false);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          again = !storedBlobs->Empty() && !drainScheduled.exchange(true);
+        }
+        {
+          std::lock_guard<std::mutex> lock(storedBlobsMutex);
+          if (again && !quitting) {
+            activeDrains++;
+            callbackPool->Submit([this]() { DrainCallbacks(); });
+          }
+          activeDrains--;
+          // Notify while holding the lock; the destructor may free the condition
+          // variable as soon as it sees the count drop to zero.
+          storedBlobsCondition.notify_all();
+        }
+      }
+
+      /// Sleep on the condition variable until the producer thread hands us a
+      /// blob or we time out.  Negative timeouts are treated as zero.  Must be
+      /// called with storedBlobsMutex locked by the lock that is passed in.
+      /// @return True if there is at least one stored blob.
+      bool WaitForStoredBlobs(std::unique_lock<std::mutex> &lock, struct timeval timeout)
+      {
+        auto deadline = DeadlineAfter(timeout);
+
+        // Announce that we may sleep before checking the ring, so that a producer
+        // that pushes after our check is sure to see us and notify.
+        waitingConsumers++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        storedBlobsCondition.wait_until(lock, deadline,
+          [this]() { return !storedBlobs->Empty() || quitting; });
+        waitingConsumers--;
+        return !storedBlobs->Empty();
+      }
+
+      /// Called by the producer after pushing, to fill in any waiting requests and
+      /// wake a consumer if one is asleep.
+      void NotifyConsumers()
+      {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (requestCount.load() > 0) {
+          std::lock_guard<std::mutex> lock(storedBlobsMutex);
+          FillRequests();
+        }
+        int fd = notifyFD.load();
+        if (fd >= 0 && !storedBlobs->Empty()) {
+          SignalNotification(fd);
+        }
+        if (waitingConsumers.load() > 0) {
+          // Taking the lock orders us after a consumer that has checked the ring
+          // but not yet gone to sleep.
+          { std::lock_guard<std::mutex> lock(storedBlobsMutex); }
+          storedBlobsCondition.notify_one();
+        }
+        if (multiplexerCount.load() > 0) {
+          std::lock_guard<std::mutex> lock(multiplexersMutex);
+          for (size_t i = 0; i < multiplexers.size(); i++) {
+            multiplexers[i]->Notify();
+          }
+        }
+      }
+
+      /// Called by a consumer after popping, to restart a producer that is being
+      /// held back by the block-producer policy.
+      void WakeProducerIfWaiting()
+      {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting.load() && producerWaiting.exchange(false) && scheduler) {
+          scheduler->Wake(task);
+        }
+      }
+
+      /// Called by the producer task to retry storing the held blob.
+      /// @return True if it was stored, false if there is still no room.
+      bool StoreHeldBlob()
+      {
+        // If the policy has been changed since, queue it under the new one.
+        if (overflowPolicy.load() != hrgls_OVERFLOW_BLOCK_PRODUCER) {
+          producerWaiting.store(false);
+          haveHeldBlob = false;
+          return StoreBlob(std::move(heldBlob));
+        }
+
+        // Ask to be woken before checking for room, so that a consumer that pops
+        // after our check is sure to see the request.
+        producerWaiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!storedBlobs->TryPush(std::move(heldBlob))) {
+          return false;
+        }
+        statistics.CountQueueDepth(storedBlobs->Size());
+        Trace(hrgls_TRACE_BLOB_ENQUEUED, this, storedBlobs->Size());
+        producerWaiting.store(false);
+        haveHeldBlob = false;
+        NotifyConsumers();
+        return true;
+      }
+
+      /// Called by the producer task to queue a blob according to the overflow policy.
+      /// @return False if the producer must park until a consumer makes room.
+      bool StoreBlob(DataBlob &&blob)
+      {
+        if (storedBlobs->TryPush(std::move(blob))) {
+          statistics.CountQueueDepth(storedBlobs->Size());
+          Trace(hrgls_TRACE_BLOB_ENQUEUED, this, storedBlobs->Size());
+          NotifyConsumers();
+          return true;
+        }
+        switch (overflowPolicy.load()) {
+        case hrgls_OVERFLOW_DROP_NEWEST:
+          droppedBlobs++;
+          Trace(hrgls_TRACE_BLOB_DROPPED, this, 1);
+          return true;
+        case hrgls_OVERFLOW_BLOCK_PRODUCER:
+          heldBlob = std::move(blob);
+          haveHeldBlob = true;
+          return StoreHeldBlob();
+        default:
+          {
+            // Drop the oldest, acting as the consumer for a moment.
+            std::lock_guard<std::mutex> lock(storedBlobsMutex);
+            if (storedBlobs->Front()) {
+              storedBlobs->Pop();
+              droppedBlobs++;
+              Trace(hrgls_TRACE_BLOB_DROPPED, this, 1);
+            }
+            storedBlobs->TryPush(std::move(blob));
+            Trace(hrgls_TRACE_BLOB_ENQUEUED, this, storedBlobs->Size());
+          }
+          NotifyConsumers();
+          return true;
+        }
+      }
+    };
+
+    /// Make a blob of the next size from our distribution, copy our data into a buffer
+    /// from our pool and hand it to our consumers.
+    /// @return False if the blob is being held until a consumer makes room.
+    static bool SendBlob(DataBlobSource::DataBlobSource_private *info)
+    {
+      const StreamConfig &config = *info->config;
+      uint32_t size = config.NextPayloadSize(info->payloadRandom);
+      timeval myTime = info->api->GetCurrentSystemTime();
+      hrgls_DataBlob blob;
+      hrgls_DataBlobCreate(&blob);
+      hrgls_DataBlobSetTime(blob, myTime);
+
+      // Copy the DataBlob data into a buffer from the pool or the client, which it goes
+      // back to when the last reference to the blob's data is released.
+      uint8_t *data;
+      hrgls_DeletionFunction release;
+      void *releaseUserData;
+      if (!info->AcquireBuffer(config.bufferPool, size, data, release, releaseUserData)) {
+        hrgls_DataBlobDestroy(blob);
+        if (info->usingProvidedBuffers.load()) {
+          info->droppedBlobs++;
+          info->statistics.CountProduced();
+          Trace(hrgls_TRACE_BLOB_DROPPED, info, 1);
+        }
+        return true;
+      }
+      memcpy(data, config.blobToSend.data(), size);
+      hrgls_DataBlobSetData(blob, data, size, release, releaseUserData);
+
+#ifdef __linux__
+      // Copy it once into the shared ring for other processes, if we publish one.
+      SharedBlobRing *ring = info->publishedRing.load();
+      if (ring) {
+        ring->Publish(data, size, myTime);
+      }
+#endif
+
+      // The DataBlob takes ownership of the C blob, and is moved rather than copied
+      // onto the queue.
+      return info->DeliverBlob(DataBlob::Adopt(blob));
+    }
+
+    /// Scheduled task that sends a burst of BurstLength() blobs each time it comes due,
+    /// at Rate() / BurstLength() bursts per second.  While streaming is off it parks
+    /// itself so that an idle source causes no wakeups; it is woken by
+    /// SetStreamingState() and SetStreamProperties().  When it has fallen behind it sends
+    /// the bursts that are due until it has sent ProducerBatchSize blobs before letting
+    /// other tasks have a turn, so that high rates are not limited by the cost of
+    /// rescheduling.  New properties take effect at once, with the first burst at the
+    /// new rate sent now.
+    static bool DataBlobSourceTask(DataBlobSource::DataBlobSource_private *info,
+      Scheduler::Clock::time_point &next)
+    {
+      bool changed = info->TakeNewConfig();
+      if (!info->running) {
+        next = Scheduler::Clock::time_point::max();
+        return true;
+      }
+      if (changed) {
+        next = Scheduler::Clock::now();
+      }
+      const StreamConfig &config = *info->config;
+      double burstRate = config.rate / config.burstLength;
+
+      // If we are holding a blob because the queue was full, store it before we
+      // make any more.  If there is still no room, park until a consumer wakes us.
+      // The rest of the burst that it was part of is not sent.
+      if (info->haveHeldBlob) {
+        if (info->StoreHeldBlob()) {
+          if (info->callbackPool && info->HaveCallbackHandler()) {
+            info->ScheduleDrain();
+          }
+          next = NextPeriodicDeadline(next, burstRate);
+        } else {
+          next = Scheduler::Clock::time_point::max();
+        }
+        return true;
+      }
+
+      size_t sent = 0;
+      do {
+        next = NextPeriodicDeadline(next, burstRate);
+        for (uint32_t i = 0; i < config.burstLength; i++, sent++) {
+          if (!SendBlob(info)) {
+            // Held until a consumer makes room; it will wake us.
+            next = Scheduler::Clock::time_point::max();
+            return true;
+          }
+        }
+      } while (sent < ProducerBatchSize && burstRate > 0 && next <= Scheduler::Clock::now());
+      return true;
+    }
+
+#ifdef __linux__
+    /// Scheduled task that replays a recording in place of DataBlobSourceTask.  At the
+    /// recorded rate, each blob comes due at the same offset from the start time as it
+    /// has from the first record sent after streaming was started, the pacing changed,
+    /// or the source was moved, so that the blobs are spaced as they were recorded.
+    /// Otherwise blobs are sent as fast as they are taken, a batch at a time so that
+    /// other tasks get a turn.  At the end of the recording it parks until moved.
+    static bool ReplayTask(DataBlobSource::DataBlobSource_private *info,
+      Scheduler::Clock::time_point &next)
+    {
+      size_t seek = info->replaySeek.exchange(NoReplaySeek);
+      if (seek != NoReplaySeek) {
+        info->replayNext = seek;
+        info->replayRestart = true;
+        if (info->haveHeldBlob) {
+          // Held from before the move, so no longer wanted.
+          info->producerWaiting.store(false);
+          info->heldBlob = DataBlob();
+          info->haveHeldBlob = false;
+        }
+      }
+      if (!info->running) {
+        info->replayRestart = true;
+        next = Scheduler::Clock::time_point::max();
+        return true;
+      }
+      if (info->haveHeldBlob) {
+        if (!info->StoreHeldBlob()) {
+          next = Scheduler::Clock::time_point::max();
+          return true;
+        }
+        if (info->callbackPool && info->HaveCallbackHandler()) {
+          info->ScheduleDrain();
+        }
+      }
+      hrgls_ReplayPacing pacing = info->replayPacing.load();
+      if (pacing != info->replayLastPacing) {
+        info->replayLastPacing = pacing;
+        info->replayRestart = true;
+      }
+
+      ReplayFile *file = info->replay;
+      auto now = Scheduler::Clock::now();
+      for (size_t i = 0; i < ReplayBatchSize; i++) {
+        if (info->replayNext >= file->Count()) {
+          next = Scheduler::Clock::time_point::max();
+          return true;
+        }
+        if (pacing == hrgls_REPLAY_RECORDED_RATE) {
+          if (info->replayRestart) {
+            info->replayStartTime = now;
+            info->replayStartRecord = file->TimeOf(info->replayNext);
+            info->replayRestart = false;
+          }
+          auto due = info->replayStartTime + std::chrono::microseconds(
+            file->TimeOf(info->replayNext) - info->replayStartRecord);
+          if (due > now) {
+            next = due;
+            return true;
+          }
+        }
+        hrgls_DataBlob blob = file->MakeBlob(info->replayNext++);
+        if (!blob) {
+          info->droppedBlobs++;
+          info->statistics.CountProduced();
+          Trace(hrgls_TRACE_BLOB_DROPPED, info, 1);
+          continue;
+        }
+        if (!info->DeliverBlob(DataBlob::Adopt(blob))) {
+          // Held until a consumer makes room; it will wake us.
+          next = Scheduler::Clock::time_point::max();
+          return true;
+        }
+      }
+      next = now;
+      return true;
+    }
+#endif
+
+    DataBlobSource::DataBlobSource(
+      API &api,
+      StreamProperties &props,
+      ::std::string DataBlobSource
+    )
+    {
+      //------------------------------------------------------------------------------
+      // Construct the data we'll need to enable a test program to try out all of our
+      // features.
+      m_private = new DataBlobSource_private;
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      m_private->storedBlobs.reset(new SpscRing<DataBlob>(props.QueueCapacity()));
+      m_private->overflowPolicy = props.OverflowPolicy();
+
+      m_private->streamName = "/hrgls/null/DataBlobSource/" +
+        std::to_string(numCreatedDataBlobSources++);
+
+#ifdef __linux__
+      // Names under the shared-memory prefix attach to a ring published by another
+      // DataBlobSource, usually in another process, which we read with a thread of
+      // our own in place of a producer task.
+      const std::string &prefix = SharedBlobRing::NamePrefix();
+      if (DataBlobSource.compare(0, prefix.size(), prefix) == 0) {
+        m_private->sharedRing = SharedBlobRing::Attach(DataBlobSource.substr(prefix.size()));
+        if (!m_private->sharedRing) {
+          m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+          return;
+        }
+        m_private->name = DataBlobSource;
+        m_private->streamName = DataBlobSource;
+        m_private->api = &api;
+        m_private->properties = props;
+        m_private->callbackPool = api.m_private->callbackPool.get();
+        DataBlobSource_private *info = m_private;
+        m_private->sharedReader = std::thread([info]() { info->ReadSharedRing(); });
+        return;
+      }
+
+      // On an API with an endpoint, the source lives on the server and we read its
+      // blobs from a connection with a thread of our own in place of a producer task.
+      if (!api.m_private->endpoint.empty()) {
+        m_private->api = &api;
+        m_private->properties = props;
+        m_private->bufferPool = api.m_private->bufferPool;
+        m_private->callbackPool = api.m_private->callbackPool.get();
+        hrgls_Status s = m_private->OpenRemote(api.m_private->endpoint, DataBlobSource);
+        if (s != hrgls_STATUS_OKAY) {
+          m_private->status.Get() = s;
+          return;
+        }
+        DataBlobSource_private *info = m_private;
+        m_private->remoteReader = std::thread([info]() { info->ReadRemote(); });
+        return;
+      }
+
+      // Names under the replay prefix replay a recording, with a task of their own on
+      // the API's scheduler.
+      const std::string &replayPrefix = ReplayFile::NamePrefix();
+      if (DataBlobSource.compare(0, replayPrefix.size(), replayPrefix) == 0) {
+        m_private->replay = ReplayFile::Open(DataBlobSource.substr(replayPrefix.size()));
+        if (!m_private->replay) {
+          m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+          return;
+        }
+        m_private->name = DataBlobSource;
+        m_private->streamName = DataBlobSource;
+        m_private->api = &api;
+        m_private->properties = props;
+        m_private->callbackPool = api.m_private->callbackPool.get();
+        m_private->scheduler = &api.m_private->scheduler;
+        DataBlobSource_private *info = m_private;
+        m_private->task = m_private->scheduler->Post(
+          [info](Scheduler::Clock::time_point &next) { return ReplayTask(info, next); });
+        return;
+      }
+#endif
+
+      // If they ask for an empty-named DataBlobSource, return the first one.  Otherwise,
+      // make sure we have the one they asked for and return it.
+      DataBlobSourceDescription rend;
+      if (!api.m_private->rends.Find(DataBlobSource, rend)) {
+        m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+        return;
+      }
+
+      /// Squirrel away all of the information we need in our private store so
+      /// that we can implement our methods.
+      m_private->name = rend.Name();
+      m_private->api = &api;
+      m_private->properties = props;
+
+      // Make the data we're going to send, enough for the largest blob.  Each source
+      // has its own sequence of sizes, seeded by the order the sources were made in.
+      m_private->bufferPool = api.m_private->bufferPool;
+      m_private->config.reset(StreamConfig::Create(props, m_private->bufferPool));
+      if (!m_private->config) {
+        m_private->status.Get() = hrgls_STATUS_OUT_OF_MEMORY;
+        return;
+      }
+      m_private->maxPayloadSize = m_private->config->MaxPayloadSize();
+      m_private->payloadRandom.seed(static_cast<std::minstd_rand::result_type>(
+        numCreatedDataBlobSources.load() + 1));
+
+      /// Register our producer with the API's scheduler rather than starting a
+      /// thread of our own.  It is added parked, and first runs when streaming is turned on.
+      DataBlobSource_private *info = m_private;
+      m_private->scheduler = &api.m_private->scheduler;
+      m_private->callbackPool = api.m_private->callbackPool.get();
+      m_private->task = m_private->scheduler->Schedule(Scheduler::Clock::time_point::max(),
+        [info](Scheduler::Clock::time_point &next) { return DataBlobSourceTask(info, next); });
+    }
+
+    DataBlobSource::~DataBlobSource()
+    {
+      // Stop my producer task and wake up anyone who is waiting for a blob.
+      if (m_private) {
+        if (m_private->scheduler) {
+          m_private->scheduler->Cancel(m_private->task);
+        }
+#ifdef __linux__
+        if (m_private->sharedReader.joinable()) {
+          m_private->sharedReaderQuit = true;
+          m_private->sharedRing->Interrupt();
+          m_private->sharedReader.join();
+        }
+        if (m_private->remoteFD >= 0) {
+          m_private->remoteReaderQuit = true;
+          shutdown(m_private->remoteFD, SHUT_RDWR);
+          if (m_private->remoteReader.joinable()) {
+            m_private->remoteReader.join();
+          }
+          close(m_private->remoteFD);
+        }
+#endif
+        {
+          // Remove ourselves from any multiplexers that are waiting on us.
+          std::lock_guard<std::mutex> lock(m_private->multiplexersMutex);
+          for (size_t i = 0; i < m_private->multiplexers.size(); i++) {
+            DataBlobMultiplexer::DataBlobMultiplexer_private *mux = m_private->multiplexers[i];
+            std::lock_guard<std::mutex> lock2(mux->mutex);
+            for (size_t j = 0; j < mux->members.size(); j++) {
+              if (mux->members[j].source == m_private) {
+                mux->members.erase(mux->members.begin() + j);
+                break;
+              }
+            }
+          }
+          m_private->multiplexers.clear();
+          m_private->multiplexerCount = 0;
+        }
+        {
+          // Wake our consumers, then wait for any callback drain task to finish.
+          std::unique_lock<std::mutex> lock(m_private->storedBlobsMutex);
+          m_private->quitting = true;
+          m_private->storedBlobsCondition.notify_all();
+          DataBlobSource_private *info = m_private;
+          info->storedBlobsCondition.wait(lock, [info]() { return info->activeDrains.load() == 0; });
+
+          // Let waiting requests know that they will not be filled in.
+          for (size_t i = 0; i < info->requests.size(); i++) {
+            std::shared_ptr<DataBlobRequest::DataBlobRequest_private::State> state =
+              info->requests[i].lock();
+            if (state) {
+              {
+                std::lock_guard<std::mutex> lock2(state->mutex);
+                state->done = true;
+              }
+              state->condition.notify_all();
+            }
+          }
+          info->requests.clear();
+        }
+#ifdef __linux__
+        if (m_private->notifyFD.load() >= 0) {
+          close(m_private->notifyFD.load());
+        }
+
+        // Queued blobs from a shared ring or a recording hold their own references to it.
+        if (m_private->sharedRing) {
+          m_private->sharedRing->Unref();
+        }
+        if (m_private->replay) {
+          m_private->replay->Unref();
+        }
+        SharedBlobRing *ring = m_private->publishedRing.load();
+        if (ring) {
+          ring->Close();
+          ring->Unref();
+        }
+#endif
+        // Nothing can take a provided buffer now, so give back the ones not holding a blob.
+        for (size_t i = 0; i < m_private->providedFree.size(); i++) {
+          ProvidedBuffers::Return(m_private->providedFree[i].provider,
+            m_private->providedFree[i].buffer);
+        }
+        m_private->providedFree.clear();
+
+        // Our producer is gone, so nothing else will take a new configuration.
+        delete m_private->newConfig.exchange(nullptr);
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobSource::SetStreamProperties(StreamProperties &props)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      if (std::max<size_t>(1, props.QueueCapacity()) != m_private->storedBlobs->Capacity()) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+#ifdef __linux__
+      // Blobs from a shared ring or a recording are made by someone else.
+      if (m_private->sharedRing || m_private->replay) {
+        return hrgls_STATUS_NOT_IMPLEMENTED;
+      }
+      // The server makes the blobs of a remote source; we only queue them.
+      if (m_private->remoteFD >= 0) {
+        m_private->overflowPolicy = props.OverflowPolicy();
+        return m_private->SendRemoteProperties(props);
+      }
+#endif
+      if (!m_private->scheduler) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+
+      // Build the new configuration here, then hand it to the producer task in one
+      // step and wake it so that the change takes effect at once.
+      StreamConfig *config = StreamConfig::Create(props, m_private->bufferPool);
+      if (!config) {
+        return hrgls_STATUS_OUT_OF_MEMORY;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_private->configMutex);
+        m_private->overflowPolicy = props.OverflowPolicy();
+        m_private->maxPayloadSize = config->MaxPayloadSize();
+        delete m_private->newConfig.exchange(config, std::memory_order_acq_rel);
+      }
+      m_private->scheduler->Wake(m_private->task);
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_Status DataBlobSource::ProvideBuffers(const std::vector<uint8_t*> &buffers,
+      uint32_t size, hrgls_DeletionFunction returnFunction, void *userData)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      if (buffers.empty() || size == 0 || !returnFunction) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      for (size_t i = 0; i < buffers.size(); i++) {
+        if (!buffers[i]) {
+          return hrgls_STATUS_BAD_PARAMETER;
+        }
+      }
+#ifdef __linux__
+      // Blobs from a shared ring or a recording point at memory that is already mapped.
+      if (m_private->sharedRing || m_private->replay) {
+        return hrgls_STATUS_NOT_IMPLEMENTED;
+      }
+#endif
+      // The blobs we make ourselves must always fit.
+      if (m_private->scheduler && size < m_private->maxPayloadSize.load()) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+
+      ProvidedBuffers *provider = new ProvidedBuffers;
+      provider->returnFunction = returnFunction;
+      provider->userData = userData;
+      provider->size = size;
+      provider->lent = buffers.size();
+      {
+        std::lock_guard<std::mutex> lock(m_private->providedMutex);
+        for (size_t i = 0; i < buffers.size(); i++) {
+          ProvidedBuffer b = { buffers[i], provider };
+          m_private->providedFree.push_back(b);
+        }
+      }
+      m_private->usingProvidedBuffers = true;
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_Status DataBlobSource::PublishSharedMemory(const std::string &name)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+#ifdef __linux__
+      if (!SharedBlobRing::ValidName(name) || !m_private->scheduler ||
+          m_private->replay || m_private->publishedRing.load()) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+
+      // Twice as many slots as our queue holds, so that a consumer with the same
+      // queue capacity can fill its queue without causing blobs to be skipped.
+      SharedBlobRing *ring = SharedBlobRing::Create(name,
+        2 * m_private->properties.QueueCapacity(),
+        m_private->maxPayloadSize.load());
+      if (!ring) {
+        return hrgls_STATUS_OUT_OF_MEMORY;
+      }
+      SharedBlobRing *none = nullptr;
+      if (!m_private->publishedRing.compare_exchange_strong(none, ring)) {
+        ring->Close();
+        ring->Unref();
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      return hrgls_STATUS_OKAY;
+#else
+      (void)name;
+      return hrgls_STATUS_NOT_IMPLEMENTED;
+#endif
+    }
+
+    hrgls_Status DataBlobSource::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      } else {
+        hrgls_Status &status = m_private->status.Get();
+        hrgls_Status ret = status;
+        status = hrgls_STATUS_OKAY;
+        return ret;
+      }
+    }
+
+    hrgls_Status DataBlobSource::SetStreamingState(bool running)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      m_private->running = running;
+      if (running && m_private->scheduler) {
+        m_private->scheduler->Wake(m_private->task);
+      }
+#ifdef __linux__
+      if (m_private->remoteFD >= 0) {
+        return m_private->SendRemoteStreamingState(running);
+      }
+#endif
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_Status DataBlobSource::SetStreamCallback(StreamCallback callback, void *userdata)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+
+      // Lock the thread mutices for callback and streaming while we change
+      // the state.
+      std::lock_guard<std::mutex> lock(m_private->callbackMutex);
+      std::lock_guard<std::mutex> lock2(m_private->storedBlobsMutex);
+
+      // Set the streaming callback handler.
+      m_private->callbackHandler = callback;
+      m_private->callbackUserData = userdata;
+
+      // Flush all stored blobs, releasing a producer that is waiting for room.
+      m_private->storedBlobs->Clear();
+      m_private->WakeProducerIfWaiting();
+      m_private->ClearNotificationIfEmpty();
+
+      return hrgls_STATUS_OKAY;
+    }
+
+    DataBlob DataBlobSource::GetNextBlob(struct timeval timeout)
+    {
+      if (!m_private) {
+        return DataBlob();
+      }
+
+      std::unique_lock<std::mutex> lock(m_private->storedBlobsMutex);
+      if (m_private->WaitForStoredBlobs(lock, timeout)) {
+        DataBlob ret(std::move(*m_private->storedBlobs->Front()));
+        m_private->storedBlobs->Pop();
+        m_private->statistics.CountDelivered(ret.Time());
+        Trace(hrgls_TRACE_BLOB_DEQUEUED, m_private, 1);
+        m_private->WakeProducerIfWaiting();
+        m_private->ClearNotificationIfEmpty();
+        m_private->status.Get() = hrgls_STATUS_OKAY;
+        return ret;
+      }
+
+      m_private->status.Get() = hrgls_STATUS_TIMEOUT;
+      return DataBlob();
+    }
+
+    std::vector<DataBlob> DataBlobSource::GetPendingBlobs(size_t maxNum, struct timeval timeout)
+    {
+      std::vector<DataBlob> ret;
+      if (!m_private) {
+        return ret;
+      }
+
+      // Move out everything that is available under a single lock.
+      std::unique_lock<std::mutex> lock(m_private->storedBlobsMutex);
+      if (m_private->WaitForStoredBlobs(lock, timeout)) {
+        size_t count = m_private->storedBlobs->Size();
+        if ((maxNum > 0) && (maxNum < count)) {
+          count = maxNum;
+        }
+        ret.reserve(count);
+        StatisticsCounters::DeliveredBatch delivered(m_private->statistics);
+        for (size_t i = 0; i < count; i++) {
+          ret.push_back(std::move(*m_private->storedBlobs->Front()));
+          m_private->storedBlobs->Pop();
+          delivered.Count(ret.back().Time());
+        }
+        Trace(hrgls_TRACE_BLOB_DEQUEUED, m_private, count);
+        m_private->WakeProducerIfWaiting();
+        m_private->ClearNotificationIfEmpty();
+        m_private->status.Get() = hrgls_STATUS_OKAY;
+      } else {
+        m_private->status.Get() = hrgls_STATUS_TIMEOUT;
+      }
+      return ret;
+    }
+
+    DataBlobRequest DataBlobSource::GetNextBlobAsync()
+    {
+      DataBlobRequest ret;
+      if (!m_private) {
+        return ret;
+      }
+      try {
+        ret.m_private->state = std::make_shared<DataBlobRequest::DataBlobRequest_private::State>();
+        std::lock_guard<std::mutex> lock(m_private->storedBlobsMutex);
+
+        // Forget requests that were given up on, so that a caller that keeps making
+        // requests and dropping them does not grow the list or keep the producer
+        // taking the mutex.
+        auto &requests = m_private->requests;
+        size_t before = requests.size();
+        requests.erase(std::remove_if(requests.begin(), requests.end(),
+          [](const std::weak_ptr<DataBlobRequest::DataBlobRequest_private::State> &r) {
+            return r.expired();
+          }), requests.end());
+        m_private->requestCount -= before - requests.size();
+
+        requests.push_back(ret.m_private->state);
+
+        // Count ourselves before checking the ring, so that a producer that pushes
+        // after our check is sure to see us and fill us in.
+        m_private->requestCount++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_private->FillRequests();
+      } catch (...) {
+        ret.m_private->state.reset();
+        m_private->status.Get() = hrgls_STATUS_OUT_OF_MEMORY;
+        return ret;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    int DataBlobSource::GetNotificationFD()
+    {
+      if (!m_private) {
+        return -1;
+      }
+#ifdef __linux__
+      std::lock_guard<std::mutex> lock(m_private->storedBlobsMutex);
+      int fd = m_private->notifyFD.load();
+      if (fd < 0) {
+        fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0) {
+          m_private->status.Get() = hrgls_STATUS_OUT_OF_MEMORY;
+          return -1;
+        }
+        m_private->notifyFD.store(fd);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!m_private->storedBlobs->Empty()) {
+          m_private->SignalNotification(fd);
+        }
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return fd;
+#else
+      m_private->status.Get() = hrgls_STATUS_NOT_IMPLEMENTED;
+      return -1;
+#endif
+    }
+
+    hrgls_Status DataBlobSource::SetReplayPacing(hrgls_ReplayPacing pacing)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+#ifdef __linux__
+      if (!m_private->replay || (pacing != hrgls_REPLAY_RECORDED_RATE &&
+            pacing != hrgls_REPLAY_AS_FAST_AS_POSSIBLE)) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      m_private->replayPacing.store(pacing);
+      m_private->scheduler->Wake(m_private->task);
+      return hrgls_STATUS_OKAY;
+#else
+      (void)pacing;
+      return hrgls_STATUS_BAD_PARAMETER;
+#endif
+    }
+
+    hrgls_Status DataBlobSource::SeekReplay(struct timeval time)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+#ifdef __linux__
+      if (!m_private->replay) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      m_private->replaySeek.store(m_private->replay->Find(MicrosecondsOf(time)));
+      m_private->scheduler->Wake(m_private->task);
+      return hrgls_STATUS_OKAY;
+#else
+      (void)time;
+      return hrgls_STATUS_BAD_PARAMETER;
+#endif
+    }
+
+    uint64_t DataBlobSource::GetDroppedBlobCount()
+    {
+      if (!m_private) {
+        return 0;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return m_private->droppedBlobs.load();
+    }
+
+    StreamStatistics DataBlobSource::GetStatistics()
+    {
+      StreamStatistics ret;
+      if (!m_private) {
+        return ret;
+      }
+      m_private->statistics.Read(ret);
+      ret.Dropped(m_private->droppedBlobs.load());
+      if (m_private->storedBlobs) {
+        ret.QueueDepth(m_private->storedBlobs->Size());
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    DataBlobSourceDescription DataBlobSource::GetInfo()
+    {
+      DataBlobSourceDescription ret;
+      if (!m_private) {
+        m_private->status.Get() = hrgls_STATUS_NULL_OBJECT_POINTER;
+        return ret;
+      }
+      ret.Name(m_private->streamName);
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    //------------------------------------------------------------------------------
+    class DataBlobSourceGroup::DataBlobSourceGroup_private {
+    public:
+      std::vector< std::unique_ptr<DataBlobSource> > sources;
+      Scheduler *scheduler = nullptr;
+
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> status;
+    };
+
+    DataBlobSourceGroup::DataBlobSourceGroup(
+      API &api,
+      StreamProperties &props,
+      const ::std::vector< ::std::string > &sources)
+    {
+      m_private = new DataBlobSourceGroup_private;
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      m_private->scheduler = &api.m_private->scheduler;
+
+      ::std::vector< ::std::string > names = sources;
+      if (names.empty()) {
+        ::std::vector<DataBlobSourceDescription> all = api.GetAvailableDataBlobSources();
+        hrgls_Status s = api.GetStatus();
+        if (s != hrgls_STATUS_OKAY) {
+          m_private->status.Get() = s;
+          return;
+        }
+        for (size_t i = 0; i < all.size(); i++) {
+          names.push_back(all[i].Name());
+        }
+      }
+
+      // Construct the sources in slices on as many threads as are worth starting.
+      // Each thread checks the status of the ones it made, because a source reports
+      // its status only to the thread that made it.
+      size_t count = names.size();
+      m_private->sources.resize(count);
+      std::vector<hrgls_Status> results(count, hrgls_STATUS_OKAY);
+      size_t numThreads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+        (count + GroupSourcesPerThread - 1) / GroupSourcesPerThread);
+      DataBlobSourceGroup_private *info = m_private;
+      auto construct = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          try {
+            info->sources[i].reset(new DataBlobSource(api, props, names[i]));
+            results[i] = info->sources[i]->GetStatus();
+          } catch (...) {
+            results[i] = hrgls_STATUS_OUT_OF_MEMORY;
+          }
+        }
+      };
+      std::vector<std::thread> threads;
+      for (size_t t = 1; t < numThreads; t++) {
+        threads.push_back(std::thread(construct, count * t / numThreads,
+          count * (t + 1) / numThreads));
+      }
+      construct(0, numThreads > 1 ? count / numThreads : count);
+      for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+      }
+
+      // If any failed, report the first and keep none of them.
+      for (size_t i = 0; i < count; i++) {
+        if (results[i] != hrgls_STATUS_OKAY) {
+          m_private->status.Get() = results[i];
+          m_private->sources.clear();
+          return;
+        }
+      }
+    }
+
+    DataBlobSourceGroup::~DataBlobSourceGroup()
+    {
+      // Remove all of the producer tasks from the scheduler at once, so that each
+      // source's destructor finds its task already gone.
+      if (m_private) {
+        std::vector<Scheduler::TaskId> tasks;
+        for (size_t i = 0; i < m_private->sources.size(); i++) {
+          DataBlobSource::DataBlobSource_private *source = m_private->sources[i]->m_private;
+          if (source->scheduler == m_private->scheduler) {
+            tasks.push_back(source->task);
+          }
+        }
+        m_private->scheduler->Cancel(tasks);
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobSourceGroup::GetStatus()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
+
+    size_t DataBlobSourceGroup::Size() const
+    {
+      if (!m_private) {
+        return 0;
+      }
+      return m_private->sources.size();
+    }
+
+    DataBlobSource &DataBlobSourceGroup::operator[](size_t which)
+    {
+      return *m_private->sources[which];
+    }
+
+    hrgls_Status DataBlobSourceGroup::SetStreamingState(bool running)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+
+      // Sources with producer tasks are all woken with a single call.  The others are
+      // set one at a time, which for remote sources tells the server.
+      hrgls_Status ret = hrgls_STATUS_OKAY;
+      std::vector<Scheduler::TaskId> tasks;
+      for (size_t i = 0; i < m_private->sources.size(); i++) {
+        DataBlobSource &source = *m_private->sources[i];
+        if (source.m_private->scheduler == m_private->scheduler) {
+          source.m_private->running = running;
+          tasks.push_back(source.m_private->task);
+        } else {
+          hrgls_Status s = source.SetStreamingState(running);
+          if (ret == hrgls_STATUS_OKAY) {
+            ret = s;
+          }
+        }
+      }
+      if (running) {
+        m_private->scheduler->Wake(tasks);
+      }
+      return ret;
+    }
+
+    DataBlobMultiplexer::DataBlobMultiplexer(API &api)
+    {
+      m_private = new DataBlobMultiplexer_private;
+      m_private->api = &api;
+      m_private->status.Get() = hrgls_STATUS_OKAY;
     }
-    return hrgls_STATUS_OKAY;
-  }
 
-  hrgls_Status API::SetLogMessageCallback(LogMessageCallback callback,
-      void *userdata)
-  {
-      if (!m_private) {
-          return hrgls_STATUS_NULL_OBJECT_POINTER;
+    bool DataBlobMultiplexer::DataBlobMultiplexer_private::Has(
+      DataBlobSource::DataBlobSource_private *source) const
+    {
+      for (size_t i = 0; i < members.size(); i++) {
+        if (members[i].source == source) {
+          return true;
+        }
       }
+      return false;
+    }
 
-      // Lock the thread mutices for callback and streaming while we change
-      // the state.
-      {
-        std::lock_guard<std::mutex> lock(m_private->callbackMutex);
+    void DataBlobMultiplexer::DataBlobMultiplexer_private::Join(
+      DataBlobSource::DataBlobSource_private *source, uint32_t id)
+    {
+      Member member = { source, id };
+      members.push_back(member);
+      source->multiplexers.push_back(this);
+      source->multiplexerCount++;
+    }
 
-        // Set the streaming callback handler.
-        m_private->callbackHandler = callback;
-        m_private->callbackUserData = userdata;
+    bool DataBlobMultiplexer::DataBlobMultiplexer_private::Leave(
+      DataBlobSource::DataBlobSource_private *source, uint32_t &id)
+    {
+      for (size_t i = 0; i < members.size(); i++) {
+        if (members[i].source == source) {
+          id = members[i].id;
+          members.erase(members.begin() + i);
+          if (next >= members.size()) {
+            next = 0;
+          }
+          source->multiplexers.erase(std::find(source->multiplexers.begin(),
+            source->multiplexers.end(), this));
+          source->multiplexerCount--;
+          return true;
+        }
       }
+      return false;
+    }
 
-      // Flush all stored messages.
-      std::lock_guard<std::mutex> lock2(m_private->storedMessagesMutex);
-      m_private->storedMessages.clear();
-
-      return hrgls_STATUS_OKAY;
-  }
+    void DataBlobMultiplexer::DataBlobMultiplexer_private::Detach()
+    {
+      // The source mutex must be locked before ours, so we work from a copy of the list.
+      std::vector<Member> copy;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+        copy = members;
+      }
+      condition.notify_all();
+      for (size_t i = 0; i < copy.size(); i++) {
+        DataBlobSource::DataBlobSource_private *source = copy[i].source;
+        std::lock_guard<std::mutex> lock(source->multiplexersMutex);
+        auto it = std::find(source->multiplexers.begin(), source->multiplexers.end(), this);
+        if (it != source->multiplexers.end()) {
+          source->multiplexers.erase(it);
+          source->multiplexerCount--;
+        }
+      }
+    }
 
-  hrgls_Status API::SetLogMessageStreamingState(bool running)
-  {
-      if (!m_private) {
-          return hrgls_STATUS_NULL_OBJECT_POINTER;
+    DataBlobMultiplexer::~DataBlobMultiplexer()
+    {
+      if (m_private) {
+        m_private->Detach();
       }
-      m_private->messageStreaming = running;
-      return hrgls_STATUS_OKAY;
-  }
+      delete m_private;
+    }
 
-  std::vector<Message> API::GetPendingLogMessages(size_t maxNum)
-  {
-      std::vector<Message> ret;
+    hrgls_Status DataBlobMultiplexer::GetStatus()
+    {
       if (!m_private) {
-          return ret;
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
+    }
 
-      std::lock_guard<std::mutex> lock2(m_private->storedMessagesMutex);
-      while ((m_private->storedMessages.size() > 0) &&
-             ((maxNum == 0) || (ret.size() < maxNum)) ) {
-        ret.push_back(m_private->storedMessages.front());
-        m_private->storedMessages.pop_front();
+    hrgls_Status DataBlobMultiplexer::AddSource(DataBlobSource &source, uint32_t sourceId)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      if (ret.size() == 0) {
-        m_private->status[std::this_thread::get_id()] = hrgls_STATUS_TIMEOUT;
+      DataBlobSource::DataBlobSource_private *info = source.m_private;
+      if (info->api != m_private->api) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      {
+        std::lock_guard<std::mutex> lock(info->multiplexersMutex);
+        std::lock_guard<std::mutex> lock2(m_private->mutex);
+        if (m_private->Has(info)) {
+          return hrgls_STATUS_BAD_PARAMETER;
+        }
+        m_private->Join(info, sourceId);
       }
-      return ret;
-  }
 
-  hrgls_Status API::SetLogMessageMinimumLevel(hrgls_MessageLevel level)
-  {
+      // The source may already have blobs waiting.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      m_private->Notify();
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_Status DataBlobMultiplexer::RemoveSource(DataBlobSource &source)
+    {
+      if (!m_private || !source.m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      DataBlobSource::DataBlobSource_private *info = source.m_private;
+      std::lock_guard<std::mutex> lock(info->multiplexersMutex);
+      std::lock_guard<std::mutex> lock2(m_private->mutex);
+      uint32_t id;
+      return m_private->Leave(info, id) ? hrgls_STATUS_OKAY : hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    DataBlob DataBlobMultiplexer::GetNextBlob(uint32_t &sourceId, struct timeval timeout)
+    {
       if (!m_private) {
-          return hrgls_STATUS_NULL_OBJECT_POINTER;
+        return DataBlob();
+      }
+      DataBlobMultiplexer_private *mux = m_private;
+
+      // Announce that we may sleep before checking the sources, so that a producer
+      // that pushes after our check is sure to see us and notify.
+      std::unique_lock<std::mutex> lock(mux->mutex);
+      mux->waitingConsumers++;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mux->condition.wait_until(lock, DeadlineAfter(timeout), [mux]() {
+        if (mux->quitting) {
+          return true;
+        }
+        for (size_t i = 0; i < mux->members.size(); i++) {
+          if (!mux->members[i].source->storedBlobs->Empty()) {
+            return true;
+          }
+        }
+        return false;
+      });
+      mux->waitingConsumers--;
+
+      // Take a blob from the first ready source at or after the one following
+      // the source that we served last time.
+      size_t count = mux->members.size();
+      for (size_t i = 0; i < count; i++) {
+        size_t which = (mux->next + i) % count;
+        DataBlobSource::DataBlobSource_private *info = mux->members[which].source;
+        std::lock_guard<std::mutex> lock2(info->storedBlobsMutex);
+        if (info->storedBlobs->Front()) {
+          DataBlob ret(std::move(*info->storedBlobs->Front()));
+          info->storedBlobs->Pop();
+          info->statistics.CountDelivered(ret.Time());
+          Trace(hrgls_TRACE_BLOB_DEQUEUED, info, 1);
+          info->WakeProducerIfWaiting();
+          info->ClearNotificationIfEmpty();
+          mux->next = (which + 1) % count;
+          sourceId = mux->members[which].id;
+          mux->status.Get() = hrgls_STATUS_OKAY;
+          return ret;
+        }
       }
-      m_private->minLevel = level;
-      return m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
-  }
 
-  namespace datablob {
+      mux->status.Get() = hrgls_STATUS_TIMEOUT;
+      return DataBlob();
+    }
 
     //------------------------------------------------------------------------------
-    static std::atomic<size_t> numCreatedDataBlobSources(0);
-    class DataBlobSource::DataBlobSource_private {
+    class DataBlobMerger::DataBlobMerger_private {
     public:
-      API *api = nullptr;
-      std::string streamName;
-      StreamProperties properties;
-
       // Keep a per-thread status to make it so that a single thread only gets
       // results from methods that it calls.
-      std::map<std::thread::id, hrgls_Status> status;
-      std::string name;
-      bool running = false;
-
-      /// Thread that listens for incoming DataBlobs and either sends them to the callback
-      /// handler or stores them locally to be gotten one by one.
-      std::thread myThread;
-      volatile bool quitThread = false;   ///< Time to quit the thread.
-
-      /// Callback handler registered with us, along with its userdata and a mutex
-      /// that is used to ensure that we read and update both data values atomically.
-      std::mutex callbackMutex;
-      StreamCallback callbackHandler = nullptr;
-      void *callbackUserData = nullptr;
-
-      /// List of blobs that have come in with no callback handler to deal
-      /// with them.  They are retrieved by GetNextBlob()
-      std::mutex storedBlobsMutex;
-      std::list< DataBlob> storedBlobs;
-    };
-
-    static void DataBlobSourceThread(DataBlobSource::DataBlobSource_private *info)
-    {
-      if (!info) { return; }
-
-      // Keeps track of how long since we sent a blob
-      auto lastBlob = std::chrono::system_clock::now();
-
-      // Make the data we're going to send.
-      std::vector<char> blobToSend;
-      for (size_t i = 0; i < 256; i++) {
-        blobToSend.push_back(i % 256);
+      PerThread<hrgls_Status> status;
+
+      /// Waits on and keeps track of the sources for us, registering each under a key
+      /// of our own.  Its mutex protects everything below except lateCount.
+      DataBlobMultiplexer::DataBlobMultiplexer_private mux;
+      int64_t window = 0;       ///< Microseconds
+      hrgls_LateBlobPolicy latePolicy = hrgls_LATE_BLOB_DROP;
+
+      /// Blobs taken from each source and not yet returned, oldest first, by key.  The
+      /// slot of a source that was destroyed is kept until it has been emptied.
+      struct Slot {
+        uint32_t id;
+        std::deque<DataBlob> blobs;
+      };
+      std::map<uint32_t, Slot> slots;
+      uint32_t nextKey = 0;
+
+      /// Min-heap on time holding the oldest blob of each slot that has any.  Entries
+      /// for slots that were removed are discarded when they reach the top.
+      struct Head {
+        int64_t time;
+        uint32_t key;
+        bool operator<(const Head &other) const
+        {
+          return time > other.time || (time == other.time && key > other.key);
+        }
+      };
+      std::vector<Head> heads;
+
+      /// Late blobs waiting to be delivered out of order, with their IDs, and the time
+      /// of the last blob returned in order.
+      std::deque<std::pair<uint32_t, DataBlob> > late;
+      bool released = false;
+      int64_t lastReleased = 0;
+      std::atomic<uint64_t> lateCount{ 0 };
+
+      /// Scratch space for moving blobs out of a source's queue.
+      std::vector<DataBlob> taken;
+
+      /// Whether a blob at this time is older than one already returned.  Those that
+      /// are to be delivered are queued.
+      bool IsLate(int64_t time, uint32_t id, DataBlob &blob)
+      {
+        if (!released || time >= lastReleased) {
+          return false;
+        }
+        lateCount++;
+        if (latePolicy == hrgls_LATE_BLOB_DELIVER) {
+          late.emplace_back(id, std::move(blob));
+        }
+        return true;
       }
 
-      do {
-        // See if we are streaming.
-        if (info->running) {
-          // See if it is time to create a new blob.
-          auto now = std::chrono::system_clock::now();
-          std::chrono::duration<float> dt = now - lastBlob;
-          double interval = 1.0 / info->properties.Rate();
-          timeval myTime = info->api->GetCurrentSystemTime();
-          if (dt.count() > interval) {
-
-            // Create a blob
-            hrgls_DataBlob blob;
-            hrgls_DataBlobCreate(&blob);
-            hrgls_DataBlobSetTime(blob, myTime);
-
-            // Copy the DataBlob data, make a copy, and set the deleter function for it.
-            uint8_t *data = new uint8_t[blobToSend.size()];
-            memcpy(data, blobToSend.data(), blobToSend.size());
-            hrgls_DataBlobSetData(blob, data, static_cast<uint32_t>(blobToSend.size()),
-              myDelete, nullptr);
-
-            // Need to guard the access to the callback handler and userdata with a
-            // mutex so that we don't get half of the information due to a race with the
-            // main thread.
-            StreamCallback callbackHandler;
-            void *callbackUserData;
-            {
-              std::lock_guard<std::mutex> lock(info->callbackMutex);
-              callbackHandler = info->callbackHandler;
-              callbackUserData = info->callbackUserData;
+      /// Move every blob queued by the sources into their slots.
+      void Gather()
+      {
+        for (size_t i = 0; i < mux.members.size(); i++) {
+          DataBlobSource::DataBlobSource_private *info = mux.members[i].source;
+          {
+            std::lock_guard<std::mutex> lock(info->storedBlobsMutex);
+            size_t count = info->storedBlobs->Size();
+            if (count == 0) {
+              continue;
+            }
+            StatisticsCounters::DeliveredBatch delivered(info->statistics);
+            for (size_t j = 0; j < count; j++) {
+              taken.push_back(std::move(*info->storedBlobs->Front()));
+              info->storedBlobs->Pop();
+              delivered.Count(taken.back().Time());
+            }
+            Trace(hrgls_TRACE_BLOB_DEQUEUED, info, count);
+            info->WakeProducerIfWaiting();
+            info->ClearNotificationIfEmpty();
+          }
+          uint32_t key = mux.members[i].id;
+          Slot &slot = slots[key];
+          for (size_t j = 0; j < taken.size(); j++) {
+            int64_t time = MicrosecondsOf(taken[j].Time());
+            if (IsLate(time, slot.id, taken[j])) {
+              continue;
+            }
+            if (slot.blobs.empty()) {
+              heads.push_back(Head{ time, key });
+              std::push_heap(heads.begin(), heads.end());
             }
+            slot.blobs.push_back(std::move(taken[j]));
+          }
+          taken.clear();
+        }
 
-            // If we have a callback handler, call it.  If not, queue the DataBlob
-            // for later delivery.
-            DataBlob blobpp(blob);
-            hrgls_DataBlobDestroy(blob);
-            if (callbackHandler) {
-              callbackHandler(blobpp, callbackUserData);
+        // Forget the slots of destroyed sources once they are empty.
+        if (slots.size() > mux.members.size()) {
+          std::set<uint32_t> live;
+          for (size_t i = 0; i < mux.members.size(); i++) {
+            live.insert(mux.members[i].id);
+          }
+          for (auto it = slots.begin(); it != slots.end(); ) {
+            if (it->second.blobs.empty() && live.count(it->first) == 0) {
+              it = slots.erase(it);
             } else {
-              // Store a blob with a copy of the data onto the front of the queue for
-              // GetNextBlob.
-              std::lock_guard<std::mutex> lock(info->storedBlobsMutex);
-              info->storedBlobs.push_back(blobpp);
+              ++it;
             }
-          } // if time for a new blob
-
-        } // if running
+          }
+        }
+      }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      } while (!info->quitThread);
-    }
+      /// Take the next blob if one is ready.  Otherwise, due is set to the system time
+      /// in microseconds at which the oldest blob will be, or left alone if there is none.
+      bool TakeReady(DataBlob &blob, uint32_t &sourceId, int64_t now, int64_t &due)
+      {
+        if (!late.empty()) {
+          sourceId = late.front().first;
+          blob = std::move(late.front().second);
+          late.pop_front();
+          return true;
+        }
+        while (!heads.empty()) {
+          Head top = heads.front();
+          auto it = slots.find(top.key);
+          if (it == slots.end()) {
+            std::pop_heap(heads.begin(), heads.end());
+            heads.pop_back();
+            continue;
+          }
 
-    DataBlobSource::DataBlobSource(
-      API &api,
-      StreamProperties &props,
-      ::std::string DataBlobSource
-    )
-    {
-      //------------------------------------------------------------------------------
-      // Construct the data we'll need to enable a test program to try out all of our
-      // features.
-      m_private = new DataBlobSource_private;
-      m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+          // The oldest blob is next unless a source with nothing waiting might still
+          // send an older one and the window has not yet passed.
+          if (top.time + window > now) {
+            for (size_t i = 0; i < mux.members.size(); i++) {
+              if (slots[mux.members[i].id].blobs.empty()) {
+                due = top.time + window;
+                return false;
+              }
+            }
+          }
+          std::pop_heap(heads.begin(), heads.end());
+          heads.pop_back();
+          Slot &slot = it->second;
+          DataBlob next(std::move(slot.blobs.front()));
+          slot.blobs.pop_front();
+          if (!slot.blobs.empty()) {
+            heads.push_back(Head{ MicrosecondsOf(slot.blobs.front().Time()), top.key });
+            std::push_heap(heads.begin(), heads.end());
+          }
 
-      m_private->streamName = "/hrgls/null/DataBlobSource/" +
-        std::to_string(numCreatedDataBlobSources++);
-      // If they ask for an empty-named DataBlobSource, return the first one.  Otherwise,
-      // make sure we have the one they asked for and return it.
-      std::vector<DataBlobSourceDescription> rends = api.GetAvailableDataBlobSources();
-      size_t which = 0;
-      if (DataBlobSource.size() > 0) {
-        bool found = false;
-        for (size_t i = 0; i < rends.size(); i++) {
-          if (rends[i].Name() == DataBlobSource) {
-            found = true;
-            which = i;
-            break;
+          // A source whose own blobs were out of order can still produce a late one.
+          if (IsLate(top.time, slot.id, next)) {
+            if (!late.empty()) {
+              return TakeReady(blob, sourceId, now, due);
+            }
+            continue;
           }
+          released = true;
+          lastReleased = top.time;
+          sourceId = slot.id;
+          blob = std::move(next);
+          return true;
         }
-        if (!found) {
-          m_private->status[std::this_thread::get_id()] = hrgls_STATUS_BAD_PARAMETER;
-          return;
-        }
+        return false;
       }
+    };
 
-      /// Squirrel away all of the information we need in our private store so
-      /// that we can implement our methods.
-      m_private->name = rends[which].Name();
-      m_private->api = &api;
-      m_private->properties = props;
-
-      /// Start our thread that polls the remote interface and receives blobs,
-      /// passing it a pointer to our private stream information.
-      m_private->myThread = std::thread(DataBlobSourceThread, m_private);
+    DataBlobMerger::DataBlobMerger(API &api, struct timeval reorderWindow,
+      hrgls_LateBlobPolicy latePolicy)
+    {
+      m_private = new DataBlobMerger_private;
+      m_private->mux.api = &api;
+      m_private->window = MicrosecondsOf(reorderWindow);
+      m_private->latePolicy = latePolicy;
+      if (m_private->window < 0 || reorderWindow.tv_usec < 0 ||
+          (latePolicy != hrgls_LATE_BLOB_DROP && latePolicy != hrgls_LATE_BLOB_DELIVER)) {
+        m_private->status.Get() = hrgls_STATUS_BAD_PARAMETER;
+        return;
+      }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
     }
 
-    DataBlobSource::~DataBlobSource()
+    DataBlobMerger::~DataBlobMerger()
     {
-      // Stop my thread.
       if (m_private) {
-        m_private->quitThread = true;
-        m_private->myThread.join();
+        m_private->mux.Detach();
       }
       delete m_private;
     }
 
-    hrgls_Status DataBlobSource::GetStatus()
+    hrgls_Status DataBlobMerger::GetStatus()
     {
       if (!m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
-      } else {
-        hrgls_Status ret = m_private->status[std::this_thread::get_id()];
-        m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
-        return ret;
       }
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
+      return ret;
     }
 
-    hrgls_Status DataBlobSource::SetStreamingState(bool running)
+    hrgls_Status DataBlobMerger::AddSource(DataBlobSource &source, uint32_t sourceId)
     {
-      if (!m_private) {
+      if (!m_private || !source.m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      m_private->running = running;
+      DataBlobSource::DataBlobSource_private *info = source.m_private;
+      DataBlobMultiplexer::DataBlobMultiplexer_private &mux = m_private->mux;
+      if (info->api != mux.api) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      {
+        std::lock_guard<std::mutex> lock(info->multiplexersMutex);
+        std::lock_guard<std::mutex> lock2(mux.mutex);
+        if (mux.Has(info)) {
+          return hrgls_STATUS_BAD_PARAMETER;
+        }
+        uint32_t key = m_private->nextKey++;
+        m_private->slots[key].id = sourceId;
+        mux.Join(info, key);
+      }
+
+      // The source may already have blobs waiting.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      mux.Notify();
       return hrgls_STATUS_OKAY;
     }
 
-    hrgls_Status DataBlobSource::SetStreamCallback(StreamCallback callback, void *userdata)
+    hrgls_Status DataBlobMerger::RemoveSource(DataBlobSource &source)
     {
-      if (!m_private) {
+      if (!m_private || !source.m_private) {
         return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-
-      // Lock the thread mutices for callback and streaming while we change
-      // the state.
-      std::lock_guard<std::mutex> lock(m_private->callbackMutex);
-      std::lock_guard<std::mutex> lock2(m_private->storedBlobsMutex);
-
-      // Set the streaming callback handler.
-      m_private->callbackHandler = callback;
-      m_private->callbackUserData = userdata;
-
-      // Flush all stored blobs.
-      m_private->storedBlobs.clear();
-
+      DataBlobSource::DataBlobSource_private *info = source.m_private;
+      std::lock_guard<std::mutex> lock(info->multiplexersMutex);
+      std::lock_guard<std::mutex> lock2(m_private->mux.mutex);
+      uint32_t key;
+      if (!m_private->mux.Leave(info, key)) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      m_private->slots.erase(key);
       return hrgls_STATUS_OKAY;
     }
 
-    DataBlob DataBlobSource::GetNextBlob(struct timeval timeout)
+    DataBlob DataBlobMerger::GetNextBlob(uint32_t &sourceId, struct timeval timeout)
     {
+      if (!m_private) {
+        return DataBlob();
+      }
+      DataBlobMerger_private *merger = m_private;
+      DataBlobMultiplexer::DataBlobMultiplexer_private *mux = &merger->mux;
+      std::chrono::steady_clock::time_point deadline = DeadlineAfter(timeout);
+
+      // Gather what the sources have queued and see whether the oldest blob can go.
+      // If not, sleep until a source queues more, the oldest blob's window passes,
+      // or the timeout expires.
+      std::unique_lock<std::mutex> lock(mux->mutex);
       DataBlob ret;
+      for (;;) {
+        merger->Gather();
+        int64_t now = MicrosecondsOf(WallClockTimeval());
+        int64_t due = INT64_MAX;
+        if (merger->TakeReady(ret, sourceId, now, due)) {
+          merger->status.Get() = hrgls_STATUS_OKAY;
+          return ret;
+        }
+        std::chrono::steady_clock::time_point wake = std::chrono::steady_clock::now();
+        if (mux->quitting || wake >= deadline) {
+          break;
+        }
+        if (due != INT64_MAX && wake + std::chrono::microseconds(due - now) < deadline) {
+          wake += std::chrono::microseconds(due - now);
+        } else {
+          wake = deadline;
+        }
+        mux->waitingConsumers++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        mux->condition.wait_until(lock, wake, [mux]() {
+          if (mux->quitting) {
+            return true;
+          }
+          for (size_t i = 0; i < mux->members.size(); i++) {
+            if (!mux->members[i].source->storedBlobs->Empty()) {
+              return true;
+            }
+          }
+          return false;
+        });
+        mux->waitingConsumers--;
+      }
+
+      merger->status.Get() = hrgls_STATUS_TIMEOUT;
+      return DataBlob();
+    }
+
+    uint64_t DataBlobMerger::GetLateBlobCount()
+    {
       if (!m_private) {
-        return ret;
+        return 0;
       }
+      m_private->status.Get() = hrgls_STATUS_OKAY;
+      return m_private->lateCount.load();
+    }
 
-      // Keep checking for a new blob until we either find one or time out.
-      bool empty;
-      double timeoutSeconds = timeout.tv_sec + timeout.tv_usec / 1e6;
-      std::chrono::duration<float> dt;
-      auto start = std::chrono::system_clock::now();
-      do {
-        std::lock_guard<std::mutex> lock(m_private->storedBlobsMutex);
-        empty = m_private->storedBlobs.empty();
-        auto now = std::chrono::system_clock::now();
-        dt = now - start;
-      } while (empty && (dt.count() < timeoutSeconds));
+    //------------------------------------------------------------------------------
+    class DataBlobRecorder::DataBlobRecorder_private {
+    public:
+      // Keep a per-thread status to make it so that a single thread only gets
+      // results from methods that it calls.
+      PerThread<hrgls_Status> status;
 
-      if (!empty) {
-        std::lock_guard<std::mutex> lock(m_private->storedBlobsMutex);
-        ret = m_private->storedBlobs.front();
-        m_private->storedBlobs.pop_front();
-        m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
-      } else {
-        m_private->status[std::this_thread::get_id()] = hrgls_STATUS_TIMEOUT;
+      /// The recording and its index, with the offset in the recording that the next
+      /// record goes at.  The mutex serializes the threads that are recording.
+      std::mutex mutex;
+      FILE *data = nullptr;
+      FILE *index = nullptr;
+      uint64_t offset = 0;
+
+      /// Write a file header with the magic string.
+      static bool WriteHeader(FILE *f, const char *magic)
+      {
+        std::vector<uint8_t> header(magic, magic + 8);
+        PutLittle32(header, RecordingVersion);
+        PutLittle32(header, 0);
+        return fwrite(header.data(), 1, header.size(), f) == header.size();
       }
+    };
 
-      return ret;
+    DataBlobRecorder::DataBlobRecorder(const ::std::string &fileName)
+    {
+      m_private = new DataBlobRecorder_private;
+      m_private->data = fopen(fileName.c_str(), "wb");
+      m_private->index = fopen(RecordingIndexName(fileName).c_str(), "wb");
+      if (!m_private->data || !m_private->index ||
+          !DataBlobRecorder_private::WriteHeader(m_private->data, RecordingMagic) ||
+          !DataBlobRecorder_private::WriteHeader(m_private->index, RecordingIndexMagic)) {
+        m_private->status.Get() = hrgls_STATUS_FILE_ERROR;
+        return;
+      }
+      m_private->offset = RecordingHeaderSize;
+      m_private->status.Get() = hrgls_STATUS_OKAY;
     }
 
-    DataBlobSourceDescription DataBlobSource::GetInfo()
+    DataBlobRecorder::~DataBlobRecorder()
+    {
+      if (m_private) {
+        if (m_private->data) {
+          fclose(m_private->data);
+        }
+        if (m_private->index) {
+          fclose(m_private->index);
+        }
+      }
+      delete m_private;
+    }
+
+    hrgls_Status DataBlobRecorder::GetStatus()
     {
-      DataBlobSourceDescription ret;
       if (!m_private) {
-        m_private->status[std::this_thread::get_id()] = hrgls_STATUS_NULL_OBJECT_POINTER;
-        return ret;
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
       }
-      ret.Name(m_private->streamName);
-      m_private->status[std::this_thread::get_id()] = hrgls_STATUS_OKAY;
+      hrgls_Status &status = m_private->status.Get();
+      hrgls_Status ret = status;
+      status = hrgls_STATUS_OKAY;
       return ret;
     }
 
+    hrgls_Status DataBlobRecorder::Record(const DataBlob &blob)
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      // Records have 32-bit sizes.  Data in pieces is written a segment at a time.
+      uint64_t totalSize = blob.TotalSize();
+      if (totalSize > 0xffffffffu) {
+        return hrgls_STATUS_BAD_PARAMETER;
+      }
+      uint32_t size = static_cast<uint32_t>(totalSize);
+      uint32_t segments = size > 0 ? blob.SegmentCount() : 0;
+      for (uint32_t i = 0; i < segments; i++) {
+        if (blob.SegmentSize(i) > 0 && !blob.SegmentData(i)) {
+          return hrgls_STATUS_BAD_PARAMETER;
+        }
+      }
+      struct timeval time = blob.Time();
+      std::vector<uint8_t> header;
+      PutLittle64(header, static_cast<uint64_t>(time.tv_sec));
+      PutLittle32(header, static_cast<uint32_t>(time.tv_usec));
+      PutLittle32(header, size);
+      static const uint8_t padding[RecordAlignment] = {};
+      size_t pad = (RecordAlignment - size % RecordAlignment) % RecordAlignment;
+
+      std::lock_guard<std::mutex> lock(m_private->mutex);
+      if (!m_private->data || !m_private->index) {
+        return hrgls_STATUS_FILE_ERROR;
+      }
+      std::vector<uint8_t> entry;
+      PutLittle64(entry, static_cast<uint64_t>(MicrosecondsOf(time)));
+      PutLittle64(entry, m_private->offset);
+      if (fwrite(header.data(), 1, header.size(), m_private->data) != header.size()) {
+        return hrgls_STATUS_FILE_ERROR;
+      }
+      for (uint32_t i = 0; i < segments; i++) {
+        size_t segmentSize = static_cast<size_t>(blob.SegmentSize(i));
+        if (fwrite(blob.SegmentData(i), 1, segmentSize, m_private->data) != segmentSize) {
+          return hrgls_STATUS_FILE_ERROR;
+        }
+      }
+      if (fwrite(padding, 1, pad, m_private->data) != pad ||
+          fwrite(entry.data(), 1, entry.size(), m_private->index) != entry.size()) {
+        return hrgls_STATUS_FILE_ERROR;
+      }
+      m_private->offset += RecordHeaderSize + size + pad;
+      return hrgls_STATUS_OKAY;
+    }
+
+    hrgls_Status DataBlobRecorder::Flush()
+    {
+      if (!m_private) {
+        return hrgls_STATUS_NULL_OBJECT_POINTER;
+      }
+      std::lock_guard<std::mutex> lock(m_private->mutex);
+      if (!m_private->data || !m_private->index ||
+          fflush(m_private->data) != 0 || fflush(m_private->index) != 0) {
+        return hrgls_STATUS_FILE_ERROR;
+      }
+      return hrgls_STATUS_OKAY;
+    }
+
   } // End namespace render
 
 } // End namespace hrgls
@@ -11,6 +11,11 @@
 %include "std_pair.i"
 %include "typemaps.i"
 
+/* NumPy must be initialized before any arrays are created. */
+%init %{
+  import_array();
+%}
+
 %{
 /* Includes the headers inside the brackets to put it in the wrapper code */
 
@@ -21,6 +26,66 @@
 #include "hrgls_api_defs.hpp"
 #include "hrgls_api.hpp"
 #include <map>
+#include <algorithm>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/* NumPy is used to hand DataBlob data to Python without copying it. */
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+/* Name of the capsules that keep a DataBlob alive on behalf of a NumPy array. */
+static const char *hrgls_Python_DataBlob_Capsule_Name = "hrgls.DataBlob";
+
+/* Destructor for the capsule, called once the array that it is the base of has been
+ * collected.  Destroying the DataBlob copy releases its reference on the data. */
+static void hrgls_Python_DataBlob_Capsule_Destroy(PyObject *capsule)
+{
+  delete static_cast<hrgls::datablob::DataBlob *>(
+    PyCapsule_GetPointer(capsule, hrgls_Python_DataBlob_Capsule_Name));
+}
+
+/* Make a read-only NumPy array that points at data belonging to a blob, with a copy
+ * of the blob as its base so that the data stays alive as long as the array. */
+static PyObject *hrgls_Python_DataBlob_Array(const hrgls::datablob::DataBlob &blob,
+  const uint8_t *data, npy_intp size)
+{
+  if (data == nullptr) {
+    size = 0;
+  }
+  if (size == 0) {
+    return PyArray_SimpleNew(1, &size, NPY_UINT8);
+  }
+
+  /* The copy shares the data with the blob, so nothing is copied here. */
+  hrgls::datablob::DataBlob *owner = new hrgls::datablob::DataBlob(blob);
+  PyObject *capsule = PyCapsule_New(owner, hrgls_Python_DataBlob_Capsule_Name,
+    hrgls_Python_DataBlob_Capsule_Destroy);
+  if (capsule == nullptr) {
+    delete owner;
+    return nullptr;
+  }
+
+  /* The data is handed out read-only because other copies of the blob share it. */
+  PyObject *array = PyArray_New(&PyArray_Type, 1, &size, NPY_UINT8, nullptr,
+    const_cast<uint8_t *>(data), 0, NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED,
+    nullptr);
+  if (array == nullptr) {
+    Py_DECREF(capsule);
+    return nullptr;
+  }
+
+  /* The array steals the reference to the capsule, even when this fails. */
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject *>(array), capsule) < 0) {
+    Py_DECREF(array);
+    return nullptr;
+  }
+  return array;
+}
 
 /* Map from DataBlobSource objects to Python callback/userdata pairs.
  * that is used to keep track of the objects that have been registered
@@ -114,6 +179,273 @@ static void hrgls_Python_Log_Callback(hrgls::Message &message, void *userData)
   SWIG_PYTHON_THREAD_END_BLOCK;
 }
 
+/* Most items that a batcher will queue, as a multiple of its maximum batch size,
+ * before it starts dropping the items that it is handed. */
+static const size_t hrgls_Python_Batch_Queue_Factor = 4;
+
+/* Collects DataBlobs or Messages from the library's callback threads without
+ * holding the global interpreter lock and hands them to a Python function in
+ * batches from a thread of its own, taking the lock once per batch rather than
+ * once per item.  After the first item of a batch arrives, the thread waits up to
+ * the coalescing window for more, delivering early if the batch fills.  Add() never
+ * waits: without callback threads the library calls it on the API's shared workers,
+ * which also produce every other source's blobs and the log messages, so when Python
+ * falls behind and the queue is full, further items are dropped and counted. */
+template <class T>
+class hrgls_Python_Batcher : public std::enable_shared_from_this<hrgls_Python_Batcher<T> > {
+public:
+  hrgls_Python_Batcher(swig_type_info *type) : m_type(type) {}
+
+  /* Must be called with the global interpreter lock held, on a batcher owned by a
+   * shared_ptr.  Takes references to the handler and userData until Stop() is called.
+   * The thread holds a reference to the batcher, so that it is not deleted under a
+   * thread that Stop() had to leave running. */
+  void Start(PyObject *handler, PyObject *userData, double window, size_t maxBatch)
+  {
+    Py_INCREF(handler);
+    Py_INCREF(userData);
+    m_handler = handler;
+    m_userData = userData;
+    m_window = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(window));
+    m_maxBatch = maxBatch;
+    m_quit = false;
+    std::shared_ptr<hrgls_Python_Batcher> self = this->shared_from_this();
+    m_thread = std::thread([self]() { self->Run(); });
+  }
+
+  /* Must be called with the global interpreter lock held; it is released while
+   * waiting for the thread, which may need it to finish a delivery.  Items that
+   * have not been delivered are discarded, and later calls to Add() are ignored.
+   * A handler that clears or replaces its own batch callback calls this from the
+   * thread itself, which cannot be joined; it is detached instead, and drops its
+   * references to the handler and userData once the handler returns. */
+  void Stop()
+  {
+    if (!m_thread.joinable()) {
+      return;
+    }
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+        m_items.clear();
+      }
+      m_releaseOnExit = true;
+      m_thread.detach();
+      return;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_quit = true;
+    }
+    m_ready.notify_all();
+    m_thread.join();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_items.clear();
+    }
+    Py_END_ALLOW_THREADS
+    Py_DECREF(m_handler);
+    Py_DECREF(m_userData);
+    m_handler = nullptr;
+    m_userData = nullptr;
+  }
+
+  /* Called by the library's callback threads, without the global interpreter lock. */
+  void Add(const T &item)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_quit) {
+      return;
+    }
+    if (m_items.size() >= m_maxBatch * hrgls_Python_Batch_Queue_Factor) {
+      m_dropped++;
+      return;
+    }
+    m_items.push_back(item);
+    if (m_items.size() == 1 || m_items.size() == m_maxBatch) {
+      m_ready.notify_one();
+    }
+  }
+
+  /* Number of items dropped because the queue was full. */
+  uint64_t DroppedCount()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+  }
+
+private:
+  void Run()
+  {
+    std::vector<T> batch;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_ready.wait(lock, [this]() { return m_quit || !m_items.empty(); });
+        if (!m_quit && m_items.size() < m_maxBatch) {
+          m_ready.wait_for(lock, m_window, [this]() {
+            return m_quit || m_items.size() >= m_maxBatch;
+          });
+        }
+        if (m_quit) {
+          break;
+        }
+        size_t count = std::min(m_items.size(), m_maxBatch);
+        for (size_t i = 0; i < count; i++) {
+          batch.push_back(std::move(m_items.front()));
+          m_items.pop_front();
+        }
+      }
+      Deliver(batch);
+      batch.clear();
+    }
+
+    // Only set by Stop() on this thread, from within Deliver().
+    if (m_releaseOnExit) {
+      SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+      Py_DECREF(m_handler);
+      Py_DECREF(m_userData);
+      m_handler = nullptr;
+      m_userData = nullptr;
+      SWIG_PYTHON_THREAD_END_BLOCK;
+    }
+  }
+
+  /* Hands the batch to Python as a list, taking the global interpreter lock once.
+   * Each list entry owns a copy of its item, which shares the item's data. */
+  void Deliver(std::vector<T> &batch)
+  {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+    PyObject *list = PyList_New(static_cast<Py_ssize_t>(batch.size()));
+    if (list != nullptr) {
+      for (size_t i = 0; i < batch.size(); i++) {
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i),
+          SWIG_NewPointerObj(SWIG_as_voidptr(new T(std::move(batch[i]))), m_type, SWIG_POINTER_OWN));
+      }
+      PyObject *result = PyObject_CallFunctionObjArgs(m_handler, list, m_userData, nullptr);
+      if (result == nullptr) {
+        PyErr_Print();
+      }
+      Py_XDECREF(result);
+      Py_DECREF(list);
+    } else {
+      PyErr_Print();
+    }
+    SWIG_PYTHON_THREAD_END_BLOCK;
+  }
+
+  swig_type_info *m_type;
+  PyObject *m_handler = nullptr;
+  PyObject *m_userData = nullptr;
+  std::chrono::steady_clock::duration m_window;
+  size_t m_maxBatch = 1;
+
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_ready;
+  std::deque<T> m_items;
+  uint64_t m_dropped = 0;
+  bool m_quit = true;
+  bool m_releaseOnExit = false;
+};
+
+/* Batchers that have been handed to the library, by the id that was passed to it as
+ * callback user data.  A library thread may call a handler just after it has been
+ * removed, so the user data is not the batcher's address: a batcher that has been
+ * unregistered is not found, and one that a thread is inside Add() on is kept alive
+ * until that call returns. */
+template <class T>
+class hrgls_Python_Batcher_Registry {
+public:
+  static void *Register(const std::shared_ptr<hrgls_Python_Batcher<T> > &batcher)
+  {
+    std::lock_guard<std::mutex> lock(Mutex());
+    uintptr_t id = ++NextId();
+    Batchers()[id] = batcher;
+    return reinterpret_cast<void *>(id);
+  }
+
+  static std::shared_ptr<hrgls_Python_Batcher<T> > Find(void *userData)
+  {
+    std::lock_guard<std::mutex> lock(Mutex());
+    auto it = Batchers().find(reinterpret_cast<uintptr_t>(userData));
+    if (it == Batchers().end()) {
+      return std::shared_ptr<hrgls_Python_Batcher<T> >();
+    }
+    return it->second;
+  }
+
+  static std::shared_ptr<hrgls_Python_Batcher<T> > Unregister(void *userData)
+  {
+    std::lock_guard<std::mutex> lock(Mutex());
+    std::shared_ptr<hrgls_Python_Batcher<T> > ret;
+    auto it = Batchers().find(reinterpret_cast<uintptr_t>(userData));
+    if (it != Batchers().end()) {
+      ret = std::move(it->second);
+      Batchers().erase(it);
+    }
+    return ret;
+  }
+
+  /* Library callback handler for the batcher registered under userData. */
+  static void Callback(T &item, void *userData)
+  {
+    std::shared_ptr<hrgls_Python_Batcher<T> > batcher = Find(userData);
+    if (batcher) {
+      batcher->Add(item);
+    }
+  }
+
+private:
+  static std::mutex &Mutex() { static std::mutex m; return m; }
+  static uintptr_t &NextId() { static uintptr_t id = 0; return id; }
+  static std::map<uintptr_t, std::shared_ptr<hrgls_Python_Batcher<T> > > &Batchers()
+  {
+    static std::map<uintptr_t, std::shared_ptr<hrgls_Python_Batcher<T> > > m;
+    return m;
+  }
+};
+
+/* Ids of the batchers that have been registered for each DataBlobSource and API.
+ * These are only used with the global interpreter lock held. */
+static ::std::map<hrgls::datablob::DataBlobSource*, void*> hrgls_Python_Blob_Batcher_Map;
+static ::std::map<hrgls::API*, void*> hrgls_Python_Log_Batcher_Map;
+
+/* Forgets the batcher registered for a DataBlobSource or API, if there is one, and
+ * stops its thread; library callbacks that arrive afterwards find nothing.  Takes the
+ * global interpreter lock, so it can be called whether or not it is held. */
+template <class T, class Owner>
+static void hrgls_Python_Release_Batcher(std::map<Owner*, void*> &batchers, Owner *owner)
+{
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+  auto it = batchers.find(owner);
+  if (it != batchers.end()) {
+    std::shared_ptr<hrgls_Python_Batcher<T> > batcher =
+      hrgls_Python_Batcher_Registry<T>::Unregister(it->second);
+    batchers.erase(it);
+    if (batcher) {
+      batcher->Stop();
+    }
+  }
+  SWIG_PYTHON_THREAD_END_BLOCK;
+}
+
+/* Number of items dropped by the batcher registered for a DataBlobSource or API. */
+template <class T, class Owner>
+static uint64_t hrgls_Python_Batcher_Dropped(std::map<Owner*, void*> &batchers, Owner *owner)
+{
+  auto it = batchers.find(owner);
+  if (it == batchers.end()) {
+    return 0;
+  }
+  std::shared_ptr<hrgls_Python_Batcher<T> > batcher =
+    hrgls_Python_Batcher_Registry<T>::Find(it->second);
+  return batcher ? batcher->DroppedCount() : 0;
+}
+
 %}
 
 /* Parse the header files again outside of the brackets to generate wrappers */
@@ -123,6 +455,48 @@ static void hrgls_Python_Log_Callback(hrgls::Message &message, void *userData)
 /** @todo Check if this works on Windows */
 #define HRGLS_EXPORT
 #define hrgls_SWIG_PARSING_NOW
+
+/* Ownership hand-off between the C and C++ layers is internal and would let
+ * Python code leak or double-destroy handles, so do not wrap it. */
+%ignore hrgls::Message::Adopt;
+%ignore hrgls::Message::Detach;
+%ignore hrgls::datablob::DataBlob::Adopt;
+%ignore hrgls::datablob::DataBlob::Detach;
+
+/* Borrowed log messages are only valid during a C callback, which Python code
+ * cannot be lent; it uses SetLogMessageBatchCallback() below instead. */
+%ignore hrgls::MessageView;
+%ignore hrgls::API::SetLogMessageViewCallback;
+%ignore hrgls_APISetLogMessageViewCallback;
+
+/* Changes to the list of DataBlobSources are reported from whatever thread made them;
+ * Python code asks DataBlobSourcesChangedSince() instead. */
+%ignore hrgls::API::SetDataBlobSourcesChangedCallback;
+%ignore hrgls_APISetDataBlobSourcesChangedCallback;
+
+/* DataBlobRequest is move-only, which SWIG cannot return by value.  Python code
+ * awaits blobs with GetNextBlobAsyncio() below instead. */
+%ignore hrgls::datablob::DataBlobRequest;
+%ignore hrgls::datablob::DataBlobSource::GetNextBlobAsync;
+
+/* Provided buffers are raw memory handed back through a C function, which Python
+ * code cannot supply. */
+%ignore hrgls::datablob::DataBlobSource::ProvideBuffers;
+%ignore hrgls_DataBlobSourceProvideBuffers;
+
+/* DataBlobMultiplexer::GetNextBlob() reports which source a blob came from through
+ * a reference, which Python gets back as a (blob, sourceId) pair. */
+%apply uint32_t &OUTPUT { uint32_t &sourceId };
+
+/* Python handlers are installed by the SetStreamCallback() and SetLogMessageCallback()
+ * extensions below, which also unhook any batch handler; C function pointers are of
+ * no use from Python. */
+%ignore hrgls::datablob::DataBlobSource::SetStreamCallback(StreamCallback, void *);
+%ignore hrgls::API::SetLogMessageCallback(LogMessageCallback, void *);
+
+/* Python code gets the sources in a DataBlobSourceGroup with Source(i). */
+%rename(Source) hrgls::datablob::DataBlobSourceGroup::operator[];
+
 %include "hrgls_api.h"
 %include "hrgls_api_defs.hpp"
 
@@ -147,6 +521,7 @@ static void hrgls_Python_Log_Callback(hrgls::Message &message, void *userData)
 %template(StringVector) std::vector<std::string>;
 %template(DataBlobSourceVector) std::vector<hrgls::DataBlobSourceDescription>;
 %template(MessageVector) std::vector<hrgls::Message>;
+%template(DataBlobVector) std::vector<hrgls::datablob::DataBlob>;
 
 /* Define structures that we need to access members of. */
 struct timeval {
@@ -156,9 +531,8 @@ struct timeval {
 
 /*****************************************************************/
 /* Wrap the DataBlob callback handler so that we can call it from Python.
- * When the SetStreamCallback method is called with (None, None), Swig
- * directly calls the C++ method with (nullptr, nullptr) and bypasses
- * this wrapped method. */
+ * The C++ method that takes a function pointer is not wrapped, so calling
+ * SetStreamCallback(None, None) also comes here and removes the handler. */
 
 %extend hrgls::datablob::DataBlobSource {
   hrgls_Status SetStreamCallback(PyObject *callbackHandler, PyObject *userData)
@@ -203,6 +577,19 @@ struct timeval {
     }
 */
 
+    /* This replaces any handler set with SetStreamBatchCallback(), whose batcher is
+     * no longer needed. */
+    if (hrgls_Python_Blob_Batcher_Map.count($self)) {
+      hrgls_Status ret = $self->SetStreamCallback(nullptr, nullptr);
+      if (ret != hrgls_STATUS_OKAY) {
+        return ret;
+      }
+      hrgls_Python_Release_Batcher<hrgls::datablob::DataBlob>(hrgls_Python_Blob_Batcher_Map, $self);
+    }
+    if ((callbackHandler == nullptr) || (callbackHandler == Py_None)) {
+      return $self->SetStreamCallback(nullptr, nullptr);
+    }
+
     /* Construct a new vector of objects, one for the handler and one for
      * the user data.  Add it to the map.  Pass a pointer to the vector
      * in the map as userdata to the C++ handler defined above. */
@@ -219,11 +606,93 @@ struct timeval {
 
 %nothread hrgls::datablob::DataBlobSource::SetStreamCallback;
 
+/*****************************************************************/
+/* Batch delivery of DataBlobs.  SetStreamBatchCallback(handler, userData, window,
+ * maxBatch) calls handler(blobs, userData) with a list of up to maxBatch blobs,
+ * waiting up to window seconds after the first blob of a batch arrives for more to
+ * join it.  The global interpreter lock is taken once per batch rather than once
+ * per blob.  The blobs in the list remain valid after the handler returns.  When
+ * Python falls behind, blobs beyond four batches' worth are dropped rather than
+ * holding up the library thread that produced them.  Passing None as the handler
+ * removes it.  This replaces any handler set with SetStreamCallback(), and the other
+ * way around. */
+
+%extend hrgls::datablob::DataBlobSource {
+  hrgls_Status SetStreamBatchCallback(PyObject *callbackHandler, PyObject *userData,
+    double window = 0.001, uint32_t maxBatch = 256)
+  {
+    bool clearing = (callbackHandler == nullptr) || (callbackHandler == Py_None);
+    if (!clearing && ((window < 0) || (maxBatch == 0) || !PyCallable_Check(callbackHandler))) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    /* Unhook the library from any earlier batcher before stopping it. */
+    if (hrgls_Python_Blob_Batcher_Map.count($self)) {
+      hrgls_Status ret = $self->SetStreamCallback(nullptr, nullptr);
+      if (ret != hrgls_STATUS_OKAY) {
+        return ret;
+      }
+      hrgls_Python_Release_Batcher<hrgls::datablob::DataBlob>(hrgls_Python_Blob_Batcher_Map, $self);
+    }
+    if (clearing) {
+      return $self->SetStreamCallback(nullptr, nullptr);
+    }
+
+    std::shared_ptr<hrgls_Python_Batcher<hrgls::datablob::DataBlob> > batcher(
+      new hrgls_Python_Batcher<hrgls::datablob::DataBlob>(SWIGTYPE_p_hrgls__datablob__DataBlob));
+    batcher->Start(callbackHandler, userData, window, maxBatch);
+    void *id = hrgls_Python_Batcher_Registry<hrgls::datablob::DataBlob>::Register(batcher);
+    hrgls_Status ret = $self->SetStreamCallback(
+      hrgls_Python_Batcher_Registry<hrgls::datablob::DataBlob>::Callback, id);
+    if (ret != hrgls_STATUS_OKAY) {
+      hrgls_Python_Batcher_Registry<hrgls::datablob::DataBlob>::Unregister(id);
+      batcher->Stop();
+      return ret;
+    }
+    hrgls_Python_Blob_Batcher_Map[$self] = id;
+    return ret;
+  }
+};
+
+%nothread hrgls::datablob::DataBlobSource::SetStreamBatchCallback;
+
+/* GetStreamBatchDroppedCount() reports how many blobs the current batch handler has
+ * dropped because Python fell behind and its queue was full.  Deleting a
+ * DataBlobSource, or the DataBlobSourceGroup that holds it, also removes its batch
+ * handler. */
+
+%extend hrgls::datablob::DataBlobSource {
+  uint64_t GetStreamBatchDroppedCount()
+  {
+    return hrgls_Python_Batcher_Dropped<hrgls::datablob::DataBlob>(
+      hrgls_Python_Blob_Batcher_Map, $self);
+  }
+
+  ~DataBlobSource()
+  {
+    hrgls_Python_Release_Batcher<hrgls::datablob::DataBlob>(
+      hrgls_Python_Blob_Batcher_Map, $self);
+    delete $self;
+  }
+};
+
+%nothread hrgls::datablob::DataBlobSource::GetStreamBatchDroppedCount;
+
+%extend hrgls::datablob::DataBlobSourceGroup {
+  ~DataBlobSourceGroup()
+  {
+    for (size_t i = 0; i < $self->Size(); i++) {
+      hrgls_Python_Release_Batcher<hrgls::datablob::DataBlob>(
+        hrgls_Python_Blob_Batcher_Map, &(*$self)[i]);
+    }
+    delete $self;
+  }
+};
+
 /*****************************************************************/
 /* Wrap the log callback handler so that we can call it from Python.
- * When the SetLogMessageCallback method is called with (None, None), Swig
- * directly calls the C++ method with (nullptr, nullptr) and bypasses
- * this wrapped method. */
+ * The C++ method that takes a function pointer is not wrapped, so calling
+ * SetLogMessageCallback(None, None) also comes here and removes the handler. */
 
 %extend hrgls::API {
   hrgls_Status SetLogMessageCallback(PyObject *callbackHandler, PyObject *userData)
@@ -268,6 +737,19 @@ struct timeval {
     }
 */
 
+    /* This replaces any handler set with SetLogMessageBatchCallback(), whose batcher
+     * is no longer needed. */
+    if (hrgls_Python_Log_Batcher_Map.count($self)) {
+      hrgls_Status ret = $self->SetLogMessageCallback(nullptr, nullptr);
+      if (ret != hrgls_STATUS_OKAY) {
+        return ret;
+      }
+      hrgls_Python_Release_Batcher<hrgls::Message>(hrgls_Python_Log_Batcher_Map, $self);
+    }
+    if ((callbackHandler == nullptr) || (callbackHandler == Py_None)) {
+      return $self->SetLogMessageCallback(nullptr, nullptr);
+    }
+
     /* Construct a new vector of objects, one for the handler and one for
      * the user data.  Add it to the map.  Pass a pointer to the vector
      * in the map as userdata to the C++ handler defined above. */
@@ -284,3 +766,188 @@ struct timeval {
 
 %nothread hrgls::API::SetLogMessageCallback;
 
+/*****************************************************************/
+/* Batch delivery of log messages, which works like SetStreamBatchCallback().
+ * handler(messages, userData) is called with a list of up to maxBatch messages. */
+
+%extend hrgls::API {
+  hrgls_Status SetLogMessageBatchCallback(PyObject *callbackHandler, PyObject *userData,
+    double window = 0.001, uint32_t maxBatch = 256)
+  {
+    bool clearing = (callbackHandler == nullptr) || (callbackHandler == Py_None);
+    if (!clearing && ((window < 0) || (maxBatch == 0) || !PyCallable_Check(callbackHandler))) {
+      return hrgls_STATUS_BAD_PARAMETER;
+    }
+
+    /* Unhook the library from any earlier batcher before stopping it. */
+    if (hrgls_Python_Log_Batcher_Map.count($self)) {
+      hrgls_Status ret = $self->SetLogMessageCallback(nullptr, nullptr);
+      if (ret != hrgls_STATUS_OKAY) {
+        return ret;
+      }
+      hrgls_Python_Release_Batcher<hrgls::Message>(hrgls_Python_Log_Batcher_Map, $self);
+    }
+    if (clearing) {
+      return $self->SetLogMessageCallback(nullptr, nullptr);
+    }
+
+    std::shared_ptr<hrgls_Python_Batcher<hrgls::Message> > batcher(
+      new hrgls_Python_Batcher<hrgls::Message>(SWIGTYPE_p_hrgls__Message));
+    batcher->Start(callbackHandler, userData, window, maxBatch);
+    void *id = hrgls_Python_Batcher_Registry<hrgls::Message>::Register(batcher);
+    hrgls_Status ret = $self->SetLogMessageCallback(
+      hrgls_Python_Batcher_Registry<hrgls::Message>::Callback, id);
+    if (ret != hrgls_STATUS_OKAY) {
+      hrgls_Python_Batcher_Registry<hrgls::Message>::Unregister(id);
+      batcher->Stop();
+      return ret;
+    }
+    hrgls_Python_Log_Batcher_Map[$self] = id;
+    return ret;
+  }
+};
+
+%nothread hrgls::API::SetLogMessageBatchCallback;
+
+/* GetLogMessageBatchDroppedCount() works like GetStreamBatchDroppedCount(), and
+ * deleting an API also removes its batch handler. */
+
+%extend hrgls::API {
+  uint64_t GetLogMessageBatchDroppedCount()
+  {
+    return hrgls_Python_Batcher_Dropped<hrgls::Message>(hrgls_Python_Log_Batcher_Map, $self);
+  }
+
+  ~API()
+  {
+    hrgls_Python_Release_Batcher<hrgls::Message>(hrgls_Python_Log_Batcher_Map, $self);
+    delete $self;
+  }
+};
+
+%nothread hrgls::API::GetLogMessageBatchDroppedCount;
+
+/*****************************************************************/
+/* asyncio support for batch delivery.  AsyncBatches registers a batch callback on
+ * a DataBlobSource or an API and hands each batch to an asyncio event loop, so a
+ * coroutine can await them:
+ *
+ *   batches = hrglspy.AsyncBatches(stream, window=0.005, maxBatch=64)
+ *   async for blobs in batches:
+ *       ...
+ *   batches.close()
+ *
+ * It should be constructed from within the event loop that will await it. */
+
+%pythoncode %{
+import asyncio as _asyncio
+
+class AsyncBatches(object):
+    def __init__(self, source, window=0.001, maxBatch=256, loop=None):
+        if loop is None:
+            try:
+                loop = _asyncio.get_running_loop()
+            except (AttributeError, RuntimeError):
+                loop = _asyncio.get_event_loop()
+        self._loop = loop
+        self._queue = _asyncio.Queue()
+        self._source = source
+        if isinstance(source, API):
+            self._set = source.SetLogMessageBatchCallback
+        else:
+            self._set = source.SetStreamBatchCallback
+        status = self._set(self._deliver, None, window, maxBatch)
+        if status != hrgls_STATUS_OKAY:
+            raise RuntimeError(hrgls_ErrorMessage(status))
+
+    def _deliver(self, batch, userData):
+        try:
+            self._loop.call_soon_threadsafe(self._queue.put_nowait, batch)
+        except RuntimeError:
+            # The event loop has been closed.
+            pass
+
+    async def get(self):
+        return await self._queue.get()
+
+    def close(self):
+        if self._set is not None:
+            self._set(None, None)
+            self._set = None
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        return await self.get()
+
+# Awaits the next blob from a DataBlobSource without blocking the event loop, by
+# waiting for its notification file descriptor to become readable.  Only available
+# on Linux.  Returns as soon as GetNextBlob() has a blob to return.
+async def GetNextBlobAsyncio(stream, loop=None):
+    if loop is None:
+        try:
+            loop = _asyncio.get_running_loop()
+        except (AttributeError, RuntimeError):
+            loop = _asyncio.get_event_loop()
+    fd = stream.GetNotificationFD()
+    status = stream.GetStatus()
+    if status != hrgls_STATUS_OKAY:
+        raise RuntimeError(hrgls_ErrorMessage(status))
+    zero = timeval()
+    zero.tv_sec = 0
+    zero.tv_usec = 0
+    while True:
+        blob = stream.GetNextBlob(zero)
+        if stream.GetStatus() == hrgls_STATUS_OKAY:
+            return blob
+        readable = loop.create_future()
+        def ready():
+            if not readable.done():
+                readable.set_result(None)
+        loop.add_reader(fd, ready)
+        try:
+            await readable
+        finally:
+            loop.remove_reader(fd)
+%}
+
+/*****************************************************************/
+/* Provide zero-copy, read-only access to the data in a DataBlob.
+ * AsArray() returns a one-dimensional NumPy array of uint8 that points at the
+ * blob's data rather than copying it.  The array holds its own copy of the
+ * DataBlob, which shares the data, so the data remains valid for as long as
+ * the array (or any view of it) is alive, even after ReleaseData() has been
+ * called on the original blob or the callback handler that received it has
+ * returned.  The __array__ method lets numpy.asarray(blob) do the same, and the
+ * array supports the buffer protocol so memoryview(blob.AsArray()) also works.
+ * An empty array is returned for a blob that has no data, or whose data is in
+ * more than one segment; SegmentAsArray(i) makes an array of one segment. */
+
+%extend hrgls::datablob::DataBlob {
+  PyObject *AsArray()
+  {
+    const uint8_t *data = $self->Data();
+    return hrgls_Python_DataBlob_Array(*$self, data, static_cast<npy_intp>($self->Size()));
+  }
+
+  /* Data that is in more than one segment is reached a segment at a time. */
+  PyObject *SegmentAsArray(uint32_t which)
+  {
+    const uint8_t *data = $self->SegmentData(which);
+    return hrgls_Python_DataBlob_Array(*$self, data,
+      static_cast<npy_intp>($self->SegmentSize(which)));
+  }
+
+  %pythoncode %{
+    def __array__(self, dtype=None, copy=None):
+        a = self.AsArray()
+        if dtype is not None:
+            a = a.astype(dtype)
+        return a
+  %}
+};
+
+%nothread hrgls::datablob::DataBlob::AsArray;
+%nothread hrgls::datablob::DataBlob::SegmentAsArray;
+
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Verifies that buffer pools and handle pools reuse memory and count their
+// hits and misses, and that pooled buffers outlive the pool they came from.
+
+#include <stdio.h>
+#include <string.h>
+#include <hrgls_api.h>
+
+static int CheckStats(hrgls_BufferPool pool, uint64_t hits, uint64_t misses)
+{
+  uint64_t h, m;
+  hrgls_Status status = hrgls_BufferPoolGetStatistics(pool, &h, &m);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not get pool statistics: %s\n",
+      hrgls_ErrorMessage(status));
+    return 0;
+  }
+  if (h != hits || m != misses) {
+    fprintf(stderr, "Pool hits/misses %u/%u, expected %u/%u\n",
+      (unsigned)h, (unsigned)m, (unsigned)hits, (unsigned)misses);
+    return 0;
+  }
+  return 1;
+}
+
+int main(int argc, const char *argv[])
+{
+  hrgls_Status status;
+  hrgls_BufferPool pool;
+
+  if (hrgls_BufferPoolCreate(&pool, 0, 4) != hrgls_STATUS_BAD_PARAMETER) {
+    fprintf(stderr, "Zero-sized buffer pool was not rejected\n");
+    return 1;
+  }
+  status = hrgls_BufferPoolCreate(&pool, 64, 1);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not create pool: %s\n", hrgls_ErrorMessage(status));
+    return 2;
+  }
+
+  // The first buffer is a miss; once it has been returned it is reused.
+  uint8_t *buf1, *buf2;
+  if (hrgls_BufferPoolAcquire(pool, 64, &buf1) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not acquire buffer\n");
+    return 3;
+  }
+  memset(buf1, 1, 64);
+  hrgls_BufferPoolReturn(pool, buf1);
+  if (hrgls_BufferPoolAcquire(pool, 10, &buf2) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not acquire buffer\n");
+    return 4;
+  }
+  if (buf2 != buf1) {
+    fprintf(stderr, "Returned buffer was not reused\n");
+    return 5;
+  }
+  if (!CheckStats(pool, 1, 1)) { return 6; }
+
+  // Requests larger than the pool's buffers are allocated but not kept.
+  uint8_t *big;
+  if (hrgls_BufferPoolAcquire(pool, 1000, &big) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not acquire large buffer\n");
+    return 7;
+  }
+  memset(big, 2, 1000);
+  hrgls_BufferPoolReturn(pool, big);
+  if (!CheckStats(pool, 1, 2)) { return 8; }
+
+  // A buffer handed to a DataBlob goes back to the pool when the last reference
+  // is released, and remains valid after the pool is destroyed.
+  hrgls_DataBlob blob, copy;
+  hrgls_DataBlobCreate(&blob);
+  hrgls_DataBlobSetData(blob, buf2, 64, hrgls_BufferPoolReturn, pool);
+  hrgls_DataBlobCopy(&copy, blob);
+  hrgls_DataBlobDestroy(blob);
+  if (hrgls_BufferPoolDestroy(pool) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not destroy pool\n");
+    return 9;
+  }
+  const uint8_t *data;
+  uint32_t size;
+  hrgls_DataBlobGetData(copy, &data, &size);
+  if (data != buf2 || size != 64 || data[0] != 1) {
+    fprintf(stderr, "Blob data was not kept alive after the pool was destroyed\n");
+    return 10;
+  }
+  hrgls_DataBlobDestroy(copy);
+
+  // Destroyed handles are reused by later creates.
+  if (hrgls_HandlePoolReserve(hrgls_HANDLE_POOL_MESSAGE, 8) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not reserve message handles\n");
+    return 11;
+  }
+  uint64_t hitsBefore, hitsAfter, misses;
+  hrgls_HandlePoolGetStatistics(hrgls_HANDLE_POOL_MESSAGE, &hitsBefore, NULL);
+  hrgls_Message message;
+  hrgls_MessageCreate(&message);
+  hrgls_MessageDestroy(message);
+  hrgls_HandlePoolGetStatistics(hrgls_HANDLE_POOL_MESSAGE, &hitsAfter, &misses);
+  if (hitsAfter != hitsBefore + 1 || misses != 0) {
+    fprintf(stderr, "Reserved message handle was not used\n");
+    return 12;
+  }
+  if (hrgls_HandlePoolGetStatistics(-1, NULL, NULL) != hrgls_STATUS_BAD_PARAMETER) {
+    fprintf(stderr, "Unknown handle pool was not rejected\n");
+    return 13;
+  }
+
+  // An API provides the pool that its DataBlobSources use.
+  hrgls_API api;
+  hrgls_APICreateParams params;
+  hrgls_APICreateParametersCreate(&params);
+  status = hrgls_APICreate(&api, params);
+  hrgls_APICreateParametersDestroy(params);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not create API: %s\n", hrgls_ErrorMessage(status));
+    return 14;
+  }
+  hrgls_BufferPool apiPool = NULL;
+  status = hrgls_APIGetBufferPool(api, &apiPool);
+  if (status != hrgls_STATUS_OKAY || !apiPool) {
+    fprintf(stderr, "Could not get API buffer pool: %s\n", hrgls_ErrorMessage(status));
+    return 15;
+  }
+  hrgls_APIDestroy(api);
+
+  printf("Success!\n");
+  return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Verifies that copies of a DataBlob share its data and that the deletion
+// function is called exactly once, when the last reference is released.
+
+#include <stdio.h>
+#include <hrgls_api.h>
+
+static int g_deleteCount = 0;
+
+static void CountingDelete(void *userData, const uint8_t *dataToDelete)
+{
+  g_deleteCount++;
+}
+
+static int CheckCount(hrgls_DataBlob blob, uint32_t expected)
+{
+  uint32_t count;
+  hrgls_Status status = hrgls_DataBlobGetDataReferenceCount(blob, &count);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not get reference count: %s\n",
+      hrgls_ErrorMessage(status));
+    return 0;
+  }
+  if (count != expected) {
+    fprintf(stderr, "Reference count %u, expected %u\n", count, expected);
+    return 0;
+  }
+  return 1;
+}
+
+int main(int argc, const char *argv[])
+{
+  static uint8_t buffer[16];
+  hrgls_Status status;
+
+  hrgls_DataBlob blob;
+  status = hrgls_DataBlobCreate(&blob);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not create blob: %s\n", hrgls_ErrorMessage(status));
+    return 1;
+  }
+  if (!CheckCount(blob, 0)) { return 2; }
+  struct timeval t = { 12, 34 };
+  hrgls_DataBlobSetTime(blob, t);
+  status = hrgls_DataBlobSetData(blob, buffer, sizeof(buffer), CountingDelete, NULL);
+  if (status != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not set blob data: %s\n", hrgls_ErrorMessage(status));
+    return 3;
+  }
+  if (!CheckCount(blob, 1)) { return 4; }
+
+  // Copies share the same data pointer and the time.
+  hrgls_DataBlob copy1, copy2;
+  if (hrgls_DataBlobCopy(&copy1, blob) != hrgls_STATUS_OKAY ||
+      hrgls_DataBlobCopy(&copy2, copy1) != hrgls_STATUS_OKAY) {
+    fprintf(stderr, "Could not copy blob\n");
+    return 5;
+  }
+  if (!CheckCount(blob, 3)) { return 6; }
+  const uint8_t *data;
+  uint32_t size;
+  hrgls_DataBlobGetData(copy2, &data, &size);
+  if (data != buffer || size != sizeof(buffer)) {
+    fprintf(stderr, "Copy does not share data\n");
+    return 7;
+  }
+  struct timeval t2;
+  hrgls_DataBlobGetTime(copy2, &t2);
+  if (t2.tv_sec != t.tv_sec || t2.tv_usec != t.tv_usec) {
+    fprintf(stderr, "Copy does not have the same time\n");
+    return 8;
+  }
+
+  // Releasing the original more than once only drops its own reference.
+  hrgls_DataBlobReleaseData(blob);
+  hrgls_DataBlobReleaseData(blob);
+  if (!CheckCount(copy1, 2)) { return 9; }
+  hrgls_DataBlobGetData(blob, &data, &size);
+  if (data != NULL || size != 0) {
+    fprintf(stderr, "Released blob still refers to data\n");
+    return 10;
+  }
+
+  // Destroying a copy releases its reference.
+  hrgls_DataBlobDestroy(copy1);
+  if (!CheckCount(copy2, 1)) { return 11; }
+
+  // Extra references on one handle must each be released.
+  hrgls_DataBlobRetainData(copy2);
+  if (!CheckCount(copy2, 2)) { return 12; }
+  hrgls_DataBlobReleaseData(copy2);
+  if (!CheckCount(copy2, 1) || g_deleteCount != 0) {
+    fprintf(stderr, "Data deleted before last release\n");
+    return 13;
+  }
+  hrgls_DataBlobRetainData(copy2);
+  hrgls_DataBlobDestroy(copy2);
+  if (g_deleteCount != 1) {
+    fprintf(stderr, "Deletion function called %d times, expected 1\n", g_deleteCount);
+    return 14;
+  }
+
+  hrgls_DataBlobDestroy(blob);
+  if (g_deleteCount != 1) {
+    fprintf(stderr, "Deletion function called again after last release\n");
+    return 15;
+  }
+
+  printf("Success!\n");
+  return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// requests made by GetNextBlobAsync() are filled in order as blobs are produced,
+// that abandoned requests are handled, and (on Linux) that the notification file
+// descriptor is readable exactly when blobs are queued.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <hrgls_api.hpp>
+#include "test_helpers.hpp"
+#ifdef __linux__
+#include <poll.h>
+#endif
+
+static const size_t NUM_REQUESTS = 5;
+
+#ifdef __linux__
+/// @return True if the descriptor becomes readable within the timeout.
+static bool Readable(int fd, int timeoutMs)
+{
+  struct pollfd p;
+  p.fd = fd;
+  p.events = POLLIN;
+  p.revents = 0;
+  return poll(&p, 1, timeoutMs) == 1 && (p.revents & POLLIN);
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+    hrgls::StreamProperties sp;
+    sp.Rate(200);
+    hrgls::datablob::DataBlobSource stream(api, sp);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource" << std::endl;
+      return 2;
+    }
+
+    // An unassociated request is never ready.
+    hrgls::datablob::DataBlobRequest empty;
+    if (empty.IsReady() || empty.GetStatus() != hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Unassociated request reported ready" << std::endl;
+      return 3;
+    }
+
+    // Requests made before streaming are not filled in until it starts.
+    std::vector<hrgls::datablob::DataBlobRequest> requests;
+    for (size_t i = 0; i < NUM_REQUESTS; i++) {
+      requests.push_back(stream.GetNextBlobAsync());
+      if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not make request " << i << std::endl;
+        return 4;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    if (requests[0].IsReady()) {
+      std::cerr << "Request filled in without streaming" << std::endl;
+      return 5;
+    }
+    requests[0].Wait();
+    if (requests[0].GetStatus() != hrgls_STATUS_TIMEOUT) {
+      std::cerr << "Wait on unfilled request did not time out" << std::endl;
+      return 6;
+    }
+
+    // Abandon one request in the middle; the others are filled in order.
+    requests[2] = hrgls::datablob::DataBlobRequest();
+    if (stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start streaming" << std::endl;
+      return 7;
+    }
+    double last = 0;
+    for (size_t i = 0; i < NUM_REQUESTS; i++) {
+      if (i == 2) {
+        continue;
+      }
+      struct timeval timeout = { 1, 0 };
+      hrgls::datablob::DataBlob blob = requests[i].Wait(timeout);
+      if (requests[i].GetStatus() != hrgls_STATUS_OKAY || blob.Size() == 0) {
+        std::cerr << "Request " << i << " was not filled in" << std::endl;
+        return 8;
+      }
+      if (TimeOf(blob) <= last) {
+        std::cerr << "Request " << i << " was filled out of order" << std::endl;
+        return 9;
+      }
+      last = TimeOf(blob);
+
+      // A request yields only one blob.
+      requests[i].Wait();
+      if (requests[i].GetStatus() != hrgls_STATUS_NULL_OBJECT_POINTER) {
+        std::cerr << "Request " << i << " was filled twice" << std::endl;
+        return 10;
+      }
+    }
+
+    // A request made while blobs are queued is filled in at once.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    hrgls::datablob::DataBlobRequest queued = stream.GetNextBlobAsync();
+    if (!queued.IsReady()) {
+      std::cerr << "Request not filled from queued blob" << std::endl;
+      return 11;
+    }
+    queued.Wait();
+    if (queued.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not get queued blob" << std::endl;
+      return 12;
+    }
+
+#ifdef __linux__
+    // The notification descriptor is readable while blobs are queued, and not
+    // once they have been drained with streaming stopped.
+    int fd = stream.GetNotificationFD();
+    if (stream.GetStatus() != hrgls_STATUS_OKAY || fd < 0) {
+      std::cerr << "Could not get notification descriptor" << std::endl;
+      return 13;
+    }
+    if (!Readable(fd, 1000)) {
+      std::cerr << "Descriptor not readable while streaming" << std::endl;
+      return 14;
+    }
+    stream.SetStreamingState(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stream.GetPendingBlobs();
+    if (Readable(fd, 0)) {
+      std::cerr << "Descriptor readable after queue was emptied" << std::endl;
+      return 15;
+    }
+    stream.SetStreamingState(true);
+    if (!Readable(fd, 1000)) {
+      std::cerr << "Descriptor not readable after restarting" << std::endl;
+      return 16;
+    }
+    struct timeval zero = { 0, 0 };
+    stream.GetNextBlob(zero);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "No blob when descriptor was readable" << std::endl;
+      return 17;
+    }
+#endif
+
+    // Requests that are dropped while no blobs come are forgotten, and a request made
+    // after them is still filled in once streaming starts.
+    {
+      hrgls::datablob::DataBlobSource idle(api, sp);
+      for (size_t i = 0; i < 10000; i++) {
+        idle.GetNextBlobAsync();
+      }
+      hrgls::datablob::DataBlobRequest last = idle.GetNextBlobAsync();
+      idle.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      hrgls::datablob::DataBlob blob = last.Wait(timeout);
+      if (last.GetStatus() != hrgls_STATUS_OKAY || blob.Size() == 0) {
+        std::cerr << "Request after dropped ones was not filled in" << std::endl;
+        return 20;
+      }
+    }
+
+    // Requests that are still waiting when the source is destroyed are abandoned.
+    std::unique_ptr<hrgls::datablob::DataBlobSource> doomed(
+      new hrgls::datablob::DataBlobSource(api, sp));
+    hrgls::datablob::DataBlobRequest orphan = doomed->GetNextBlobAsync();
+    doomed.reset();
+    if (!orphan.IsReady()) {
+      std::cerr << "Orphaned request not ready" << std::endl;
+      return 18;
+    }
+    orphan.Wait();
+    if (orphan.GetStatus() != hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Orphaned request did not report its source was destroyed" << std::endl;
+      return 19;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlob whose data is in several segments reports each of them and their
+// total size, that each segment's deletion function is called once when the last
+// copy lets go, that sizes of 4 GiB and more are described, that Data() and Size()
+// still work for data in one piece, and that a recording of a segmented blob
+// replays its data in one piece.
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <hrgls_api.hpp>
+
+/// @brief Records the order in which segments were deleted.
+static std::vector<const uint8_t *> g_deleted;
+
+static void DeleteSegment(void *userData, const uint8_t *data)
+{
+  if (userData == &g_deleted) {
+    g_deleted.push_back(data);
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    static const uint8_t header[] = { 'h', 'd', 'r' };
+    static const uint8_t body[] = { 'b', 'o', 'd', 'y', '!' };
+    static const uint8_t trailer[] = { 't' };
+    hrgls_DataBlobSegment segments[3] = {
+      { header, sizeof(header), DeleteSegment, &g_deleted },
+      { body, sizeof(body), DeleteSegment, &g_deleted },
+      { trailer, sizeof(trailer), DeleteSegment, &g_deleted }
+    };
+
+    //------------------------------------------------------
+    // Each segment is reported as it was given, and Data() is not available.
+    hrgls_DataBlob raw = nullptr;
+    if (hrgls_DataBlobCreate(&raw) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSetSegments(raw, segments, 3) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set segments" << std::endl;
+      return 1;
+    }
+    uint32_t count = 0;
+    uint64_t total = 0;
+    const uint8_t *data = nullptr;
+    uint32_t size = 1;
+    if (hrgls_DataBlobGetSegmentCount(raw, &count) != hrgls_STATUS_OKAY || count != 3 ||
+        hrgls_DataBlobGetTotalSize(raw, &total) != hrgls_STATUS_OKAY || total != 9 ||
+        hrgls_DataBlobGetData(raw, &data, &size) != hrgls_STATUS_SEGMENTED_DATA ||
+        data != nullptr || size != 0) {
+      std::cerr << "Bad description of segmented data" << std::endl;
+      return 2;
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+      uint64_t segmentSize = 0;
+      if (hrgls_DataBlobGetSegment(raw, i, &data, &segmentSize) != hrgls_STATUS_OKAY ||
+          data != segments[i].data || segmentSize != segments[i].size) {
+        std::cerr << "Bad segment " << i << std::endl;
+        return 3;
+      }
+    }
+    uint64_t segmentSize = 0;
+    if (hrgls_DataBlobGetSegment(raw, 3, &data, &segmentSize) != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Read past the last segment" << std::endl;
+      return 4;
+    }
+
+    // The C++ class reports the same, and copies share the segments.
+    {
+      hrgls::datablob::DataBlob blob = hrgls::datablob::DataBlob::Adopt(raw);
+      hrgls::datablob::DataBlob copy(blob);
+      if (copy.SegmentCount() != 3 || copy.TotalSize() != 9 ||
+          copy.SegmentData(1) != body || copy.SegmentSize(1) != sizeof(body) ||
+          copy.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Bad segments from C++" << std::endl;
+        return 5;
+      }
+      if (copy.Data() != nullptr || copy.GetStatus() != hrgls_STATUS_SEGMENTED_DATA ||
+          copy.Size() != 0) {
+        std::cerr << "Data() did not report segmented data" << std::endl;
+        return 6;
+      }
+
+#ifdef __linux__
+      //------------------------------------------------------
+      // A recording of the blob replays its data in one piece.
+      std::string fileName = "test_blob_segments.rec";
+      {
+        hrgls::datablob::DataBlobRecorder recorder(fileName);
+        if (recorder.Record(copy) != hrgls_STATUS_OKAY || recorder.Flush() != hrgls_STATUS_OKAY) {
+          std::cerr << "Could not record a segmented blob" << std::endl;
+          return 7;
+        }
+      }
+      {
+        hrgls::API api;
+        hrgls::StreamProperties sp;
+        hrgls::datablob::DataBlobSource replay(api, sp, "/hrgls/replay/" + fileName);
+        replay.SetStreamingState(true);
+        struct timeval timeout = { 2, 0 };
+        hrgls::datablob::DataBlob played = replay.GetNextBlob(timeout);
+        if (played.SegmentCount() != 1 || played.Size() != 9 ||
+            memcmp(played.Data(), "hdrbody!t", 9) != 0) {
+          std::cerr << "Replayed data does not match the segments" << std::endl;
+          return 8;
+        }
+      }
+      std::remove(fileName.c_str());
+      std::remove((fileName + ".idx").c_str());
+#endif
+      if (!g_deleted.empty()) {
+        std::cerr << "Segments deleted while still referenced" << std::endl;
+        return 9;
+      }
+    }
+    if (g_deleted.size() != 3 || g_deleted[0] != header || g_deleted[1] != body ||
+        g_deleted[2] != trailer) {
+      std::cerr << "Segments were not each deleted once, in order" << std::endl;
+      return 10;
+    }
+
+    //------------------------------------------------------
+    // Sizes of 4 GiB and more can be described; the data is never touched here.
+    hrgls_DataBlobSegment huge[2] = {
+      { header, sizeof(header), nullptr, nullptr },
+      { body, 5ULL << 30, nullptr, nullptr }
+    };
+    hrgls_DataBlobCreate(&raw);
+    if (hrgls_DataBlobSetSegments(raw, huge + 1, 1) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobGetTotalSize(raw, &total) != hrgls_STATUS_OKAY || total != (5ULL << 30) ||
+        hrgls_DataBlobGetData(raw, &data, &size) != hrgls_STATUS_SEGMENTED_DATA ||
+        hrgls_DataBlobSetSegments(raw, huge, 2) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobGetTotalSize(raw, &total) != hrgls_STATUS_OKAY ||
+        total != (5ULL << 30) + sizeof(header)) {
+      std::cerr << "Bad size for a large blob" << std::endl;
+      return 11;
+    }
+
+    //------------------------------------------------------
+    // Data set in one piece is one segment, and bad segments are refused.
+    hrgls_DataBlobSegment bad = { nullptr, 1, nullptr, nullptr };
+    if (hrgls_DataBlobSetData(raw, body, sizeof(body), nullptr, nullptr) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobGetSegmentCount(raw, &count) != hrgls_STATUS_OKAY || count != 1 ||
+        hrgls_DataBlobGetSegment(raw, 0, &data, &segmentSize) != hrgls_STATUS_OKAY ||
+        data != body || segmentSize != sizeof(body) ||
+        hrgls_DataBlobGetData(raw, &data, &size) != hrgls_STATUS_OKAY || size != sizeof(body) ||
+        hrgls_DataBlobSetSegments(raw, &bad, 1) != hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_DataBlobSetSegments(raw, nullptr, 2) != hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_DataBlobSetSegments(nullptr, segments, 1) != hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Bad single-segment data or accepted bad segments" << std::endl;
+      return 12;
+    }
+    if (hrgls_DataBlobSetSegments(raw, segments, 0) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobGetSegmentCount(raw, &count) != hrgls_STATUS_OKAY || count != 0 ||
+        hrgls_DataBlobGetTotalSize(raw, &total) != hrgls_STATUS_OKAY || total != 0) {
+      std::cerr << "No segments did not leave the blob empty" << std::endl;
+      return 13;
+    }
+    hrgls_DataBlobDestroy(raw);
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// when an API has callback threads, slow stream callbacks do not slow down the
+// producers, callbacks for one source are made in order and one at a time, and
+// callbacks for different sources run in parallel.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <hrgls_api.hpp>
+
+static const size_t NUM_SOURCES = 3;
+
+static double Seconds(const struct timeval &t)
+{
+  return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+static std::atomic<int> g_running(0);      ///< Handlers running right now.
+static std::atomic<int> g_maxRunning(0);   ///< Most handlers ever running at once.
+
+struct SourceInfo {
+  std::atomic<bool> inHandler{ false };
+  std::atomic<bool> overlapped{ false };
+  std::mutex mutex;
+  std::vector<double> times;
+};
+
+static void SlowHandler(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  SourceInfo *info = static_cast<SourceInfo*>(userData);
+  if (info->inHandler.exchange(true)) {
+    info->overlapped = true;
+  }
+  int running = ++g_running;
+  int max = g_maxRunning.load();
+  while (running > max && !g_maxRunning.compare_exchange_weak(max, running)) {}
+
+  {
+    std::lock_guard<std::mutex> lock(info->mutex);
+    info->times.push_back(Seconds(blob.Time()));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  g_running--;
+  info->inHandler = false;
+}
+
+struct MessageInfo {
+  std::mutex mutex;
+  std::vector<double> times;
+};
+
+static void MessageHandler(hrgls::Message &message, void *userData)
+{
+  MessageInfo *info = static_cast<MessageInfo*>(userData);
+  std::lock_guard<std::mutex> lock(info->mutex);
+  info->times.push_back(Seconds(message.TimeStamp()));
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    // The handlers' data must outlive the API, whose callback threads use it.
+    MessageInfo messages;
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 4);
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    if (api.SetLogMessageCallback(MessageHandler, &messages) != hrgls_STATUS_OKAY ||
+        api.SetLogMessageStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start log messages" << std::endl;
+      return 2;
+    }
+
+    // Each handler takes twice as long as the time between blobs.
+    hrgls::StreamProperties sp;
+    sp.Rate(100);
+    std::vector<std::unique_ptr<hrgls::datablob::DataBlobSource> > sources;
+    std::vector<std::unique_ptr<SourceInfo> > infos;
+    for (size_t i = 0; i < NUM_SOURCES; i++) {
+      sources.emplace_back(new hrgls::datablob::DataBlobSource(api, sp));
+      infos.emplace_back(new SourceInfo);
+      if (sources.back()->GetStatus() != hrgls_STATUS_OKAY ||
+          sources.back()->SetStreamCallback(SlowHandler, infos.back().get()) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not Open DataBlobSource " << i << std::endl;
+        return 3;
+      }
+    }
+    for (size_t i = 0; i < NUM_SOURCES; i++) {
+      sources[i]->SetStreamingState(true);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    for (size_t i = 0; i < NUM_SOURCES; i++) {
+      sources[i]->SetStreamingState(false);
+    }
+    api.SetLogMessageStreamingState(false);
+
+    // Destroying the sources with a backlog of blobs must not wait for all of them.
+    auto start = std::chrono::steady_clock::now();
+    sources.clear();
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+    if (dt.count() > 0.5) {
+      std::cerr << "Destroying sources took " << dt.count() << " seconds" << std::endl;
+      return 4;
+    }
+
+    for (size_t i = 0; i < NUM_SOURCES; i++) {
+      SourceInfo &info = *infos[i];
+      std::lock_guard<std::mutex> lock(info.mutex);
+      if (info.overlapped) {
+        std::cerr << "Handlers for source " << i << " overlapped" << std::endl;
+        return 5;
+      }
+      if (info.times.size() < 5) {
+        std::cerr << "Only " << info.times.size() << " blobs from source " << i << std::endl;
+        return 6;
+      }
+      for (size_t j = 1; j < info.times.size(); j++) {
+        if (info.times[j] <= info.times[j - 1]) {
+          std::cerr << "Blobs from source " << i << " out of order" << std::endl;
+          return 7;
+        }
+      }
+      // Blobs should have been produced at the configured rate, not at the rate
+      // that the handler consumed them.
+      double spacing = (info.times.back() - info.times.front()) / (info.times.size() - 1);
+      if (spacing > 0.015) {
+        std::cerr << "Blobs from source " << i << " produced every " << spacing
+          << " seconds" << std::endl;
+        return 8;
+      }
+    }
+    if (g_maxRunning < 2) {
+      std::cerr << "Handlers for different sources did not run in parallel" << std::endl;
+      return 9;
+    }
+
+    std::lock_guard<std::mutex> lock(messages.mutex);
+    if (messages.times.empty()) {
+      std::cerr << "No log messages received" << std::endl;
+      return 10;
+    }
+    for (size_t j = 1; j < messages.times.size(); j++) {
+      if (messages.times[j] < messages.times[j - 1]) {
+        std::cerr << "Log messages out of order" << std::endl;
+        return 11;
+      }
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// GetNextBlob() blocks for the requested timeout when no blob is available and
+// that it returns blobs as they arrive when streaming.
+
+#include <iostream>
+#include <chrono>
+#include <hrgls_api.hpp>
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    hrgls_Status status = api.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 1;
+    }
+
+    hrgls::StreamProperties sp;
+    hrgls::datablob::DataBlobSource stream(api, sp);
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 2;
+    }
+
+    // With streaming turned off, we should wait for the whole timeout and then
+    // get a timeout status.
+    struct timeval timeout = { 0, 200000 };
+    auto start = std::chrono::steady_clock::now();
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    status = stream.GetStatus();
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+    if (status != hrgls_STATUS_TIMEOUT) {
+      std::cerr << "Expected timeout with streaming off, got: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 3;
+    }
+    if (dt.count() < 0.15) {
+      std::cerr << "GetNextBlob() returned after " << dt.count()
+        << " seconds, before its timeout" << std::endl;
+      return 4;
+    }
+
+    // With a zero timeout, we should return right away.
+    start = std::chrono::steady_clock::now();
+    blob = stream.GetNextBlob();
+    status = stream.GetStatus();
+    dt = std::chrono::steady_clock::now() - start;
+    if (status != hrgls_STATUS_TIMEOUT) {
+      std::cerr << "Expected timeout with zero wait, got: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 5;
+    }
+    if (dt.count() > 0.1) {
+      std::cerr << "GetNextBlob() with zero timeout took " << dt.count()
+        << " seconds" << std::endl;
+      return 6;
+    }
+
+    // Turn on streaming and make sure that each blocking call gets a blob.
+    if (stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set streaming state on" << std::endl;
+      return 7;
+    }
+    timeout.tv_sec = 2;
+    timeout.tv_usec = 0;
+    for (size_t i = 0; i < 5; i++) {
+      blob = stream.GetNextBlob(timeout);
+      status = stream.GetStatus();
+      if (status != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not get blob " << i << ": "
+          << hrgls_ErrorMessage(status) << std::endl;
+        return 8;
+      }
+      if (blob.Size() == 0) {
+        std::cerr << "Got empty blob " << i << std::endl;
+        return 9;
+      }
+      blob.ReleaseData();
+    }
+    if (stream.SetStreamingState(false) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set streaming state off" << std::endl;
+      return 10;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
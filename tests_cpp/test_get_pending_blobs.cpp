@@ -0,0 +1,118 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// GetPendingBlobs() returns queued blobs in order and honors its maximum count.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <hrgls_api.hpp>
+
+static bool Before(const struct timeval &a, const struct timeval &b)
+{
+  return (a.tv_sec < b.tv_sec) || ((a.tv_sec == b.tv_sec) && (a.tv_usec < b.tv_usec));
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    hrgls_Status status = api.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 1;
+    }
+
+    hrgls::StreamProperties sp;
+    sp.Rate(1000);
+    hrgls::datablob::DataBlobSource stream(api, sp);
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 2;
+    }
+
+    // Nothing is queued before streaming starts.
+    std::vector<hrgls::datablob::DataBlob> blobs = stream.GetPendingBlobs();
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_TIMEOUT || !blobs.empty()) {
+      std::cerr << "Expected timeout with streaming off, got: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 3;
+    }
+
+    // Let blobs queue up, then stop the source so the count is stable.
+    if (stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set streaming state on" << std::endl;
+      return 4;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if (stream.SetStreamingState(false) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not set streaming state off" << std::endl;
+      return 5;
+    }
+
+    // A bounded request returns exactly that many.
+    blobs = stream.GetPendingBlobs(5);
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_OKAY || blobs.size() != 5) {
+      std::cerr << "Expected 5 blobs, got " << blobs.size() << ": "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 6;
+    }
+    struct timeval last = blobs.back().Time();
+
+    // An unbounded request drains the rest, which spans more than one chunk
+    // across the C interface, in order.
+    blobs = stream.GetPendingBlobs();
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_OKAY || blobs.size() < 65) {
+      std::cerr << "Expected many blobs, got " << blobs.size() << ": "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 7;
+    }
+    for (size_t i = 0; i < blobs.size(); i++) {
+      if (blobs[i].Size() == 0) {
+        std::cerr << "Got empty blob " << i << std::endl;
+        return 8;
+      }
+      struct timeval t = blobs[i].Time();
+      if (Before(t, last)) {
+        std::cerr << "Blob " << i << " is out of order" << std::endl;
+        return 9;
+      }
+      last = t;
+    }
+
+    // Now the queue is empty again, and a short wait times out.
+    struct timeval timeout = { 0, 50000 };
+    blobs = stream.GetPendingBlobs(0, timeout);
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_TIMEOUT || !blobs.empty()) {
+      std::cerr << "Expected timeout on empty queue, got: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 10;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that are shared by the tests that read blobs from the Null implementation.
+
+#pragma once
+
+#include <cstdint>
+#include <hrgls_api.hpp>
+
+/// Whether each byte of the blob's data holds its index modulo 256, which is what
+/// the Null implementation's sources fill their blobs with.
+inline bool CheckPattern(hrgls::datablob::DataBlob &blob)
+{
+  for (uint32_t i = 0; i < blob.Size(); i++) {
+    if (blob.Data()[i] != i % 256) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Whether a blob is one that a Null implementation source makes with its default
+/// payload: 256 bytes of the pattern.
+inline bool CheckData(hrgls::datablob::DataBlob &blob)
+{
+  return blob.Size() == 256 && CheckPattern(blob);
+}
+
+/// Times in seconds, for comparing and subtracting them.
+inline double TimeOf(struct timeval t)
+{
+  return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+inline double TimeOf(hrgls::datablob::DataBlob &blob)
+{
+  return TimeOf(blob.Time());
+}
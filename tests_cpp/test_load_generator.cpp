@@ -0,0 +1,236 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// the load it generates follows the source count, message rate and level given when
+// the API is created and the payload size, distribution and bursts in the
+// StreamProperties.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <hrgls_api.hpp>
+#include "test_helpers.hpp"
+
+/// @brief Reads blobs from a new source with the given properties.
+/// @return The blobs, which are fewer than asked for if they did not all arrive.
+static std::vector<hrgls::datablob::DataBlob> GetBlobs(hrgls::API &api,
+  hrgls::StreamProperties &sp, size_t count)
+{
+  std::vector<hrgls::datablob::DataBlob> ret;
+  hrgls::datablob::DataBlobSource stream(api, sp);
+  if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+    return ret;
+  }
+  stream.SetStreamingState(true);
+  struct timeval timeout = { 1, 0 };
+  while (ret.size() < count) {
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      break;
+    }
+    ret.push_back(blob);
+  }
+  stream.SetStreamingState(false);
+  return ret;
+}
+
+/// @brief Checks the sizes of the blobs from a payload distribution against its range
+/// and a range for their mean.
+static bool CheckSizes(hrgls::API &api, hrgls_PayloadDistribution distribution,
+  uint32_t maxSize, double lowMean, double highMean)
+{
+  hrgls::StreamProperties sp;
+  sp.Rate(2000);
+  sp.QueueCapacity(1000);
+  sp.PayloadSize(100);
+  sp.PayloadDistribution(distribution);
+  std::vector<hrgls::datablob::DataBlob> blobs = GetBlobs(api, sp, 300);
+  if (blobs.size() != 300) {
+    return false;
+  }
+  double total = 0;
+  bool varied = false;
+  for (size_t i = 0; i < blobs.size(); i++) {
+    if (blobs[i].Size() < 1 || blobs[i].Size() > maxSize || !CheckPattern(blobs[i])) {
+      return false;
+    }
+    varied = varied || blobs[i].Size() != blobs[0].Size();
+    total += blobs[i].Size();
+  }
+  double mean = total / blobs.size();
+  return varied && mean >= lowMean && mean <= highMean;
+}
+
+/// @brief Streams log messages from an API for a time.
+static std::vector<hrgls::Message> GetMessages(hrgls::API &api, int milliseconds)
+{
+  api.SetLogMessageStreamingState(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  api.SetLogMessageStreamingState(false);
+  return api.GetPendingLogMessages();
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    //------------------------------------------------------
+    // Bad parameters are rejected.
+    {
+      hrgls::API none(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 0);
+      hrgls::API negative(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, -1);
+      if (none.GetStatus() != hrgls_STATUS_BAD_PARAMETER ||
+          negative.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Bad API parameters were not rejected" << std::endl;
+        return 1;
+      }
+    }
+    hrgls::StreamProperties sp;
+    if (sp.PayloadSize() != 256 || sp.PayloadDistribution() != hrgls_PAYLOAD_FIXED ||
+        sp.BurstLength() != 1) {
+      std::cerr << "Bad default stream properties" << std::endl;
+      return 2;
+    }
+    if (sp.PayloadSize(0) != hrgls_STATUS_BAD_PARAMETER ||
+        sp.PayloadSize((1u << 28) + 1) != hrgls_STATUS_BAD_PARAMETER ||
+        sp.PayloadDistribution(42) != hrgls_STATUS_BAD_PARAMETER ||
+        sp.BurstLength(0) != hrgls_STATUS_BAD_PARAMETER || sp.PayloadSize() != 256) {
+      std::cerr << "Bad stream properties were not rejected" << std::endl;
+      return 3;
+    }
+
+    //------------------------------------------------------
+    // The number of sources advertised.
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 5);
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 4;
+    }
+    std::vector<hrgls::DataBlobSourceDescription> sources = api.GetAvailableDataBlobSources();
+    if (sources.size() != 5 || sources[4].Name() != "/hrgls/null/DataBlobSource/5") {
+      std::cerr << "Wrong sources advertised" << std::endl;
+      return 5;
+    }
+    {
+      hrgls::datablob::DataBlobSource last(api, sp, "/hrgls/null/DataBlobSource/5");
+      if (last.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not open the last source" << std::endl;
+        return 6;
+      }
+    }
+
+    //------------------------------------------------------
+    // Payload sizes.
+    sp.Rate(1000);
+    sp.PayloadSize(1000);
+    std::vector<hrgls::datablob::DataBlob> blobs = GetBlobs(api, sp, 10);
+    for (size_t i = 0; i < blobs.size(); i++) {
+      if (blobs[i].Size() != 1000 || !CheckPattern(blobs[i])) {
+        std::cerr << "Bad fixed-size blob" << std::endl;
+        return 7;
+      }
+    }
+    if (blobs.size() != 10) {
+      std::cerr << "Did not get fixed-size blobs" << std::endl;
+      return 8;
+    }
+    if (!CheckSizes(api, hrgls_PAYLOAD_UNIFORM, 199, 80, 120)) {
+      std::cerr << "Bad uniformly-distributed sizes" << std::endl;
+      return 9;
+    }
+    if (!CheckSizes(api, hrgls_PAYLOAD_EXPONENTIAL, 800, 70, 130)) {
+      std::cerr << "Bad exponentially-distributed sizes" << std::endl;
+      return 10;
+    }
+
+    //------------------------------------------------------
+    // Bursts: 10 blobs at once, 10 times a second.
+    sp.PayloadSize(256);
+    sp.Rate(100);
+    sp.BurstLength(10);
+    blobs = GetBlobs(api, sp, 30);
+    if (blobs.size() != 30) {
+      std::cerr << "Did not get burst blobs" << std::endl;
+      return 11;
+    }
+    size_t close = 0, apart = 0;
+    for (size_t i = 1; i < blobs.size(); i++) {
+      double gap = TimeOf(blobs[i]) - TimeOf(blobs[i - 1]);
+      if (gap < 0.005) {
+        close++;
+      } else if (gap > 0.05) {
+        apart++;
+      }
+    }
+    if (close < 20 || apart < 1) {
+      std::cerr << "Blobs were not sent in bursts (" << close << " close, " << apart
+        << " apart)" << std::endl;
+      return 12;
+    }
+
+    //------------------------------------------------------
+    // Message rate and levels.
+    {
+      hrgls::API fast(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1000,
+        hrgls_MESSAGE_MINIMUM_WARNING);
+      std::vector<hrgls::Message> messages = GetMessages(fast, 300);
+      if (messages.size() < 100) {
+        std::cerr << "Too few messages: " << messages.size() << std::endl;
+        return 13;
+      }
+      bool sawCritical = false;
+      for (size_t i = 0; i < messages.size(); i++) {
+        if (messages[i].Level() < hrgls_MESSAGE_MINIMUM_WARNING) {
+          std::cerr << "Message below the lowest level" << std::endl;
+          return 14;
+        }
+        sawCritical = sawCritical || messages[i].Level() == hrgls_MESSAGE_MINIMUM_CRITICAL_ERROR;
+      }
+      if (!sawCritical || messages[0].Level() != hrgls_MESSAGE_MINIMUM_WARNING) {
+        std::cerr << "Messages did not cycle through the levels" << std::endl;
+        return 15;
+      }
+    }
+    {
+      const hrgls_MessageLevel custom = hrgls_MESSAGE_MINIMUM_CRITICAL_ERROR + 1;
+      hrgls::API high(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1000, custom);
+      std::vector<hrgls::Message> messages = GetMessages(high, 50);
+      if (messages.empty()) {
+        std::cerr << "No messages at a custom level" << std::endl;
+        return 16;
+      }
+      for (size_t i = 0; i < messages.size(); i++) {
+        if (messages[i].Level() != custom) {
+          std::cerr << "Message not at the custom level" << std::endl;
+          return 17;
+        }
+      }
+    }
+    {
+      hrgls::API quiet(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 0);
+      if (!GetMessages(quiet, 150).empty()) {
+        std::cerr << "Messages sent with a rate of 0" << std::endl;
+        return 18;
+      }
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
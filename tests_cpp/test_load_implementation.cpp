@@ -0,0 +1,230 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// an API can be implemented by a library loaded at run time, alongside the one that
+// the program is linked against, and that blobs, callbacks, multiplexers and
+// recorders work with the objects that come from it.  The build tells it where the
+// loadable Null implementation is in HRGLS_NULL_IMPLEMENTATION.
+
+#include <iostream>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <hrgls_api.hpp>
+#include <hrgls_implementation.h>
+#include "test_helpers.hpp"
+
+#ifdef HRGLS_NULL_IMPLEMENTATION
+/// @return The implementation that made a handle, as described in hrgls_implementation.h.
+static const hrgls_Implementation *ImplementationOf(const void *handle)
+{
+  return *static_cast<const hrgls_Implementation * const *>(handle);
+}
+
+static std::atomic<size_t> g_callbackBlobs(0);
+
+static void CountBlobCallback(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  if (CheckData(blob)) {
+    g_callbackBlobs++;
+  }
+}
+
+static std::atomic<size_t> g_views(0);
+
+static void CountViewCallback(const hrgls::MessageView &message, void *userData)
+{
+  if (message.Value()) {
+    g_views++;
+  }
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+#ifdef HRGLS_NULL_IMPLEMENTATION
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    const hrgls_Implementation *linked = hrgls_GetImplementation(hrgls_IMPLEMENTATION_VERSION);
+    if (!linked || linked->version < hrgls_IMPLEMENTATION_VERSION ||
+        hrgls_GetImplementation(hrgls_IMPLEMENTATION_VERSION + 1)) {
+      std::cerr << "Bad function table from linked implementation" << std::endl;
+      return 1;
+    }
+
+    {
+      hrgls::API missing(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "",
+        "no_such_hrgls_implementation");
+      if (missing.GetStatus() != hrgls_STATUS_IMPLEMENTATION_NOT_FOUND) {
+        std::cerr << "Loaded an implementation that does not exist" << std::endl;
+        return 2;
+      }
+    }
+
+    hrgls::API direct;
+    hrgls::API loaded(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "",
+      HRGLS_NULL_IMPLEMENTATION);
+    if (direct.GetStatus() != hrgls_STATUS_OKAY || loaded.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open APIs" << std::endl;
+      return 3;
+    }
+    std::vector<hrgls::DataBlobSourceDescription> sources = loaded.GetAvailableDataBlobSources();
+    if (loaded.GetStatus() != hrgls_STATUS_OKAY || sources.size() !=
+        direct.GetAvailableDataBlobSources().size()) {
+      std::cerr << "Loaded implementation listed wrong sources" << std::endl;
+      return 6;
+    }
+
+    // Both implementations stream at once, each making its own blobs.
+    hrgls::StreamProperties sp;
+    sp.Rate(500);
+    hrgls::datablob::DataBlobSource directStream(direct, sp);
+    hrgls::datablob::DataBlobSource loadedStream(loaded, sp, sources[0].Name());
+    if (directStream.GetStatus() != hrgls_STATUS_OKAY ||
+        loadedStream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSources" << std::endl;
+      return 7;
+    }
+    directStream.SetStreamingState(true);
+    loadedStream.SetStreamingState(true);
+    struct timeval timeout = { 1, 0 };
+    const hrgls_Implementation *other = nullptr;
+    {
+      hrgls::datablob::DataBlob l = loadedStream.GetNextBlob(timeout);
+      other = ImplementationOf(l.RawDataBlob());
+      if (other == linked || !other || other->version < hrgls_IMPLEMENTATION_VERSION) {
+        std::cerr << "Blob was not made by the loaded implementation" << std::endl;
+        return 4;
+      }
+    }
+
+    // Naming the library again uses the one that is already loaded.  The load
+    // generator's parameters and stream properties are passed on to it.
+    {
+      hrgls::API again(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "",
+        HRGLS_NULL_IMPLEMENTATION, 3);
+      if (again.GetAvailableDataBlobSources().size() != 3) {
+        std::cerr << "Source count was not passed on" << std::endl;
+        return 15;
+      }
+      hrgls::StreamProperties big(sp);
+      big.PayloadSize(1000);
+      hrgls::datablob::DataBlobSource againStream(again, big);
+      againStream.SetStreamingState(true);
+      hrgls::datablob::DataBlob a = againStream.GetNextBlob(timeout);
+      if (againStream.GetStatus() != hrgls_STATUS_OKAY || ImplementationOf(a.RawDataBlob()) != other) {
+        std::cerr << "Second API did not use the loaded implementation" << std::endl;
+        return 5;
+      }
+      if (a.Size() != 1000) {
+        std::cerr << "Payload size was not passed on" << std::endl;
+        return 16;
+      }
+      hrgls::StreamStatistics stats = againStream.GetStatistics();
+      if (againStream.GetStatus() != hrgls_STATUS_OKAY || stats.Delivered() != 1 ||
+          stats.Produced() < 1) {
+        std::cerr << "Statistics were not read from the loaded implementation" << std::endl;
+        return 17;
+      }
+
+      // Borrowed log messages are lent by the loaded implementation.
+      again.SetLogMessageViewCallback(CountViewCallback, nullptr);
+      again.SetLogMessageStreamingState(true);
+      struct timeval start = again.GetCurrentSystemTime();
+      while (g_views < 1) {
+        struct timeval now = again.GetCurrentSystemTime();
+        if (now.tv_sec - start.tv_sec > 5) {
+          std::cerr << "Timeout waiting for views from loaded implementation" << std::endl;
+          return 18;
+        }
+      }
+      again.SetLogMessageStreamingState(false);
+      again.SetLogMessageViewCallback(nullptr, nullptr);
+    }
+    for (int i = 0; i < 10; i++) {
+      hrgls::datablob::DataBlob d = directStream.GetNextBlob(timeout);
+      if (directStream.GetStatus() != hrgls_STATUS_OKAY || !CheckData(d) ||
+          ImplementationOf(d.RawDataBlob()) != linked) {
+        std::cerr << "Bad blob from linked implementation" << std::endl;
+        return 8;
+      }
+      hrgls::datablob::DataBlob l = loadedStream.GetNextBlob(timeout);
+      if (loadedStream.GetStatus() != hrgls_STATUS_OKAY || !CheckData(l) ||
+          ImplementationOf(l.RawDataBlob()) != other) {
+        std::cerr << "Bad blob from loaded implementation" << std::endl;
+        return 9;
+      }
+
+      // Copies share the data, counting references in the loaded implementation.
+      hrgls::datablob::DataBlob copy(l);
+      uint32_t refs = 0;
+      if (hrgls_DataBlobGetDataReferenceCount(l.RawDataBlob(), &refs) != hrgls_STATUS_OKAY ||
+          refs != 2 || copy.Data() != l.Data()) {
+        std::cerr << "Copy of loaded blob did not share its data" << std::endl;
+        return 10;
+      }
+    }
+
+    // Blobs from a loaded implementation can be recorded.
+    {
+      std::string fileName = "test_load_implementation.rec";
+      hrgls::datablob::DataBlobRecorder recorder(fileName);
+      hrgls::datablob::DataBlob l = loadedStream.GetNextBlob(timeout);
+      if (recorder.Record(l) != hrgls_STATUS_OKAY || recorder.Flush() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not record loaded blob" << std::endl;
+        return 11;
+      }
+      std::remove(fileName.c_str());
+      std::remove((fileName + ".idx").c_str());
+    }
+
+    // Multiplexers take sources only from their own implementation.
+    {
+      hrgls::datablob::DataBlobMultiplexer mux(loaded);
+      if (mux.GetStatus() != hrgls_STATUS_OKAY ||
+          mux.AddSource(directStream, 1) != hrgls_STATUS_BAD_PARAMETER ||
+          mux.AddSource(loadedStream, 2) != hrgls_STATUS_OKAY) {
+        std::cerr << "Multiplexer did not check implementations" << std::endl;
+        return 12;
+      }
+      uint32_t id = 0;
+      hrgls::datablob::DataBlob b = mux.GetNextBlob(id, timeout);
+      if (mux.GetStatus() != hrgls_STATUS_OKAY || id != 2 || !CheckData(b)) {
+        std::cerr << "Multiplexer did not get loaded blob" << std::endl;
+        return 13;
+      }
+    }
+
+    // Callbacks are called by the loaded implementation with its own blobs.
+    loadedStream.SetStreamCallback(CountBlobCallback, nullptr);
+    struct timeval start = loaded.GetCurrentSystemTime();
+    while (g_callbackBlobs < 5) {
+      struct timeval now = loaded.GetCurrentSystemTime();
+      if (now.tv_sec - start.tv_sec > 5) {
+        std::cerr << "Timeout waiting for callbacks from loaded implementation" << std::endl;
+        return 14;
+      }
+    }
+    loadedStream.SetStreamCallback(nullptr, nullptr);
+  }
+#endif
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// log messages can be lent to callback handlers through the C++ and C interfaces,
+// with or without a callback pool, that messages can refer to static and interned
+// text without copying it, and that filtered-out messages are not delivered.
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string.h>
+#include <hrgls_api.hpp>
+
+/// @brief What the view handlers found.
+struct ViewCounts {
+  std::atomic<size_t> views{ 0 };
+  std::atomic<size_t> badViews{ 0 };
+  std::atomic<size_t> copies{ 0 };
+};
+
+static void HandleView(const hrgls::MessageView &message, void *userData)
+{
+  ViewCounts *counts = static_cast<ViewCounts*>(userData);
+  if (!message.Value() || strlen(message.Value()) == 0 || message.TimeStamp().tv_sec == 0 ||
+      message.Level() < hrgls_MESSAGE_MINIMUM_INFO) {
+    counts->badViews++;
+  }
+  counts->views++;
+}
+
+static void HandleCopy(hrgls::Message &message, void *userData)
+{
+  static_cast<ViewCounts*>(userData)->copies++;
+}
+
+static void HandleCView(const hrgls_MessageView *message, void *userData)
+{
+  ViewCounts *counts = static_cast<ViewCounts*>(userData);
+  if (!message || !message->value || strlen(message->value) == 0) {
+    counts->badViews++;
+  }
+  counts->views++;
+}
+
+/// @brief Streams log messages from an API for a time.
+static void Stream(hrgls::API &api, int milliseconds)
+{
+  api.SetLogMessageStreamingState(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  api.SetLogMessageStreamingState(false);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    //------------------------------------------------------
+    // Views handed out from the thread that generates the messages.
+    ViewCounts counts;
+    {
+      hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1000);
+      if (api.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not Open API" << std::endl;
+        return 1;
+      }
+      if (api.SetLogMessageViewCallback(HandleView, &counts) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not set view callback" << std::endl;
+        return 2;
+      }
+      Stream(api, 100);
+      hrgls::StreamStatistics stats = api.GetLogMessageStatistics();
+      if (counts.views < 10 || counts.badViews != 0 || stats.Callbacks() != counts.views ||
+          !api.GetPendingLogMessages().empty()) {
+        std::cerr << "Bad views: " << counts.views << " (" << counts.badViews << " bad)"
+          << std::endl;
+        return 3;
+      }
+
+      // Setting a copying handler replaces the borrowing one, and the other way around.
+      counts.views = 0;
+      api.SetLogMessageCallback(HandleCopy, &counts);
+      Stream(api, 50);
+      if (counts.views != 0 || counts.copies == 0) {
+        std::cerr << "Copying handler did not replace the view handler" << std::endl;
+        return 4;
+      }
+      counts.copies = 0;
+      api.SetLogMessageViewCallback(HandleView, &counts);
+      Stream(api, 50);
+      if (counts.views == 0 || counts.copies != 0) {
+        std::cerr << "View handler did not replace the copying handler" << std::endl;
+        return 5;
+      }
+
+      // Filtered-out messages are not delivered.
+      counts.views = 0;
+      api.SetLogMessageMinimumLevel(hrgls_MESSAGE_MINIMUM_CRITICAL_ERROR + 1);
+      Stream(api, 50);
+      api.SetLogMessageViewCallback(nullptr, nullptr);
+      if (counts.views != 0) {
+        std::cerr << "Filtered messages were delivered" << std::endl;
+        return 6;
+      }
+    }
+
+    //------------------------------------------------------
+    // Views handed out from a callback pool.
+    {
+      counts.views = 0;
+      hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 2, "", "", 2, 1000);
+      api.SetLogMessageViewCallback(HandleView, &counts);
+      Stream(api, 100);
+      api.SetLogMessageViewCallback(nullptr, nullptr);
+      if (counts.views < 10 || counts.badViews != 0) {
+        std::cerr << "Bad views from the callback pool" << std::endl;
+        return 7;
+      }
+    }
+
+    //------------------------------------------------------
+    // The C interface.
+    {
+      hrgls_API api;
+      hrgls_APICreateParams params;
+      if (hrgls_APICreateParametersCreate(&params) != hrgls_STATUS_OKAY ||
+          hrgls_APICreateParametersSetMessageRate(params, 1000) != hrgls_STATUS_OKAY ||
+          hrgls_APICreate(&api, params) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create C API" << std::endl;
+        return 8;
+      }
+      hrgls_APICreateParametersDestroy(params);
+      counts.views = 0;
+      if (hrgls_APISetLogMessageViewCallback(nullptr, HandleCView, &counts) !=
+            hrgls_STATUS_NULL_OBJECT_POINTER ||
+          hrgls_APISetLogMessageViewCallback(api, HandleCView, &counts) != hrgls_STATUS_OKAY ||
+          hrgls_APISetLogMessageStreamingState(api, true) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not set C view callback" << std::endl;
+        return 9;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      hrgls_APISetLogMessageStreamingState(api, false);
+      hrgls_APISetLogMessageViewCallback(api, nullptr, nullptr);
+      hrgls_APIDestroy(api);
+      if (counts.views < 10 || counts.badViews != 0) {
+        std::cerr << "Bad C views" << std::endl;
+        return 10;
+      }
+    }
+
+    //------------------------------------------------------
+    // Static and interned text.
+    {
+      std::string text = "interned text";
+      const char *first = nullptr, *second = nullptr, *other = nullptr;
+      if (hrgls_InternString(text.c_str(), &first) != hrgls_STATUS_OKAY ||
+          hrgls_InternString(std::string(text).c_str(), &second) != hrgls_STATUS_OKAY ||
+          hrgls_InternString("other text", &other) != hrgls_STATUS_OKAY ||
+          hrgls_InternString(nullptr, &first) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_InternString("x", nullptr) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Could not intern strings" << std::endl;
+        return 11;
+      }
+      if (first != second || first == other || first == text.c_str() || text != first) {
+        std::cerr << "Bad interned strings" << std::endl;
+        return 12;
+      }
+
+      hrgls::Message m;
+      if (m.StaticValue(first) != hrgls_STATUS_OKAY || m.Value() != text ||
+          hrgls_MessageSetStaticValue(m.RawMessage(), nullptr) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_MessageSetStaticValue(nullptr, first) != hrgls_STATUS_NULL_OBJECT_POINTER) {
+        std::cerr << "Could not set static value" << std::endl;
+        return 13;
+      }
+      // Copies refer to the same text.
+      hrgls::Message copy(m);
+      const char *copied = nullptr;
+      hrgls_MessageGetValue(copy.RawMessage(), &copied);
+      if (copied != first) {
+        std::cerr << "Static value was copied" << std::endl;
+        return 14;
+      }
+      // Setting a copied value replaces the static one.
+      copy.Value("copied text");
+      if (copy.Value() != "copied text" || m.Value() != text) {
+        std::cerr << "Bad value after replacing static value" << std::endl;
+        return 15;
+      }
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlobMerger returns blobs from several sources in time order, holds a blob
+// back for a quiet source by no more than its reorder window, releases the blobs of
+// a source that stops being merged, and drops or delivers late blobs as asked.  The
+// parts that replay recordings only run on Linux.
+
+#include <iostream>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <hrgls_api.hpp>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+static int64_t MicrosecondsOf(struct timeval t)
+{
+  return static_cast<int64_t>(t.tv_sec) * 1000000 + t.tv_usec;
+}
+
+#ifdef __linux__
+/// @brief Record blobs at the given offsets in microseconds from a base time.
+static bool RecordAt(const std::string &fileName, int64_t base, const std::vector<int> &offsets)
+{
+  static const uint8_t data[] = { 1, 2, 3, 4 };
+  hrgls::datablob::DataBlobRecorder recorder(fileName);
+  for (size_t i = 0; i < offsets.size(); i++) {
+    int64_t t = base + offsets[i];
+    struct timeval time;
+    time.tv_sec = static_cast<decltype(time.tv_sec)>(t / 1000000);
+    time.tv_usec = static_cast<decltype(time.tv_usec)>(t % 1000000);
+    hrgls_DataBlob raw = nullptr;
+    if (hrgls_DataBlobCreate(&raw) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSetTime(raw, time) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSetData(raw, data, sizeof(data), nullptr, nullptr) != hrgls_STATUS_OKAY) {
+      return false;
+    }
+    hrgls::datablob::DataBlob blob = hrgls::datablob::DataBlob::Adopt(raw);
+    if (recorder.Record(blob) != hrgls_STATUS_OKAY) {
+      return false;
+    }
+  }
+  return recorder.Flush() == hrgls_STATUS_OKAY;
+}
+
+/// @brief A source that replays a recording as fast as it is consumed.
+struct Replay {
+  hrgls::StreamProperties sp;
+  std::unique_ptr<hrgls::datablob::DataBlobSource> source;
+
+  Replay(hrgls::API &api, const std::string &fileName)
+  {
+    sp.QueueCapacity(8);
+    sp.OverflowPolicy(hrgls_OVERFLOW_BLOCK_PRODUCER);
+    source.reset(new hrgls::datablob::DataBlobSource(api, sp, "/hrgls/replay/" + fileName));
+    source->SetReplayPacing(hrgls_REPLAY_AS_FAST_AS_POSSIBLE);
+    source->SetStreamingState(true);
+  }
+};
+
+/// @brief Read blobs, returning their offsets from base and IDs, until one is not ready.
+static void ReadAll(hrgls::datablob::DataBlobMerger &merger, int64_t base,
+  std::vector<int> &offsets, std::vector<uint32_t> &ids)
+{
+  struct timeval timeout = { 0, 300000 };
+  while (true) {
+    uint32_t id = 0;
+    hrgls::datablob::DataBlob blob = merger.GetNextBlob(id, timeout);
+    if (merger.GetStatus() != hrgls_STATUS_OKAY) {
+      return;
+    }
+    offsets.push_back(static_cast<int>(MicrosecondsOf(blob.Time()) - base));
+    ids.push_back(id);
+  }
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    //------------------------------------------------------
+    // Bad parameters are refused.
+    {
+      struct timeval negative = { -1, 0 };
+      struct timeval window = { 0, 1000 };
+      hrgls::datablob::DataBlobMerger bad(api, negative);
+      hrgls::datablob::DataBlobMerger badPolicy(api, window, 42);
+      hrgls_DataBlobMerger raw = nullptr;
+      uint64_t count;
+      if (bad.GetStatus() != hrgls_STATUS_BAD_PARAMETER ||
+          badPolicy.GetStatus() != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_DataBlobMergerCreate(&raw, nullptr, window, hrgls_LATE_BLOB_DROP) !=
+            hrgls_STATUS_BAD_PARAMETER || raw != nullptr ||
+          hrgls_DataBlobMergerGetLateBlobCount(nullptr, &count) !=
+            hrgls_STATUS_NULL_OBJECT_POINTER) {
+        std::cerr << "Bad merger parameters were accepted" << std::endl;
+        return 2;
+      }
+    }
+
+    //------------------------------------------------------
+    // Blobs from live sources come out in time order, and a blob held for a quiet
+    // source is returned once its window has passed.
+    {
+      struct timeval window = { 0, 100000 };
+      hrgls::datablob::DataBlobMerger merger(api, window);
+      hrgls::StreamProperties fast, slow;
+      fast.Rate(200);
+      slow.Rate(70);
+      hrgls::datablob::DataBlobSource a(api, fast), b(api, slow), quiet(api, slow);
+      if (merger.GetStatus() != hrgls_STATUS_OKAY || merger.AddSource(a, 1) != hrgls_STATUS_OKAY ||
+          merger.AddSource(b, 2) != hrgls_STATUS_OKAY ||
+          merger.AddSource(a, 3) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Could not add sources" << std::endl;
+        return 3;
+      }
+      a.SetStreamingState(true);
+      b.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      int64_t last = 0;
+      size_t fromA = 0, fromB = 0;
+      for (int i = 0; i < 60; i++) {
+        uint32_t id = 0;
+        hrgls::datablob::DataBlob blob = merger.GetNextBlob(id, timeout);
+        int64_t t = MicrosecondsOf(blob.Time());
+        if (merger.GetStatus() != hrgls_STATUS_OKAY || t < last) {
+          std::cerr << "Blob " << i << " was missing or out of order" << std::endl;
+          return 4;
+        }
+        last = t;
+        (id == 1 ? fromA : fromB)++;
+      }
+      if (fromA < fromB || fromB == 0 || merger.GetLateBlobCount() != 0) {
+        std::cerr << "Got " << fromA << " and " << fromB << " blobs with " <<
+          merger.GetLateBlobCount() << " late" << std::endl;
+        return 5;
+      }
+
+      merger.AddSource(quiet, 4);
+      for (int i = 0; i < 5; i++) {
+        uint32_t id = 0;
+        hrgls::datablob::DataBlob blob = merger.GetNextBlob(id, timeout);
+        int64_t age = MicrosecondsOf(api.GetCurrentSystemTime()) - MicrosecondsOf(blob.Time());
+        if (merger.GetStatus() != hrgls_STATUS_OKAY || age < 95000) {
+          std::cerr << "Blob was returned " << age << "us after it was made" << std::endl;
+          return 6;
+        }
+      }
+      a.SetStreamingState(false);
+      b.SetStreamingState(false);
+    }
+
+#ifdef __linux__
+    //------------------------------------------------------
+    // Recordings whose times are an hour from now are merged by time, and the last
+    // blob waits for a source that has run out until that source is removed.
+    std::string prefix = "test_merger_" + std::to_string(getpid());
+    std::string fileA = prefix + "_a.rec", fileB = prefix + "_b.rec", fileC = prefix + "_c.rec";
+    int64_t base = MicrosecondsOf(api.GetCurrentSystemTime()) + 3600LL * 1000000;
+    if (!RecordAt(fileA, base, { 10, 30, 50 }) || !RecordAt(fileB, base, { 20, 40, 60 }) ||
+        !RecordAt(fileC, base, { 0, 5 })) {
+      std::cerr << "Could not make recordings" << std::endl;
+      return 7;
+    }
+    {
+      struct timeval window = { 10, 0 };
+      hrgls::datablob::DataBlobMerger merger(api, window);
+      Replay a(api, fileA), b(api, fileB);
+      merger.AddSource(*a.source, 1);
+      merger.AddSource(*b.source, 2);
+      std::vector<int> offsets;
+      std::vector<uint32_t> ids;
+      ReadAll(merger, base, offsets, ids);
+      if (offsets != std::vector<int>({ 10, 20, 30, 40, 50 }) ||
+          ids != std::vector<uint32_t>({ 1, 2, 1, 2, 1 })) {
+        std::cerr << "Recordings were not merged in time order" << std::endl;
+        return 8;
+      }
+      if (merger.RemoveSource(*a.source) != hrgls_STATUS_OKAY ||
+          merger.RemoveSource(*a.source) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Could not remove a source" << std::endl;
+        return 9;
+      }
+      ReadAll(merger, base, offsets, ids);
+      if (offsets.size() != 6 || offsets.back() != 60 || ids.back() != 2) {
+        std::cerr << "Last blob was not released when its source was removed" << std::endl;
+        return 10;
+      }
+
+      // Blobs older than the last one returned are dropped and counted.
+      Replay c(api, fileC);
+      merger.AddSource(*c.source, 3);
+      ReadAll(merger, base, offsets, ids);
+      if (offsets.size() != 6 || merger.GetLateBlobCount() != 2) {
+        std::cerr << "Late blobs were not dropped" << std::endl;
+        return 11;
+      }
+    }
+    {
+      // Or delivered at once, out of order, as asked.
+      struct timeval window = {};
+      hrgls::datablob::DataBlobMerger merger(api, window, hrgls_LATE_BLOB_DELIVER);
+      Replay b(api, fileB);
+      merger.AddSource(*b.source, 2);
+      std::vector<int> offsets;
+      std::vector<uint32_t> ids;
+      ReadAll(merger, base, offsets, ids);
+      Replay c(api, fileC);
+      merger.AddSource(*c.source, 3);
+      ReadAll(merger, base, offsets, ids);
+      if (offsets != std::vector<int>({ 20, 40, 60, 0, 5 }) || ids.back() != 3 ||
+          merger.GetLateBlobCount() != 2) {
+        std::cerr << "Late blobs were not delivered" << std::endl;
+        return 12;
+      }
+    }
+    const std::string files[] = { fileA, fileB, fileC };
+    for (size_t i = 0; i < 3; i++) {
+      std::remove(files[i].c_str());
+      std::remove((files[i] + ".idx").c_str());
+    }
+#endif
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Verifies that moving DataBlob, Message and StreamProperties objects transfers
+// their contents and leaves the moved-from object empty but safe to use.
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <hrgls_api.hpp>
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    // StreamProperties
+    hrgls::StreamProperties sp;
+    sp.Rate(1000);
+    hrgls::StreamProperties sp2(std::move(sp));
+    if (sp2.Rate() != 1000) {
+      std::cerr << "Moved StreamProperties has wrong rate" << std::endl;
+      return 2;
+    }
+    if (sp.Rate(10) != hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Moved-from StreamProperties not empty" << std::endl;
+      return 3;
+    }
+    sp = sp2;
+    if (sp.Rate() != 1000) {
+      std::cerr << "Assignment to moved-from StreamProperties failed" << std::endl;
+      return 4;
+    }
+
+    // DataBlob
+    hrgls::datablob::DataBlobSource stream(api, sp2);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource" << std::endl;
+      return 5;
+    }
+    stream.SetStreamingState(true);
+    struct timeval timeout = { 2, 0 };
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not get blob" << std::endl;
+      return 6;
+    }
+    stream.SetStreamingState(false);
+    const uint8_t *data = blob.Data();
+    uint32_t size = blob.Size();
+    hrgls::datablob::DataBlob moved(std::move(blob));
+    if (moved.Data() != data || moved.Size() != size) {
+      std::cerr << "Moved DataBlob does not have the original data" << std::endl;
+      return 7;
+    }
+    if (blob.GetStatus() != hrgls_STATUS_NULL_OBJECT_POINTER ||
+        blob.Data() != nullptr || blob.Size() != 0) {
+      std::cerr << "Moved-from DataBlob not empty" << std::endl;
+      return 8;
+    }
+    blob.ReleaseData();
+    blob = std::move(moved);
+    if (blob.Data() != data) {
+      std::cerr << "Move assignment of DataBlob failed" << std::endl;
+      return 9;
+    }
+
+    // Message
+    struct timeval t = { 1, 2 };
+    hrgls::Message m("moving", t, hrgls_MESSAGE_MINIMUM_WARNING);
+    std::vector<hrgls::Message> v;
+    v.push_back(std::move(m));
+    if (v[0].Value() != "moving" || v[0].Level() != hrgls_MESSAGE_MINIMUM_WARNING) {
+      std::cerr << "Moved Message has wrong contents" << std::endl;
+      return 10;
+    }
+    if (m.GetStatus() != hrgls_STATUS_NULL_OBJECT_POINTER || !m.Value().empty()) {
+      std::cerr << "Moved-from Message not empty" << std::endl;
+      return 11;
+    }
+    m = v[0];
+    if (m.Value() != "moving") {
+      std::cerr << "Assignment to moved-from Message failed" << std::endl;
+      return 12;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlobMultiplexer returns blobs from all of its sources, taking turns among
+// them, and that it blocks when none of them has a blob.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <hrgls_api.hpp>
+
+static const uint32_t NUM_SOURCES = 3;
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+    hrgls::datablob::DataBlobMultiplexer mux(api);
+    if (mux.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobMultiplexer" << std::endl;
+      return 2;
+    }
+
+    hrgls::StreamProperties sp;
+    sp.Rate(200);
+    std::vector<std::unique_ptr<hrgls::datablob::DataBlobSource> > sources;
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      sources.emplace_back(new hrgls::datablob::DataBlobSource(api, sp));
+      if (sources.back()->GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not Open DataBlobSource " << i << std::endl;
+        return 3;
+      }
+      if (mux.AddSource(*sources.back(), 100 + i) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not add source " << i << std::endl;
+        return 4;
+      }
+    }
+
+    // Adding a source twice, or one from another API, fails.
+    if (mux.AddSource(*sources[0], 7) != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Duplicate source was not rejected" << std::endl;
+      return 5;
+    }
+    {
+      hrgls::API otherApi;
+      hrgls::datablob::DataBlobSource other(otherApi, sp);
+      if (mux.AddSource(other, 7) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Source from another API was not rejected" << std::endl;
+        return 6;
+      }
+      if (mux.RemoveSource(other) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Removal of unregistered source was not rejected" << std::endl;
+        return 7;
+      }
+    }
+
+    // With nothing streaming, we wait for the whole timeout.
+    uint32_t id = 0;
+    struct timeval timeout = { 0, 200000 };
+    auto start = std::chrono::steady_clock::now();
+    hrgls::datablob::DataBlob blob = mux.GetNextBlob(id, timeout);
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - start;
+    if (mux.GetStatus() != hrgls_STATUS_TIMEOUT || dt.count() < 0.15) {
+      std::cerr << "Expected to time out after waiting" << std::endl;
+      return 8;
+    }
+
+    // A single streaming source wakes us as soon as it sends.
+    sources[1]->SetStreamingState(true);
+    timeout = { 2, 0 };
+    start = std::chrono::steady_clock::now();
+    blob = mux.GetNextBlob(id, timeout);
+    dt = std::chrono::steady_clock::now() - start;
+    if (mux.GetStatus() != hrgls_STATUS_OKAY || id != 101 || blob.Size() == 0) {
+      std::cerr << "Did not get blob from streaming source" << std::endl;
+      return 9;
+    }
+    if (dt.count() > 0.5) {
+      std::cerr << "Waited " << dt.count() << " seconds for a blob" << std::endl;
+      return 10;
+    }
+    sources[1]->SetStreamingState(false);
+    while (mux.GetNextBlob(id).Size() > 0) {}
+
+    // Let all of the sources queue a backlog, then make sure that we take turns
+    // among them.
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      sources[i]->SetStreamingState(true);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      sources[i]->SetStreamingState(false);
+    }
+    std::vector<size_t> counts(NUM_SOURCES);
+    for (size_t i = 0; i < 3 * NUM_SOURCES; i++) {
+      blob = mux.GetNextBlob(id);
+      if (mux.GetStatus() != hrgls_STATUS_OKAY || id < 100 || id >= 100 + NUM_SOURCES) {
+        std::cerr << "Could not get blob " << i << " from backlog" << std::endl;
+        return 11;
+      }
+      counts[id - 100]++;
+    }
+    for (uint32_t i = 0; i < NUM_SOURCES; i++) {
+      if (counts[i] != 3) {
+        std::cerr << "Source " << i << " served " << counts[i]
+          << " times out of " << 3 * NUM_SOURCES << std::endl;
+        return 12;
+      }
+    }
+
+    // Removed and destroyed sources are no longer waited on.
+    if (mux.RemoveSource(*sources[0]) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not remove source" << std::endl;
+      return 13;
+    }
+    sources[1].reset();
+    while (mux.GetNextBlob(id).Size() > 0) {
+      if (id != 102) {
+        std::cerr << "Got blob from removed source " << id << std::endl;
+        return 14;
+      }
+    }
+    if (sources[0]->GetNextBlob().Size() == 0) {
+      std::cerr << "Removed source lost its blobs" << std::endl;
+      return 15;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
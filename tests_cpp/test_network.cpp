@@ -0,0 +1,184 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// an API created with an endpoint lists the sources of an API that has called
+// StartServer() and streams blobs from them over the loopback interface, in order
+// and with their original times, at the rate asked for.  Only does anything on Linux.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <hrgls_api.hpp>
+#include "test_helpers.hpp"
+
+int main(int argc, const char *argv[])
+{
+#ifdef __linux__
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    std::unique_ptr<hrgls::API> server(new hrgls::API);
+    if (server->GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open server API" << std::endl;
+      return 1;
+    }
+    server->StartServer("nonsense");
+    if (server->GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Bad server endpoint was not rejected" << std::endl;
+      return 2;
+    }
+    uint16_t port = server->StartServer("127.0.0.1:0");
+    if (server->GetStatus() != hrgls_STATUS_OKAY || port == 0) {
+      std::cerr << "Could not start server" << std::endl;
+      return 3;
+    }
+    server->StartServer("127.0.0.1:0");
+    if (server->GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Second server was not rejected" << std::endl;
+      return 4;
+    }
+    std::string endpoint = "127.0.0.1:" + std::to_string(port);
+
+    {
+      hrgls::API bad("", hrgls::NO_CREDENTIALS, 0, "no port");
+      if (bad.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Bad client endpoint was not rejected" << std::endl;
+        return 5;
+      }
+    }
+
+    // The remote API lists the server's sources.
+    hrgls::API client("", hrgls::NO_CREDENTIALS, 0, endpoint);
+    if (client.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open client API" << std::endl;
+      return 6;
+    }
+    std::vector<hrgls::DataBlobSourceDescription> local = server->GetAvailableDataBlobSources();
+    std::vector<hrgls::DataBlobSourceDescription> remote = client.GetAvailableDataBlobSources();
+    if (client.GetStatus() != hrgls_STATUS_OKAY || remote.size() != local.size() ||
+        remote.empty() || remote[0].Name() != local[0].Name()) {
+      std::cerr << "Remote source list does not match" << std::endl;
+      return 7;
+    }
+
+    // Names that the server does not have are rejected by it.
+    hrgls::StreamProperties sp;
+    {
+      hrgls::datablob::DataBlobSource missing(client, sp, "/no/such/source");
+      if (missing.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Remote source with a bad name was not rejected" << std::endl;
+        return 8;
+      }
+    }
+
+    // Blobs arrive in order with the server's times, at about the rate we asked for.
+    sp.Rate(100);
+    hrgls::datablob::DataBlobSource stream(client, sp, remote[1].Name());
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open remote DataBlobSource" << std::endl;
+      return 9;
+    }
+    if (stream.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start remote streaming" << std::endl;
+      return 10;
+    }
+    struct timeval timeout = { 1, 0 };
+    double last = 0;
+    size_t count = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (std::chrono::steady_clock::now() < end) {
+      hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+      if (stream.GetStatus() != hrgls_STATUS_OKAY || !CheckData(blob)) {
+        std::cerr << "Did not get good remote blob " << count << std::endl;
+        return 11;
+      }
+      double t = TimeOf(blob.Time());
+      if (t <= last || t > TimeOf(server->GetCurrentSystemTime())) {
+        std::cerr << "Remote blob " << count << " has a bad time" << std::endl;
+        return 12;
+      }
+      last = t;
+      count++;
+    }
+    if (count < 20 || count > 80) {
+      std::cerr << "Got " << count << " blobs in half a second at rate 100" << std::endl;
+      return 13;
+    }
+
+    // No more blobs arrive once streaming has been turned off.
+    stream.SetStreamingState(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stream.GetPendingBlobs();
+    struct timeval shortTimeout = { 0, 100000 };
+    stream.GetNextBlob(shortTimeout);
+    if (stream.GetStatus() != hrgls_STATUS_TIMEOUT) {
+      std::cerr << "Got a blob after streaming was turned off" << std::endl;
+      return 14;
+    }
+
+    // A consumer that is not reading holds back a fast producer that blocks when
+    // its queue is full, rather than losing blobs.
+    hrgls::StreamProperties fast;
+    fast.Rate(2000);
+    fast.QueueCapacity(4);
+    fast.OverflowPolicy(hrgls_OVERFLOW_BLOCK_PRODUCER);
+    hrgls::datablob::DataBlobSource blocked(client, fast, remote[0].Name());
+    blocked.SetStreamingState(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    last = 0;
+    for (size_t i = 0; i < 100; i++) {
+      hrgls::datablob::DataBlob blob = blocked.GetNextBlob(timeout);
+      if (blocked.GetStatus() != hrgls_STATUS_OKAY || TimeOf(blob.Time()) <= last) {
+        std::cerr << "Did not get blocked blob " << i << " in order" << std::endl;
+        return 15;
+      }
+      last = TimeOf(blob.Time());
+    }
+    if (blocked.GetDroppedBlobCount() != 0) {
+      std::cerr << "Blocking consumer dropped blobs" << std::endl;
+      return 16;
+    }
+
+    // When the server goes away, the client finds out.
+    server.reset();
+    bool lost = false;
+    for (int i = 0; i < 100 && !lost; i++) {
+      lost = stream.SetStreamingState(true) == hrgls_STATUS_CONNECTION_FAILED;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!lost) {
+      std::cerr << "Lost connection was not reported" << std::endl;
+      return 17;
+    }
+    client.GetAvailableDataBlobSources();
+    if (client.GetStatus() != hrgls_STATUS_CONNECTION_FAILED) {
+      std::cerr << "Listing sources without a server did not fail" << std::endl;
+      return 18;
+    }
+    hrgls::datablob::DataBlobSource orphan(client, sp);
+    if (orphan.GetStatus() != hrgls_STATUS_CONNECTION_FAILED) {
+      std::cerr << "Opened a source without a server" << std::endl;
+      return 19;
+    }
+  }
+#endif
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// each thread only sees the status of the calls that it made, including when many
+// short-lived threads share the same objects.
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <hrgls_api.hpp>
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    hrgls_Status status = api.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 1;
+    }
+
+    hrgls::StreamProperties sp;
+    hrgls::datablob::DataBlobSource stream(api, sp);
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 2;
+    }
+
+    // Leave a timeout status for the main thread to read after the others are done.
+    stream.GetNextBlob();
+
+    // Several rounds of threads each get a timeout status of their own, along with
+    // the list of sources, which is latched per thread by the C interface.
+    std::atomic<size_t> failures(0);
+    for (size_t round = 0; round < 10; round++) {
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < 8; i++) {
+        threads.push_back(std::thread([&]() {
+          if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+            failures++;
+          }
+          stream.GetNextBlob();
+          if (stream.GetStatus() != hrgls_STATUS_TIMEOUT) {
+            failures++;
+          }
+          if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+            failures++;
+          }
+          if (api.GetAvailableDataBlobSources().size() != 2) {
+            failures++;
+          }
+          if (api.GetStatus() != hrgls_STATUS_OKAY) {
+            failures++;
+          }
+        }));
+      }
+      for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+      }
+    }
+    if (failures != 0) {
+      std::cerr << failures << " unexpected per-thread statuses" << std::endl;
+      return 3;
+    }
+
+    status = stream.GetStatus();
+    if (status != hrgls_STATUS_TIMEOUT) {
+      std::cerr << "Main thread status changed by other threads: "
+        << hrgls_ErrorMessage(status) << std::endl;
+      return 4;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
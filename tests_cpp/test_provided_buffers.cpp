@@ -0,0 +1,191 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlobSource that has been given buffers writes its blobs into them, hands
+// each back once when the last reference to its blob is released, drops blobs when
+// none are free, hands back the unused ones when it is destroyed, and refuses bad
+// buffers.
+
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <hrgls_api.hpp>
+
+/// @brief How many times each buffer has been handed back.
+static std::mutex g_mutex;
+static std::map<const uint8_t *, int> g_returned;
+
+static void ReturnBuffer(void *userData, const uint8_t *buffer)
+{
+  if (userData == &g_returned) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_returned[buffer]++;
+  }
+}
+
+static size_t ReturnedCount()
+{
+  std::lock_guard<std::mutex> lock(g_mutex);
+  size_t ret = 0;
+  for (std::map<const uint8_t *, int>::const_iterator i = g_returned.begin();
+       i != g_returned.end(); ++i) {
+    ret += i->second;
+  }
+  return ret;
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    const uint32_t payloadSize = 1000;
+    const uint32_t bufferSize = 4096;
+    const size_t numBuffers = 4;
+    std::vector<std::vector<uint8_t> > storage(numBuffers, std::vector<uint8_t>(bufferSize));
+    std::vector<uint8_t*> buffers;
+    for (size_t i = 0; i < numBuffers; i++) {
+      buffers.push_back(storage[i].data());
+    }
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+    hrgls::StreamProperties sp;
+    sp.Rate(1000);
+    sp.PayloadSize(payloadSize);
+
+    {
+      hrgls::datablob::DataBlobSource source(api, sp);
+      if (source.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create DataBlobSource" << std::endl;
+        return 2;
+      }
+
+      //------------------------------------------------------
+      // Bad buffers are refused, including ones too small for the blobs.
+      std::vector<uint8_t*> withNull(buffers);
+      withNull.push_back(nullptr);
+      if (source.ProvideBuffers(std::vector<uint8_t*>(), bufferSize, ReturnBuffer, &g_returned) !=
+            hrgls_STATUS_BAD_PARAMETER ||
+          source.ProvideBuffers(withNull, bufferSize, ReturnBuffer, &g_returned) !=
+            hrgls_STATUS_BAD_PARAMETER ||
+          source.ProvideBuffers(buffers, bufferSize, nullptr, &g_returned) !=
+            hrgls_STATUS_BAD_PARAMETER ||
+          source.ProvideBuffers(buffers, payloadSize - 1, ReturnBuffer, &g_returned) !=
+            hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_DataBlobSourceProvideBuffers(nullptr, buffers.data(), 1, bufferSize,
+            ReturnBuffer, &g_returned) != hrgls_STATUS_NULL_OBJECT_POINTER) {
+        std::cerr << "Bad buffers were accepted" << std::endl;
+        return 3;
+      }
+      if (ReturnedCount() != 0) {
+        std::cerr << "Refused buffers were handed back" << std::endl;
+        return 4;
+      }
+
+      //------------------------------------------------------
+      // Each blob is written into one of the buffers, which are all in use once
+      // we are holding as many blobs as there are buffers.
+      if (source.ProvideBuffers(buffers, bufferSize, ReturnBuffer, &g_returned) !=
+            hrgls_STATUS_OKAY || source.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not provide buffers" << std::endl;
+        return 5;
+      }
+      struct timeval timeout = { 2, 0 };
+      std::vector<hrgls::datablob::DataBlob> held;
+      std::map<const uint8_t *, int> used;
+      for (size_t i = 0; i < numBuffers; i++) {
+        held.push_back(source.GetNextBlob(timeout));
+        const uint8_t *data = held.back().Data();
+        if (held.back().Size() != payloadSize || used[data]++ != 0 ||
+            (data != buffers[0] && data != buffers[1] && data != buffers[2] && data != buffers[3])) {
+          std::cerr << "Blob " << i << " was not written into a free provided buffer" << std::endl;
+          return 6;
+        }
+        if (data[1] != 1 || data[payloadSize - 1] != static_cast<uint8_t>((payloadSize - 1) % 256)) {
+          std::cerr << "Bad data in blob " << i << std::endl;
+          return 7;
+        }
+      }
+
+      // With every buffer held, new blobs are dropped rather than allocated.
+      uint64_t dropped = source.GetDroppedBlobCount();
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      if (source.GetDroppedBlobCount() <= dropped) {
+        std::cerr << "Blobs were not dropped with no free buffers" << std::endl;
+        return 8;
+      }
+      if (ReturnedCount() != 0) {
+        std::cerr << "Buffers were handed back while their blobs were held" << std::endl;
+        return 9;
+      }
+
+      // A copy keeps the data; the buffer comes back when the last reference goes.
+      hrgls::datablob::DataBlob copy(held[0]);
+      const uint8_t *copied = copy.Data();
+      held.clear();
+      if (ReturnedCount() != numBuffers - 1 || g_returned.count(copied) != 0) {
+        std::cerr << "Buffers were not handed back when their blobs were released" << std::endl;
+        return 10;
+      }
+      copy = hrgls::datablob::DataBlob();
+      if (ReturnedCount() != numBuffers || g_returned[copied] != 1) {
+        std::cerr << "Buffer was not handed back when the last copy was released" << std::endl;
+        return 11;
+      }
+
+      //------------------------------------------------------
+      // Providing the handed-back buffers again keeps the source streaming.
+      if (source.ProvideBuffers(buffers, bufferSize, ReturnBuffer, &g_returned) !=
+            hrgls_STATUS_OKAY) {
+        std::cerr << "Could not provide buffers again" << std::endl;
+        return 12;
+      }
+      source.GetPendingBlobs();
+      hrgls::datablob::DataBlob again = source.GetNextBlob(timeout);
+      if (used.count(again.Data()) == 0) {
+        std::cerr << "Blob was not written into a buffer provided again" << std::endl;
+        return 13;
+      }
+      source.SetStreamingState(false);
+    }
+
+    //------------------------------------------------------
+    // Destroying the source hands back the buffers not holding a blob, and every
+    // buffer comes back exactly once for each time it was provided.
+    if (ReturnedCount() != 2 * numBuffers) {
+      std::cerr << "Buffers were not all handed back" << std::endl;
+      return 14;
+    }
+    for (size_t i = 0; i < numBuffers; i++) {
+      if (g_returned[buffers[i]] != 2) {
+        std::cerr << "Buffer " << i << " was handed back " << g_returned[buffers[i]] <<
+          " times" << std::endl;
+        return 15;
+      }
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
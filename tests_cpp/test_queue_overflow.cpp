@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// the blob queue is bounded by its QueueCapacity and that each OverflowPolicy
+// behaves as described when the consumer falls behind.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <hrgls_api.hpp>
+
+static const uint32_t CAPACITY = 10;
+
+static double Seconds(const struct timeval &t)
+{
+  return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+/// Stream from a source with the specified policy for long enough to overflow
+/// its queue, then drain it.
+/// @return 0 on success, nonzero on failure.
+static int Fill(hrgls::API &api, hrgls_OverflowPolicy policy,
+  std::vector<hrgls::datablob::DataBlob> &blobs, uint64_t &dropped, double &start)
+{
+  hrgls::StreamProperties sp;
+  sp.Rate(1000);
+  if (sp.QueueCapacity(CAPACITY) != hrgls_STATUS_OKAY ||
+      sp.OverflowPolicy(policy) != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not set queue properties" << std::endl;
+    return 1;
+  }
+  hrgls::datablob::DataBlobSource stream(api, sp);
+  if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not Open DataBlobSource" << std::endl;
+    return 2;
+  }
+  start = Seconds(api.GetCurrentSystemTime());
+  stream.SetStreamingState(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  stream.SetStreamingState(false);
+  blobs = stream.GetPendingBlobs();
+  dropped = stream.GetDroppedBlobCount();
+  if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Could not read dropped count" << std::endl;
+    return 3;
+  }
+  if (blobs.size() != CAPACITY) {
+    std::cerr << "Got " << blobs.size() << " blobs from a queue of capacity "
+      << CAPACITY << std::endl;
+    return 4;
+  }
+
+  if (policy == hrgls_OVERFLOW_BLOCK_PRODUCER) {
+    // The producer has been holding one more blob, which it should hand over
+    // once there is room and streaming is back on.
+    stream.SetStreamingState(true);
+    struct timeval timeout = { 2, 0 };
+    hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+    if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Blocked producer did not resume" << std::endl;
+      return 5;
+    }
+    stream.SetStreamingState(false);
+  }
+  return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    // Check defaults and parameter validation.
+    hrgls::StreamProperties sp;
+    if (sp.QueueCapacity() != 256 || sp.OverflowPolicy() != hrgls_OVERFLOW_DROP_OLDEST) {
+      std::cerr << "Unexpected default queue properties" << std::endl;
+      return 2;
+    }
+    if (sp.QueueCapacity(0) != hrgls_STATUS_BAD_PARAMETER ||
+        sp.OverflowPolicy(77) != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Bad queue properties not rejected" << std::endl;
+      return 3;
+    }
+
+    std::vector<hrgls::datablob::DataBlob> blobs;
+    uint64_t dropped;
+    double start;
+
+    // Dropping the oldest keeps the most-recent blobs.
+    if (Fill(api, hrgls_OVERFLOW_DROP_OLDEST, blobs, dropped, start) != 0) {
+      return 10;
+    }
+    if (dropped == 0 || Seconds(blobs.front().Time()) - start < 0.1) {
+      std::cerr << "Drop-oldest did not drop the oldest blobs" << std::endl;
+      return 11;
+    }
+
+    // Dropping the newest keeps the first blobs.
+    if (Fill(api, hrgls_OVERFLOW_DROP_NEWEST, blobs, dropped, start) != 0) {
+      return 20;
+    }
+    if (dropped == 0 || Seconds(blobs.back().Time()) - start > 0.1) {
+      std::cerr << "Drop-newest did not drop the newest blobs" << std::endl;
+      return 21;
+    }
+
+    // Blocking the producer drops nothing.
+    if (Fill(api, hrgls_OVERFLOW_BLOCK_PRODUCER, blobs, dropped, start) != 0) {
+      return 30;
+    }
+    if (dropped != 0) {
+      std::cerr << "Block-producer dropped " << dropped << " blobs" << std::endl;
+      return 31;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// blobs written by a DataBlobRecorder are replayed by a DataBlobSource with their
+// times and data, as fast as possible or at the recorded rate, that seeking finds
+// the right blob, and that recordings with a missing index or a partial last record
+// are still replayed.  Only does anything on Linux.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <hrgls_api.hpp>
+#include "test_helpers.hpp"
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+static const size_t NUM_BLOBS = 40;
+
+static bool SameTime(struct timeval a, struct timeval b)
+{
+  return a.tv_sec == b.tv_sec && a.tv_usec == b.tv_usec;
+}
+
+/// @return The number of blobs replayed as fast as possible before running out, or -1
+///         if one of them was not as recorded.
+static int ReplayAll(hrgls::API &api, const std::string &name,
+  const std::vector<struct timeval> &times)
+{
+  hrgls::StreamProperties sp;
+  sp.QueueCapacity(8);
+  sp.OverflowPolicy(hrgls_OVERFLOW_BLOCK_PRODUCER);
+  hrgls::datablob::DataBlobSource replay(api, sp, name);
+  if (replay.GetStatus() != hrgls_STATUS_OKAY ||
+      replay.SetReplayPacing(hrgls_REPLAY_AS_FAST_AS_POSSIBLE) != hrgls_STATUS_OKAY) {
+    return -1;
+  }
+  replay.SetStreamingState(true);
+  struct timeval timeout = { 0, 200000 };
+  int count = 0;
+  while (true) {
+    hrgls::datablob::DataBlob blob = replay.GetNextBlob(timeout);
+    if (replay.GetStatus() != hrgls_STATUS_OKAY) {
+      return count;
+    }
+    if (static_cast<size_t>(count) >= times.size() || !CheckData(blob) ||
+        !SameTime(blob.Time(), times[count])) {
+      return -1;
+    }
+    count++;
+  }
+}
+
+static std::vector<uint8_t> ReadFile(const std::string &fileName)
+{
+  std::vector<uint8_t> ret;
+  FILE *f = fopen(fileName.c_str(), "rb");
+  if (f) {
+    uint8_t buf[4096];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+      ret.insert(ret.end(), buf, buf + got);
+    }
+    fclose(f);
+  }
+  return ret;
+}
+
+static bool WriteFile(const std::string &fileName, const std::vector<uint8_t> &data)
+{
+  FILE *f = fopen(fileName.c_str(), "wb");
+  if (!f) {
+    return false;
+  }
+  bool ret = fwrite(data.data(), 1, data.size(), f) == data.size();
+  return fclose(f) == 0 && ret;
+}
+
+/// @return The number of good blobs replayed, or -1 if any was bad.
+static int CountReplayed(hrgls::API &api, const std::string &name)
+{
+  hrgls::StreamProperties sp;
+  sp.QueueCapacity(8);
+  sp.OverflowPolicy(hrgls_OVERFLOW_BLOCK_PRODUCER);
+  hrgls::datablob::DataBlobSource replay(api, sp, name);
+  if (replay.GetStatus() != hrgls_STATUS_OKAY ||
+      replay.SetReplayPacing(hrgls_REPLAY_AS_FAST_AS_POSSIBLE) != hrgls_STATUS_OKAY) {
+    return -1;
+  }
+  replay.SetStreamingState(true);
+  struct timeval timeout = { 0, 200000 };
+  int count = 0;
+  while (true) {
+    hrgls::datablob::DataBlob blob = replay.GetNextBlob(timeout);
+    if (replay.GetStatus() != hrgls_STATUS_OKAY) {
+      return count;
+    }
+    if (!CheckData(blob)) {
+      return -1;
+    }
+    count++;
+  }
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+#ifdef __linux__
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    std::string fileName = "test_record_replay_" + std::to_string(getpid()) + ".rec";
+    std::string indexName = fileName + ".idx";
+    std::string name = "/hrgls/replay/" + fileName;
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    {
+      hrgls::datablob::DataBlobRecorder bad("/no/such/directory/file.rec");
+      if (bad.GetStatus() != hrgls_STATUS_FILE_ERROR) {
+        std::cerr << "Recorder in a bad directory did not fail" << std::endl;
+        return 2;
+      }
+    }
+
+    // Record blobs from a source.
+    std::vector<struct timeval> times;
+    {
+      hrgls::datablob::DataBlobRecorder recorder(fileName);
+      if (recorder.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create recorder" << std::endl;
+        return 3;
+      }
+      hrgls::StreamProperties sp;
+      sp.Rate(500);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      stream.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      while (times.size() < NUM_BLOBS) {
+        hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+        if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+          std::cerr << "Could not get blob to record" << std::endl;
+          return 4;
+        }
+        if (recorder.Record(blob) != hrgls_STATUS_OKAY) {
+          std::cerr << "Could not record blob" << std::endl;
+          return 5;
+        }
+        times.push_back(blob.Time());
+      }
+    }
+
+    // The recording can be listed; other files cannot.
+    if (api.AddReplayFile("no_such_file.rec") != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Missing recording was added" << std::endl;
+      return 6;
+    }
+    if (api.AddReplayFile(fileName) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not add recording" << std::endl;
+      return 7;
+    }
+    bool listed = false;
+    std::vector<hrgls::DataBlobSourceDescription> sources = api.GetAvailableDataBlobSources();
+    for (size_t i = 0; i < sources.size(); i++) {
+      listed = listed || sources[i].Name() == name;
+    }
+    if (!listed) {
+      std::cerr << "Recording was not listed" << std::endl;
+      return 8;
+    }
+
+    // Everything comes back as it was recorded.
+    if (ReplayAll(api, name, times) != static_cast<int>(NUM_BLOBS)) {
+      std::cerr << "Replay did not match recording" << std::endl;
+      return 9;
+    }
+
+    hrgls::StreamProperties sp;
+    hrgls::datablob::DataBlobSource live(api, sp);
+    if (live.SetReplayPacing(hrgls_REPLAY_RECORDED_RATE) != hrgls_STATUS_BAD_PARAMETER ||
+        live.SeekReplay(times[0]) != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Replay controls accepted by a live source" << std::endl;
+      return 10;
+    }
+
+    hrgls::datablob::DataBlob kept;
+    {
+      hrgls::datablob::DataBlobSource replay(api, sp, name);
+      if (replay.SetReplayPacing(42) != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Bad pacing was accepted" << std::endl;
+        return 11;
+      }
+
+      // Seeking finds the blob recorded at a time; at the recorded rate, the blobs
+      // after it take about as long to arrive as they took to record.
+      const size_t from = 20;
+      if (replay.SeekReplay(times[from]) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not seek" << std::endl;
+        return 12;
+      }
+      replay.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = from; i < NUM_BLOBS; i++) {
+        hrgls::datablob::DataBlob blob = replay.GetNextBlob(timeout);
+        if (replay.GetStatus() != hrgls_STATUS_OKAY || !SameTime(blob.Time(), times[i])) {
+          std::cerr << "Did not get recorded blob " << i << " after seeking" << std::endl;
+          return 13;
+        }
+        if (i == from) {
+          kept = blob;
+          start = std::chrono::steady_clock::now();
+        }
+      }
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      double recorded = (times[NUM_BLOBS - 1].tv_sec - times[from].tv_sec) +
+        1e-6 * (times[NUM_BLOBS - 1].tv_usec - times[from].tv_usec);
+      if (elapsed < 0.8 * recorded) {
+        std::cerr << "Replay took " << elapsed << "s for blobs recorded over " << recorded << "s"
+          << std::endl;
+        return 14;
+      }
+    }
+
+    // Blobs still point at their data after the replaying source is gone.
+    if (!CheckData(kept) || !SameTime(kept.Time(), times[20])) {
+      std::cerr << "Blob did not outlive its replay" << std::endl;
+      return 15;
+    }
+
+    // A damaged index cannot hand out blobs that point outside the file.  Moving an
+    // entry into the middle of its record's data makes its size nonsense, so that
+    // blob is dropped; an entry whose time goes backwards ends the index, and the
+    // records after it are found by reading through them.
+    std::vector<uint8_t> index = ReadFile(indexName);
+    if (index.size() != 16 + 16 * NUM_BLOBS) {
+      std::cerr << "Unexpected index size" << std::endl;
+      return 18;
+    }
+    std::vector<uint8_t> damaged = index;
+    damaged[16 + 16 * 5 + 8] += 16;
+    if (!WriteFile(indexName, damaged) ||
+        CountReplayed(api, name) != static_cast<int>(NUM_BLOBS - 1)) {
+      std::cerr << "Replay with a bad index entry did not skip it" << std::endl;
+      return 19;
+    }
+    damaged = index;
+    memset(&damaged[16 + 16 * 10], 0, 8);
+    if (!WriteFile(indexName, damaged) ||
+        ReplayAll(api, name, times) != static_cast<int>(NUM_BLOBS)) {
+      std::cerr << "Replay with an out-of-order index did not match recording" << std::endl;
+      return 20;
+    }
+
+    // Without the index the records are found by reading through them, and a partial
+    // last record is ignored.
+    std::remove(indexName.c_str());
+    if (ReplayAll(api, name, times) != static_cast<int>(NUM_BLOBS)) {
+      std::cerr << "Replay without index did not match recording" << std::endl;
+      return 16;
+    }
+    if (truncate(fileName.c_str(), 16 + (16 + 256) * NUM_BLOBS - 10) != 0 ||
+        ReplayAll(api, name, times) != static_cast<int>(NUM_BLOBS - 1)) {
+      std::cerr << "Replay of partial recording did not match" << std::endl;
+      return 17;
+    }
+    std::remove(fileName.c_str());
+  }
+#endif
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
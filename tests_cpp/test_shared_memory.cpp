@@ -0,0 +1,214 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlobSource published with PublishSharedMemory() delivers its blobs to a
+// DataBlobSource attached in another process, and that a blob held by the consumer
+// is not overwritten while more blobs stream past it.  Only does anything on Linux.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <hrgls_api.hpp>
+#include "test_helpers.hpp"
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+static const uint32_t CAPACITY = 16;
+
+/// Runs in the child process, attaching to the ring once the parent has published it.
+static int Consume(const std::string &name)
+{
+  hrgls::API api;
+  if (api.GetStatus() != hrgls_STATUS_OKAY) {
+    std::cerr << "Child could not Open API" << std::endl;
+    return 20;
+  }
+  hrgls::StreamProperties sp;
+  sp.QueueCapacity(CAPACITY);
+  std::unique_ptr<hrgls::datablob::DataBlobSource> stream;
+  for (int tries = 0; tries < 200; tries++) {
+    stream.reset(new hrgls::datablob::DataBlobSource(api, sp, "/hrgls/shm/" + name));
+    if (stream->GetStatus() == hrgls_STATUS_OKAY) {
+      break;
+    }
+    stream.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if (!stream) {
+    std::cerr << "Child could not attach" << std::endl;
+    return 21;
+  }
+  if (stream->GetInfo().Name() != "/hrgls/shm/" + name) {
+    std::cerr << "Child got wrong name" << std::endl;
+    return 22;
+  }
+  stream->SetStreamingState(true);
+
+  // Hold on to the first blob while several ring's worth go by.
+  struct timeval timeout = { 1, 0 };
+  hrgls::datablob::DataBlob held = stream->GetNextBlob(timeout);
+  if (stream->GetStatus() != hrgls_STATUS_OKAY || !CheckData(held)) {
+    std::cerr << "Child did not get a good first blob" << std::endl;
+    return 23;
+  }
+  double heldTime = TimeOf(held);
+  double last = heldTime;
+  for (uint32_t i = 0; i < 4 * CAPACITY; i++) {
+    hrgls::datablob::DataBlob blob = stream->GetNextBlob(timeout);
+    if (stream->GetStatus() != hrgls_STATUS_OKAY || !CheckData(blob)) {
+      std::cerr << "Child did not get good blob " << i << std::endl;
+      return 24;
+    }
+    if (TimeOf(blob) <= last) {
+      std::cerr << "Child got blob " << i << " out of order" << std::endl;
+      return 25;
+    }
+    last = TimeOf(blob);
+  }
+  if (TimeOf(held) != heldTime || !CheckData(held)) {
+    std::cerr << "Held blob was overwritten" << std::endl;
+    return 26;
+  }
+  return 0;
+}
+#endif
+
+int main(int argc, const char *argv[])
+{
+#ifdef __linux__
+  // Fork before making any threads.
+  std::string name = "test_shared_memory_" + std::to_string(getpid());
+  pid_t child = fork();
+  if (child < 0) {
+    std::cerr << "Could not fork" << std::endl;
+    return 1;
+  }
+  if (child == 0) {
+    _exit(Consume(name));
+  }
+
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 2;
+    }
+    hrgls::StreamProperties sp;
+    sp.Rate(500);
+    sp.QueueCapacity(CAPACITY);
+    std::unique_ptr<hrgls::datablob::DataBlobSource> stream(
+      new hrgls::datablob::DataBlobSource(api, sp));
+    if (stream->GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open DataBlobSource" << std::endl;
+      return 3;
+    }
+
+    // Bad names and second publications are rejected; attaching to a ring
+    // that does not exist fails.  Names are limited to characters that are safe in
+    // a file name and must fit under /dev/shm along with the prefix.
+    const std::string longest = name + std::string(245 - name.size(), 'x');
+    if (stream->PublishSharedMemory("") != hrgls_STATUS_BAD_PARAMETER ||
+        stream->PublishSharedMemory("a/b") != hrgls_STATUS_BAD_PARAMETER ||
+        stream->PublishSharedMemory("hrgls/replay/x") != hrgls_STATUS_BAD_PARAMETER ||
+        stream->PublishSharedMemory("a b") != hrgls_STATUS_BAD_PARAMETER ||
+        stream->PublishSharedMemory(longest + "x") != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Bad name was not rejected" << std::endl;
+      return 4;
+    }
+    for (const std::string &bad : { std::string("/hrgls/shm/hrgls/replay/x"),
+                                    std::string("/hrgls/shm/a b"),
+                                    "/hrgls/shm/" + longest + "x" }) {
+      hrgls::datablob::DataBlobSource attached(api, sp, bad);
+      if (attached.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Attached with a bad name" << std::endl;
+        return 4;
+      }
+    }
+    {
+      hrgls::datablob::DataBlobSource other(api, sp);
+      if (other.PublishSharedMemory(longest) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not publish with the longest name" << std::endl;
+        return 4;
+      }
+    }
+    if (stream->PublishSharedMemory(name) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not publish" << std::endl;
+      return 5;
+    }
+    if (stream->PublishSharedMemory(name) != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Second publication was not rejected" << std::endl;
+      return 6;
+    }
+    {
+      hrgls::datablob::DataBlobSource missing(api, sp, "/hrgls/shm/" + name + "_missing");
+      if (missing.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Attached to a ring that does not exist" << std::endl;
+        return 7;
+      }
+    }
+    if (stream->SetStreamingState(true) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start streaming" << std::endl;
+      return 8;
+    }
+
+    // A consumer in this process gets the blobs too.
+    {
+      hrgls::datablob::DataBlobSource local(api, sp, "/hrgls/shm/" + name);
+      if (local.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not attach locally" << std::endl;
+        return 9;
+      }
+      local.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      hrgls::datablob::DataBlob blob = local.GetNextBlob(timeout);
+      if (local.GetStatus() != hrgls_STATUS_OKAY || !CheckData(blob)) {
+        std::cerr << "Local consumer did not get a good blob" << std::endl;
+        return 10;
+      }
+    }
+
+    int childStatus = 0;
+    if (waitpid(child, &childStatus, 0) != child || !WIFEXITED(childStatus)) {
+      std::cerr << "Child did not exit" << std::endl;
+      return 11;
+    }
+    if (WEXITSTATUS(childStatus) != 0) {
+      std::cerr << "Child failed with code " << WEXITSTATUS(childStatus) << std::endl;
+      return 12;
+    }
+
+    // Once the publisher is gone, its ring can no longer be attached to.
+    stream.reset();
+    hrgls::datablob::DataBlobSource gone(api, sp, "/hrgls/shm/" + name);
+    if (gone.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+      std::cerr << "Attached to a ring after its publisher was destroyed" << std::endl;
+      return 13;
+    }
+  }
+#endif
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation as a scaling and
+// soak test.  It streams from N APIs with M DataBlobSources each, taking the blobs of
+// each source with a stream callback, with K threads calling GetNextBlob(), or with K
+// threads calling GetPendingBlobs(), in turn.  While they stream, it keeps creating
+// and destroying other sources on short-lived threads.  At regular intervals it prints
+// the throughput, the 99th-percentile latency, the queue depths, the resident memory,
+// the numbers of threads and open file descriptors, and how many handles and buffers
+// have had to be allocated rather than reused.  It fails if any queue is past its
+// capacity, if streaming stops, or if, after a warm-up, memory, threads, descriptors,
+// handle or buffer allocations, or latency grow past the limits below.
+//
+// It runs for a few seconds by default; pass --seconds to soak for longer.  The resource
+// counts are only read on Linux.
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <hrgls_api.hpp>
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+/// Most that resident memory may grow after the warm-up, in bytes.
+static const double MAX_RSS_GROWTH = 32.0 * 1024 * 1024;
+
+/// Most that the 99th-percentile latency of an interval may be, as a multiple of that
+/// during the warm-up.  Latencies up to MIN_LATENCY_LIMIT are always accepted, so that
+/// a short pause on a busy machine is not taken for drift.
+static const double MAX_LATENCY_RATIO = 8;
+static const double MIN_LATENCY_LIMIT = 50e-3;
+
+/// Most handles and buffers that may be allocated after the warm-up for each source.
+/// Once every queue has filled, they should all come from their pools.
+static const uint64_t MAX_ALLOCATIONS_PER_SOURCE = 256;
+
+static const double RATE = 1000;
+static const uint32_t QUEUE_CAPACITY = 64;
+
+/// How the blobs of a source are taken.
+enum Mode { CALLBACK, NEXT_BLOB, PENDING_BLOBS };
+static const char *ModeName(Mode mode)
+{
+  switch (mode) {
+  case CALLBACK: return "callback";
+  case NEXT_BLOB: return "GetNextBlob";
+  default: return "GetPendingBlobs";
+  }
+}
+
+static std::atomic<bool> g_quit(false);
+static std::atomic<uint64_t> g_blobs(0);
+static std::atomic<uint64_t> g_badBlobs(0);
+
+/// Checks the data of each blob and counts it.
+static void CheckBlob(hrgls::datablob::DataBlob &blob)
+{
+  if (blob.Size() == 0 || blob.Data()[1] != 1) {
+    g_badBlobs++;
+  }
+  g_blobs++;
+}
+
+static void CallbackHandler(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  CheckBlob(blob);
+}
+
+/// Takes blobs until told to quit.  Each consumer holds on to its last few blobs and
+/// releases the data of every other one explicitly, as clients do.
+static void Consume(hrgls::datablob::DataBlobSource *source, Mode mode)
+{
+  struct timeval timeout = { 0, 50000 };
+  std::vector<hrgls::datablob::DataBlob> held(4);
+  size_t count = 0;
+  while (!g_quit) {
+    std::vector<hrgls::datablob::DataBlob> blobs;
+    if (mode == NEXT_BLOB) {
+      hrgls::datablob::DataBlob blob = source->GetNextBlob(timeout);
+      if (source->GetStatus() == hrgls_STATUS_OKAY) {
+        blobs.push_back(std::move(blob));
+      }
+    } else {
+      blobs = source->GetPendingBlobs(32, timeout);
+    }
+    for (size_t i = 0; i < blobs.size(); i++) {
+      CheckBlob(blobs[i]);
+      if (++count % 2 == 0) {
+        blobs[i].ReleaseData();
+      }
+      held[count % held.size()] = std::move(blobs[i]);
+    }
+  }
+}
+
+/// Creates a source, takes a few blobs from it, and destroys it, all on a thread that
+/// then exits.
+static void Churn(hrgls::API *api)
+{
+  hrgls::StreamProperties sp;
+  sp.Rate(RATE);
+  hrgls::datablob::DataBlobSource source(*api, sp);
+  source.SetStreamingState(true);
+  struct timeval timeout = { 0, 100000 };
+  for (int i = 0; i < 5; i++) {
+    hrgls::datablob::DataBlob blob = source.GetNextBlob(timeout);
+  }
+  source.SetStreamingState(false);
+  api->GetStatus();
+}
+
+/// Resources used by the process, all 0 where they cannot be read.
+struct Resources {
+  double rss = 0;
+  uint64_t threads = 0;
+  uint64_t fds = 0;
+};
+
+static Resources ReadResources()
+{
+  Resources ret;
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  double pages = 0, resident = 0;
+  if (statm >> pages >> resident) {
+    ret.rss = resident * sysconf(_SC_PAGESIZE);
+  }
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 8, "Threads:") == 0) {
+      ret.threads = std::strtoull(line.c_str() + 8, nullptr, 10);
+    }
+  }
+  if (DIR *dir = opendir("/proc/self/fd")) {
+    while (struct dirent *entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        ret.fds++;
+      }
+    }
+    closedir(dir);
+    ret.fds--;    // The one that we are reading it with.
+  }
+#endif
+  return ret;
+}
+
+/// What was measured over one interval.
+struct Sample {
+  double seconds;
+  double rate;
+  double latency99;
+  uint64_t queued;
+  Resources resources;
+  uint64_t handleMisses;
+  uint64_t bufferMisses;
+};
+
+int main(int argc, const char *argv[])
+{
+  double seconds = 5;
+  int numAPIs = 2, numSources = 3, numConsumers = 2;
+  for (int i = 1; i < argc; i++) {
+    int *count = nullptr;
+    if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = std::atof(argv[++i]);
+    } else if (strcmp(argv[i], "--apis") == 0) {
+      count = &numAPIs;
+    } else if (strcmp(argv[i], "--sources") == 0) {
+      count = &numSources;
+    } else if (strcmp(argv[i], "--consumers") == 0) {
+      count = &numConsumers;
+    } else {
+      seconds = 0;
+    }
+    if (count) {
+      *count = (i + 1 < argc) ? std::atoi(argv[++i]) : 0;
+    }
+    if (seconds <= 0 || numAPIs <= 0 || numSources <= 0 || numConsumers <= 0) {
+      std::cerr << "Usage: " << argv[0] << " [--seconds SECONDS] [--apis N]"
+        " [--sources PER_API] [--consumers PER_SOURCE]" << std::endl;
+      return -1;
+    }
+  }
+  double interval = seconds / 10;
+  if (interval < 0.25) {
+    interval = 0.25;
+  } else if (interval > 10) {
+    interval = 10;
+  }
+  size_t warmup = static_cast<size_t>(seconds / 4 / interval);
+  if (warmup < 1) {
+    warmup = 1;
+  }
+
+  int ret = 0;
+  std::vector<Sample> samples;
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    //------------------------------------------------------
+    // Bring up the APIs, their sources, and the consumers.
+    std::vector<std::unique_ptr<hrgls::API> > apis;
+    std::vector<std::unique_ptr<hrgls::datablob::DataBlobSource> > sources;
+    std::vector<std::thread> consumers;
+    hrgls::StreamProperties sp;
+    sp.Rate(RATE);
+    sp.QueueCapacity(QUEUE_CAPACITY);
+    for (int a = 0; a < numAPIs; a++) {
+      apis.emplace_back(new hrgls::API(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS,
+        numConsumers));
+      if (apis.back()->GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not Open API " << a << std::endl;
+        return 1;
+      }
+      for (int s = 0; s < numSources; s++) {
+        Mode mode = static_cast<Mode>(sources.size() % 3);
+        sources.emplace_back(new hrgls::datablob::DataBlobSource(*apis.back(), sp));
+        hrgls::datablob::DataBlobSource *source = sources.back().get();
+        if (source->GetStatus() != hrgls_STATUS_OKAY ||
+            (mode == CALLBACK && source->SetStreamCallback(CallbackHandler) != hrgls_STATUS_OKAY) ||
+            source->SetStreamingState(true) != hrgls_STATUS_OKAY) {
+          std::cerr << "Could not start " << ModeName(mode) << " source " << s << " on API "
+            << a << std::endl;
+          return 2;
+        }
+        for (int c = 0; mode != CALLBACK && c < numConsumers; c++) {
+          consumers.emplace_back(Consume, source, mode);
+        }
+      }
+    }
+    std::cout << numAPIs << " APIs x " << numSources << " sources x " << numConsumers <<
+      " consumers for " << seconds << " s" << std::endl;
+    std::cout << "  time  blobs/s  p99 ms  queued  RSS MiB  threads  fds  handle allocs"
+      "  buffer allocs" << std::endl;
+
+    //------------------------------------------------------
+    // Sample everything at each interval, churning sources in between.
+    std::vector<std::vector<uint64_t> > lastHistograms(sources.size());
+    uint64_t lastBlobs = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point last = start;
+    size_t churned = 0;
+    while (ret == 0 && std::chrono::duration<double>(last - start).count() < seconds) {
+      Clock::time_point next = last + std::chrono::microseconds(
+        static_cast<int64_t>(interval * 1e6));
+      while (Clock::now() < next) {
+        std::thread churn(Churn, apis[churned++ % apis.size()].get());
+        churn.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+      Clock::time_point now = Clock::now();
+      double dt = std::chrono::duration<double>(now - last).count();
+      last = now;
+
+      Sample sample;
+      sample.seconds = std::chrono::duration<double>(now - start).count();
+      uint64_t blobs = g_blobs.load();
+      sample.rate = (blobs - lastBlobs) / dt;
+      lastBlobs = blobs;
+
+      // Latencies over the interval come from the change in each source's histogram.
+      std::vector<uint64_t> histogram(hrgls_STATISTICS_HISTOGRAM_BINS);
+      sample.queued = 0;
+      for (size_t i = 0; i < sources.size(); i++) {
+        hrgls::StreamStatistics stats = sources[i]->GetStatistics();
+        const std::vector<uint64_t> &h = stats.LatencyHistogram();
+        lastHistograms[i].resize(h.size());
+        for (size_t b = 0; b < h.size() && b < histogram.size(); b++) {
+          histogram[b] += h[b] - lastHistograms[i][b];
+        }
+        lastHistograms[i] = h;
+        if (stats.QueueDepth() > QUEUE_CAPACITY) {
+          std::cerr << "Source " << i << " has " << stats.QueueDepth() << " blobs queued" <<
+            std::endl;
+          ret = 3;
+        }
+        sample.queued += stats.QueueDepth();
+      }
+      sample.latency99 = 1e-9 * hrgls::StreamStatistics::HistogramPercentile(histogram, 0.99);
+
+      sample.resources = ReadResources();
+      uint64_t misses = 0;
+      sample.handleMisses = 0;
+      hrgls_HandlePoolGetStatistics(hrgls_HANDLE_POOL_DATABLOB, nullptr, &misses);
+      sample.handleMisses += misses;
+      hrgls_HandlePoolGetStatistics(hrgls_HANDLE_POOL_DATABLOB_PAYLOAD, nullptr, &misses);
+      sample.handleMisses += misses;
+      sample.bufferMisses = 0;
+      for (size_t a = 0; a < apis.size(); a++) {
+        hrgls_BufferPoolGetStatistics(apis[a]->GetBufferPool(), nullptr, &misses);
+        sample.bufferMisses += misses;
+      }
+      samples.push_back(sample);
+
+      std::cout << std::fixed << std::setprecision(1) << std::setw(6) << sample.seconds <<
+        std::setw(9) << sample.rate << std::setw(8) << 1e3 * sample.latency99 <<
+        std::setw(8) << sample.queued << std::setw(9) << sample.resources.rss / (1 << 20) <<
+        std::setw(9) << sample.resources.threads << std::setw(5) << sample.resources.fds <<
+        std::setw(15) << sample.handleMisses << std::setw(15) << sample.bufferMisses <<
+        std::endl;
+      if (sample.rate == 0) {
+        std::cerr << "Streaming stopped" << std::endl;
+        ret = 4;
+      }
+    }
+
+    g_quit = true;
+    for (size_t i = 0; i < consumers.size(); i++) {
+      consumers[i].join();
+    }
+    for (size_t i = 0; i < sources.size(); i++) {
+      sources[i]->SetStreamingState(false);
+      sources[i]->SetStreamCallback(nullptr);
+    }
+    if (g_badBlobs.load() != 0) {
+      std::cerr << g_badBlobs.load() << " blobs had bad data" << std::endl;
+      ret = 5;
+    }
+  }
+  if (ret != 0) {
+    return ret;
+  }
+
+  //------------------------------------------------------
+  // Compare the end of the run with the end of the warm-up.
+  if (samples.size() <= warmup) {
+    std::cerr << "Not enough samples after the warm-up" << std::endl;
+    return 6;
+  }
+  const Sample &base = samples[warmup - 1];
+  const Sample &end = samples.back();
+  uint64_t numStreams = static_cast<uint64_t>(numAPIs) * numSources;
+  if (end.resources.rss - base.resources.rss > MAX_RSS_GROWTH) {
+    std::cerr << "Resident memory grew by " << (end.resources.rss - base.resources.rss) /
+      (1 << 20) << " MiB" << std::endl;
+    return 7;
+  }
+  if (end.resources.threads > base.resources.threads || end.resources.fds > base.resources.fds) {
+    std::cerr << "Threads went from " << base.resources.threads << " to " <<
+      end.resources.threads << " and descriptors from " << base.resources.fds << " to " <<
+      end.resources.fds << std::endl;
+    return 8;
+  }
+  if (end.handleMisses - base.handleMisses > MAX_ALLOCATIONS_PER_SOURCE * numStreams ||
+      end.bufferMisses - base.bufferMisses > MAX_ALLOCATIONS_PER_SOURCE * numStreams) {
+    std::cerr << "Allocated " << end.handleMisses - base.handleMisses << " handles and " <<
+      end.bufferMisses - base.bufferMisses << " buffers after the warm-up" << std::endl;
+    return 9;
+  }
+  double latencyLimit = MAX_LATENCY_RATIO * samples[warmup - 1].latency99;
+  if (latencyLimit < MIN_LATENCY_LIMIT) {
+    latencyLimit = MIN_LATENCY_LIMIT;
+  }
+  for (size_t i = warmup; i < samples.size(); i++) {
+    if (samples[i].latency99 > latencyLimit) {
+      std::cerr << "Latency drifted to " << 1e3 * samples[i].latency99 << " ms at " <<
+        samples[i].seconds << " s" << std::endl;
+      return 10;
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
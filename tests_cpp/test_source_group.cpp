@@ -0,0 +1,165 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// a DataBlobSourceGroup creates all of the listed sources or named ones, that
+// starting and stopping the group starts and stops each of its sources, that its
+// sources can be used like any others, and that the C interface keeps the sources
+// owned by their group.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <hrgls_api.hpp>
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    const uint32_t numSources = 2000;
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", numSources);
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+    std::vector<hrgls::DataBlobSourceDescription> sources = api.GetAvailableDataBlobSources();
+    hrgls::StreamProperties sp;
+    sp.Rate(1000);
+
+    //------------------------------------------------------
+    // An empty list makes one of each of the available sources, all of which
+    // stream once the group is started.
+    {
+      hrgls::datablob::DataBlobSourceGroup group(api, sp);
+      if (group.GetStatus() != hrgls_STATUS_OKAY || group.Size() != numSources) {
+        std::cerr << "Could not create a group of all sources" << std::endl;
+        return 2;
+      }
+      if (group.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not start the group" << std::endl;
+        return 3;
+      }
+      struct timeval timeout = { 2, 0 };
+      size_t which[] = { 0, numSources / 2, numSources - 1 };
+      for (size_t i = 0; i < sizeof(which) / sizeof(which[0]); i++) {
+        hrgls::datablob::DataBlob blob = group[which[i]].GetNextBlob(timeout);
+        if (group[which[i]].GetStatus() != hrgls_STATUS_OKAY || blob.Size() == 0) {
+          std::cerr << "No blob from source " << which[i] << " of a started group" << std::endl;
+          return 4;
+        }
+      }
+
+      // Sources in a group can be waited on like any others.
+      hrgls::datablob::DataBlobMultiplexer mux(api);
+      uint32_t sourceId = 0;
+      if (mux.AddSource(group[7], 7) != hrgls_STATUS_OKAY ||
+          mux.GetNextBlob(sourceId, timeout).Size() == 0 || sourceId != 7) {
+        std::cerr << "Could not multiplex a source in a group" << std::endl;
+        return 5;
+      }
+
+      // Once stopped, a drained source stays empty.
+      if (group.SetStreamingState(false) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not stop the group" << std::endl;
+        return 6;
+      }
+      hrgls::datablob::DataBlobSource &last = group[numSources - 1];
+      last.GetPendingBlobs();
+      struct timeval wait = { 0, 50000 };
+      last.GetNextBlob(wait);
+      if (last.GetNextBlob(wait).Size() != 0 || last.GetStatus() != hrgls_STATUS_TIMEOUT) {
+        std::cerr << "Source streamed after its group was stopped" << std::endl;
+        return 7;
+      }
+    }
+
+    //------------------------------------------------------
+    // Named sources are made in the order given, and one missing name fails the group.
+    {
+      std::vector<std::string> names;
+      names.push_back(sources[10].Name());
+      names.push_back(sources[3].Name());
+      hrgls::datablob::DataBlobSourceGroup named(api, sp, names);
+      if (named.GetStatus() != hrgls_STATUS_OKAY || named.Size() != 2) {
+        std::cerr << "Could not create a group of named sources" << std::endl;
+        return 8;
+      }
+      names.push_back("/hrgls/null/DataBlobSource/none");
+      hrgls::datablob::DataBlobSourceGroup missing(api, sp, names);
+      if (missing.GetStatus() != hrgls_STATUS_BAD_PARAMETER || missing.Size() != 0) {
+        std::cerr << "Group with a missing source did not fail" << std::endl;
+        return 9;
+      }
+    }
+
+    //------------------------------------------------------
+    // The C interface makes the first sources when not given names.
+    hrgls_APICreateParams apiParams;
+    hrgls_APICreateParametersCreate(&apiParams);
+    hrgls_APICreateParametersSetSourceCount(apiParams, 8);
+    hrgls_API rawAPI = nullptr;
+    if (hrgls_APICreate(&rawAPI, apiParams) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not create C API" << std::endl;
+      return 10;
+    }
+    hrgls_APICreateParametersDestroy(apiParams);
+    hrgls_StreamProperties props = nullptr;
+    hrgls_DataBlobSourceCreateParams params = nullptr;
+    hrgls_StreamPropertiesCreate(&props);
+    hrgls_DataBlobSourceCreateParametersCreate(&params);
+    hrgls_DataBlobSourceCreateParametersSetAPI(params, rawAPI);
+    hrgls_DataBlobSourceCreateParametersSetStreamProperties(params, props);
+
+    hrgls_DataBlobSourceGroup rawGroup = nullptr;
+    const char *rawNames[] = { "" };
+    uint32_t count = 0;
+    if (hrgls_DataBlobSourceGroupCreate(&rawGroup, params, nullptr, 9) !=
+          hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_DataBlobSourceGroupCreate(&rawGroup, params, rawNames, 0) !=
+          hrgls_STATUS_BAD_PARAMETER || rawGroup != nullptr) {
+      std::cerr << "Bad group was created" << std::endl;
+      return 11;
+    }
+    if (hrgls_DataBlobSourceGroupCreate(&rawGroup, params, nullptr, 5) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSourceGroupGetCount(rawGroup, &count) != hrgls_STATUS_OKAY || count != 5) {
+      std::cerr << "Could not create C group" << std::endl;
+      return 12;
+    }
+    hrgls_DataBlobSource rawSource = nullptr, outOfRange = nullptr;
+    if (hrgls_DataBlobSourceGroupGetSource(rawGroup, 4, &rawSource) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSourceGroupGetSource(rawGroup, 5, &outOfRange) !=
+          hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_DataBlobSourceDestroy(rawSource) != hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_DataBlobSourceGroupSetStreamingState(rawGroup, true) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSourceGroupSetStreamingState(nullptr, true) !=
+          hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Bad status from C group functions" << std::endl;
+      return 13;
+    }
+    if (hrgls_DataBlobSourceGroupDestroy(rawGroup) != hrgls_STATUS_OKAY ||
+        hrgls_DataBlobSourceGroupDestroy(nullptr) != hrgls_STATUS_DELETE_OF_NULL_POINTER) {
+      std::cerr << "Bad status destroying C group" << std::endl;
+      return 14;
+    }
+    hrgls_DataBlobSourceCreateParametersDestroy(params);
+    hrgls_StreamPropertiesDestroy(props);
+    hrgls_APIDestroy(rawAPI);
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
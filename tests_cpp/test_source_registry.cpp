@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// the list of available DataBlobSources carries a generation that tells clients
+// when it has changed, that handlers are told about each change, that sources can
+// be opened by name from a long list, and that the C interface keeps the list it
+// latched until it changes.
+
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <hrgls_api.hpp>
+
+/// @brief What the changed handler has been told.
+struct Changes {
+  size_t calls = 0;
+  uint64_t generation = 0;
+};
+
+static void CountChange(uint64_t generation, void *userData)
+{
+  Changes *changes = static_cast<Changes*>(userData);
+  changes->calls++;
+  changes->generation = generation;
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    const uint32_t numSources = 5000;
+    hrgls::API api(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", numSources);
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+
+    //------------------------------------------------------
+    // The generation stays the same while the list does.
+    uint64_t generation = api.GetDataBlobSourceGeneration();
+    std::vector<hrgls::DataBlobSourceDescription> sources = api.GetAvailableDataBlobSources();
+    if (api.GetStatus() != hrgls_STATUS_OKAY || generation == 0 || sources.size() != numSources ||
+        api.GetDataBlobSourceGeneration() != generation ||
+        api.DataBlobSourcesChangedSince(generation) || !api.DataBlobSourcesChangedSince(0)) {
+      std::cerr << "Bad generation for an unchanged list" << std::endl;
+      return 2;
+    }
+
+    //------------------------------------------------------
+    // Sources are found by name from anywhere in the list.
+    {
+      hrgls::StreamProperties sp;
+      hrgls::datablob::DataBlobSource last(api, sp, sources.back().Name());
+      hrgls::datablob::DataBlobSource first(api, sp);
+      hrgls::datablob::DataBlobSource missing(api, sp, "/hrgls/null/DataBlobSource/none");
+      if (last.GetStatus() != hrgls_STATUS_OKAY || first.GetStatus() != hrgls_STATUS_OKAY ||
+          missing.GetStatus() != hrgls_STATUS_BAD_PARAMETER) {
+        std::cerr << "Could not find sources by name" << std::endl;
+        return 3;
+      }
+    }
+
+    //------------------------------------------------------
+    // The C interface keeps what it latched while the list is unchanged.
+    hrgls_API rawAPI = nullptr;
+    {
+      hrgls_APICreateParams params;
+      hrgls_APICreateParametersCreate(&params);
+      hrgls_APICreateParametersSetSourceCount(params, 3);
+      if (hrgls_APICreate(&rawAPI, params) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create C API" << std::endl;
+        return 4;
+      }
+      hrgls_APICreateParametersDestroy(params);
+    }
+    uint32_t count = 0, again = 0;
+    hrgls_APIDataBlobSourceInfo info = nullptr, infoAgain = nullptr;
+    uint64_t rawGeneration = 0;
+    if (hrgls_APIGetAvailableDataBlobSourceCount(rawAPI, &count) != hrgls_STATUS_OKAY ||
+        hrgls_APIGetAvailableDataBlobSourceInfo(rawAPI, 2, &info) != hrgls_STATUS_OKAY ||
+        hrgls_APIGetAvailableDataBlobSourceCount(rawAPI, &again) != hrgls_STATUS_OKAY ||
+        hrgls_APIGetAvailableDataBlobSourceInfo(rawAPI, 2, &infoAgain) != hrgls_STATUS_OKAY ||
+        hrgls_APIGetDataBlobSourceGeneration(rawAPI, &rawGeneration) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not read C source list" << std::endl;
+      return 5;
+    }
+    if (count != 3 || again != 3 || info != infoAgain || rawGeneration == 0) {
+      std::cerr << "C source list was not kept while unchanged" << std::endl;
+      return 6;
+    }
+    if (hrgls_APIGetDataBlobSourceGeneration(nullptr, &rawGeneration) !=
+          hrgls_STATUS_NULL_OBJECT_POINTER ||
+        hrgls_APIGetDataBlobSourceGeneration(rawAPI, nullptr) != hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_APISetDataBlobSourcesChangedCallback(nullptr, CountChange, nullptr) !=
+          hrgls_STATUS_NULL_OBJECT_POINTER) {
+      std::cerr << "Bad status from C generation functions" << std::endl;
+      return 7;
+    }
+
+#ifdef __linux__
+    //------------------------------------------------------
+    // Adding a recording changes the list and tells the handler.
+    std::string fileName = "test_source_registry.rec";
+    {
+      hrgls::datablob::DataBlobRecorder recorder(fileName);
+      hrgls::StreamProperties sp;
+      sp.Rate(1000);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      stream.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      hrgls::datablob::DataBlob blob = stream.GetNextBlob(timeout);
+      if (recorder.Record(blob) != hrgls_STATUS_OKAY || recorder.Flush() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not make a recording" << std::endl;
+        return 8;
+      }
+    }
+    Changes changes;
+    if (api.SetDataBlobSourcesChangedCallback(CountChange, &changes) != hrgls_STATUS_OKAY ||
+        api.AddReplayFile(fileName) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not add recording" << std::endl;
+      return 9;
+    }
+    uint64_t changed = api.GetDataBlobSourceGeneration();
+    if (changes.calls != 1 || changes.generation != changed || changed <= generation ||
+        !api.DataBlobSourcesChangedSince(generation) ||
+        api.GetAvailableDataBlobSources().size() != numSources + 1) {
+      std::cerr << "Adding a recording was not reported" << std::endl;
+      return 10;
+    }
+
+    // Adding it again changes nothing, and a removed handler is not called.
+    api.AddReplayFile(fileName);
+    if (changes.calls != 1 || api.GetDataBlobSourceGeneration() != changed) {
+      std::cerr << "Adding a listed recording was reported" << std::endl;
+      return 11;
+    }
+
+    // The C interface latches the list again once it has changed.
+    Changes rawChanges;
+    hrgls_APISetDataBlobSourcesChangedCallback(rawAPI, CountChange, &rawChanges);
+    hrgls_APIAddReplayFile(rawAPI, fileName.c_str());
+    hrgls_APISetDataBlobSourcesChangedCallback(rawAPI, nullptr, nullptr);
+    const char *name = nullptr;
+    if (rawChanges.calls != 1 ||
+        hrgls_APIGetAvailableDataBlobSourceCount(rawAPI, &count) != hrgls_STATUS_OKAY ||
+        count != 4 ||
+        hrgls_APIGetAvailableDataBlobSourceInfo(rawAPI, 3, &info) != hrgls_STATUS_OKAY ||
+        hrgls_APIDataBlobSourceGetName(info, &name) != hrgls_STATUS_OKAY ||
+        std::string(name) != "/hrgls/replay/" + fileName) {
+      std::cerr << "C source list was not latched again after a change" << std::endl;
+      return 12;
+    }
+    std::remove(fileName.c_str());
+    std::remove((fileName + ".idx").c_str());
+#endif
+    hrgls_APIDestroy(rawAPI);
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// DataBlobSources and the log-message path count what passes through them, and that
+// the statistics can be read through both the C++ and C interfaces.
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <hrgls_api.hpp>
+
+static uint64_t Sum(const std::vector<uint64_t> &histogram)
+{
+  uint64_t ret = 0;
+  for (size_t i = 0; i < histogram.size(); i++) {
+    ret += histogram[i];
+  }
+  return ret;
+}
+
+static void SlowCallback(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    //------------------------------------------------------
+    // Histogram bins and percentiles.
+    if (hrgls::StreamStatistics::HistogramBin(0) != 0 ||
+        hrgls::StreamStatistics::HistogramBin(1) != 1 ||
+        hrgls::StreamStatistics::HistogramBin(1023) != 10 ||
+        hrgls::StreamStatistics::HistogramBin(1024) != 11 ||
+        hrgls::StreamStatistics::HistogramBin(2047) != 11 ||
+        hrgls::StreamStatistics::HistogramBin(~uint64_t(0)) != hrgls_STATISTICS_HISTOGRAM_BINS - 1) {
+      std::cerr << "Bad histogram bins" << std::endl;
+      return 1;
+    }
+    std::vector<uint64_t> histogram(hrgls_STATISTICS_HISTOGRAM_BINS);
+    histogram[11] = 90;
+    histogram[21] = 10;
+    if (hrgls::StreamStatistics::HistogramPercentile(histogram, 0.5) != 2047 ||
+        hrgls::StreamStatistics::HistogramPercentile(histogram, 0.95) != (1 << 21) - 1 ||
+        hrgls::StreamStatistics::HistogramPercentile(std::vector<uint64_t>(10), 0.5) != 0) {
+      std::cerr << "Bad histogram percentiles" << std::endl;
+      return 2;
+    }
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 3;
+    }
+    struct timeval timeout = { 1, 0 };
+
+    //------------------------------------------------------
+    // Blobs retrieved one at a time and in batches.
+    {
+      hrgls::StreamProperties sp;
+      sp.Rate(1000);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      hrgls::StreamStatistics stats = stream.GetStatistics();
+      if (stream.GetStatus() != hrgls_STATUS_OKAY || stats.Produced() != 0 ||
+          stats.Delivered() != 0 || stats.LatencyHistogram().size() != hrgls_STATISTICS_HISTOGRAM_BINS) {
+        std::cerr << "Bad statistics for a new source" << std::endl;
+        return 4;
+      }
+      stream.SetStreamingState(true);
+      for (size_t i = 0; i < 20; i++) {
+        stream.GetNextBlob(timeout);
+        if (stream.GetStatus() != hrgls_STATUS_OKAY) {
+          std::cerr << "Could not get blob" << std::endl;
+          return 5;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      size_t batch = stream.GetPendingBlobs(0, timeout).size();
+      stream.SetStreamingState(false);
+
+      stats = stream.GetStatistics();
+      if (stats.Delivered() != 20 + batch || stats.Produced() < stats.Delivered() ||
+          Sum(stats.LatencyHistogram()) != stats.Delivered() ||
+          stats.LatencyMax() * stats.Delivered() < stats.LatencyTotal() ||
+          stats.Callbacks() != 0 || Sum(stats.CallbackDurationHistogram()) != 0) {
+        std::cerr << "Bad statistics for retrieved blobs" << std::endl;
+        return 6;
+      }
+      // Blobs were being waited for, so they should not have been queued for long.
+      if (hrgls::StreamStatistics::HistogramPercentile(stats.LatencyHistogram(), 0.5) > 100000000) {
+        std::cerr << "Latency too large" << std::endl;
+        return 7;
+      }
+    }
+
+    //------------------------------------------------------
+    // Blobs handed to a callback handler.
+    {
+      hrgls::StreamProperties sp;
+      sp.Rate(200);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      stream.SetStreamCallback(SlowCallback, nullptr);
+      stream.SetStreamingState(true);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      stream.SetStreamingState(false);
+      stream.SetStreamCallback(nullptr, nullptr);
+
+      hrgls::StreamStatistics stats = stream.GetStatistics();
+      if (stats.Callbacks() < 5 || stats.Delivered() != stats.Callbacks() ||
+          Sum(stats.CallbackDurationHistogram()) != stats.Callbacks() ||
+          stats.CallbackDurationMax() < 1000000 ||
+          stats.CallbackDurationTotal() < 1000000 * stats.Callbacks() ||
+          hrgls::StreamStatistics::HistogramPercentile(stats.CallbackDurationHistogram(), 0.5)
+            < 1000000) {
+        std::cerr << "Bad statistics for callbacks" << std::endl;
+        return 8;
+      }
+    }
+
+    //------------------------------------------------------
+    // Blobs left in the queue until it overflows.
+    {
+      hrgls::StreamProperties sp;
+      sp.Rate(1000);
+      sp.QueueCapacity(10);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      stream.SetStreamingState(true);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      stream.SetStreamingState(false);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+      hrgls::StreamStatistics stats = stream.GetStatistics();
+      if (stats.QueueDepth() != 10 || stats.MaxQueueDepth() != 10 || stats.Dropped() == 0 ||
+          stats.Dropped() != stream.GetDroppedBlobCount() ||
+          stats.Produced() != stats.Dropped() + stats.QueueDepth() || stats.Delivered() != 0) {
+        std::cerr << "Bad statistics for an overflowing queue" << std::endl;
+        return 9;
+      }
+    }
+
+    //------------------------------------------------------
+    // Log messages.
+    {
+      hrgls::API loud(hrgls::ANONYMOUS_USER, hrgls::NO_CREDENTIALS, 0, "", "", 2, 1000);
+      loud.SetLogMessageStreamingState(true);
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      loud.SetLogMessageStreamingState(false);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      size_t count = loud.GetPendingLogMessages().size();
+
+      hrgls::StreamStatistics stats = loud.GetLogMessageStatistics();
+      if (loud.GetStatus() != hrgls_STATUS_OKAY || count == 0 || stats.Delivered() != count ||
+          stats.Produced() != count + stats.Dropped() || stats.QueueDepth() != 0 ||
+          stats.MaxQueueDepth() == 0 || Sum(stats.LatencyHistogram()) != count) {
+        std::cerr << "Bad statistics for log messages" << std::endl;
+        return 10;
+      }
+    }
+
+    //------------------------------------------------------
+    // The parts of the C interface that the C++ one does not use.
+    {
+      hrgls_StreamStatistics stats;
+      if (hrgls_StreamStatisticsCreate(nullptr) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_StreamStatisticsCreate(&stats) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create C statistics" << std::endl;
+        return 11;
+      }
+      uint64_t delivered = 42;
+      uint64_t counts[hrgls_STATISTICS_HISTOGRAM_BINS + 2];
+      counts[hrgls_STATISTICS_HISTOGRAM_BINS + 1] = 42;
+      if (hrgls_DataBlobSourceGetStatistics(nullptr, stats) != hrgls_STATUS_NULL_OBJECT_POINTER ||
+          hrgls_APIGetLogMessageStatistics(nullptr, stats) != hrgls_STATUS_NULL_OBJECT_POINTER ||
+          hrgls_StreamStatisticsGetDelivered(stats, &delivered) != hrgls_STATUS_OKAY ||
+          hrgls_StreamStatisticsGetDelivered(stats, nullptr) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_StreamStatisticsGetDelivered(nullptr, &delivered) != hrgls_STATUS_NULL_OBJECT_POINTER ||
+          hrgls_StreamStatisticsGetLatencyHistogram(stats, nullptr, 1) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_StreamStatisticsGetLatencyHistogram(stats, counts,
+            hrgls_STATISTICS_HISTOGRAM_BINS + 2) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not read C statistics" << std::endl;
+        return 12;
+      }
+      if (delivered != 0 || counts[hrgls_STATISTICS_HISTOGRAM_BINS + 1] != 0) {
+        std::cerr << "Bad C statistics" << std::endl;
+        return 13;
+      }
+      if (hrgls_StreamStatisticsDestroy(stats) != hrgls_STATUS_OKAY ||
+          hrgls_StreamStatisticsDestroy(nullptr) != hrgls_STATUS_DELETE_OF_NULL_POINTER) {
+        std::cerr << "Could not destroy C statistics" << std::endl;
+        return 14;
+      }
+    }
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// changing the StreamProperties of a DataBlobSource while it is streaming changes
+// its rate and payload size without recreating it, that a different queue capacity
+// is refused, and that the change reaches a server for a remote source on Linux.
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <hrgls_api.hpp>
+
+/// @brief Count the blobs that arrive in the next interval.
+static size_t CountBlobs(hrgls::datablob::DataBlobSource &source, int milliseconds)
+{
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(milliseconds);
+  size_t ret = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    struct timeval timeout = { 0, 20000 };
+    hrgls::datablob::DataBlob blob = source.GetNextBlob(timeout);
+    if (source.GetStatus() == hrgls_STATUS_OKAY) {
+      ret++;
+    }
+  }
+  return ret;
+}
+
+/// @brief Checks that the rate changes from slow to fast on the fly.
+static int CheckRateChange(hrgls::datablob::DataBlobSource &source, hrgls::StreamProperties &sp)
+{
+  if (source.SetStreamingState(true) != hrgls_STATUS_OKAY) {
+    return 1;
+  }
+  size_t slow = CountBlobs(source, 500);
+  sp.Rate(400);
+  if (source.SetStreamProperties(sp) != hrgls_STATUS_OKAY) {
+    return 2;
+  }
+  size_t fast = CountBlobs(source, 500);
+  if (slow > 30 || fast < 4 * slow || fast < 60) {
+    std::cerr << "Got " << slow << " blobs before and " << fast << " after" << std::endl;
+    return 3;
+  }
+  return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 1;
+    }
+    hrgls::StreamProperties sp;
+    sp.Rate(20);
+    sp.QueueCapacity(64);
+
+    {
+      hrgls::datablob::DataBlobSource source(api, sp);
+      if (source.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create DataBlobSource" << std::endl;
+        return 2;
+      }
+
+      //------------------------------------------------------
+      // The rate changes while streaming.
+      if (int ret = CheckRateChange(source, sp)) {
+        std::cerr << "Rate did not change on the fly (" << ret << ")" << std::endl;
+        return 3;
+      }
+
+      //------------------------------------------------------
+      // The payload size changes and no blob is made with a mix of the two.
+      sp.PayloadSize(100);
+      if (source.SetStreamProperties(sp) != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not change the payload size" << std::endl;
+        return 4;
+      }
+      source.GetPendingBlobs();
+      struct timeval timeout = { 2, 0 };
+      bool changed = false;
+      for (int i = 0; i < 20; i++) {
+        hrgls::datablob::DataBlob blob = source.GetNextBlob(timeout);
+        if (blob.Size() == 100) {
+          changed = true;
+        } else if (changed || blob.Size() != 256) {
+          std::cerr << "Got a blob of size " << blob.Size() << std::endl;
+          return 5;
+        }
+      }
+      if (!changed) {
+        std::cerr << "Payload size did not change" << std::endl;
+        return 6;
+      }
+
+      //------------------------------------------------------
+      // The queue capacity cannot change, and bad calls are reported.
+      hrgls::StreamProperties other(sp);
+      other.QueueCapacity(8);
+      hrgls_StreamProperties raw = nullptr;
+      hrgls_StreamPropertiesCreate(&raw);
+      if (source.SetStreamProperties(other) != hrgls_STATUS_BAD_PARAMETER ||
+          hrgls_DataBlobSourceSetStreamProperties(nullptr, raw) !=
+            hrgls_STATUS_NULL_OBJECT_POINTER) {
+        std::cerr << "Bad changes were accepted" << std::endl;
+        return 7;
+      }
+      hrgls_StreamPropertiesDestroy(raw);
+      source.SetStreamingState(false);
+    }
+
+#ifdef __linux__
+    //------------------------------------------------------
+    // A remote source sends the new properties to the server.
+    uint16_t port = api.StartServer("127.0.0.1:0");
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start server" << std::endl;
+      return 8;
+    }
+    hrgls::API client("", hrgls::NO_CREDENTIALS, 0, "127.0.0.1:" + std::to_string(port));
+    std::vector<hrgls::DataBlobSourceDescription> remote = client.GetAvailableDataBlobSources();
+    if (client.GetStatus() != hrgls_STATUS_OKAY || remote.empty()) {
+      std::cerr << "Could not list remote sources" << std::endl;
+      return 9;
+    }
+    sp.Rate(20);
+    {
+      hrgls::datablob::DataBlobSource source(client, sp, remote[0].Name());
+      if (source.GetStatus() != hrgls_STATUS_OKAY) {
+        std::cerr << "Could not create remote DataBlobSource" << std::endl;
+        return 10;
+      }
+      if (int ret = CheckRateChange(source, sp)) {
+        std::cerr << "Remote rate did not change on the fly (" << ret << ")" << std::endl;
+        return 11;
+      }
+      source.SetStreamingState(false);
+    }
+#endif
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
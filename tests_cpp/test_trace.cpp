@@ -0,0 +1,231 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This program is meant to be run against the Null implementation to verify that
+// tracing records what streams and callbacks do on each thread, that the file that
+// hrgls_TraceDump() writes can be read back, that rings keep only their newest events,
+// and that the trace_to_json tool converts the file.  The build tells it where the
+// tool is in HRGLS_TRACE_TO_JSON.
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <hrgls_api.hpp>
+
+/// @brief The contents of a trace file.
+struct Trace {
+  std::vector<std::string> names;
+  std::vector<hrgls_TraceEvent> events;
+};
+
+/// @brief Read a trace file in the format described for hrgls_TraceEvent.
+static bool ReadTrace(const std::string &fileName, Trace &trace)
+{
+  FILE *f = fopen(fileName.c_str(), "rb");
+  if (!f) {
+    return false;
+  }
+  char magic[8];
+  uint32_t version = 0, nameCount = 0;
+  bool ok = fread(magic, 1, 8, f) == 8 && memcmp(magic, "HRGLSTRC", 8) == 0 &&
+    fread(&version, sizeof(version), 1, f) == 1 && version == 1 &&
+    fread(&nameCount, sizeof(nameCount), 1, f) == 1;
+  for (uint32_t i = 0; ok && i < nameCount; i++) {
+    uint32_t length = 0;
+    ok = fread(&length, sizeof(length), 1, f) == 1;
+    std::string name(length, '\0');
+    ok = ok && (length == 0 || fread(&name[0], 1, length, f) == length);
+    trace.names.push_back(name);
+  }
+  uint64_t eventCount = 0;
+  ok = ok && fread(&eventCount, sizeof(eventCount), 1, f) == 1;
+  if (ok) {
+    trace.events.resize(static_cast<size_t>(eventCount));
+    ok = eventCount == 0 ||
+      fread(trace.events.data(), sizeof(hrgls_TraceEvent), trace.events.size(), f) ==
+        trace.events.size();
+  }
+  // Nothing should follow the events.
+  ok = ok && fgetc(f) == EOF;
+  fclose(f);
+  return ok;
+}
+
+static void SlowCallback(hrgls::datablob::DataBlob &blob, void *userData)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+int main(int argc, const char *argv[])
+{
+  { // Putting test code in a basic block so that objects are destroyed before
+    // we print the Success! message below.
+
+    std::string fileName = "test_trace.trace";
+    if (hrgls_TraceDump(nullptr) != hrgls_STATUS_BAD_PARAMETER ||
+        hrgls_TraceDump("no_such_directory/test_trace.trace") != hrgls_STATUS_FILE_ERROR) {
+      std::cerr << "Bad status from writing a trace file" << std::endl;
+      return 1;
+    }
+
+    //------------------------------------------------------
+    // Trace a stream that is read with GetNextBlob() and then handed to a callback.
+    hrgls::API api;
+    if (api.GetStatus() != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not Open API" << std::endl;
+      return 2;
+    }
+    if (hrgls_TraceStart(0) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not start tracing" << std::endl;
+      return 3;
+    }
+    {
+      hrgls::StreamProperties sp;
+      sp.Rate(1000);
+      hrgls::datablob::DataBlobSource stream(api, sp);
+      stream.SetStreamingState(true);
+      struct timeval timeout = { 1, 0 };
+      for (size_t i = 0; i < 10; i++) {
+        stream.GetNextBlob(timeout);
+      }
+      stream.SetStreamCallback(SlowCallback, nullptr);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      stream.SetStreamingState(false);
+      stream.SetStreamCallback(nullptr, nullptr);
+    }
+    hrgls_TraceRecord(hrgls_TRACE_USER, 42, 1);
+    hrgls_TraceRecord(hrgls_TRACE_C_ENTER, 42, 2);
+    hrgls_TraceStop();
+    hrgls_TraceRecord(hrgls_TRACE_USER, 43, 3);
+    if (hrgls_TraceDump(fileName.c_str()) != hrgls_STATUS_OKAY) {
+      std::cerr << "Could not write trace" << std::endl;
+      return 4;
+    }
+
+    Trace trace;
+    if (!ReadTrace(fileName, trace)) {
+      std::cerr << "Could not read trace" << std::endl;
+      return 5;
+    }
+    std::map<hrgls_TraceEventType, size_t> counts;
+    std::map<uint32_t, uint64_t> lastTimes;
+    std::map<uint32_t, int> callbackDepths, cDepths;
+    bool ordered = true, nested = true, sawNextBlob = false;
+    for (const hrgls_TraceEvent &e : trace.events) {
+      counts[e.type]++;
+      if (e.time < lastTimes[e.thread]) {
+        ordered = false;
+      }
+      lastTimes[e.thread] = e.time;
+      if (e.type == hrgls_TRACE_CALLBACK_BEGIN) {
+        callbackDepths[e.thread]++;
+      }
+      if (e.type == hrgls_TRACE_CALLBACK_END && --callbackDepths[e.thread] < 0) {
+        nested = false;
+      }
+      if (e.type == hrgls_TRACE_C_ENTER || e.type == hrgls_TRACE_C_EXIT) {
+        if (e.value >= trace.names.size()) {
+          nested = false;
+        } else if (trace.names[e.value] == "hrgls_DataBlobSourceGetNextBlob") {
+          sawNextBlob = true;
+        }
+        cDepths[e.thread] += e.type == hrgls_TRACE_C_ENTER ? 1 : -1;
+        if (cDepths[e.thread] < 0) {
+          nested = false;
+        }
+      }
+      if (e.type == hrgls_TRACE_USER && (e.object != 42 || e.value != 1)) {
+        std::cerr << "Recorded a user event after tracing stopped" << std::endl;
+        return 6;
+      }
+    }
+    if (!ordered || !nested) {
+      std::cerr << "Events out of order on a thread" << std::endl;
+      return 7;
+    }
+    if (counts[hrgls_TRACE_BLOB_PRODUCED] < 10 || counts[hrgls_TRACE_BLOB_ENQUEUED] == 0 ||
+        counts[hrgls_TRACE_BLOB_DEQUEUED] < 10 || counts[hrgls_TRACE_CALLBACK_BEGIN] == 0 ||
+        counts[hrgls_TRACE_CALLBACK_BEGIN] != counts[hrgls_TRACE_CALLBACK_END] ||
+        counts[hrgls_TRACE_C_ENTER] < 10 ||
+        counts[hrgls_TRACE_C_ENTER] != counts[hrgls_TRACE_C_EXIT] || !sawNextBlob ||
+        counts[hrgls_TRACE_USER] != 1) {
+      std::cerr << "Missing trace events" << std::endl;
+      return 8;
+    }
+
+    //------------------------------------------------------
+    // The tool turns the trace into JSON.
+#ifdef HRGLS_TRACE_TO_JSON
+    {
+      std::string jsonName = "test_trace.json";
+      std::string command = std::string("\"") + HRGLS_TRACE_TO_JSON + "\" " + fileName + " " +
+        jsonName;
+      if (system(command.c_str()) != 0) {
+        std::cerr << "Could not run " << command << std::endl;
+        return 9;
+      }
+      std::ifstream json(jsonName.c_str());
+      std::stringstream contents;
+      contents << json.rdbuf();
+      if (contents.str().find("\"traceEvents\"") == std::string::npos ||
+          contents.str().find("\"hrgls_DataBlobSourceGetNextBlob\"") == std::string::npos ||
+          contents.str().find("\"callback\"") == std::string::npos) {
+        std::cerr << "Bad JSON from trace_to_json" << std::endl;
+        return 10;
+      }
+      json.close();
+      std::remove(jsonName.c_str());
+    }
+#endif
+
+    //------------------------------------------------------
+    // Rings keep the newest events, and starting again clears them.
+    hrgls_TraceStart(16);
+    for (uint64_t i = 0; i < 100; i++) {
+      hrgls_TraceRecord(hrgls_TRACE_USER, 44, i);
+    }
+    hrgls_TraceStop();
+    trace = Trace();
+    if (hrgls_TraceDump(fileName.c_str()) != hrgls_STATUS_OKAY || !ReadTrace(fileName, trace)) {
+      std::cerr << "Could not write and read small trace" << std::endl;
+      return 11;
+    }
+    if (trace.events.size() != 16 || !trace.names.empty()) {
+      std::cerr << "Bad event count in small trace: " << trace.events.size() << std::endl;
+      return 12;
+    }
+    for (size_t i = 0; i < trace.events.size(); i++) {
+      if (trace.events[i].type != hrgls_TRACE_USER || trace.events[i].object != 44 ||
+          trace.events[i].value != 84 + i) {
+        std::cerr << "Ring did not keep the newest events" << std::endl;
+        return 13;
+      }
+    }
+    std::remove(fileName.c_str());
+  }
+
+  std::cout << "Success!" << std::endl;
+  return 0;
+}
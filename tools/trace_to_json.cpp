@@ -0,0 +1,173 @@
+/*
+ * Copyright 2020 ReliaSolve, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Turns a trace file written by hrgls_TraceDump() into the JSON trace-event format
+// that chrome://tracing and Perfetto display.  Callbacks and calls into the C
+// interface become spans on the threads that made them; the other events become
+// instants.  Usage: trace_to_json TRACE_FILE [JSON_FILE]; the JSON goes to standard
+// output when no JSON_FILE is given.
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <hrgls_api.h>
+
+/// @brief Read a value of type T from the file.
+template <class T>
+static bool Read(FILE *f, T &value)
+{
+  return fread(&value, sizeof(value), 1, f) == 1;
+}
+
+/// @brief Quote a string for JSON.
+static std::string Quote(const std::string &s)
+{
+  std::string ret = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      ret += '\\';
+      ret += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      ret += buf;
+    } else {
+      ret += c;
+    }
+  }
+  return ret + "\"";
+}
+
+/// @brief Name shown for events of a type other than the spans.
+static std::string TypeName(hrgls_TraceEventType type)
+{
+  switch (type) {
+  case hrgls_TRACE_BLOB_PRODUCED: return "blob produced";
+  case hrgls_TRACE_BLOB_ENQUEUED: return "blob enqueued";
+  case hrgls_TRACE_BLOB_DEQUEUED: return "blob dequeued";
+  case hrgls_TRACE_BLOB_DROPPED: return "blob dropped";
+  case hrgls_TRACE_MESSAGE_PRODUCED: return "message produced";
+  default: return "user " + std::to_string(type);
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " TRACE_FILE [JSON_FILE]" << std::endl;
+    return 1;
+  }
+
+  FILE *f = fopen(argv[1], "rb");
+  if (!f) {
+    std::cerr << "Could not open " << argv[1] << std::endl;
+    return 2;
+  }
+  char magic[8];
+  uint32_t version = 0, nameCount = 0;
+  if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) ||
+      memcmp(magic, "HRGLSTRC", sizeof(magic)) != 0 || !Read(f, version) || version != 1 ||
+      !Read(f, nameCount)) {
+    std::cerr << argv[1] << " is not a version-1 trace file" << std::endl;
+    fclose(f);
+    return 3;
+  }
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < nameCount; i++) {
+    uint32_t length = 0;
+    if (!Read(f, length)) {
+      break;
+    }
+    std::string name(length, '\0');
+    if (length > 0 && fread(&name[0], 1, length, f) != length) {
+      break;
+    }
+    names.push_back(name);
+  }
+  uint64_t eventCount = 0;
+  if (names.size() != nameCount || !Read(f, eventCount)) {
+    std::cerr << "Truncated trace file " << argv[1] << std::endl;
+    fclose(f);
+    return 4;
+  }
+  std::vector<hrgls_TraceEvent> events;
+  hrgls_TraceEvent e;
+  while (events.size() < eventCount && Read(f, e)) {
+    events.push_back(e);
+  }
+  fclose(f);
+  if (events.size() != eventCount) {
+    std::cerr << "Truncated trace file " << argv[1] << std::endl;
+    return 4;
+  }
+
+  std::ofstream file;
+  if (argc == 3) {
+    file.open(argv[2]);
+    if (!file) {
+      std::cerr << "Could not open " << argv[2] << std::endl;
+      return 5;
+    }
+  }
+  std::ostream &out = (argc == 3) ? file : std::cout;
+
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  for (size_t i = 0; i < events.size(); i++) {
+    const hrgls_TraceEvent &ev = events[i];
+    std::string name, phase = "i";
+    bool hasValue = true;
+    switch (ev.type) {
+    case hrgls_TRACE_CALLBACK_BEGIN:
+    case hrgls_TRACE_CALLBACK_END:
+      name = "callback";
+      phase = ev.type == hrgls_TRACE_CALLBACK_BEGIN ? "B" : "E";
+      hasValue = false;
+      break;
+    case hrgls_TRACE_C_ENTER:
+    case hrgls_TRACE_C_EXIT:
+      name = ev.value < names.size() ? names[ev.value] : "unknown";
+      phase = ev.type == hrgls_TRACE_C_ENTER ? "B" : "E";
+      hasValue = false;
+      break;
+    default:
+      name = TypeName(ev.type);
+    }
+    char object[32];
+    snprintf(object, sizeof(object), "0x%llx", static_cast<unsigned long long>(ev.object));
+    char ts[32];
+    snprintf(ts, sizeof(ts), "%.3f", ev.time / 1000.0);
+
+    out << (i > 0 ? ",\n" : "\n") << "{\"name\":" << Quote(name) << ",\"ph\":\"" << phase
+      << "\",\"ts\":" << ts << ",\"pid\":1,\"tid\":" << ev.thread;
+    if (phase == "i") {
+      out << ",\"s\":\"t\"";
+    }
+    out << ",\"args\":{\"object\":\"" << object << "\"";
+    if (hasValue) {
+      out << ",\"value\":" << ev.value;
+    }
+    out << "}}";
+  }
+  out << "\n]}" << std::endl;
+  if (!out) {
+    std::cerr << "Could not write JSON" << std::endl;
+    return 5;
+  }
+  return 0;
+}